@@ -462,8 +462,8 @@ PHI_DEFINE_EXPORTED_double(
  * Allocator related FLAG
  * Name: FLAGS_allocator_strategy
  * Since Version: 1.2
- * Value Range: string, {naive_best_fit, auto_growth, thread_local},
- * default=auto_growth
+ * Value Range: string, {naive_best_fit, auto_growth, thread_local,
+ * size_class}, default=auto_growth
  * Example:
  * Note: For selecting allocator policy of PaddlePaddle.
  */
@@ -481,7 +481,39 @@ PHI_DEFINE_EXPORTED_string(
     "size of models may be larger). auto_growth strategy would allocate "
     "GPU memory on demand, which allows users to start several Paddle jobs "
     "on the same GPU card but may lead to more memory fragmentation "
-    "(i.e., maximum batch size of models may be smaller).");
+    "(i.e., maximum batch size of models may be smaller). "
+    "size_class serves CPU memory from per-thread size-class caches backed "
+    "by a shared slab arena, other places behave as naive_best_fit.");
+
+/**
+ * Memory related FLAG
+ * Name: FLAGS_size_class_cpu_allocator_use_huge_page
+ * Since Version: 3.0.0
+ * Value Range: bool, default=true
+ * Example:
+ * Note: Whether the size_class CPU allocator advises the kernel to back its
+ *       slabs with transparent huge pages.
+ */
+PHI_DEFINE_EXPORTED_bool(
+    size_class_cpu_allocator_use_huge_page,
+    true,
+    "Whether the size_class CPU allocator backs slabs with huge pages.");
+
+/**
+ * Memory related FLAG
+ * Name: FLAGS_size_class_cpu_allocator_idle_limit_in_mb
+ * Since Version: 3.0.0
+ * Value Range: uint64, default=64 (MB)
+ * Example:
+ * Note: The amount of idle memory one size class of the size_class CPU
+ *       allocator may keep in its central free list before completely free
+ *       slabs are returned to the system.
+ */
+PHI_DEFINE_EXPORTED_uint64(
+    size_class_cpu_allocator_idle_limit_in_mb,
+    64ul,
+    "The idle memory one size class of the size_class CPU allocator keeps "
+    "before free slabs are returned to the system.");
 
 /**
  * Memory related FLAG
@@ -1884,6 +1916,37 @@ PHI_DEFINE_EXPORTED_string(
 PHI_DEFINE_EXPORTED_bool(enable_collect_shape,
                          false,
                          "Collect shapes of value for TensorRTEngine");
+
+/**
+ * PirInterpreter related FLAG
+ * Name: pir_interpreter_shape_bucket_cache_size
+ * Since Version: 3.0.0
+ * Value Range: int32, default=8
+ * Example:
+ * Note: The number of buckets of feed shapes whose inferred metas are cached
+ * by the PirInterpreter of inference, so the runs of these shapes skip
+ * InferMeta. 0 disables the cache.
+ */
+PHI_DEFINE_EXPORTED_int32(pir_interpreter_shape_bucket_cache_size,
+                          8,
+                          "Number of feed shape buckets whose inferred metas "
+                          "are cached by PirInterpreter for inference.");
+
+/**
+ * CPU GEMM related FLAG
+ * Name: cpu_gemm_pack_weight
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_cpu_gemm_pack_weight=true
+ * Note: Pack the weights of the CPU matmul and fc kernels into the layout of
+ * the MKL packed GEMM on first use, and reuse the packed copy while the
+ * weight is neither reallocated nor written in place. Meant for inference,
+ * where the weights do not change. Needs MKL, otherwise it does nothing.
+ */
+PHI_DEFINE_EXPORTED_bool(cpu_gemm_pack_weight,
+                         false,
+                         "Cache the weights of CPU matmul and fc in the MKL "
+                         "packed GEMM layout.");
 // Example: FLAGS_accuracy_check_atol=1e-3 would set the atol to 1e-3.
 PHI_DEFINE_EXPORTED_double(accuracy_check_atol_fp32,
                            1e-6,
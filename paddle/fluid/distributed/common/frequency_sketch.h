@@ -0,0 +1,111 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace paddle {
+namespace distributed {
+
+// Approximate access frequencies of keys, used to decide which keys are
+// worth caching.
+//
+// A count-min sketch of 4 rows of 4 bits counters packed in 64 bits words.
+// Every counter saturates at 15, and all counters are halved once
+// sample_size keys are counted, so the estimation follows the recent
+// accesses. Not thread safe.
+class FrequencySketch {
+ public:
+  static constexpr int kMaxFrequency = 15;
+
+  // Sized to estimate about capacity distinct keys.
+  explicit FrequencySketch(size_t capacity = 0) { Reset(capacity); }
+
+  void Reset(size_t capacity) {
+    size_t words = 16;
+    while (words < capacity) {
+      words <<= 1;
+    }
+    _table.assign(words, 0);
+    _mask = words - 1;
+    _sample_size = words * 10;
+    _size = 0;
+  }
+
+  void Increment(uint64_t key) {
+    uint64_t hash = Hash(key);
+    bool added = false;
+    for (int i = 0; i < 4; ++i) {
+      uint64_t& word = _table[WordOf(hash, i)];
+      int shift = ShiftOf(hash, i);
+      if (((word >> shift) & 0xf) < kMaxFrequency) {
+        word += 1ULL << shift;
+        added = true;
+      }
+    }
+    if (added && ++_size >= _sample_size) {
+      Halve();
+    }
+  }
+
+  int Estimate(uint64_t key) const {
+    uint64_t hash = Hash(key);
+    int frequency = kMaxFrequency;
+    for (int i = 0; i < 4; ++i) {
+      uint64_t word = _table[WordOf(hash, i)];
+      frequency = std::min(
+          frequency, static_cast<int>((word >> ShiftOf(hash, i)) & 0xf));
+    }
+    return frequency;
+  }
+
+  size_t MemorySize() const { return _table.size() * sizeof(uint64_t); }
+
+ private:
+  static uint64_t Hash(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+  }
+  // Every row takes 16 bits of the hash for its word and 4 bits for the
+  // counter in the word.
+  size_t WordOf(uint64_t hash, int row) const {
+    uint64_t h = (hash >> (row * 16)) * 0x9e3779b97f4a7c15ULL;
+    return static_cast<size_t>(h >> 32) & _mask;
+  }
+  static int ShiftOf(uint64_t hash, int row) {
+    return static_cast<int>((hash >> (row * 16 + 12)) & 0xf) << 2;
+  }
+
+  void Halve() {
+    for (auto& word : _table) {
+      word = (word >> 1) & 0x7777777777777777ULL;
+    }
+    _size /= 2;
+  }
+
+  std::vector<uint64_t> _table;
+  size_t _mask;
+  size_t _sample_size;
+  size_t _size;
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -181,7 +181,7 @@ void Carrier::WakeUp() {
   cond_var_.notify_all();
 }
 
-void Carrier::Start() {
+void Carrier::Start(MessagePriority priority, int64_t deadline_us) {
   PADDLE_ENFORCE_EQ(
       is_init_,
       true,
@@ -190,6 +190,8 @@ void Carrier::Start() {
   start_msg.set_dst_id(SOURCE_ID);
   start_msg.set_src_id(SOURCE_ID);
   start_msg.set_message_type(START);
+  start_msg.set_priority(priority);
+  start_msg.set_deadline_us(deadline_us);
   Send(start_msg);
   // TODO(wangxi): async step
   Wait();
@@ -83,7 +83,10 @@ class Carrier final {
   Interceptor* SetInterceptor(int64_t interceptor_id,
                               std::unique_ptr<Interceptor>);
 
-  void Start();
+  // The messages of the run inherit the priority and deadline of the start
+  // message, deadline_us is microseconds since epoch of the system clock.
+  void Start(MessagePriority priority = PRIORITY_NORMAL,
+             int64_t deadline_us = -1);
 
   bool IsInit() const;
 
@@ -14,12 +14,35 @@
 
 #include "paddle/fluid/distributed/fleet_executor/interceptor.h"
 
+#include <algorithm>
+
 #include "paddle/fluid/distributed/fleet_executor/carrier.h"
 #include "paddle/fluid/distributed/fleet_executor/task_loop.h"
 #include "paddle/fluid/distributed/fleet_executor/task_node.h"
 
 namespace paddle::distributed {
 
+namespace {
+
+int64_t NowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// Whether a message of priority a and deadline a is more urgent than one of
+// priority b and deadline b, which matches the order of TaskLoop.
+bool MoreUrgent(MessagePriority priority_a,
+                int64_t deadline_a,
+                MessagePriority priority_b,
+                int64_t deadline_b) {
+  if (priority_a != priority_b) return priority_a > priority_b;
+  if (deadline_a < 0) return false;
+  return deadline_b < 0 || deadline_a < deadline_b;
+}
+
+}  // namespace
+
 Interceptor::Interceptor(int64_t interceptor_id, TaskNode* node)
     : interceptor_id_(interceptor_id),
       node_(node),
@@ -45,24 +68,49 @@ void Interceptor::Handle(const InterceptorMessage& msg) {
 }
 
 void Interceptor::LoopOnce() {
-  std::deque<InterceptorMessage> tmp_messages;
+  std::deque<QueuedMessage> tmp_messages;
   {
     std::lock_guard<std::mutex> lock(mutex_);
     messages_.swap(tmp_messages);
+    scheduled_ = false;
+    stats_.queue_depth = 0;
   }
-  PADDLE_ENFORCE_EQ(tmp_messages.empty(),
-                    false,
-                    common::errors::PreconditionNotMet(
-                        "tmp_messages must not empty in task loop"));
+  // A less urgent LoopOnce queued before a more urgent one finds the
+  // messages already handled.
+  if (tmp_messages.empty()) return;
 
-  for (auto& msg : tmp_messages) {
+  for (auto& queued : tmp_messages) {
+    const InterceptorMessage& msg = queued.msg;
     const MessageType message_type = msg.message_type();
     VLOG(3) << "Interceptor " << interceptor_id_ << " has received a message"
             << " from interceptor " << msg.src_id()
             << " with message: " << message_type << ".";
 
+    int64_t latency_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                             std::chrono::steady_clock::now() -
+                             queued.enqueue_time)
+                             .count();
+    bool missed = msg.deadline_us() >= 0 && NowMicros() > msg.deadline_us();
+    if (missed) {
+      VLOG(2) << "Interceptor " << interceptor_id_ << " handles message "
+              << message_type << " after its deadline " << msg.deadline_us()
+              << ".";
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++stats_.messages;
+      stats_.total_queue_latency_us += latency_us;
+      stats_.max_queue_latency_us =
+          std::max(stats_.max_queue_latency_us, latency_us);
+      if (missed) ++stats_.deadline_misses;
+    }
+
+    handling_priority_ = msg.priority();
+    handling_deadline_us_ = msg.deadline_us();
     Handle(msg);
   }
+  handling_priority_ = PRIORITY_NORMAL;
+  handling_deadline_us_ = -1;
 }
 
 void Interceptor::StopCarrier() {
@@ -78,14 +126,28 @@ void Interceptor::EnqueueRemoteInterceptorMessage(
   VLOG(3) << "Enqueue message: " << message.message_type() << " into "
           << interceptor_id_ << "'s remote mailbox.";
 
-  bool empty = false;
+  bool schedule = false;
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    empty = messages_.empty();
-    messages_.emplace_back(message);
+    messages_.push_back(
+        QueuedMessage{message, std::chrono::steady_clock::now()});
+    stats_.queue_depth = messages_.size();
+    stats_.max_queue_depth =
+        std::max(stats_.max_queue_depth, stats_.queue_depth);
+    if (!scheduled_ || MoreUrgent(message.priority(),
+                                  message.deadline_us(),
+                                  scheduled_priority_,
+                                  scheduled_deadline_us_)) {
+      schedule = true;
+      scheduled_ = true;
+      scheduled_priority_ = message.priority();
+      scheduled_deadline_us_ = message.deadline_us();
+    }
   }
-  if (empty) {
-    loop_->QueueInLoop([this]() { LoopOnce(); });
+  if (schedule) {
+    loop_->QueueInLoop([this]() { LoopOnce(); },
+                       message.priority(),
+                       message.deadline_us());
   }
 }
 
@@ -95,9 +157,16 @@ bool Interceptor::Send(int64_t dst_id, InterceptorMessage& msg) {
       common::errors::PreconditionNotMet("Carrier is not registered."));
   msg.set_src_id(interceptor_id_);
   msg.set_dst_id(dst_id);
+  if (!msg.has_priority()) msg.set_priority(handling_priority_);
+  if (!msg.has_deadline_us()) msg.set_deadline_us(handling_deadline_us_);
   return carrier_->Send(msg);
 }
 
+InterceptorStats Interceptor::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
 static InterceptorFactory::CreateInterceptorMap& GetInterceptorMap() {
   static InterceptorFactory::CreateInterceptorMap interceptorMap;
   return interceptorMap;
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <condition_variable>
 #include <deque>
 #include <functional>
@@ -48,6 +49,19 @@ using InterpreterCore = framework::InterpreterCore;
 constexpr int64_t SOURCE_ID = -1;
 constexpr int64_t SINK_ID = -2;
 
+struct InterceptorStats {
+  // Messages handled so far.
+  uint64_t messages{0};
+  // Messages waiting in the mailbox now, and the most ever waited.
+  uint64_t queue_depth{0};
+  uint64_t max_queue_depth{0};
+  // Time from a message being enqueued to being handled.
+  int64_t total_queue_latency_us{0};
+  int64_t max_queue_latency_us{0};
+  // Messages handled after their deadline.
+  uint64_t deadline_misses{0};
+};
+
 class Interceptor {
  public:
   using MsgHandle = std::function<void(const InterceptorMessage&)>;
@@ -71,8 +85,12 @@ class Interceptor {
   void EnqueueRemoteInterceptorMessage(
       const InterceptorMessage& interceptor_message);
 
+  // The message inherits the priority and deadline of the message being
+  // handled if it sets none of its own.
   bool Send(int64_t dst_id, InterceptorMessage& msg);  // NOLINT
 
+  InterceptorStats GetStats();
+
   void SetPlace(const phi::Place& place) { place_ = place; }
 
   void SetRootScope(framework::Scope* scope) { root_scope_ = scope; }
@@ -121,8 +139,25 @@ class Interceptor {
   // interceptor handle which process message
   MsgHandle handle_{nullptr};
 
+  struct QueuedMessage {
+    InterceptorMessage msg;
+    std::chrono::steady_clock::time_point enqueue_time;
+  };
+
   std::mutex mutex_;
-  std::deque<InterceptorMessage> messages_;
+  // Messages are handled in the order they come, the task loop only decides
+  // which interceptor handles its messages first.
+  std::deque<QueuedMessage> messages_;
+  // The urgency of the pending LoopOnce, a more urgent message queues
+  // another one ahead of it.
+  bool scheduled_{false};
+  MessagePriority scheduled_priority_{PRIORITY_NORMAL};
+  int64_t scheduled_deadline_us_{-1};
+  InterceptorStats stats_;
+
+  // The priority and deadline of the message being handled.
+  MessagePriority handling_priority_{PRIORITY_NORMAL};
+  int64_t handling_deadline_us_{-1};
 };
 
 class InterceptorFactory {
@@ -14,6 +14,8 @@
 
 #include "paddle/fluid/distributed/fleet_executor/task_loop.h"
 
+#include <algorithm>
+
 #include "paddle/common/errors.h"
 #include "paddle/fluid/platform/enforce.h"
 
@@ -45,10 +47,15 @@ void TaskLoop::Loop() {
   quit_ = false;
 
   while (!quit_) {
-    auto tasks = tasks_.PopAll();
-    for (auto& task : tasks) {
-      task();
+    Functor task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return !tasks_.empty(); });
+      std::pop_heap(tasks_.begin(), tasks_.end(), RunsAfter);
+      task = std::move(tasks_.back().fn);
+      tasks_.pop_back();
     }
+    task();
   }
   looping_ = false;
 }
@@ -66,7 +73,27 @@ void TaskLoop::RunInLoop(Functor cb) {
   }
 }
 
-void TaskLoop::QueueInLoop(Functor cb) { tasks_.Push(cb); }
+void TaskLoop::QueueInLoop(Functor cb,
+                           MessagePriority priority,
+                           int64_t deadline_us) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(Task{std::move(cb), priority, deadline_us, next_seq_++});
+    std::push_heap(tasks_.begin(), tasks_.end(), RunsAfter);
+  }
+  cv_.notify_one();
+}
+
+bool TaskLoop::RunsAfter(const Task& a, const Task& b) {
+  if (a.priority != b.priority) return a.priority < b.priority;
+  if (a.deadline_us != b.deadline_us) {
+    // The task without deadline runs after the ones with a deadline.
+    if (a.deadline_us < 0) return true;
+    if (b.deadline_us < 0) return false;
+    return a.deadline_us > b.deadline_us;
+  }
+  return a.seq > b.seq;
+}
 
 void TaskLoop::WakeUp() {
   Functor task([] {});
@@ -14,14 +14,16 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <functional>
 #include <future>
 #include <map>
+#include <mutex>
 #include <thread>
 #include <vector>
 
 #include "paddle/common/macros.h"
-#include "paddle/fluid/framework/blocking_queue.h"
+#include "paddle/fluid/distributed/fleet_executor/interceptor_message.pb.h"
 
 namespace paddle {
 namespace distributed {
@@ -39,7 +41,12 @@ class TaskLoop {
   void Quit();
 
   void RunInLoop(Functor cb);
-  void QueueInLoop(Functor cb);
+  // Tasks with higher priority run first, then the ones with the earlier
+  // deadline, then the ones queued earlier. deadline_us is microseconds
+  // since epoch of the system clock, -1 for no deadline.
+  void QueueInLoop(Functor cb,
+                   MessagePriority priority = PRIORITY_NORMAL,
+                   int64_t deadline_us = -1);
 
   template <class F, class... Args>
   auto Enqueue(F&& f, Args&&... args)
@@ -50,7 +57,7 @@ class TaskLoop {
         std::bind(std::forward<F>(f), std::forward<Args>(args)...));
     std::future<return_type> task_future = task->get_future();
 
-    tasks_.Push([task]() { (*task)(); });
+    QueueInLoop([task]() { (*task)(); });
     return task_future;
   }
 
@@ -71,13 +78,26 @@ class TaskLoop {
 
   void AbortNotInLoopThread();
 
+  struct Task {
+    Functor fn;
+    MessagePriority priority;
+    int64_t deadline_us;
+    uint64_t seq;
+  };
+  // Whether task a should run after task b, which makes tasks_ a max heap
+  // of the next task to run.
+  static bool RunsAfter(const Task& a, const Task& b);
+
   static thread_local TaskLoop* thread_local_loop_;
 
   bool looping_;
   std::atomic<bool> quit_;
   std::thread::id thread_id_;
 
-  framework::BlockingQueue<Functor> tasks_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<Task> tasks_;
+  uint64_t next_seq_{0};
 };
 
 }  // namespace distributed
@@ -0,0 +1,137 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/fleet_executor/carrier.h"
+#include "paddle/fluid/distributed/fleet_executor/interceptor.h"
+#include "paddle/fluid/distributed/fleet_executor/task_loop.h"
+
+namespace paddle {
+namespace distributed {
+
+struct Handled {
+  int64_t interceptor_id;
+  MessageType message_type;
+  MessagePriority priority;
+  int64_t deadline_us;
+};
+
+// Records every message it handles. On DATA_IS_READY it sends a message
+// with no priority or deadline of its own to forward_id_.
+class RecordInterceptor : public Interceptor {
+ public:
+  RecordInterceptor(int64_t interceptor_id,
+                    std::vector<Handled>* handled,
+                    int64_t forward_id = -1)
+      : Interceptor(interceptor_id, nullptr),
+        handled_(handled),
+        forward_id_(forward_id) {
+    RegisterMsgHandle([this](const InterceptorMessage& msg) { Record(msg); });
+  }
+
+  void Record(const InterceptorMessage& msg) {
+    handled_->push_back({GetInterceptorId(),
+                         msg.message_type(),
+                         msg.priority(),
+                         msg.deadline_us()});
+    if (msg.message_type() == DATA_IS_READY && forward_id_ >= 0) {
+      InterceptorMessage forward;
+      forward.set_message_type(DATA_IS_USELESS);
+      Send(forward_id_, forward);
+    }
+  }
+
+ private:
+  std::vector<Handled>* handled_;
+  int64_t forward_id_;
+};
+
+InterceptorMessage MakeMessage(int64_t dst_id,
+                               MessageType message_type,
+                               MessagePriority priority,
+                               int64_t deadline_us = -1) {
+  InterceptorMessage msg;
+  msg.set_src_id(dst_id);
+  msg.set_dst_id(dst_id);
+  msg.set_message_type(message_type);
+  msg.set_priority(priority);
+  msg.set_deadline_us(deadline_us);
+  return msg;
+}
+
+TEST(InterceptorTest, Priority) {
+  Carrier carrier("0");
+  carrier.Init(0, {{0, 0}, {1, 0}, {2, 0}, {3, 0}});
+  // Every interceptor runs on the loop of this thread, so the order in which
+  // they handle their messages is deterministic.
+  TaskLoop loop;
+  std::vector<Handled> handled;
+  std::vector<Interceptor*> interceptors;
+  for (int64_t id = 0; id < 4; ++id) {
+    Interceptor* interceptor = carrier.SetInterceptor(
+        id,
+        std::make_unique<RecordInterceptor>(id, &handled, id == 0 ? 1 : -1));
+    interceptor->RegisterTaskLoop(&loop);
+    interceptors.push_back(interceptor);
+  }
+
+  // 0 forwards a message to 1, which inherits the high priority and the
+  // deadline, so it runs before the high message of 2 with no deadline.
+  // The deadline has passed, so both miss it.
+  interceptors[0]->EnqueueRemoteInterceptorMessage(
+      MakeMessage(0, DATA_IS_READY, PRIORITY_HIGH, /*deadline_us=*/1));
+  // 3 has a normal message queued before 2 gets a low one, then a high one.
+  // The high one queues another LoopOnce of 2 ahead of 3, which handles
+  // both messages of 2 in the order they came.
+  interceptors[3]->EnqueueRemoteInterceptorMessage(
+      MakeMessage(3, START, PRIORITY_NORMAL));
+  interceptors[2]->EnqueueRemoteInterceptorMessage(
+      MakeMessage(2, START, PRIORITY_LOW));
+  interceptors[2]->EnqueueRemoteInterceptorMessage(
+      MakeMessage(2, RESET, PRIORITY_HIGH));
+  EXPECT_EQ(interceptors[2]->GetStats().queue_depth, 2UL);
+  // Queued after the low LoopOnce of 2, which finds no message left.
+  loop.QueueInLoop([&loop]() { loop.Quit(); }, PRIORITY_LOW);
+  loop.Loop();
+
+  ASSERT_EQ(handled.size(), 5UL);
+  EXPECT_EQ(handled[0].interceptor_id, 0);
+  EXPECT_EQ(handled[1].interceptor_id, 1);
+  EXPECT_EQ(handled[1].message_type, DATA_IS_USELESS);
+  EXPECT_EQ(handled[1].priority, PRIORITY_HIGH);
+  EXPECT_EQ(handled[1].deadline_us, 1);
+  EXPECT_EQ(handled[2].interceptor_id, 2);
+  EXPECT_EQ(handled[2].message_type, START);
+  EXPECT_EQ(handled[3].interceptor_id, 2);
+  EXPECT_EQ(handled[3].message_type, RESET);
+  EXPECT_EQ(handled[4].interceptor_id, 3);
+
+  for (int64_t id : {0, 1}) {
+    InterceptorStats stats = interceptors[id]->GetStats();
+    EXPECT_EQ(stats.messages, 1UL);
+    EXPECT_EQ(stats.deadline_misses, 1UL);
+  }
+  InterceptorStats stats = interceptors[2]->GetStats();
+  EXPECT_EQ(stats.messages, 2UL);
+  EXPECT_EQ(stats.queue_depth, 0UL);
+  EXPECT_EQ(stats.max_queue_depth, 2UL);
+  EXPECT_EQ(stats.deadline_misses, 0UL);
+  EXPECT_GE(stats.max_queue_latency_us, 0);
+  EXPECT_GE(stats.total_queue_latency_us, stats.max_queue_latency_us);
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,43 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/fleet_executor/task_loop.h"
+
+namespace paddle {
+namespace distributed {
+
+TEST(TaskLoop, Priority) {
+  TaskLoop loop;
+  std::vector<int> order;
+  auto record = [&order](int id) {
+    return [&order, id]() { order.push_back(id); };
+  };
+
+  loop.QueueInLoop(record(0), PRIORITY_LOW);
+  loop.QueueInLoop(record(1));
+  loop.QueueInLoop(record(2), PRIORITY_NORMAL, /*deadline_us=*/200);
+  loop.QueueInLoop(record(3), PRIORITY_HIGH);
+  loop.QueueInLoop(record(4), PRIORITY_NORMAL, /*deadline_us=*/100);
+  loop.QueueInLoop(record(5));
+  loop.QueueInLoop([&loop]() { loop.Quit(); }, PRIORITY_LOW);
+  loop.Loop();
+
+  std::vector<int> expected{3, 4, 2, 1, 5, 0};
+  EXPECT_EQ(order, expected);
+}
+
+}  // namespace distributed
+}  // namespace paddle
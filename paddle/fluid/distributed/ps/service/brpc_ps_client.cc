@@ -62,6 +62,16 @@ PD_DEFINE_int32(pserver_communicate_compress_type,
                 0,
                 "none:0 snappy:1 gzip:2 zlib:3 lz4:4");
 
+PD_DEFINE_string(pserver_push_dense_codec,
+                 "",
+                 "the PushCodec class encoding the raw dense gradients, "
+                 "e.g. Fp16PushCodec, empty to push them in fp32");
+
+PD_DEFINE_string(pserver_push_sparse_codec,
+                 "",
+                 "the PushCodec class encoding the raw sparse gradients, "
+                 "empty to push them in fp32");
+
 PD_DEFINE_int32(pserver_max_async_call_num,
                 13,
                 "max task num in async_call_server");
@@ -1053,14 +1063,38 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradient(
     push_request->set_client_id(_client_id);
     push_request->add_params((char *)&kv_size, sizeof(uint32_t));  // NOLINT
     auto *push_data = push_request->mutable_data();
-    push_data->resize(kv_size * (sizeof(uint64_t) + value_size));
-    char *push_data_ptr = const_cast<char *>(push_data->data());
-    memcpy(push_data_ptr, kvs.data(), kv_size * sizeof(uint64_t));
-    push_data_ptr += kv_size * sizeof(uint64_t);
-
-    for (size_t i = 0; i < kv_size; ++i) {
-      memcpy(push_data_ptr, value_ptr[i], value_size);
-      push_data_ptr += value_size;
+    if (FLAGS_pserver_push_sparse_codec.empty()) {
+      push_data->resize(kv_size * (sizeof(uint64_t) + value_size));
+      char *push_data_ptr = const_cast<char *>(push_data->data());
+      memcpy(push_data_ptr, kvs.data(), kv_size * sizeof(uint64_t));
+      push_data_ptr += kv_size * sizeof(uint64_t);
+
+      for (size_t i = 0; i < kv_size; ++i) {
+        memcpy(push_data_ptr, value_ptr[i], value_size);
+        push_data_ptr += value_size;
+      }
+    } else {
+      thread_local std::vector<float> values;
+      thread_local std::string encoded;
+      size_t value_dim = value_size / sizeof(float);
+      values.resize(kv_size * value_dim);
+      for (size_t i = 0; i < kv_size; ++i) {
+        memcpy(values.data() + i * value_dim, value_ptr[i], value_size);
+      }
+      auto *encoder =
+          GetPushEncoder(FLAGS_pserver_push_sparse_codec, table_id, shard_idx);
+      PADDLE_ENFORCE_EQ(encoder->IsPositional(),
+                        false,
+                        common::errors::InvalidArgument(
+                            "PushCodec %s only fits dense tables.",
+                            FLAGS_pserver_push_sparse_codec));
+      encoder->Encode(values.data(), values.size(), &encoded);
+      push_data->clear();
+      push_data->reserve(kv_size * sizeof(uint64_t) + encoded.size());
+      push_data->append(reinterpret_cast<const char *>(kvs.data()),
+                        kv_size * sizeof(uint64_t));
+      push_data->append(encoded);
+      push_request->add_params(FLAGS_pserver_push_sparse_codec);
     }
     PsService_Stub rpc_stub(GetSparseChannel(shard_idx));
     closure->cntl(shard_idx)->set_request_compress_type(
@@ -1090,14 +1124,11 @@ std::future<int32_t> BrpcPsClient::PushDenseRawGradient(
     closure->request(i)->set_cmd_id(PS_PUSH_DENSE_TABLE);
     closure->request(i)->set_table_id(table_id);
     closure->request(i)->set_client_id(_client_id);
-    auto *push_data = closure->request(i)->mutable_data();
-    push_data->clear();
-    push_data->resize(sizeof(uint32_t) + num_per_shard * sizeof(float));
-    char *push_data_ptr = const_cast<char *>(push_data->data());
-    memcpy(push_data_ptr, &num_per_shard, sizeof(uint32_t));
-    memcpy(push_data_ptr + sizeof(uint32_t),
-           total_send_data + i * num_per_shard,
-           num_per_shard * sizeof(float));
+    FillPushDenseData(closure->request(i),
+                      table_id,
+                      i,
+                      total_send_data + i * num_per_shard,
+                      num_per_shard);
     // closure->cntl(i)->set_request_compress_type(
     //     (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
     PsService_Stub rpc_stub(GetDenseChannel(i));
@@ -2058,14 +2089,11 @@ void BrpcPsClient::PushDenseRawGradient(std::shared_ptr<DenseAsyncTask> &task,
     closure->request(i)->set_cmd_id(PS_PUSH_DENSE_TABLE);
     closure->request(i)->set_table_id(task->table_id());
     closure->request(i)->set_client_id(_client_id);
-    auto *push_data = closure->request(i)->mutable_data();
-    push_data->clear();
-    push_data->resize(sizeof(uint32_t) + num_per_shard * sizeof(float));
-    char *push_data_ptr = const_cast<char *>(push_data->data());
-    memcpy(push_data_ptr, &num_per_shard, sizeof(uint32_t));
-    memcpy(push_data_ptr + sizeof(uint32_t),
-           total_send_data + i * num_per_shard,
-           num_per_shard * sizeof(float));
+    FillPushDenseData(closure->request(i),
+                      task->table_id(),
+                      i,
+                      total_send_data + i * num_per_shard,
+                      num_per_shard);
     closure->cntl(i)->set_request_compress_type(
         (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
     PsService_Stub rpc_stub(GetDenseChannel(i));
@@ -2074,5 +2102,52 @@ void BrpcPsClient::PushDenseRawGradient(std::shared_ptr<DenseAsyncTask> &task,
   }
 }
 
+PushCodec *BrpcPsClient::GetPushEncoder(const std::string &codec_name,
+                                        size_t table_id,
+                                        size_t shard_idx) {
+  std::string key = codec_name + "_" + std::to_string(table_id) + "_" +
+                    std::to_string(shard_idx);
+  std::lock_guard<std::mutex> lock(_push_encoder_mutex);
+  auto &encoder = _push_encoders[key];
+  if (encoder == nullptr) {
+    PushCodec *codec = CREATE_PSCORE_CLASS(PushCodec, codec_name);
+    encoder.reset(codec);
+    PADDLE_ENFORCE_NOT_NULL(
+        encoder,
+        common::errors::InvalidArgument("PushCodec %s is not registered.",
+                                        codec_name));
+  }
+  return encoder.get();
+}
+
+/*
+Push Dense Content:
+|--num--|---valuesData---|
+|--4B---|----------------|
+valuesData is encoded by the PushCodec named in params(0), if any.
+*/
+void BrpcPsClient::FillPushDenseData(PsRequestMessage *request,
+                                     size_t table_id,
+                                     size_t shard_idx,
+                                     const float *values,
+                                     uint32_t num) {
+  auto *push_data = request->mutable_data();
+  push_data->clear();
+  if (FLAGS_pserver_push_dense_codec.empty()) {
+    push_data->resize(sizeof(uint32_t) + num * sizeof(float));
+    char *push_data_ptr = const_cast<char *>(push_data->data());
+    memcpy(push_data_ptr, &num, sizeof(uint32_t));
+    memcpy(push_data_ptr + sizeof(uint32_t), values, num * sizeof(float));
+    return;
+  }
+  thread_local std::string encoded;
+  GetPushEncoder(FLAGS_pserver_push_dense_codec, table_id, shard_idx)
+      ->Encode(values, num, &encoded);
+  push_data->reserve(sizeof(uint32_t) + encoded.size());
+  push_data->append(reinterpret_cast<const char *>(&num), sizeof(uint32_t));
+  push_data->append(encoded);
+  request->add_params(FLAGS_pserver_push_dense_codec);
+}
+
 }  // namespace distributed
 }  // namespace paddle
@@ -17,7 +17,9 @@
 #include <ThreadPool.h>
 
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "brpc/channel.h"
@@ -26,6 +28,7 @@
 #include "paddle/common/macros.h"
 #include "paddle/fluid/distributed/ps/service/brpc_utils.h"
 #include "paddle/fluid/distributed/ps/service/ps_client.h"
+#include "paddle/fluid/distributed/ps/service/push_codec.h"
 #include "paddle/fluid/distributed/ps/service/sendrecv.pb.h"
 #include "paddle/fluid/framework/channel.h"
 #include "paddle/fluid/framework/lod_tensor.h"
@@ -428,6 +431,18 @@ class BrpcPsClient : public PSClient {
                             float *total_send_data,
                             size_t total_send_data_size,
                             DownpourBrpcClosure *closure);
+  // The encoder of the PushCodec named codec_name for the pushes of the
+  // table to one server.
+  PushCodec *GetPushEncoder(const std::string &codec_name,
+                            size_t table_id,
+                            size_t shard_idx);
+  void FillPushDenseData(PsRequestMessage *request,
+                         size_t table_id,
+                         size_t shard_idx,
+                         const float *values,
+                         uint32_t num);
+  std::mutex _push_encoder_mutex;
+  std::unordered_map<std::string, std::unique_ptr<PushCodec>> _push_encoders;
   float _mae = 0;
   float _mse = 0;
   uint16_t _push_times = 0;
@@ -18,6 +18,7 @@
 
 #include "butil/object_pool.h"
 #include "paddle/fluid/distributed/common/cost_timer.h"
+#include "paddle/fluid/distributed/ps/service/push_codec.h"
 #include "paddle/fluid/distributed/ps/table/depends/sparse_utils.h"
 #include "paddle/fluid/distributed/ps/table/table.h"
 #include "paddle/fluid/framework/archive.h"
@@ -334,6 +335,18 @@ int32_t BrpcPsService::PullDense(Table *table,
   return 0;
 }
 
+static int32_t DecodePushValues(const std::string &codec_name,
+                                const char *data,
+                                size_t size,
+                                float *values,
+                                size_t num) {
+  const PushCodec *decoder = GetThreadLocalPushDecoder(codec_name);
+  if (decoder == nullptr) {
+    return -1;
+  }
+  return decoder->Decode(data, size, values, num);
+}
+
 int32_t BrpcPsService::PushDenseParam(Table *table,
                                       const PsRequestMessage &request,
                                       PsResponseMessage &response,
@@ -388,10 +401,26 @@ int32_t BrpcPsService::PushDense(Table *table,
   |--4B---|----------------|
   */
   uint32_t num = *(const uint32_t *)(request.data().data());
+  const float *values =
+      (const float *)(request.data().data() + sizeof(uint32_t));
+  // the values are encoded by the PushCodec named in params
+  thread_local std::vector<float> decoded;
+  if (request.params_size() > 0) {
+    decoded.resize(num);
+    if (req_buffer_size < sizeof(uint32_t) ||
+        DecodePushValues(request.params(0),
+                         request.data().data() + sizeof(uint32_t),
+                         req_buffer_size - sizeof(uint32_t),
+                         decoded.data(),
+                         num) != 0) {
+      set_response_code(response, -1, "PushDense decode failed");
+      return 0;
+    }
+    values = decoded.data();
+  }
   TableContext table_context;
   table_context.value_type = Dense;
-  table_context.push_context.values =
-      (const float *)(request.data().data() + sizeof(uint32_t));
+  table_context.push_context.values = values;
   table_context.num = num;
   // const float *values = (const float *)(request.data().data() +
   // sizeof(uint32_t));
@@ -579,11 +608,29 @@ int32_t BrpcPsService::PushSparse(Table *table,
   |---keysData---|---valuesData---|
   |---8*{num}B---|----------------|
   */
+  const float *values =
+      (const float *)(push_data.data() + sizeof(uint64_t) * num);
+  // the values are encoded by the PushCodec named in params
+  thread_local std::vector<float> decoded;
+  if (request.params_size() > 1) {
+    size_t value_num =
+        num * table->GetValueAccessor()->GetAccessorInfo().update_dim;
+    decoded.resize(value_num);
+    if (push_data.size() < sizeof(uint64_t) * num ||
+        DecodePushValues(request.params(1),
+                         push_data.data() + sizeof(uint64_t) * num,
+                         push_data.size() - sizeof(uint64_t) * num,
+                         decoded.data(),
+                         value_num) != 0) {
+      set_response_code(response, -1, "PushSparse decode failed");
+      return 0;
+    }
+    values = decoded.data();
+  }
   TableContext table_context;
   table_context.value_type = Sparse;
   table_context.push_context.keys = (const uint64_t *)push_data.data();
-  table_context.push_context.values =
-      (const float *)(push_data.data() + sizeof(uint64_t) * num);
+  table_context.push_context.values = values;
   table_context.num = num;
   // const uint64_t *keys = (const uint64_t *)push_data.data();
   // const float *values = (const float *)(push_data.data() + sizeof(uint64_t) *
@@ -18,6 +18,7 @@ limitations under the License. */
 
 #include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/ps/service/brpc_ps_client.h"
+#include "paddle/fluid/distributed/ps/thirdparty/round_robin.h"
 #include "paddle/fluid/distributed/ps/wrapper/fleet.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/phi/core/platform/profiler.h"
@@ -720,9 +721,38 @@ void AsyncCommunicator::PushSparseFromTensorAsync(
   push_keys.reserve(MAX_FEASIGN_NUM / 100);
   std::vector<std::vector<float>> push_values;
   push_values.reserve(MAX_FEASIGN_NUM / 100);
+  // A key repeated in the batch is pushed once with the sum of its
+  // gradients, the accessor sums them on the server anyway.
+  robin_hood::unordered_flat_map<uint64_t, size_t> key_index;
+  key_index.reserve(MAX_FEASIGN_NUM / 100);
   size_t output_len = 0;
   size_t input_idx = 0;
 
+  auto add_push_value = [&](uint64_t real_id, const float *grad) {
+    auto iter = key_index.find(real_id);
+    if (iter != key_index.end()) {
+      float *data = push_values[iter->second].data() + 1;
+      for (int k = 0; k < fea_dim; ++k) {
+        data[k] += grad[k];
+      }
+      return;
+    }
+    key_index.emplace(real_id, push_keys.size());
+    push_keys.emplace_back(real_id);
+    push_values.emplace_back(fea_dim + 1);
+    // slot show clk grad... consistent with CtrCommonPushValue defined in
+    // ctr_accessor.h
+    push_values.back()[0] = 2;  // TODO(zhaocaibei123): slot
+    // push_values.back()[1] =
+    //    (i >= show_size ? 1 : static_cast<float>(show_tensor[i]));
+    // push_values.back()[2] =
+    //    (i >= clk_size ? 0 : static_cast<float>(clk_tensor[i]));
+
+    float *data = push_values.back().data() + 1;  // hard code here
+
+    memcpy(data, grad, sizeof(float) * fea_dim);
+  };
+
   VLOG(2) << "fleet.cc::emb_dim: " << fea_dim << " batch_size: " << batch_size
           << " batch_size_consist: " << batch_size_consist;
 
@@ -756,19 +786,7 @@ void AsyncCommunicator::PushSparseFromTensorAsync(
           if (real_id == padding_id) {
             continue;
           }
-          push_keys.emplace_back(real_id);
-          push_values.emplace_back(fea_dim + 1);
-          // slot show clk grad... consistent with CtrCommonPushValue defined in
-          // ctr_accessor.h
-          push_values.back()[0] = 2;  // TODO(zhaocaibei123): slot
-          // push_values.back()[1] =
-          //    (i >= show_size ? 1 : static_cast<float>(show_tensor[i]));
-          // push_values.back()[2] =
-          //    (i >= clk_size ? 0 : static_cast<float>(clk_tensor[i]));
-
-          float *data = push_values.back().data() + 1;  // hard code here
-
-          memcpy(data, g + output_len, sizeof(float) * fea_dim);
+          add_push_value(real_id, g + output_len);
 
           ++input_idx;
         }
@@ -779,19 +797,7 @@ void AsyncCommunicator::PushSparseFromTensorAsync(
         if (real_id == padding_id) {
           continue;
         }
-        push_keys.emplace_back(real_id);
-        push_values.emplace_back(fea_dim + 1);
-        // slot show clk grad... consistent with CtrCommonPushValue defined in
-        // ctr_accessor.h
-        push_values.back()[0] = 2;  // TODO(zhaocaibei123): slot
-        // push_values.back()[1] =
-        //    (i >= show_size ? 1 : static_cast<float>(show_tensor[i]));
-        // push_values.back()[2] =
-        //    (i >= clk_size ? 0 : static_cast<float>(clk_tensor[i]));
-
-        float *data = push_values.back().data() + 1;
-
-        memcpy(data, g + output_len, sizeof(float) * fea_dim);
+        add_push_value(real_id, g + output_len);
 
         ++input_idx;
       }
@@ -805,7 +811,8 @@ void AsyncCommunicator::PushSparseFromTensorAsync(
             static_cast<int64_t>(output_len)));
   }
 
-  std::vector<float *> push_g_vec(input_idx, nullptr);
+  VLOG(3) << "push " << push_keys.size() << " unique keys of " << input_idx;
+  std::vector<float *> push_g_vec(push_keys.size(), nullptr);
 
   for (auto i = 0u; i < push_keys.size(); ++i) {
     push_g_vec[i] = push_values.at(i).data();
@@ -0,0 +1,216 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/service/push_codec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+
+#include "paddle/common/flags.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+
+PD_DEFINE_double(pserver_push_topk_ratio,
+                 0.01,
+                 "the ratio of values pushed by TopKPushCodec");
+
+namespace paddle {
+namespace distributed {
+
+REGISTER_PSCORE_CLASS(PushCodec, Fp16PushCodec);
+REGISTER_PSCORE_CLASS(PushCodec, Bf16PushCodec);
+REGISTER_PSCORE_CLASS(PushCodec, Int8PushCodec);
+REGISTER_PSCORE_CLASS(PushCodec, TopKPushCodec);
+
+namespace {
+
+template <typename T>
+void CastEncode(const float *values, size_t num, std::string *out) {
+  out->resize(num * sizeof(T));
+  T *data = reinterpret_cast<T *>(const_cast<char *>(out->data()));
+  for (size_t i = 0; i < num; ++i) {
+    data[i] = static_cast<T>(values[i]);
+  }
+}
+
+template <typename T>
+int32_t CastDecode(const char *data, size_t size, float *values, size_t num) {
+  if (size != num * sizeof(T)) {
+    return -1;
+  }
+  const T *encoded = reinterpret_cast<const T *>(data);
+  for (size_t i = 0; i < num; ++i) {
+    values[i] = static_cast<float>(encoded[i]);
+  }
+  return 0;
+}
+
+}  // namespace
+
+void Fp16PushCodec::Encode(const float *values,
+                           size_t num,
+                           std::string *out) {
+  CastEncode<phi::dtype::float16>(values, num, out);
+}
+
+int32_t Fp16PushCodec::Decode(const char *data,
+                              size_t size,
+                              float *values,
+                              size_t num) const {
+  return CastDecode<phi::dtype::float16>(data, size, values, num);
+}
+
+void Bf16PushCodec::Encode(const float *values,
+                           size_t num,
+                           std::string *out) {
+  CastEncode<phi::dtype::bfloat16>(values, num, out);
+}
+
+int32_t Bf16PushCodec::Decode(const char *data,
+                              size_t size,
+                              float *values,
+                              size_t num) const {
+  return CastDecode<phi::dtype::bfloat16>(data, size, values, num);
+}
+
+/*
+Int8 Content:
+|---scales---|---values---|
+|--4*{block}B|---{num}B---|
+*/
+void Int8PushCodec::Encode(const float *values,
+                           size_t num,
+                           std::string *out) {
+  size_t block_num = (num + kBlockSize - 1) / kBlockSize;
+  out->resize(block_num * sizeof(float) + num);
+  char *data = const_cast<char *>(out->data());
+  float *scales = reinterpret_cast<float *>(data);
+  int8_t *quantized = reinterpret_cast<int8_t *>(data + block_num * 4);
+  for (size_t block = 0; block < block_num; ++block) {
+    size_t begin = block * kBlockSize;
+    size_t end = std::min(begin + kBlockSize, num);
+    float max_abs = 0;
+    for (size_t i = begin; i < end; ++i) {
+      max_abs = std::max(max_abs, std::fabs(values[i]));
+    }
+    float scale = max_abs / 127;
+    float inv_scale = scale > 0 ? 1 / scale : 0;
+    scales[block] = scale;
+    for (size_t i = begin; i < end; ++i) {
+      float q = std::nearbyint(values[i] * inv_scale);
+      quantized[i] = static_cast<int8_t>(std::min(std::max(q, -127.f), 127.f));
+    }
+  }
+}
+
+int32_t Int8PushCodec::Decode(const char *data,
+                              size_t size,
+                              float *values,
+                              size_t num) const {
+  size_t block_num = (num + kBlockSize - 1) / kBlockSize;
+  if (size != block_num * sizeof(float) + num) {
+    return -1;
+  }
+  const float *scales = reinterpret_cast<const float *>(data);
+  const int8_t *quantized =
+      reinterpret_cast<const int8_t *>(data + block_num * 4);
+  for (size_t i = 0; i < num; ++i) {
+    values[i] = quantized[i] * scales[i / kBlockSize];
+  }
+  return 0;
+}
+
+/*
+TopK Content:
+|--k--|---indexes---|---values---|
+|--4B-|----4*{k}B---|---4*{k}B---|
+*/
+void TopKPushCodec::Encode(const float *values,
+                           size_t num,
+                           std::string *out) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_residual.size() != num) {
+    _residual.assign(num, 0);
+  }
+  for (size_t i = 0; i < num; ++i) {
+    _residual[i] += values[i];
+  }
+  size_t k =
+      static_cast<size_t>(std::ceil(num * FLAGS_pserver_push_topk_ratio));
+  k = std::min(std::max<size_t>(k, 1), num);
+  _index.resize(num);
+  for (size_t i = 0; i < num; ++i) {
+    _index[i] = i;
+  }
+  std::nth_element(_index.begin(),
+                   _index.begin() + k,
+                   _index.end(),
+                   [this](uint32_t a, uint32_t b) {
+                     return std::fabs(_residual[a]) > std::fabs(_residual[b]);
+                   });
+  uint32_t k_num = k;
+  out->resize(sizeof(uint32_t) + k * (sizeof(uint32_t) + sizeof(float)));
+  char *data = const_cast<char *>(out->data());
+  memcpy(data, &k_num, sizeof(uint32_t));
+  uint32_t *indexes = reinterpret_cast<uint32_t *>(data + sizeof(uint32_t));
+  float *top_values = reinterpret_cast<float *>(indexes + k);
+  for (size_t i = 0; i < k; ++i) {
+    indexes[i] = _index[i];
+    top_values[i] = _residual[_index[i]];
+    _residual[_index[i]] = 0;
+  }
+}
+
+int32_t TopKPushCodec::Decode(const char *data,
+                              size_t size,
+                              float *values,
+                              size_t num) const {
+  if (size < sizeof(uint32_t)) {
+    return -1;
+  }
+  uint32_t k = 0;
+  memcpy(&k, data, sizeof(uint32_t));
+  if (k > num ||
+      size != sizeof(uint32_t) + k * (sizeof(uint32_t) + sizeof(float))) {
+    return -1;
+  }
+  const uint32_t *indexes =
+      reinterpret_cast<const uint32_t *>(data + sizeof(uint32_t));
+  const float *top_values = reinterpret_cast<const float *>(indexes + k);
+  std::fill(values, values + num, 0);
+  for (uint32_t i = 0; i < k; ++i) {
+    if (indexes[i] >= num) {
+      return -1;
+    }
+    values[indexes[i]] = top_values[i];
+  }
+  return 0;
+}
+
+const PushCodec *GetThreadLocalPushDecoder(const std::string &name) {
+  thread_local std::unordered_map<std::string, std::unique_ptr<PushCodec>>
+      decoders;
+  auto iter = decoders.find(name);
+  if (iter == decoders.end()) {
+    PushCodec *decoder = CREATE_PSCORE_CLASS(PushCodec, name);
+    iter = decoders.emplace(name, std::unique_ptr<PushCodec>(decoder)).first;
+  }
+  return iter->second.get();
+}
+
+}  // namespace distributed
+}  // namespace paddle
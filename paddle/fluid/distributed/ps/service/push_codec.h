@@ -0,0 +1,102 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/distributed/common/registerer.h"
+
+namespace paddle {
+namespace distributed {
+
+// Lossy encoding of the gradients pushed from workers to servers. A push
+// request encoded by a codec carries the codec class name in its params,
+// the server decodes it with its own instance of that class.
+//
+// Encoders may keep state across pushes, so a client keeps one encoder per
+// table and server, shared by its push threads; Encode should be safe to
+// call concurrently. Decoding is stateless.
+class PushCodec {
+ public:
+  virtual ~PushCodec() {}
+  virtual void Encode(const float *values, size_t num, std::string *out) = 0;
+  // Returns -1 if data does not hold num encoded values.
+  virtual int32_t Decode(const char *data,
+                         size_t size,
+                         float *values,
+                         size_t num) const = 0;
+  // The encoder keeps state by the position of the values, so it only fits
+  // pushes of the same values every time, i.e. dense tables.
+  virtual bool IsPositional() const { return false; }
+};
+REGISTER_PSCORE_REGISTERER(PushCodec);
+
+class Fp16PushCodec : public PushCodec {
+ public:
+  void Encode(const float *values, size_t num, std::string *out) override;
+  int32_t Decode(const char *data,
+                 size_t size,
+                 float *values,
+                 size_t num) const override;
+};
+
+class Bf16PushCodec : public PushCodec {
+ public:
+  void Encode(const float *values, size_t num, std::string *out) override;
+  int32_t Decode(const char *data,
+                 size_t size,
+                 float *values,
+                 size_t num) const override;
+};
+
+// int8 values with one fp32 scale per block of kBlockSize values.
+class Int8PushCodec : public PushCodec {
+ public:
+  static constexpr size_t kBlockSize = 256;
+  void Encode(const float *values, size_t num, std::string *out) override;
+  int32_t Decode(const char *data,
+                 size_t size,
+                 float *values,
+                 size_t num) const override;
+};
+
+// Only the FLAGS_pserver_push_topk_ratio values of largest magnitude are
+// sent, as index and value pairs. The rest is kept as a residual and added
+// to the next push, so no gradient is lost, only delayed.
+class TopKPushCodec : public PushCodec {
+ public:
+  void Encode(const float *values, size_t num, std::string *out) override;
+  int32_t Decode(const char *data,
+                 size_t size,
+                 float *values,
+                 size_t num) const override;
+  bool IsPositional() const override { return true; }
+
+ private:
+  // Guards the residual against the concurrent pushes of the table.
+  std::mutex _mutex;
+  std::vector<float> _residual;
+  std::vector<uint32_t> _index;
+};
+
+// The decoder of the named codec owned by the calling thread, nullptr if no
+// codec has that name.
+const PushCodec *GetThreadLocalPushDecoder(const std::string &name);
+
+}  // namespace distributed
+}  // namespace paddle
@@ -57,6 +57,10 @@ PHI_DEFINE_EXPORTED_int32(graph_edges_debug_node_id, 0, "graph debug node id");
 PHI_DEFINE_EXPORTED_int32(graph_edges_debug_node_num,
                           2,
                           "graph debug node num");
+PHI_DEFINE_EXPORTED_bool(graph_freeze_edges,
+                         false,
+                         "freeze the edges into csr after load_edges, instead "
+                         "of building the samplers of every node");
 
 namespace paddle::distributed {
 
@@ -1712,6 +1716,11 @@ int32_t GraphTable::add_comm_edge(int idx, uint64_t src_id, uint64_t dst_id) {
     return -1;
   }
   size_t index = src_shard_id - shard_start;
+  if (edge_shards[idx][index]->is_frozen()) {
+    LOG(WARNING) << "Cannot add an edge to the frozen edge_type["
+                 << id_to_edge[idx] << "]";
+    return -1;
+  }
   edge_shards[idx][index]->add_graph_node(src_id)->build_edges(false);
   edge_shards[idx][index]->add_neighbor(src_id, dst_id, 1.0);
   return 0;
@@ -1720,6 +1729,13 @@ int32_t GraphTable::add_graph_node(int idx,
                                    std::vector<uint64_t> &id_list,
                                    std::vector<bool> &is_weight_list) {
   auto &shards = edge_shards[idx];
+  for (auto &shard : shards) {
+    if (shard->is_frozen()) {
+      LOG(WARNING) << "Cannot add nodes to the frozen edge_type["
+                   << id_to_edge[idx] << "]";
+      return -1;
+    }
+  }
   size_t node_size = id_list.size();
   std::vector<std::vector<std::pair<uint64_t, bool>>> batch(task_pool_size_);
   for (size_t i = 0; i < node_size; i++) {
@@ -1777,6 +1793,48 @@ void GraphShard::clear() {
   }
   bucket.clear();
   node_location.clear();
+  csr.reset();
+}
+
+void GraphShard::freeze(bool is_weighted) {
+  thaw();
+  auto frozen = std::make_unique<GraphCSR>();
+  frozen->build(bucket, is_weighted);
+  for (size_t i = 0; i < bucket.size(); ++i) {
+    Node *node = new CSRGraphNode(bucket[i]->get_id(), frozen.get(), i);
+    delete bucket[i];
+    bucket[i] = node;
+  }
+  csr = std::move(frozen);
+}
+
+static void EnforceNotFrozen(const GraphShard &shard) {
+  PADDLE_ENFORCE_EQ(
+      shard.is_frozen(),
+      false,
+      common::errors::PreconditionNotMet(
+          "The edges of the graph shard are frozen, thaw it before adding "
+          "nodes or edges."));
+}
+
+void GraphShard::thaw() {
+  if (csr == nullptr) {
+    return;
+  }
+  for (size_t i = 0; i < bucket.size(); ++i) {
+    auto *frozen = static_cast<CSRGraphNode *>(bucket[i]);
+    auto *node = new GraphNode(frozen->get_id());
+    node->build_edges(csr->get_is_weighted());
+    size_t row = frozen->get_row();
+    for (size_t j = 0; j < csr->get_degree(row); ++j) {
+      node->add_edge(csr->get_neighbor_id(row, j),
+                     csr->get_neighbor_weight(row, j));
+    }
+    node->build_sampler(csr->get_sample_type());
+    delete frozen;
+    bucket[i] = node;
+  }
+  csr.reset();
 }
 
 GraphShard::~GraphShard() { clear(); }
@@ -1794,6 +1852,7 @@ void GraphShard::delete_node(uint64_t id) {
   bucket.pop_back();
 }
 GraphNode *GraphShard::add_graph_node(uint64_t id) {
+  EnforceNotFrozen(*this);
   if (node_location.find(id) == node_location.end()) {
     node_location[id] = bucket.size();
     bucket.push_back(new GraphNode(id));
@@ -1802,6 +1861,7 @@ GraphNode *GraphShard::add_graph_node(uint64_t id) {
 }
 
 GraphNode *GraphShard::add_graph_node(Node *node) {
+  EnforceNotFrozen(*this);
   auto id = node->get_id();
   if (node_location.find(id) == node_location.end()) {
     node_location[id] = bucket.size();
@@ -1829,6 +1889,7 @@ FeatureNode *GraphShard::add_feature_node(uint64_t id,
 }
 
 void GraphShard::add_neighbor(uint64_t id, uint64_t dst_id, float weight) {
+  EnforceNotFrozen(*this);
   find_node(id)->add_edge(dst_id, weight);
 }
 
@@ -2470,6 +2531,7 @@ int32_t GraphTable::load_nodes(const std::string &path,
 
 int32_t GraphTable::build_sampler(int idx, std::string sample_type) {
   for (auto &shard : edge_shards[idx]) {
+    shard->set_sample_type(sample_type);
     auto bucket = shard->get_bucket();
     for (auto item : bucket) {
       item->build_sampler(sample_type);
@@ -2579,6 +2641,8 @@ int32_t GraphTable::load_edges(const std::string &path,
     idx = edge_to_id[edge_type];
   }
 
+  // Nothing samples while the edges are loaded.
+  thaw_edges(idx);
   auto paths = ::paddle::string::split_string<std::string>(path, ";");
   uint64_t count = 0;
   uint64_t valid_count = 0;
@@ -2626,6 +2690,8 @@ int32_t GraphTable::load_edges(const std::string &path,
     // In order not to affect the sampler function of other scenario,
     // this optimization is only performed in load_edges function.
     VLOG(0) << "run in gpugraph mode!";
+  } else if (FLAGS_graph_freeze_edges) {
+    freeze_edges(idx);
   } else {
     std::string sample_type = "random";
     VLOG(0) << "build sampler ... ";
@@ -2640,6 +2706,43 @@ int32_t GraphTable::load_edges(const std::string &path,
   return 0;
 }
 
+int32_t GraphTable::freeze_edges(int idx) {
+  auto &shards = edge_shards[idx];
+  std::vector<std::future<int>> tasks;
+  for (size_t i = 0; i < shards.size(); ++i) {
+    tasks.push_back(_shards_task_pool[i % task_pool_size_]->enqueue(
+        [&shards, i, this]() -> int {
+          shards[i]->freeze(is_weighted_);
+          return 0;
+        }));
+  }
+  for (auto &task : tasks) task.get();
+  size_t edge_num = 0;
+  size_t memory_size = 0;
+  for (auto &shard : shards) {
+    edge_num += shard->get_csr()->get_edge_num();
+    memory_size += shard->get_csr()->get_memory_size();
+  }
+  VLOG(0) << "freeze " << edge_num << " edges of edge_type[" << id_to_edge[idx]
+          << "] to csr, memory size: " << memory_size;
+  return 0;
+}
+
+int32_t GraphTable::thaw_edges(int idx) {
+  auto &shards = edge_shards[idx];
+  std::vector<std::future<int>> tasks;
+  for (size_t i = 0; i < shards.size(); ++i) {
+    if (!shards[i]->is_frozen()) continue;
+    tasks.push_back(_shards_task_pool[i % task_pool_size_]->enqueue(
+        [&shards, i]() -> int {
+          shards[i]->thaw();
+          return 0;
+        }));
+  }
+  for (auto &task : tasks) task.get();
+  return 0;
+}
+
 Node *GraphTable::find_node(GraphTableType table_type, uint64_t id) {
   size_t shard_id = id % shard_num;
   if (shard_id >= shard_end || shard_id < shard_start) {
@@ -2769,6 +2872,23 @@ int32_t GraphTable::random_sample_nodes(GraphTableType table_type,
   memcpy(pointer, res.data(), actual_size);
   return 0;
 }
+int32_t GraphTable::make_neighbor_sample_cache(size_t size_limit,
+                                               size_t ttl,
+                                               size_t memory_limit) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (sample_cache == nullptr) {
+    sample_cache.reset(new GraphSampleCache<SampleKey, SampleResult>(
+        task_pool_size_, size_limit, ttl, memory_limit));
+    use_cache = true;
+  }
+  return 0;
+}
+
+SampleCacheStat GraphTable::get_neighbor_sample_cache_stat() const {
+  return sample_cache == nullptr ? SampleCacheStat()
+                                 : sample_cache->get_stat();
+}
+
 int32_t GraphTable::random_sample_neighbors(
     int idx,
     uint64_t *node_ids,
@@ -2796,12 +2916,15 @@ int32_t GraphTable::random_sample_neighbors(
       LRUResponse response = LRUResponse::blocked;
       if (use_cache) {
         response =
-            scaled_lru->query(i, id_list[i].data(), id_list[i].size(), r);
+            sample_cache->query(i, id_list[i].data(), id_list[i].size(), r);
       }
       size_t index = 0;
       std::vector<SampleResult> sample_res;
       std::vector<SampleKey> sample_keys;
       auto &rng = _shards_task_rng_pool[i];
+      // the frozen shards of the task draw from one block of random bits
+      SampleRandomBits bits(rng,
+                            id_list[i].size() * std::max(sample_size, 0));
       for (size_t k = 0; k < id_list[i].size(); k++) {
         if (index < r.size() &&
             r[index].first.node_key == id_list[i][k].node_key) {
@@ -2832,7 +2955,17 @@ int32_t GraphTable::random_sample_neighbors(
             continue;
           }
           std::shared_ptr<char> &buffer = buffers[idy];
-          std::vector<int> res = node->sample_k(sample_size, rng);
+          // frozen shards are sampled on their csr, without virtual calls
+          const GraphCSR *csr =
+              edge_shards[idx][node_id % shard_num - shard_start]->get_csr();
+          size_t row = 0;
+          std::vector<int> res;
+          if (csr != nullptr) {
+            row = static_cast<CSRGraphNode *>(node)->get_row();
+            csr->sample_k(row, sample_size, &bits, &res);
+          } else {
+            res = node->sample_k(sample_size, rng);
+          }
           actual_size =
               res.size() * (need_weight ? (Node::id_size + Node::weight_size)
                                         : Node::id_size);
@@ -2848,12 +2981,17 @@ int32_t GraphTable::random_sample_neighbors(
             buffer.reset(buffer_addr, char_del);
           }
           for (int &x : res) {
-            id = node->get_neighbor_id(x);
+            id = csr != nullptr ? csr->get_neighbor_id(row, x)
+                                : node->get_neighbor_id(x);
             memcpy(buffer_addr + offset, &id, Node::id_size);
             offset += Node::id_size;
             if (need_weight) {
 #if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
-              weight = node->get_neighbor_weight(x);
+              if (csr != nullptr) {
+                weight = csr->get_neighbor_weight(row, x);
+              } else {
+                weight = node->get_neighbor_weight(x);
+              }
 #else
               weight = 1.0;
 #endif
@@ -2864,7 +3002,7 @@ int32_t GraphTable::random_sample_neighbors(
         }
       }
       if (!sample_res.empty()) {
-        scaled_lru->insert(
+        sample_cache->insert(
             i, sample_keys.data(), sample_res.data(), sample_keys.size());
       }
       return 0;
@@ -3446,7 +3584,9 @@ int32_t GraphTable::Initialize(const GraphParameter &graph) {
   if (use_cache) {
     cache_size_limit = graph.cache_size_limit();
     cache_ttl = graph.cache_ttl();
-    make_neighbor_sample_cache(cache_size_limit, cache_ttl);
+    cache_memory_limit = graph.cache_memory_limit();
+    make_neighbor_sample_cache(
+        cache_size_limit, cache_ttl, cache_memory_limit);
   }
   _shards_task_pool.resize(task_pool_size_);
   for (size_t i = 0; i < _shards_task_pool.size(); ++i) {
@@ -246,6 +246,11 @@ int32_t CtrCommonAccessor::Merge(float** update_values,
 int32_t CtrCommonAccessor::Update(float** update_values,
                                   const float** push_values,
                                   size_t num) {
+  // the sgd rules update the values of the push in batches
+  thread_local SparseValueSGDBatch embed_batch;
+  thread_local SparseValueSGDBatch embedx_batch;
+  embed_batch.Clear();
+  embedx_batch.Clear();
   for (size_t value_item = 0; value_item < num; ++value_item) {
     float* update_value = update_values[value_item];
     const float* push_value = push_values[value_item];
@@ -265,17 +270,17 @@ int32_t CtrCommonAccessor::Update(float** update_values,
     }
     VLOG(3) << "accessor show scale:" << _show_scale
             << ", push_show:" << push_show;
-    _embed_sgd_rule->UpdateValue(
-        update_value + common_feature_value.EmbedWIndex(),
-        update_value + common_feature_value.EmbedG2SumIndex(),
-        push_value + CtrCommonPushValue::EmbedGIndex(),
-        push_show);
-    _embedx_sgd_rule->UpdateValue(
-        update_value + common_feature_value.EmbedxWIndex(),
-        update_value + common_feature_value.EmbedxG2SumIndex(),
-        push_value + CtrCommonPushValue::EmbedxGIndex(),
-        push_show);
+    embed_batch.Add(update_value + common_feature_value.EmbedWIndex(),
+                    update_value + common_feature_value.EmbedG2SumIndex(),
+                    push_value + CtrCommonPushValue::EmbedGIndex(),
+                    push_show);
+    embedx_batch.Add(update_value + common_feature_value.EmbedxWIndex(),
+                     update_value + common_feature_value.EmbedxG2SumIndex(),
+                     push_value + CtrCommonPushValue::EmbedxGIndex(),
+                     push_show);
   }
+  embed_batch.Update(_embed_sgd_rule);
+  embedx_batch.Update(_embedx_sgd_rule);
   return 0;
 }
 
@@ -0,0 +1,334 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "paddle/fluid/distributed/ps/table/depends/feature_value.h"
+#include "paddle/fluid/distributed/ps/table/depends/fixed_stride_value_store.h"
+#include "paddle/phi/core/memory/allocation/spin_lock.h"
+
+namespace paddle {
+namespace distributed {
+
+// A sparse table shard whose lookups take no lock.
+//
+// Keys are spread over CTR_SPARSE_SHARD_BUCKET_NUM stripes. The values of a
+// stripe live in a FixedStrideValueStore, and an open addressing table maps
+// the keys to their handles. A slot packs a tag of the key hash and the
+// handle in one atomic word, and a full table is replaced by a twice larger
+// copy, so a reader always probes a consistent table without locking. The
+// tables replaced by growth are retired until EraseIf/Clear.
+//
+// Find may run concurrently with everything but EraseIf and Clear. Creating
+// or resizing a value, and updating its data in place, must hold Mutex(key).
+// A reader may see a value in the middle of an update, but always gets a
+// size which fits the data it gets.
+template <class KEY>
+class alignas(64) ConcurrentSparseTableShard {
+ public:
+  typedef FixedStrideValueStore<KEY> store_type;
+  typedef typename store_type::Entry entry_type;
+  typedef paddle::memory::SpinLock mutex_type;
+
+  ConcurrentSparseTableShard() {}
+  ConcurrentSparseTableShard(const ConcurrentSparseTableShard&) = delete;
+  ~ConcurrentSparseTableShard() { Clear(); }
+
+  size_t size() const {
+    size_t size = 0;
+    for (auto& stripe : _stripes) {
+      size += stripe.size.load(std::memory_order_relaxed);
+    }
+    return size;
+  }
+  bool empty() const { return size() == 0; }
+  size_t bucket_count() const { return CTR_SPARSE_SHARD_BUCKET_NUM; }
+
+  // Bytes of the slot tables and value pages.
+  size_t MemorySize() const {
+    size_t memory_size = 0;
+    for (auto& stripe : _stripes) {
+      memory_size += stripe.store.MemorySize();
+      memory_size += stripe.memory_size;
+    }
+    return memory_size;
+  }
+
+  mutex_type& Mutex(const KEY& key) {
+    return _stripes[compute_bucket(Hash(key))].mutex;
+  }
+
+  // Return the data of key and set its size, or return nullptr. Takes no
+  // lock.
+  float* Find(const KEY& key, size_t* size) {
+    size_t hash = Hash(key);
+    Stripe& stripe = _stripes[compute_bucket(hash)];
+    uint32_t handle = FindHandle(&stripe, key, hash, nullptr);
+    if (handle == 0) {
+      return nullptr;
+    }
+    entry_type* entry = stripe.store.Get(handle);
+    *size = entry->size.load(std::memory_order_acquire);
+    return entry->data();
+  }
+
+  // Return the data and size of key, or create it with a copy of
+  // init[0, init_size). The caller must hold Mutex(key).
+  float* EmplaceLocked(const KEY& key,
+                       const float* init,
+                       size_t init_size,
+                       size_t* size) {
+    float* data = Find(key, size);
+    if (data != nullptr) {
+      return data;
+    }
+    size_t hash = Hash(key);
+    Stripe& stripe = _stripes[compute_bucket(hash)];
+    Table* table = stripe.table.load(std::memory_order_relaxed);
+    if (table == nullptr || (stripe.used + 1) * 4 > (table->mask + 1) * 3) {
+      table = Grow(&stripe);
+    }
+    uint32_t handle = stripe.store.Allocate(key, init, init_size);
+    Insert(table, hash, handle);
+    ++stripe.used;
+    stripe.size.fetch_add(1, std::memory_order_relaxed);
+    *size = init_size;
+    return stripe.store.Get(handle)->data();
+  }
+
+  float* Emplace(const KEY& key,
+                 const float* init,
+                 size_t init_size,
+                 size_t* size) {
+    std::lock_guard<mutex_type> guard(Mutex(key));
+    return EmplaceLocked(key, init, init_size, size);
+  }
+
+  // Set the value of an existing key to a copy of init[0, size) and return
+  // its data. A value growing beyond its entry moves to a larger one, the old
+  // entry stays readable until EraseIf. The caller must hold Mutex(key).
+  float* ResizeLocked(const KEY& key, const float* init, size_t size) {
+    size_t hash = Hash(key);
+    Stripe& stripe = _stripes[compute_bucket(hash)];
+    std::atomic<uint64_t>* slot = nullptr;
+    uint32_t handle = FindHandle(&stripe, key, hash, &slot);
+    PADDLE_ENFORCE_NE(handle,
+                      0,
+                      common::errors::NotFound(
+                          "The key %d to resize is not in the shard.", key));
+    if (size <= stripe.store.Capacity(handle)) {
+      entry_type* entry = stripe.store.Get(handle);
+      memcpy(entry->data(), init, size * sizeof(float));
+      entry->size.store(size, std::memory_order_release);
+      return entry->data();
+    }
+    uint32_t new_handle = stripe.store.Allocate(key, init, size);
+    slot->store(MakeSlot(hash, new_handle), std::memory_order_release);
+    stripe.store.Release(handle);
+    return stripe.store.Get(new_handle)->data();
+  }
+
+  // Call func(key, data, size) for every value, streaming the value pages
+  // in memory order. No writer may run concurrently.
+  void ForEach(const std::function<void(const KEY&, float*, size_t)>& func) {
+    for (auto& stripe : _stripes) {
+      stripe.store.ForEach([&func](uint32_t handle, entry_type* entry) {
+        func(entry->key,
+             entry->data(),
+             entry->size.load(std::memory_order_relaxed));
+      });
+    }
+  }
+
+  // Erase the values for which pred(key, data, size) is true, and return
+  // how many are erased. The value pages are compacted and the tables are
+  // rebuilt to fit the remaining values. Nothing else may access the shard
+  // concurrently.
+  size_t EraseIf(const std::function<bool(const KEY&, float*, size_t)>& pred) {
+    size_t erased = 0;
+    for (auto& stripe : _stripes) {
+      FreeRetired(&stripe);
+      Table* table = stripe.table.load(std::memory_order_relaxed);
+      if (table == nullptr) {
+        continue;
+      }
+      erased += stripe.store.Compact([&pred](entry_type* entry) {
+        return pred(entry->key,
+                    entry->data(),
+                    entry->size.load(std::memory_order_relaxed));
+      });
+      size_t live = stripe.store.size();
+      size_t capacity = kMinTableSize;
+      while (live * 2 > capacity) {
+        capacity *= 2;
+      }
+      Table* new_table = NewTable(&stripe, capacity);
+      stripe.store.ForEach([new_table](uint32_t handle, entry_type* entry) {
+        Insert(new_table, Hash(entry->key), handle);
+      });
+      stripe.table.store(new_table, std::memory_order_release);
+      DeleteTable(&stripe, table);
+      stripe.used = live;
+      stripe.size.store(live, std::memory_order_relaxed);
+    }
+    return erased;
+  }
+
+  // Nothing else may access the shard concurrently.
+  void Clear() {
+    for (auto& stripe : _stripes) {
+      FreeRetired(&stripe);
+      Table* table = stripe.table.load(std::memory_order_relaxed);
+      if (table != nullptr) {
+        DeleteTable(&stripe, table);
+        stripe.table.store(nullptr, std::memory_order_relaxed);
+      }
+      stripe.store.Clear();
+      stripe.used = 0;
+      stripe.size.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  static size_t compute_bucket(size_t hash) {
+    if (CTR_SPARSE_SHARD_BUCKET_NUM == 1) {
+      return 0;
+    } else {
+      return hash >> (sizeof(size_t) * 8 - CTR_SPARSE_SHARD_BUCKET_NUM_BITS);
+    }
+  }
+
+ private:
+  static constexpr size_t kMinTableSize = 16;
+  static constexpr uint64_t kTagMask = 0xffffffff00000000ULL;
+
+  // A slot holds the high 32 bits of the key hash and the handle, 0 is empty.
+  struct Table {
+    size_t mask;
+    std::atomic<uint64_t>* slots;
+  };
+  struct alignas(64) Stripe {
+    std::atomic<Table*> table{nullptr};
+    mutex_type mutex;
+    // slots taken in table, only accessed under the mutex
+    size_t used = 0;
+    std::atomic<size_t> size{0};
+    size_t memory_size = 0;
+    store_type store;
+    std::vector<Table*> retired;
+  };
+
+  // The keys are usually routed to shards by their low bits, mix them so that
+  // both the stripe (high bits) and the slot (low bits) are uniform.
+  static size_t Hash(const KEY& key) {
+    uint64_t h = static_cast<uint64_t>(std::hash<KEY>()(key));
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return static_cast<size_t>(h);
+  }
+
+  static uint64_t MakeSlot(size_t hash, uint32_t handle) {
+    return (static_cast<uint64_t>(hash) & kTagMask) | handle;
+  }
+
+  // Return the handle of key or 0, and set found to its slot.
+  uint32_t FindHandle(Stripe* stripe,
+                      const KEY& key,
+                      size_t hash,
+                      std::atomic<uint64_t>** found) {
+    Table* table = stripe->table.load(std::memory_order_acquire);
+    if (table == nullptr) {
+      return 0;
+    }
+    const uint64_t tag = MakeSlot(hash, 0);
+    for (size_t i = hash & table->mask;; i = (i + 1) & table->mask) {
+      uint64_t slot = table->slots[i].load(std::memory_order_acquire);
+      if (slot == 0) {
+        return 0;
+      }
+      uint32_t handle = static_cast<uint32_t>(slot);
+      if ((slot & kTagMask) == tag && stripe->store.Get(handle)->key == key) {
+        if (found != nullptr) {
+          *found = &table->slots[i];
+        }
+        return handle;
+      }
+    }
+  }
+
+  static void Insert(Table* table, size_t hash, uint32_t handle) {
+    size_t i = hash & table->mask;
+    while (table->slots[i].load(std::memory_order_relaxed) != 0) {
+      i = (i + 1) & table->mask;
+    }
+    table->slots[i].store(MakeSlot(hash, handle), std::memory_order_release);
+  }
+
+  Table* NewTable(Stripe* stripe, size_t capacity) {
+    Table* table = new Table;
+    table->mask = capacity - 1;
+    table->slots = new std::atomic<uint64_t>[capacity];
+    for (size_t i = 0; i < capacity; ++i) {
+      table->slots[i].store(0, std::memory_order_relaxed);
+    }
+    stripe->memory_size += capacity * sizeof(uint64_t);
+    return table;
+  }
+
+  void DeleteTable(Stripe* stripe, Table* table) {
+    stripe->memory_size -= (table->mask + 1) * sizeof(uint64_t);
+    delete[] table->slots;
+    delete table;
+  }
+
+  // Publish a twice larger copy of the stripe table, the old one may still be
+  // probed by readers and is retired.
+  Table* Grow(Stripe* stripe) {
+    Table* table = stripe->table.load(std::memory_order_relaxed);
+    size_t capacity = table == nullptr ? kMinTableSize : (table->mask + 1) * 2;
+    Table* new_table = NewTable(stripe, capacity);
+    if (table != nullptr) {
+      for (size_t i = 0; i <= table->mask; ++i) {
+        uint64_t slot = table->slots[i].load(std::memory_order_relaxed);
+        if (slot != 0) {
+          uint32_t handle = static_cast<uint32_t>(slot);
+          Insert(new_table, Hash(stripe->store.Get(handle)->key), handle);
+        }
+      }
+      stripe->retired.push_back(table);
+    }
+    stripe->table.store(new_table, std::memory_order_release);
+    return new_table;
+  }
+
+  void FreeRetired(Stripe* stripe) {
+    for (Table* table : stripe->retired) {
+      DeleteTable(stripe, table);
+    }
+    stripe->retired.clear();
+  }
+
+  Stripe _stripes[CTR_SPARSE_SHARD_BUCKET_NUM];
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,292 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace distributed {
+
+// Sparse values kept in pages of fixed stride entries.
+//
+// Every entry holds the key, the size and the floats of one value, so the
+// values can be streamed page by page. Entries are grouped in up to
+// kMaxClasses classes by their capacity (e.g. the values with and without
+// embedx), and addressed by a 32 bits handle made of the class, the page and
+// the index in the page. Handles are never 0.
+//
+// Entries are only appended; a released entry is a hole until Compact, which
+// moves the remaining entries to the front and frees the empty pages. Get
+// takes no lock and may run concurrently with Allocate/Release, as long as
+// the handle was published to the reader with a release store after
+// Allocate. The other methods must be serialized by the caller, and nothing
+// may run concurrently with Compact/Clear.
+template <class KEY>
+class FixedStrideValueStore {
+ public:
+  static constexpr int kMaxClasses = 3;
+  static constexpr int kPageBits = 10;
+  static constexpr int kPageIdBits = 20;
+  static constexpr uint32_t kPageEntries = 1U << kPageBits;
+  static constexpr uint32_t kMaxPages = 1U << kPageIdBits;
+
+  struct Entry {
+    KEY key;
+    std::atomic<uint32_t> size;
+    uint32_t live;
+    float* data() { return reinterpret_cast<float*>(this + 1); }
+  };
+
+  FixedStrideValueStore() {}
+  FixedStrideValueStore(const FixedStrideValueStore&) = delete;
+  ~FixedStrideValueStore() { Clear(); }
+
+  Entry* Get(uint32_t handle) const {
+    const ValueClass& value_class = _classes[(handle >> 30) - 1];
+    Directory* dir = value_class.dir.load(std::memory_order_acquire);
+    char* page = dir->pages[(handle >> kPageBits) & (kMaxPages - 1)];
+    return reinterpret_cast<Entry*>(
+        page + (handle & (kPageEntries - 1)) * value_class.entry_bytes);
+  }
+
+  // Floats an entry of the handle can hold.
+  size_t Capacity(uint32_t handle) const {
+    return _classes[(handle >> 30) - 1].stride;
+  }
+
+  uint32_t Allocate(const KEY& key, const float* init, size_t size) {
+    int class_id = ClassOf(size);
+    ValueClass& value_class = _classes[class_id];
+    uint32_t index = value_class.count;
+    uint32_t page_id = index >> kPageBits;
+    if ((index & (kPageEntries - 1)) == 0) {
+      NewPage(&value_class, page_id);
+    }
+    ++value_class.count;
+    ++_live;
+    uint32_t handle = (static_cast<uint32_t>(class_id + 1) << 30) |
+                      (page_id << kPageBits) | (index & (kPageEntries - 1));
+    Entry* entry = Get(handle);
+    entry->key = key;
+    memcpy(entry->data(), init, size * sizeof(float));
+    entry->size.store(size, std::memory_order_relaxed);
+    entry->live = 1;
+    return handle;
+  }
+
+  // Readers may still use the entry, it stays until the next Compact.
+  void Release(uint32_t handle) {
+    Get(handle)->live = 0;
+    --_live;
+  }
+
+  // Call func(handle, entry) for every live entry in memory order.
+  template <class FUNC>
+  void ForEach(FUNC&& func) {
+    for (int c = 0; c < _num_classes; ++c) {
+      ValueClass& value_class = _classes[c];
+      Directory* dir = value_class.dir.load(std::memory_order_relaxed);
+      for (uint32_t index = 0; index < value_class.count; ++index) {
+        char* page = dir->pages[index >> kPageBits];
+        Entry* entry = reinterpret_cast<Entry*>(
+            page + (index & (kPageEntries - 1)) * value_class.entry_bytes);
+        if (entry->live) {
+          uint32_t handle = (static_cast<uint32_t>(c + 1) << 30) | index;
+          func(handle, entry);
+        }
+      }
+    }
+  }
+
+  // Drop the released entries and those for which pred(entry) is true, and
+  // move the others to the front of their class. All handles change, return
+  // how many entries are dropped by pred.
+  template <class PRED>
+  size_t Compact(PRED&& pred) {
+    size_t erased = 0;
+    for (int c = 0; c < _num_classes; ++c) {
+      ValueClass& value_class = _classes[c];
+      FreeRetired(&value_class);
+      Directory* dir = value_class.dir.load(std::memory_order_relaxed);
+      const size_t entry_bytes = value_class.entry_bytes;
+      uint32_t kept = 0;
+      for (uint32_t index = 0; index < value_class.count; ++index) {
+        Entry* entry = reinterpret_cast<Entry*>(
+            dir->pages[index >> kPageBits] +
+            (index & (kPageEntries - 1)) * entry_bytes);
+        if (!entry->live) {
+          continue;
+        }
+        if (pred(entry)) {
+          entry->live = 0;
+          --_live;
+          ++erased;
+          continue;
+        }
+        if (kept != index) {
+          Entry* target = reinterpret_cast<Entry*>(
+              dir->pages[kept >> kPageBits] +
+              (kept & (kPageEntries - 1)) * entry_bytes);
+          size_t size = entry->size.load(std::memory_order_relaxed);
+          target->key = entry->key;
+          target->size.store(size, std::memory_order_relaxed);
+          target->live = 1;
+          memcpy(target->data(), entry->data(), size * sizeof(float));
+        }
+        ++kept;
+      }
+      uint32_t pages = (value_class.count + kPageEntries - 1) >> kPageBits;
+      uint32_t kept_pages = (kept + kPageEntries - 1) >> kPageBits;
+      for (uint32_t page_id = kept_pages; page_id < pages; ++page_id) {
+        free(dir->pages[page_id]);
+        dir->pages[page_id] = nullptr;
+        _memory_size -= kPageEntries * entry_bytes;
+      }
+      value_class.count = kept;
+    }
+    return erased;
+  }
+
+  void Clear() {
+    for (int c = 0; c < _num_classes; ++c) {
+      ValueClass& value_class = _classes[c];
+      FreeRetired(&value_class);
+      Directory* dir = value_class.dir.load(std::memory_order_relaxed);
+      uint32_t pages = (value_class.count + kPageEntries - 1) >> kPageBits;
+      for (uint32_t page_id = 0; page_id < pages; ++page_id) {
+        free(dir->pages[page_id]);
+      }
+      DeleteDirectory(dir);
+      value_class.dir.store(nullptr, std::memory_order_relaxed);
+      value_class.count = 0;
+    }
+    _num_classes = 0;
+    _live = 0;
+    _memory_size = 0;
+  }
+
+  size_t size() const { return _live; }
+  // Bytes of all pages and directories.
+  size_t MemorySize() const { return _memory_size; }
+
+ private:
+  struct Directory {
+    uint32_t capacity;
+    char** pages;
+  };
+  struct ValueClass {
+    size_t stride = 0;
+    size_t entry_bytes = 0;
+    // entries appended, including the released ones
+    uint32_t count = 0;
+    std::atomic<Directory*> dir{nullptr};
+    std::vector<Directory*> retired;
+  };
+
+  // The class of the smallest capacity which fits size, a new class is made
+  // for size if none fits.
+  int ClassOf(size_t size) {
+    int best = -1;
+    for (int c = 0; c < _num_classes; ++c) {
+      if (_classes[c].stride >= size &&
+          (best < 0 || _classes[c].stride < _classes[best].stride)) {
+        best = c;
+      }
+    }
+    if (best >= 0) {
+      return best;
+    }
+    PADDLE_ENFORCE_LT(
+        _num_classes,
+        kMaxClasses,
+        common::errors::ResourceExhausted(
+            "FixedStrideValueStore supports at most %d value sizes, but a "
+            "value of size %d does not fit any of them.",
+            kMaxClasses,
+            size));
+    ValueClass& value_class = _classes[_num_classes];
+    value_class.stride = size;
+    value_class.entry_bytes =
+        (sizeof(Entry) + size * sizeof(float) + 7) & ~static_cast<size_t>(7);
+    value_class.count = 0;
+    return _num_classes++;
+  }
+
+  void NewPage(ValueClass* value_class, uint32_t page_id) {
+    PADDLE_ENFORCE_LT(page_id,
+                      kMaxPages,
+                      common::errors::ResourceExhausted(
+                          "FixedStrideValueStore can not hold more than %d "
+                          "pages of a value size.",
+                          kMaxPages));
+    Directory* dir = value_class->dir.load(std::memory_order_relaxed);
+    if (dir == nullptr || page_id >= dir->capacity) {
+      // readers may still use the old directory, it is retired
+      uint32_t capacity = dir == nullptr ? 16 : dir->capacity * 2;
+      Directory* new_dir = new Directory;
+      new_dir->capacity = capacity;
+      new_dir->pages = new char*[capacity]();
+      if (dir != nullptr) {
+        std::copy(dir->pages, dir->pages + dir->capacity, new_dir->pages);
+        value_class->retired.push_back(dir);
+      }
+      _memory_size += capacity * sizeof(char*);
+      value_class->dir.store(new_dir, std::memory_order_release);
+      dir = new_dir;
+    }
+    size_t page_bytes = kPageEntries * value_class->entry_bytes;
+    char* page = nullptr;
+    int error = posix_memalign(
+        reinterpret_cast<void**>(&page), alignof(Entry), page_bytes);
+    PADDLE_ENFORCE_EQ(error,
+                      0,
+                      common::errors::ResourceExhausted(
+                          "Fail to alloc memory of %ld size, error code is %d.",
+                          page_bytes,
+                          error));
+    dir->pages[page_id] = page;
+    _memory_size += page_bytes;
+  }
+
+  void DeleteDirectory(Directory* dir) {
+    if (dir != nullptr) {
+      _memory_size -= dir->capacity * sizeof(char*);
+      delete[] dir->pages;
+      delete dir;
+    }
+  }
+
+  void FreeRetired(ValueClass* value_class) {
+    for (Directory* dir : value_class->retired) {
+      DeleteDirectory(dir);
+    }
+    value_class->retired.clear();
+  }
+
+  ValueClass _classes[kMaxClasses];
+  int _num_classes = 0;
+  size_t _live = 0;
+  size_t _memory_size = 0;
+};
+
+}  // namespace distributed
+}  // namespace paddle
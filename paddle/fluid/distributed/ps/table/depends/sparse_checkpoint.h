@@ -0,0 +1,387 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/fluid/distributed/common/afs_warpper.h"
+
+namespace paddle {
+namespace distributed {
+
+// Binary checkpoint of one sparse table shard, with the suffix
+// SPARSE_CHECKPOINT_SUFFIX.
+//
+// The values are written as raw floats, so that a file can be mapped and
+// copied into a table without parsing:
+//
+//   header   magic, version
+//   values   the floats of all values, one after another
+//   keys     uint64 key of every value
+//   index    uint64 offset in floats of every value, and the end offset
+//   footer   block offsets and counts, a checksum of every block, magic
+//
+// Every block begins at a multiple of kSparseCheckpointAlign bytes. The
+// values are streamed first and the keys, which are only known at the end,
+// follow them, so a shard is written in one pass.
+#define SPARSE_CHECKPOINT_SUFFIX ".bin"
+// A delta checkpoint has the same layout, and holds the values changed since
+// the previous checkpoint. Erased keys are values of size 0.
+#define SPARSE_CHECKPOINT_DELTA_SUFFIX ".delta"
+
+static constexpr uint64_t kSparseCheckpointMagic = 0x54504b4353445050ULL;
+static constexpr uint32_t kSparseCheckpointVersion = 1;
+static constexpr size_t kSparseCheckpointAlign = 64;
+
+struct SparseCheckpointHeader {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t reserved;
+};
+
+struct SparseCheckpointFooter {
+  uint64_t key_num;
+  uint64_t value_num;  // floats
+  uint64_t value_offset;
+  uint64_t key_offset;
+  uint64_t index_offset;
+  uint64_t value_checksum;
+  uint64_t key_checksum;
+  uint64_t index_checksum;
+  uint64_t magic;
+};
+
+// Whether the files of a table are binary checkpoints with the suffix.
+inline bool IsSparseCheckpoint(
+    const std::vector<std::string>& file_list,
+    const std::string& suffix = SPARSE_CHECKPOINT_SUFFIX) {
+  for (auto& file : file_list) {
+    if (file.size() < suffix.size() ||
+        file.compare(file.size() - suffix.size(), suffix.size(), suffix) !=
+            0) {
+      return false;
+    }
+  }
+  return !file_list.empty();
+}
+
+// Checksum of a stream of 32 bits words, which are spread over four
+// independent lanes so that it is not bound by the multiply latency.
+class SparseCheckpointChecksum {
+ public:
+  void Update(const void* data, size_t bytes) {
+    const char* ptr = reinterpret_cast<const char*>(data);
+    for (size_t i = 0; i + sizeof(uint32_t) <= bytes; i += sizeof(uint32_t)) {
+      uint32_t word;
+      memcpy(&word, ptr + i, sizeof(uint32_t));
+      uint64_t& lane = _lanes[_count++ & 3];
+      lane = (lane ^ word) * 0x100000001b3ULL;
+    }
+  }
+
+  uint64_t Digest() const {
+    uint64_t h = _count;
+    for (uint64_t lane : _lanes) {
+      h ^= lane;
+      h *= 0xff51afd7ed558ccdULL;
+      h ^= h >> 33;
+    }
+    return h;
+  }
+
+ private:
+  uint64_t _lanes[4] = {0xcbf29ce484222325ULL,
+                        0x84222325cbf29ce4ULL,
+                        0xcbf29ce484222325ULL ^ 1,
+                        0x84222325cbf29ce4ULL ^ 1};
+  uint64_t _count = 0;
+};
+
+class SparseCheckpointWriter {
+ public:
+  explicit SparseCheckpointWriter(FsWriteChannel* channel)
+      : _channel(channel) {}
+
+  int WriteHeader() {
+    SparseCheckpointHeader header = {
+        kSparseCheckpointMagic, kSparseCheckpointVersion, 0};
+    _offset = 0;
+    _value_num = 0;
+    _keys.clear();
+    _index.clear();
+    _value_checksum = SparseCheckpointChecksum();
+    _failed = false;
+    if (Write(&header, sizeof(header)) != 0) {
+      return -1;
+    }
+    return Pad();
+  }
+
+  int Append(uint64_t key, const float* data, size_t size) {
+    _keys.push_back(key);
+    _index.push_back(_value_num);
+    _value_num += size;
+    _value_checksum.Update(data, size * sizeof(float));
+    return Write(data, size * sizeof(float));
+  }
+
+  int Finish() {
+    SparseCheckpointFooter footer;
+    footer.key_num = _keys.size();
+    footer.value_num = _value_num;
+    footer.value_offset = kSparseCheckpointAlign;
+    footer.value_checksum = _value_checksum.Digest();
+    _index.push_back(_value_num);
+    if (Pad() != 0) {
+      return -1;
+    }
+    footer.key_offset = _offset;
+    footer.key_checksum = WriteBlock(_keys);
+    if (Pad() != 0) {
+      return -1;
+    }
+    footer.index_offset = _offset;
+    footer.index_checksum = WriteBlock(_index);
+    footer.magic = kSparseCheckpointMagic;
+    if (_failed || Pad() != 0) {
+      return -1;
+    }
+    return Write(&footer, sizeof(footer));
+  }
+
+  size_t key_num() const { return _keys.size(); }
+
+ private:
+  int Write(const void* data, size_t size) {
+    if (size == 0) {
+      return 0;
+    }
+    if (_channel->write(reinterpret_cast<const char*>(data), size) != 0) {
+      _failed = true;
+      return -1;
+    }
+    _offset += size;
+    return 0;
+  }
+  int Pad() {
+    static const char zeros[kSparseCheckpointAlign] = {0};
+    size_t tail = _offset % kSparseCheckpointAlign;
+    return Write(zeros, tail == 0 ? 0 : kSparseCheckpointAlign - tail);
+  }
+  uint64_t WriteBlock(const std::vector<uint64_t>& block) {
+    SparseCheckpointChecksum checksum;
+    checksum.Update(block.data(), block.size() * sizeof(uint64_t));
+    Write(block.data(), block.size() * sizeof(uint64_t));
+    return checksum.Digest();
+  }
+
+  FsWriteChannel* _channel;
+  uint64_t _offset = 0;
+  uint64_t _value_num = 0;
+  bool _failed = false;
+  std::vector<uint64_t> _keys;
+  std::vector<uint64_t> _index;
+  SparseCheckpointChecksum _value_checksum;
+};
+
+// A checkpoint file mapped (local files) or read (remote files) in memory.
+class SparseCheckpointReader {
+ public:
+  SparseCheckpointReader() {}
+  SparseCheckpointReader(const SparseCheckpointReader&) = delete;
+  ~SparseCheckpointReader() { Close(); }
+
+  // Map a local file, the pages are read by the kernel as they are touched.
+  int Map(const std::string& path) {
+    Close();
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      LOG(ERROR) << "SparseCheckpointReader open failed, path:" << path;
+      return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+      LOG(ERROR) << "SparseCheckpointReader stat failed, path:" << path;
+      close(fd);
+      return -1;
+    }
+    // private and writable, so that the values can be handed to the accessors
+    // which take float*, the file is never modified
+    void* addr = mmap(
+        nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+      LOG(ERROR) << "SparseCheckpointReader mmap failed, path:" << path;
+      return -1;
+    }
+    madvise(addr, st.st_size, MADV_SEQUENTIAL);
+    _mapped = true;
+    _data = reinterpret_cast<const char*>(addr);
+    _size = st.st_size;
+    return Parse();
+  }
+
+  // Read a whole file through the channel, for the files which can not be
+  // mapped.
+  int Read(FsReadChannel* channel) {
+    Close();
+    const size_t chunk = 4 << 20;
+    size_t read_size = 0;
+    while (true) {
+      _buffer.resize(read_size + chunk);
+      int count = channel->read(&_buffer[read_size], chunk);
+      if (count <= 0) {
+        break;
+      }
+      read_size += count;
+    }
+    _buffer.resize(read_size);
+    _data = _buffer.data();
+    _size = _buffer.size();
+    return Parse();
+  }
+
+  // Compare the checksums of all blocks with the footer.
+  bool Verify() const {
+    if (_index[_footer.key_num] != _footer.value_num) {
+      return false;
+    }
+    SparseCheckpointChecksum value_checksum;
+    value_checksum.Update(values(), _footer.value_num * sizeof(float));
+    SparseCheckpointChecksum key_checksum;
+    key_checksum.Update(_keys, _footer.key_num * sizeof(uint64_t));
+    SparseCheckpointChecksum index_checksum;
+    index_checksum.Update(_index, (_footer.key_num + 1) * sizeof(uint64_t));
+    return value_checksum.Digest() == _footer.value_checksum &&
+           key_checksum.Digest() == _footer.key_checksum &&
+           index_checksum.Digest() == _footer.index_checksum;
+  }
+
+  void Close() {
+    if (_mapped) {
+      munmap(const_cast<char*>(_data), _size);
+    }
+    _mapped = false;
+    _data = nullptr;
+    _size = 0;
+    _buffer.clear();
+    _buffer.shrink_to_fit();
+  }
+
+  size_t key_num() const { return _footer.key_num; }
+  uint64_t key(size_t i) const { return _keys[i]; }
+  const uint64_t* key_data(size_t i) const { return _keys + i; }
+  const float* value(size_t i) const { return values() + _index[i]; }
+  size_t value_size(size_t i) const { return _index[i + 1] - _index[i]; }
+
+ private:
+  const float* values() const {
+    return reinterpret_cast<const float*>(_data + _footer.value_offset);
+  }
+
+  int Parse() {
+    SparseCheckpointHeader header;
+    if (_size < sizeof(header) + sizeof(_footer)) {
+      LOG(ERROR) << "SparseCheckpointReader file is truncated, size:" << _size;
+      return -1;
+    }
+    memcpy(&header, _data, sizeof(header));
+    memcpy(&_footer, _data + _size - sizeof(_footer), sizeof(_footer));
+    if (header.magic != kSparseCheckpointMagic ||
+        _footer.magic != kSparseCheckpointMagic) {
+      LOG(ERROR) << "SparseCheckpointReader bad magic, not a checkpoint";
+      return -1;
+    }
+    if (header.version != kSparseCheckpointVersion) {
+      LOG(ERROR) << "SparseCheckpointReader unknown version:"
+                 << header.version;
+      return -1;
+    }
+    uint64_t end = _size - sizeof(_footer);
+    if (_footer.value_offset + _footer.value_num * sizeof(float) >
+            _footer.key_offset ||
+        _footer.key_offset + _footer.key_num * sizeof(uint64_t) >
+            _footer.index_offset ||
+        _footer.index_offset + (_footer.key_num + 1) * sizeof(uint64_t) >
+            end) {
+      LOG(ERROR) << "SparseCheckpointReader blocks out of the file";
+      return -1;
+    }
+    _keys = reinterpret_cast<const uint64_t*>(_data + _footer.key_offset);
+    _index = reinterpret_cast<const uint64_t*>(_data + _footer.index_offset);
+    return 0;
+  }
+
+  bool _mapped = false;
+  const char* _data = nullptr;
+  size_t _size = 0;
+  std::vector<char> _buffer;
+  SparseCheckpointFooter _footer;
+  const uint64_t* _keys = nullptr;
+  const uint64_t* _index = nullptr;
+};
+
+// Merge a checkpoint and its deltas, given in the order they were saved, into
+// one checkpoint: the last value of a key wins and the erased keys are
+// dropped. The writer must be fresh, return the number of keys written or -1.
+inline int64_t MergeSparseCheckpoints(
+    const std::vector<const SparseCheckpointReader*>& inputs,
+    SparseCheckpointWriter* writer) {
+  // the input and the index of the latest value of every key
+  std::unordered_map<uint64_t, std::pair<size_t, size_t>> latest;
+  if (!inputs.empty()) {
+    latest.reserve(inputs[0]->key_num());
+  }
+  for (size_t r = 0; r < inputs.size(); ++r) {
+    for (size_t i = 0; i < inputs[r]->key_num(); ++i) {
+      latest[inputs[r]->key(i)] = std::make_pair(r, i);
+    }
+  }
+  if (writer->WriteHeader() != 0) {
+    return -1;
+  }
+  // every key is written with its latest value, in the order of the inputs
+  for (size_t r = 0; r < inputs.size(); ++r) {
+    const SparseCheckpointReader& reader = *inputs[r];
+    for (size_t i = 0; i < reader.key_num(); ++i) {
+      if (reader.value_size(i) == 0 ||
+          latest[reader.key(i)] != std::make_pair(r, i)) {
+        continue;
+      }
+      int ret =
+          writer->Append(reader.key(i), reader.value(i), reader.value_size(i));
+      if (ret != 0) {
+        return -1;
+      }
+    }
+  }
+  if (writer->Finish() != 0) {
+    return -1;
+  }
+  return writer->key_num();
+}
+
+}  // namespace distributed
+}  // namespace paddle
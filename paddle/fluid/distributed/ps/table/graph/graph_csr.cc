@@ -0,0 +1,298 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_csr.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace paddle::distributed {
+
+void SampleRandomBits::refill() {
+  size = std::min(kBlockSize, std::max<size_t>(expected_draws, 1));
+  expected_draws -= std::min(expected_draws, size);
+  for (size_t i = 0; i < size; ++i) {
+    block[i] = (*rng)();
+  }
+  pos = 0;
+}
+
+void GraphCSR::build(const std::vector<Node *> &nodes, bool is_weighted) {
+  size_t edge_num = 0;
+  for (auto node : nodes) {
+    edge_num += node->get_neighbor_size();
+  }
+  offsets.clear();
+  neighbors.clear();
+  weights.clear();
+  alias_probs.clear();
+  alias_index.clear();
+  offsets.reserve(nodes.size() + 1);
+  neighbors.reserve(edge_num);
+  if (is_weighted) {
+    weights.reserve(edge_num);
+  }
+  offsets.push_back(0);
+  for (auto node : nodes) {
+    size_t degree = node->get_neighbor_size();
+    for (size_t i = 0; i < degree; ++i) {
+      neighbors.push_back(node->get_neighbor_id(i));
+      if (is_weighted) {
+        weights.emplace_back(static_cast<float>(node->get_neighbor_weight(i)));
+      }
+    }
+    offsets.push_back(neighbors.size());
+  }
+  if (is_weighted) {
+    alias_probs.resize(edge_num);
+    alias_index.resize(edge_num);
+    std::vector<uint32_t> small, large;
+    for (size_t row = 0; row < nodes.size(); ++row) {
+      build_alias(row, &small, &large);
+    }
+  }
+}
+
+void GraphCSR::build_alias(size_t row,
+                           std::vector<uint32_t> *small,
+                           std::vector<uint32_t> *large) {
+  // Vose: scale the weights to mean 1, then pair each slot below 1 with a
+  // slot above 1 which fills its rest.
+  size_t n = get_degree(row);
+  float *probs = alias_probs.data() + offsets[row];
+  uint32_t *alias = alias_index.data() + offsets[row];
+  const phi::dtype::float16 *row_weights = weights.data() + offsets[row];
+  double sum = 0;
+  for (size_t i = 0; i < n; ++i) {
+    sum += std::max(static_cast<float>(row_weights[i]), 0.0f);
+  }
+  small->clear();
+  large->clear();
+  for (size_t i = 0; i < n; ++i) {
+    alias[i] = i;
+    probs[i] = sum > 0 ? std::max(static_cast<float>(row_weights[i]), 0.0f) *
+                             n / sum
+                       : 1.0;
+    if (probs[i] < 1.0) {
+      small->push_back(i);
+    } else {
+      large->push_back(i);
+    }
+  }
+  while (!small->empty() && !large->empty()) {
+    uint32_t less = small->back();
+    uint32_t more = large->back();
+    small->pop_back();
+    alias[less] = more;
+    probs[more] -= 1.0 - probs[less];
+    if (probs[more] < 1.0) {
+      large->pop_back();
+      small->push_back(more);
+    }
+  }
+  // What is left is 1 up to rounding.
+  for (uint32_t i : *small) {
+    probs[i] = 1.0;
+  }
+  for (uint32_t i : *large) {
+    probs[i] = 1.0;
+  }
+}
+
+namespace {
+
+// The slots moved by the partial shuffle, few for small k, so a flat vector
+// beats a hash map.
+class FlatSwapMap {
+ public:
+  explicit FlatSwapMap(int k) { slots.reserve(k); }
+  int get(int key) const {
+    for (auto &slot : slots) {
+      if (slot.first == key) {
+        return slot.second;
+      }
+    }
+    return key;
+  }
+  void set(int key, int value) {
+    for (auto &slot : slots) {
+      if (slot.first == key) {
+        slot.second = value;
+        return;
+      }
+    }
+    slots.emplace_back(key, value);
+  }
+
+ private:
+  std::vector<std::pair<int, int>> slots;
+};
+
+class HashSwapMap {
+ public:
+  explicit HashSwapMap(int k) { slots.reserve(k); }
+  int get(int key) const {
+    auto iter = slots.find(key);
+    return iter == slots.end() ? key : iter->second;
+  }
+  void set(int key, int value) { slots[key] = value; }
+
+ private:
+  std::unordered_map<int, int> slots;
+};
+
+// The first k slots of a Fisher-Yates shuffle of [0, n), only the moved
+// slots are stored.
+template <typename SwapMap>
+void PartialShuffle(int n,
+                    int k,
+                    SampleRandomBits *bits,
+                    std::vector<int> *res) {
+  SwapMap swapped(k);
+  for (int i = 0; i < k; ++i) {
+    int j = i + SampleRandomBits::bounded(bits->next(), n - i);
+    int value = swapped.get(j);
+    swapped.set(j, swapped.get(i));
+    res->push_back(value);
+  }
+}
+
+}  // namespace
+
+std::vector<int> GraphCSR::sample_k(
+    size_t row, int k, const std::shared_ptr<std::mt19937_64> &rng) const {
+  SampleRandomBits bits(rng, std::max(k, 0));
+  std::vector<int> sample_result;
+  sample_k(row, k, &bits, &sample_result);
+  return sample_result;
+}
+
+void GraphCSR::sample_k_batch(const std::vector<size_t> &rows,
+                              int k,
+                              const std::shared_ptr<std::mt19937_64> &rng,
+                              std::vector<std::vector<int>> *res) const {
+  SampleRandomBits bits(rng, rows.size() * std::max(k, 0));
+  res->resize(rows.size());
+  for (size_t i = 0; i < rows.size(); ++i) {
+    (*res)[i].clear();
+    sample_k(rows[i], k, &bits, &(*res)[i]);
+  }
+}
+
+void GraphCSR::sample_k(size_t row,
+                        int k,
+                        SampleRandomBits *bits,
+                        std::vector<int> *res) const {
+  int n = static_cast<int>(get_degree(row));
+  if (k <= 0) {
+    return;
+  }
+  if (k >= n) {
+    res->reserve(n);
+    for (int i = 0; i < n; i++) {
+      res->push_back(i);
+    }
+    return;
+  }
+  res->reserve(k);
+  if (weighted_sample && !weights.empty()) {
+    // Few draws rarely collide, more are cheaper in one pass.
+    if (2 * k > n || !alias_sample_k(row, k, bits, res)) {
+      res->clear();
+      weighted_sample_k(row, k, bits, res);
+    }
+    return;
+  }
+  if (k <= 64) {
+    PartialShuffle<FlatSwapMap>(n, k, bits, res);
+  } else {
+    PartialShuffle<HashSwapMap>(n, k, bits, res);
+  }
+}
+
+bool GraphCSR::alias_sample_k(size_t row,
+                              int k,
+                              SampleRandomBits *bits,
+                              std::vector<int> *res) const {
+  // Drawing with replacement and dropping the repeats samples without
+  // replacement by the weights. Rows whose weight sits on a few neighbors
+  // repeat too often, those give up and take the one pass sampler.
+  uint32_t n = get_degree(row);
+  const float *probs = alias_probs.data() + offsets[row];
+  const uint32_t *alias = alias_index.data() + offsets[row];
+  std::unordered_set<int> sampled;
+  bool flat = k <= 64;
+  if (!flat) {
+    sampled.reserve(k);
+  }
+  int budget = 4 * k + 32;
+  while (static_cast<int>(res->size()) < k) {
+    if (budget-- == 0) {
+      return false;
+    }
+    uint64_t random = bits->next();
+    uint32_t col = SampleRandomBits::bounded(random, n);
+    int idx = SampleRandomBits::unit(random) < probs[col] ? col : alias[col];
+    bool repeated =
+        flat ? std::find(res->begin(), res->end(), idx) != res->end()
+             : !sampled.insert(idx).second;
+    if (!repeated) {
+      res->push_back(idx);
+    }
+  }
+  return true;
+}
+
+void GraphCSR::weighted_sample_k(size_t row,
+                                 int k,
+                                 SampleRandomBits *bits,
+                                 std::vector<int> *res) const {
+  // Efraimidis-Spirakis: the k largest log(u) / weight are a weighted sample
+  // without replacement, found in one pass with a min heap of k keys.
+  int n = static_cast<int>(get_degree(row));
+  const phi::dtype::float16 *row_weights = weights.data() + offsets[row];
+  using Key = std::pair<float, int>;
+  std::priority_queue<Key, std::vector<Key>, std::greater<Key>> heap;
+  for (int i = 0; i < n; ++i) {
+    float weight = static_cast<float>(row_weights[i]);
+    // u in (0, 1], so log(u) is finite.
+    double u = ((bits->next() >> 11) + 1) * (1.0 / 9007199254740992.0);
+    float key = weight > 0 ? std::log(u) / weight
+                           : -std::numeric_limits<float>::infinity();
+    if (static_cast<int>(heap.size()) < k) {
+      heap.emplace(key, i);
+    } else if (key > heap.top().first) {
+      heap.pop();
+      heap.emplace(key, i);
+    }
+  }
+  while (!heap.empty()) {
+    res->push_back(heap.top().second);
+    heap.pop();
+  }
+}
+
+void CSRGraphNode::add_edge(uint64_t id UNUSED, float weight UNUSED) {
+  PADDLE_THROW(common::errors::Unavailable(
+      "The edges of node %d are frozen, thaw its GraphShard to change them.",
+      get_id()));
+}
+
+}  // namespace paddle::distributed
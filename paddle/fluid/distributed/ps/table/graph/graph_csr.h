@@ -0,0 +1,176 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_node.h"
+#include "paddle/phi/common/float16.h"
+
+namespace paddle {
+namespace distributed {
+
+// Random bits for the samplers of GraphCSR, drawn from the rng in blocks so
+// the generator runs in a tight loop rather than once per draw. The first
+// blocks are sized by the expected number of draws, so a small sample does
+// not pay for a whole block.
+class SampleRandomBits {
+ public:
+  SampleRandomBits(const std::shared_ptr<std::mt19937_64> &rng,
+                   size_t expected_draws)
+      : rng(rng.get()), expected_draws(expected_draws) {}
+  uint64_t next() {
+    if (pos == size) {
+      refill();
+    }
+    return block[pos++];
+  }
+  // Uniform in [0, n) from the high 32 bits.
+  static uint32_t bounded(uint64_t bits, uint32_t n) {
+    return static_cast<uint32_t>(((bits >> 32) * n) >> 32);
+  }
+  // Uniform in [0, 1) from the low 32 bits.
+  static float unit(uint64_t bits) {
+    return static_cast<uint32_t>(bits) * (1.0f / 4294967296.0f);
+  }
+
+ private:
+  void refill();
+
+  static constexpr size_t kBlockSize = 64;
+  std::mt19937_64 *rng;
+  size_t expected_draws;
+  size_t pos = 0;
+  size_t size = 0;
+  uint64_t block[kBlockSize];
+};
+
+// The adjacency of the nodes of a frozen GraphShard in compressed sparse row
+// format: the neighbors of row i are neighbors[offsets[i], offsets[i + 1]),
+// with their weights in fp16 for weighted graphs. Weighted graphs also keep
+// a Vose alias table per row, so a weighted draw is O(1). Immutable once
+// built, so it is sampled without locks.
+class GraphCSR {
+ public:
+  GraphCSR() {}
+  // Row i holds the neighbors of nodes[i].
+  void build(const std::vector<Node *> &nodes, bool is_weighted);
+
+  size_t get_row_num() const {
+    return offsets.empty() ? 0 : offsets.size() - 1;
+  }
+  size_t get_edge_num() const { return neighbors.size(); }
+  size_t get_degree(size_t row) const {
+    return offsets[row + 1] - offsets[row];
+  }
+  uint64_t get_neighbor_id(size_t row, size_t idx) const {
+    return neighbors[offsets[row] + idx];
+  }
+  float get_neighbor_weight(size_t row, size_t idx) const {
+    return weights.empty() ? 1.0
+                           : static_cast<float>(weights[offsets[row] + idx]);
+  }
+  bool get_is_weighted() const { return !weights.empty(); }
+  // "weighted" samples the neighbors by their weights, otherwise uniformly.
+  void set_sample_type(const std::string &sample_type) {
+    weighted_sample = sample_type == "weighted";
+  }
+  std::string get_sample_type() const {
+    return weighted_sample ? "weighted" : "random";
+  }
+  // Sample k neighbors of the row without replacement, return their indexes.
+  std::vector<int> sample_k(size_t row,
+                            int k,
+                            const std::shared_ptr<std::mt19937_64> &rng) const;
+  // Appends the indexes to the empty res.
+  void sample_k(size_t row,
+                int k,
+                SampleRandomBits *bits,
+                std::vector<int> *res) const;
+  // Sample k neighbors of each of the rows, sharing one block of random bits.
+  void sample_k_batch(const std::vector<size_t> &rows,
+                      int k,
+                      const std::shared_ptr<std::mt19937_64> &rng,
+                      std::vector<std::vector<int>> *res) const;
+  size_t get_memory_size() const {
+    return offsets.capacity() * sizeof(uint64_t) +
+           neighbors.capacity() * sizeof(uint64_t) +
+           weights.capacity() * sizeof(phi::dtype::float16) +
+           alias_probs.capacity() * sizeof(float) +
+           alias_index.capacity() * sizeof(uint32_t);
+  }
+
+ private:
+  void build_alias(size_t row,
+                   std::vector<uint32_t> *small,
+                   std::vector<uint32_t> *large);
+  bool alias_sample_k(size_t row,
+                      int k,
+                      SampleRandomBits *bits,
+                      std::vector<int> *res) const;
+  void weighted_sample_k(size_t row,
+                         int k,
+                         SampleRandomBits *bits,
+                         std::vector<int> *res) const;
+
+  std::vector<uint64_t> offsets;
+  std::vector<uint64_t> neighbors;
+  std::vector<phi::dtype::float16> weights;
+  // The alias table of edge offsets[i] + j: j is kept with probability
+  // alias_probs, otherwise alias_index is drawn.
+  std::vector<float> alias_probs;
+  std::vector<uint32_t> alias_index;
+  bool weighted_sample = false;
+};
+
+// A node of a frozen GraphShard, its edges are a row of the GraphCSR of the
+// shard.
+class CSRGraphNode : public Node {
+ public:
+  CSRGraphNode(uint64_t id, const GraphCSR *csr, size_t row)
+      : Node(id), csr(csr), row(row) {
+    is_weighted = csr->get_is_weighted();
+  }
+  virtual ~CSRGraphNode() {}
+  virtual void add_edge(uint64_t id UNUSED, float weight UNUSED);
+  virtual std::vector<int> sample_k(
+      int k, const std::shared_ptr<std::mt19937_64> rng) {
+    return csr->sample_k(row, k, rng);
+  }
+  virtual uint64_t get_neighbor_id(int idx) {
+    return csr->get_neighbor_id(row, idx);
+  }
+#ifdef PADDLE_WITH_CUDA
+  virtual half get_neighbor_weight(int idx) {
+    return (half)(csr->get_neighbor_weight(row, idx));
+  }
+#else
+  virtual float get_neighbor_weight(int idx) {
+    return csr->get_neighbor_weight(row, idx);
+  }
+#endif
+  virtual size_t get_neighbor_size() { return csr->get_degree(row); }
+  size_t get_row() const { return row; }
+
+ protected:
+  const GraphCSR *csr;
+  size_t row;
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,319 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "paddle/fluid/distributed/common/frequency_sketch.h"
+
+namespace paddle {
+namespace distributed {
+
+enum LRUResponse { ok = 0, blocked = 1, err = 2 };
+
+struct SampleCacheStat {
+  size_t hit = 0;
+  size_t miss = 0;
+  size_t insert = 0;
+  // Entries pushed out by more frequent ones.
+  size_t evict = 0;
+  // New entries not admitted, being less frequent than the entries they
+  // would push out.
+  size_t reject = 0;
+  // Entries dropped after ttl hits.
+  size_t expire = 0;
+  size_t size = 0;
+  size_t memory_size = 0;
+};
+
+// A cache of sampling results with W-TinyLFU replacement, sharded by the
+// task index of the caller.
+//
+// New entries enter a small LRU window. An entry leaving the window is only
+// admitted into the main cache when the FrequencySketch of the shard has
+// seen its key more often than the key it would push out, so hot keys are
+// not flushed by a burst of cold ones. The main cache is a segmented LRU:
+// a hit in the probation segment promotes the entry to the protected one.
+// Every entry serves ttl hits, then it is dropped and sampled again.
+//
+// The cache is bounded by entries and, when memory_limit is not 0, by the
+// bytes of the entries, the data size taken from V::actual_size. A shard is
+// only tried locked, a busy shard answers LRUResponse::blocked and the
+// caller samples without the cache, so no caller ever waits on it.
+template <typename K, typename V>
+class GraphSampleCache {
+ public:
+  GraphSampleCache(size_t shard_num,
+                   size_t size_limit,
+                   size_t ttl,
+                   size_t memory_limit = 0)
+      : ttl(std::max<size_t>(ttl, 1)) {
+    size_t shard_size = std::max<size_t>(size_limit / shard_num, 1);
+    size_t shard_memory = memory_limit / shard_num;
+    shards.reserve(shard_num);
+    for (size_t i = 0; i < shard_num; ++i) {
+      shards.emplace_back(new CacheShard(shard_size, shard_memory));
+    }
+  }
+
+  // Appends the hit keys with their data to res, in the order of keys.
+  LRUResponse query(size_t index,
+                    K *keys,
+                    size_t length,
+                    std::vector<std::pair<K, V>> &res) {  // NOLINT
+    CacheShard &shard = *shards[index];
+    std::unique_lock<std::mutex> lock(shard.mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+      return LRUResponse::blocked;
+    }
+    for (size_t i = 0; i < length; i++) {
+      shard.sketch.Increment(hasher(keys[i]));
+      auto iter = shard.key_map.find(keys[i]);
+      if (iter == shard.key_map.end()) {
+        shard.miss.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      shard.hit.fetch_add(1, std::memory_order_relaxed);
+      auto entry = iter->second;
+      res.emplace_back(keys[i], entry->data);
+      if (--entry->ttl == 0) {
+        shard.expire.fetch_add(1, std::memory_order_relaxed);
+        shard.erase(entry);
+      } else {
+        shard.touch(entry);
+      }
+    }
+    return LRUResponse::ok;
+  }
+
+  LRUResponse insert(size_t index, K *keys, V *data, size_t length) {
+    CacheShard &shard = *shards[index];
+    std::unique_lock<std::mutex> lock(shard.mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+      return LRUResponse::blocked;
+    }
+    for (size_t i = 0; i < length; i++) {
+      shard.insert.fetch_add(1, std::memory_order_relaxed);
+      auto iter = shard.key_map.find(keys[i]);
+      if (iter != shard.key_map.end()) {
+        auto entry = iter->second;
+        shard.charge(entry->segment, -static_cast<int64_t>(entry->charge));
+        entry->data = data[i];
+        entry->ttl = ttl;
+        entry->charge = ChargeOf(data[i]);
+        shard.charge(entry->segment, entry->charge);
+        shard.touch(entry);
+      } else {
+        shard.add(keys[i], data[i], ttl, ChargeOf(data[i]));
+      }
+      shard.evict_window(hasher);
+    }
+    return LRUResponse::ok;
+  }
+
+  SampleCacheStat get_stat() const {
+    SampleCacheStat stat;
+    for (auto &shard : shards) {
+      stat.hit += shard->hit.load(std::memory_order_relaxed);
+      stat.miss += shard->miss.load(std::memory_order_relaxed);
+      stat.insert += shard->insert.load(std::memory_order_relaxed);
+      stat.evict += shard->evict.load(std::memory_order_relaxed);
+      stat.reject += shard->reject.load(std::memory_order_relaxed);
+      stat.expire += shard->expire.load(std::memory_order_relaxed);
+      stat.size += shard->size.load(std::memory_order_relaxed);
+      stat.memory_size += shard->memory_size.load(std::memory_order_relaxed);
+    }
+    return stat;
+  }
+
+  size_t get_ttl() const { return ttl; }
+
+ private:
+  enum Segment { kWindow = 0, kProbation = 1, kProtected = 2 };
+
+  struct Entry {
+    Entry(const K &key, const V &data, size_t ttl, size_t charge)
+        : key(key), data(data), ttl(ttl), charge(charge) {}
+    K key;
+    V data;
+    size_t ttl;
+    size_t charge;
+    Segment segment = kWindow;
+  };
+  using EntryList = std::list<Entry>;
+  using EntryIter = typename EntryList::iterator;
+
+  // The bytes held by an entry, its data and its list and map nodes.
+  static size_t ChargeOf(const V &data) {
+    return data.actual_size + sizeof(Entry) + 2 * sizeof(void *) +
+           sizeof(std::pair<const K, EntryIter>) + 2 * sizeof(void *);
+  }
+
+  // The entries of a segment, least recently used first.
+  struct SegmentList {
+    EntryList entries;
+    size_t count = 0;
+    size_t bytes = 0;
+    size_t count_limit = 0;
+    size_t bytes_limit = 0;
+    bool over() const {
+      return count > count_limit || (bytes_limit != 0 && bytes > bytes_limit);
+    }
+  };
+
+  struct CacheShard {
+    // The window takes 1% of the shard and the protected segment 80% of the
+    // rest, as in the W-TinyLFU paper.
+    CacheShard(size_t size_limit, size_t memory_limit)
+        : sketch(size_limit) {
+      segments[kWindow].count_limit = std::max<size_t>(size_limit / 100, 1);
+      segments[kWindow].bytes_limit = memory_limit / 100;
+      size_t main_count =
+          std::max<size_t>(size_limit - segments[kWindow].count_limit, 1);
+      size_t main_bytes = memory_limit - segments[kWindow].bytes_limit;
+      segments[kProtected].count_limit = main_count * 4 / 5;
+      segments[kProtected].bytes_limit = main_bytes * 4 / 5;
+      main_count_limit = main_count;
+      main_bytes_limit = main_bytes;
+    }
+
+    void charge(Segment segment, int64_t bytes) {
+      segments[segment].bytes += bytes;
+      memory_size.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void add(const K &key, const V &data, size_t ttl, size_t bytes) {
+      auto &window = segments[kWindow];
+      window.entries.emplace_back(key, data, ttl, bytes);
+      key_map[key] = std::prev(window.entries.end());
+      window.count++;
+      charge(kWindow, bytes);
+      size.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void erase(EntryIter entry) {
+      auto &segment = segments[entry->segment];
+      segment.count--;
+      charge(entry->segment, -static_cast<int64_t>(entry->charge));
+      size.fetch_sub(1, std::memory_order_relaxed);
+      key_map.erase(entry->key);
+      segment.entries.erase(entry);
+    }
+
+    void move(EntryIter entry, Segment to) {
+      auto &from = segments[entry->segment];
+      from.count--;
+      from.bytes -= entry->charge;
+      segments[to].count++;
+      segments[to].bytes += entry->charge;
+      segments[to].entries.splice(
+          segments[to].entries.end(), from.entries, entry);
+      entry->segment = to;
+    }
+
+    // A hit moves the entry to the most recently used end of its segment,
+    // and promotes a probation entry to protected.
+    void touch(EntryIter entry) {
+      if (entry->segment == kProbation) {
+        move(entry, kProtected);
+        auto &protect = segments[kProtected];
+        while (protect.over() && protect.count > 1) {
+          move(protect.entries.begin(), kProbation);
+        }
+      } else {
+        move(entry, entry->segment);
+      }
+    }
+
+    bool main_over() const {
+      size_t count = segments[kProbation].count + segments[kProtected].count;
+      size_t bytes = segments[kProbation].bytes + segments[kProtected].bytes;
+      return count > main_count_limit ||
+             (main_bytes_limit != 0 && bytes > main_bytes_limit);
+    }
+
+    // The least recently used entry of the main cache other than the
+    // candidate, or the candidate when it is alone.
+    EntryIter victim(EntryIter candidate) {
+      auto &probation = segments[kProbation];
+      if (probation.entries.begin() != candidate) {
+        return probation.entries.begin();
+      }
+      if (segments[kProtected].count > 0) {
+        return segments[kProtected].entries.begin();
+      }
+      return candidate;
+    }
+
+    // Moves the entries overflowing the window into probation, each one
+    // only if it is more frequent than the victims it pushes out.
+    template <typename Hash>
+    void evict_window(const Hash &hasher) {
+      auto &window = segments[kWindow];
+      while (window.over() && window.count > 0) {
+        EntryIter candidate = window.entries.begin();
+        move(candidate, kProbation);
+        int frequency = sketch.Estimate(hasher(candidate->key));
+        while (main_over()) {
+          EntryIter victim_entry = victim(candidate);
+          if (victim_entry != candidate &&
+              frequency > sketch.Estimate(hasher(victim_entry->key))) {
+            evict.fetch_add(1, std::memory_order_relaxed);
+            erase(victim_entry);
+          } else {
+            reject.fetch_add(1, std::memory_order_relaxed);
+            erase(candidate);
+            break;
+          }
+        }
+      }
+      // Updated entries may have grown the main cache.
+      while (main_over()) {
+        evict.fetch_add(1, std::memory_order_relaxed);
+        erase(victim(segments[kProbation].entries.end()));
+      }
+    }
+
+    std::mutex mutex;
+    std::unordered_map<K, EntryIter> key_map;
+    SegmentList segments[3];
+    FrequencySketch sketch;
+    size_t main_count_limit;
+    size_t main_bytes_limit;
+
+    std::atomic<size_t> hit{0};
+    std::atomic<size_t> miss{0};
+    std::atomic<size_t> insert{0};
+    std::atomic<size_t> evict{0};
+    std::atomic<size_t> reject{0};
+    std::atomic<size_t> expire{0};
+    std::atomic<size_t> size{0};
+    std::atomic<size_t> memory_size{0};
+  };
+
+  std::hash<K> hasher;
+  size_t ttl;
+  std::vector<std::unique_ptr<CacheShard>> shards;
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,459 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/memory_concurrent_sparse_table.h"
+
+#include <omp.h>
+
+#include <algorithm>
+
+#include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/distributed/common/cost_timer.h"
+#include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
+#include "paddle/fluid/framework/io/fs.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/utils/string/string_helper.h"
+
+PD_DECLARE_bool(pserver_create_value_when_push);
+PD_DECLARE_bool(pserver_enable_create_feasign_randomly);
+PD_DECLARE_int32(pserver_table_save_max_retry);
+
+namespace paddle::distributed {
+
+// Keys of one task of Pull/Push, smaller requests run in the caller.
+static const size_t kConcurrentTableTaskKeys = 4096;
+
+int32_t MemoryConcurrentSparseTable::Initialize() {
+  auto &profiler = CostProfiler::instance();
+  profiler.register_profiler("pserver_sparse_update_all");
+  profiler.register_profiler("pserver_sparse_select_all");
+
+  _sparse_table_shard_num = static_cast<int>(_config.shard_num());
+  _avg_local_shard_num = MemorySparseTable::sparse_local_shard_num(
+      _sparse_table_shard_num, _shard_num);
+  _real_local_shard_num = _avg_local_shard_num;
+  if (static_cast<int>(_real_local_shard_num * (_shard_idx + 1)) >
+      _sparse_table_shard_num) {
+    _real_local_shard_num =
+        _sparse_table_shard_num - _real_local_shard_num * _shard_idx;
+    _real_local_shard_num =
+        _real_local_shard_num < 0 ? 0 : _real_local_shard_num;
+  }
+  _value_col = _value_accessor->GetAccessorInfo().size / sizeof(float);
+  _mf_value_col = _value_accessor->GetAccessorInfo().mf_size / sizeof(float);
+  _local_shards.reset(new shard_type[_real_local_shard_num]);
+  _task_pool.reset(new ::ThreadPool(_task_pool_size));
+  VLOG(0) << "initalize MemoryConcurrentSparseTable succ, "
+          << "_real_local_shard_num: " << _real_local_shard_num;
+  return 0;
+}
+
+void MemoryConcurrentSparseTable::ParallelFor(
+    size_t num, const std::function<void(size_t, size_t)> &func) {
+  if (num <= kConcurrentTableTaskKeys) {
+    func(0, num);
+    return;
+  }
+  size_t task_num = std::min<size_t>(
+      _task_pool_size,
+      (num + kConcurrentTableTaskKeys - 1) / kConcurrentTableTaskKeys);
+  size_t task_keys = (num + task_num - 1) / task_num;
+  std::vector<std::future<void>> tasks;
+  tasks.reserve(task_num);
+  for (size_t begin = 0; begin < num; begin += task_keys) {
+    size_t end = std::min(num, begin + task_keys);
+    tasks.push_back(
+        _task_pool->enqueue([&func, begin, end]() { func(begin, end); }));
+  }
+  for (auto &task : tasks) {
+    task.wait();
+  }
+}
+
+int32_t MemoryConcurrentSparseTable::Load(const std::string &path,
+                                          const std::string &param) {
+  std::string table_path = TableDir(path);
+  auto file_list = _afs_client.list(table_path);
+  std::sort(file_list.begin(), file_list.end());
+
+  int load_param = atoi(param.c_str());
+  size_t expect_shard_num = _sparse_table_shard_num;
+  if (file_list.size() != expect_shard_num) {
+    LOG(WARNING) << "MemoryConcurrentSparseTable file_size:"
+                 << file_list.size()
+                 << " not equal to expect_shard_num:" << expect_shard_num;
+    return -1;
+  }
+  if (file_list.empty()) {
+    LOG(WARNING) << "MemoryConcurrentSparseTable load file is empty, path:"
+                 << path;
+    return -1;
+  }
+
+  size_t file_start_idx = _shard_idx * _avg_local_shard_num;
+  if (file_start_idx >= file_list.size()) {
+    return 0;
+  }
+
+  int thread_num = _real_local_shard_num < 15 ? _real_local_shard_num : 15;
+  omp_set_num_threads(thread_num);
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    FsChannelConfig channel_config = {};
+    channel_config.path = file_list[file_start_idx + i];
+    channel_config.converter = _value_accessor->Converter(load_param).converter;
+    channel_config.deconverter =
+        _value_accessor->Converter(load_param).deconverter;
+
+    std::vector<float> data_buffer(_value_col);
+    bool is_read_failed = false;
+    int retry_num = 0;
+    int err_no = 0;
+    do {
+      is_read_failed = false;
+      err_no = 0;
+      std::string line_data;
+      auto read_channel = _afs_client.open_r(channel_config, 0, &err_no);
+      char *end = nullptr;
+      auto &shard = _local_shards[i];
+      try {
+        while (read_channel->read_line(line_data) == 0 &&
+               line_data.size() > 1) {
+          uint64_t key = std::strtoul(line_data.data(), &end, 10);
+          int parse_size =
+              _value_accessor->ParseFromString(++end, data_buffer.data());
+          std::lock_guard<shard_type::mutex_type> guard(shard.Mutex(key));
+          size_t value_size = 0;
+          if (shard.Find(key, &value_size) == nullptr) {
+            shard.EmplaceLocked(
+                key, data_buffer.data(), parse_size, &value_size);
+          } else {
+            shard.ResizeLocked(key, data_buffer.data(), parse_size);
+          }
+        }
+        read_channel->close();
+        if (err_no == -1) {
+          ++retry_num;
+          is_read_failed = true;
+          LOG(ERROR) << "MemoryConcurrentSparseTable load failed after read, "
+                     << "retry it! path:" << channel_config.path
+                     << " , retry_num=" << retry_num;
+        }
+      } catch (...) {
+        ++retry_num;
+        is_read_failed = true;
+        LOG(ERROR) << "MemoryConcurrentSparseTable load failed, retry it! "
+                   << "path:" << channel_config.path
+                   << " , retry_num=" << retry_num;
+      }
+      if (retry_num > FLAGS_pserver_table_save_max_retry) {
+        LOG(ERROR) << "MemoryConcurrentSparseTable load failed reach max "
+                      "limit!";
+        exit(-1);
+      }
+    } while (is_read_failed);
+  }
+  LOG(INFO) << "MemoryConcurrentSparseTable load success, path from "
+            << file_list[file_start_idx] << " to "
+            << file_list[file_start_idx + _real_local_shard_num - 1];
+  return 0;
+}
+
+int32_t MemoryConcurrentSparseTable::Save(const std::string &dirname,
+                                          const std::string &param) {
+  if (_real_local_shard_num == 0) {
+    return 0;
+  }
+  VLOG(0) << "MemoryConcurrentSparseTable::save dirname: " << dirname;
+  int save_param =
+      atoi(param.c_str());  // checkpoint:0  xbox delta:1  xbox base:2
+  PADDLE_ENFORCE_NE(save_param,
+                    5,
+                    common::errors::Unimplemented(
+                        "MemoryConcurrentSparseTable does not support the "
+                        "patch model, use MemorySparseTable instead."));
+
+  std::string table_path = TableDir(dirname);
+  _afs_client.remove(::paddle::string::format_string(
+      "%s/part-%03d-*", table_path.c_str(), _shard_idx));
+  size_t file_start_idx = _avg_local_shard_num * _shard_idx;
+
+  int thread_num = _real_local_shard_num < 20 ? _real_local_shard_num : 20;
+  omp_set_num_threads(thread_num);
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    FsChannelConfig channel_config = {};
+    if (_config.compress_in_save() && (save_param == 0 || save_param == 3)) {
+      channel_config.path =
+          ::paddle::string::format_string("%s/part-%03d-%05d.gz",
+                                          table_path.c_str(),
+                                          _shard_idx,
+                                          file_start_idx + i);
+    } else {
+      channel_config.path = ::paddle::string::format_string("%s/part-%03d-%05d",
+                                                            table_path.c_str(),
+                                                            _shard_idx,
+                                                            file_start_idx + i);
+    }
+    channel_config.converter = _value_accessor->Converter(save_param).converter;
+    channel_config.deconverter =
+        _value_accessor->Converter(save_param).deconverter;
+    bool is_write_failed = false;
+    int feasign_size = 0;
+    int retry_num = 0;
+    int err_no = 0;
+    auto &shard = _local_shards[i];
+    do {
+      err_no = 0;
+      feasign_size = 0;
+      is_write_failed = false;
+      auto write_channel =
+          _afs_client.open_w(channel_config, 1024 * 1024 * 40, &err_no);
+      // the values are streamed in the order of their pages
+      shard.ForEach([&](const uint64_t &key, float *data, size_t size) {
+        if (is_write_failed || !_value_accessor->Save(data, save_param)) {
+          return;
+        }
+        std::string format_value = _value_accessor->ParseToString(data, size);
+        if (0 != write_channel->write_line(::paddle::string::format_string(
+                     "%lu %s", key, format_value.c_str()))) {
+          ++retry_num;
+          is_write_failed = true;
+          LOG(ERROR) << "MemoryConcurrentSparseTable save prefix failed, "
+                     << "retry it! path:" << channel_config.path
+                     << " , retry_num=" << retry_num;
+          return;
+        }
+        ++feasign_size;
+      });
+      write_channel->close();
+      if (err_no == -1) {
+        ++retry_num;
+        is_write_failed = true;
+        LOG(ERROR) << "MemoryConcurrentSparseTable save prefix failed after "
+                   << "write, retry it! path:" << channel_config.path
+                   << " , retry_num=" << retry_num;
+      }
+      if (is_write_failed) {
+        _afs_client.remove(channel_config.path);
+      }
+      if (retry_num > FLAGS_pserver_table_save_max_retry) {
+        LOG(ERROR) << "MemoryConcurrentSparseTable save prefix failed reach "
+                      "max limit!";
+        exit(-1);
+      }
+    } while (is_write_failed);
+    shard.ForEach([&](const uint64_t &key, float *data, size_t size) {
+      _value_accessor->UpdateStatAfterSave(data, save_param);
+    });
+    LOG(INFO) << "MemoryConcurrentSparseTable save prefix success, path: "
+              << channel_config.path << " feasign_size: " << feasign_size;
+  }
+  return 0;
+}
+
+int64_t MemoryConcurrentSparseTable::LocalSize() {
+  int64_t local_size = 0;
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    local_size += _local_shards[i].size();
+  }
+  return local_size;
+}
+
+int64_t MemoryConcurrentSparseTable::LocalMFSize() {
+  int64_t mf_size = 0;
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    _local_shards[i].ForEach(
+        [&](const uint64_t &key, float *data, size_t size) {
+          if (_value_accessor->HasMF(size)) {
+            ++mf_size;
+          }
+        });
+  }
+  return mf_size;
+}
+
+std::pair<int64_t, int64_t> MemoryConcurrentSparseTable::PrintTableStat() {
+  int64_t feasign_size = LocalSize();
+  int64_t mf_size = LocalMFSize();
+  return {feasign_size, mf_size};
+}
+
+int32_t MemoryConcurrentSparseTable::Pull(TableContext &context) {
+  PADDLE_ENFORCE_EQ(
+      context.value_type,
+      Sparse,
+      common::errors::InvalidArgument(
+          "The 'value_type' in context must be 'Sparse', but received %d.",
+          context.value_type));
+  PADDLE_ENFORCE_EQ(context.use_ptr,
+                    false,
+                    common::errors::Unimplemented(
+                        "MemoryConcurrentSparseTable does not support pulling "
+                        "value pointers, use MemorySparseTable instead."));
+  float *pull_values = context.pull_context.values;
+  const PullSparseValue &pull_value = context.pull_context.pull_value;
+  return PullSparse(pull_values, pull_value);
+}
+
+int32_t MemoryConcurrentSparseTable::Push(TableContext &context) {
+  PADDLE_ENFORCE_EQ(
+      context.value_type,
+      Sparse,
+      common::errors::InvalidArgument(
+          "The 'value_type' in context must be 'Sparse', but received %d.",
+          context.value_type));
+  if (!context.use_ptr) {
+    return PushSparse(
+        context.push_context.keys, context.push_context.values, context.num);
+  } else {
+    return PushSparse(context.push_context.keys,
+                      context.push_context.ptr_values,
+                      context.num);
+  }
+}
+
+int32_t MemoryConcurrentSparseTable::PullSparse(
+    float *pull_values, const PullSparseValue &pull_value) {
+  CostTimer timer("pserver_sparse_select_all");
+  const size_t value_size =
+      _value_accessor->GetAccessorInfo().size / sizeof(float);
+  const size_t mf_value_size =
+      _value_accessor->GetAccessorInfo().mf_size / sizeof(float);
+  const size_t select_value_size =
+      _value_accessor->GetAccessorInfo().select_size / sizeof(float);
+
+  ParallelFor(pull_value.numel_, [&](size_t begin, size_t end) {
+    std::vector<float> data_buffer(value_size);
+    float *data_buffer_ptr = data_buffer.data();
+    for (size_t i = begin; i < end; ++i) {
+      uint64_t key = pull_value.feasigns_[i];
+      auto &local_shard = _local_shards[LocalShardId(key)];
+      size_t data_size = 0;
+      float *data = local_shard.Find(key, &data_size);
+      if (data == nullptr) {
+        data_size = value_size - mf_value_size;
+        if (FLAGS_pserver_create_value_when_push) {
+          memset(data_buffer_ptr, 0, sizeof(float) * data_size);
+        } else {
+          _value_accessor->Create(&data_buffer_ptr, 1);
+          // another pull may have created it first
+          data = local_shard.Emplace(
+              key, data_buffer_ptr, data_size, &data_size);
+        }
+      }
+      if (data != nullptr) {
+        memcpy(data_buffer_ptr, data, data_size * sizeof(float));
+      }
+      for (size_t mf_idx = data_size; mf_idx < value_size; ++mf_idx) {
+        data_buffer[mf_idx] = 0.0;
+      }
+      float *select_data = pull_values + select_value_size * i;
+      _value_accessor->Select(
+          &select_data, (const float **)&data_buffer_ptr, 1);
+    }
+  });
+  return 0;
+}
+
+void MemoryConcurrentSparseTable::PushOne(uint64_t key,
+                                          const float *update_data,
+                                          float *buffer) {
+  const size_t value_col = _value_col;
+  const size_t mf_value_col = _mf_value_col;
+  auto &local_shard = _local_shards[LocalShardId(key)];
+
+  std::lock_guard<shard_type::mutex_type> guard(local_shard.Mutex(key));
+  size_t value_size = 0;
+  float *value_data = local_shard.Find(key, &value_size);
+  if (value_data == nullptr) {
+    if (FLAGS_pserver_enable_create_feasign_randomly &&
+        !_value_accessor->CreateValue(1, update_data)) {
+      return;
+    }
+    _value_accessor->Create(&buffer, 1);
+    value_data = local_shard.EmplaceLocked(
+        key, buffer, value_col - mf_value_col, &value_size);
+  }
+
+  if (value_size == value_col) {
+    _value_accessor->Update(&value_data, &update_data, 1);
+    return;
+  }
+  // update a copy, the embedx is created when the value is extended
+  memcpy(buffer, value_data, value_size * sizeof(float));
+  _value_accessor->Update(&buffer, &update_data, 1);
+  if (_value_accessor->NeedExtendMF(buffer)) {
+    std::vector<float> extended(value_col);
+    float *extended_ptr = extended.data();
+    _value_accessor->Create(&extended_ptr, 1);
+    memcpy(extended_ptr, buffer, value_size * sizeof(float));
+    local_shard.ResizeLocked(key, extended_ptr, value_col);
+  } else {
+    memcpy(value_data, buffer, value_size * sizeof(float));
+  }
+}
+
+int32_t MemoryConcurrentSparseTable::PushSparse(const uint64_t *keys,
+                                                const float *values,
+                                                size_t num) {
+  CostTimer timer("pserver_sparse_update_all");
+  const size_t update_value_col =
+      _value_accessor->GetAccessorInfo().update_size / sizeof(float);
+  ParallelFor(num, [&](size_t begin, size_t end) {
+    std::vector<float> data_buffer(_value_col);
+    for (size_t i = begin; i < end; ++i) {
+      PushOne(keys[i], values + i * update_value_col, data_buffer.data());
+    }
+  });
+  return 0;
+}
+
+int32_t MemoryConcurrentSparseTable::PushSparse(const uint64_t *keys,
+                                                const float **values,
+                                                size_t num) {
+  ParallelFor(num, [&](size_t begin, size_t end) {
+    std::vector<float> data_buffer(_value_col);
+    for (size_t i = begin; i < end; ++i) {
+      PushOne(keys[i], values[i], data_buffer.data());
+    }
+  });
+  return 0;
+}
+
+int32_t MemoryConcurrentSparseTable::Shrink(const std::string &param) {
+  VLOG(0) << "MemoryConcurrentSparseTable::Shrink";
+  std::atomic<uint32_t> shrink_size_all{0};
+  int thread_num = _real_local_shard_num;
+  omp_set_num_threads(thread_num);
+#pragma omp parallel for schedule(dynamic)
+  for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
+    shrink_size_all += _local_shards[shard_id].EraseIf(
+        [this](const uint64_t &key, float *data, size_t size) {
+          return _value_accessor->Shrink(data);
+        });
+  }
+  VLOG(0) << "MemoryConcurrentSparseTable::Shrink success, shrink size:"
+          << shrink_size_all;
+  return 0;
+}
+
+void MemoryConcurrentSparseTable::Clear() {
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    _local_shards[i].Clear();
+  }
+}
+
+}  // namespace paddle::distributed
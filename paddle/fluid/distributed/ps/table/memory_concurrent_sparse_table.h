@@ -0,0 +1,95 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <ThreadPool.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "paddle/fluid/distributed/ps/table/accessor.h"
+#include "paddle/fluid/distributed/ps/table/common_table.h"
+#include "paddle/fluid/distributed/ps/table/depends/concurrent_feature_value.h"
+
+namespace paddle {
+namespace distributed {
+
+// A MemorySparseTable on ConcurrentSparseTableShard, selected with
+// table_class: "MemoryConcurrentSparseTable" in TableParameter.
+//
+// Pulls look keys up without locking and pushes only lock the stripe of
+// every key, so requests are split over a shared thread pool instead of being
+// funnelled through one thread per shard. Values are kept in fixed stride
+// pages, which Shrink compacts and Save streams in order. The keys are
+// sharded and saved like MemorySparseTable, so the checkpoints of both tables
+// can be loaded by the other. Patch model, cache model and
+// PullSparsePtr, which hands out FixedFeatureValue pointers, are not
+// supported.
+class MemoryConcurrentSparseTable : public Table {
+ public:
+  typedef ConcurrentSparseTableShard<uint64_t> shard_type;
+  MemoryConcurrentSparseTable() {}
+  virtual ~MemoryConcurrentSparseTable() {}
+
+  int32_t Pull(TableContext& context) override;
+  int32_t Push(TableContext& context) override;
+
+  int32_t Initialize() override;
+  int32_t InitializeShard() override { return 0; }
+
+  int32_t Load(const std::string& path, const std::string& param) override;
+  int32_t Save(const std::string& path, const std::string& param) override;
+
+  int64_t LocalSize();
+  int64_t LocalMFSize();
+  std::pair<int64_t, int64_t> PrintTableStat() override;
+
+  int32_t PullSparse(float* values, const PullSparseValue& pull_value);
+  int32_t PushSparse(const uint64_t* keys, const float* values, size_t num);
+  int32_t PushSparse(const uint64_t* keys, const float** values, size_t num);
+
+  int32_t Flush() override { return 0; }
+  int32_t Shrink(const std::string& param) override;
+  void Clear() override;
+
+  // The shards are not SparseTableShard, which the callers of GetShard
+  // expect, so none is handed out; the cache model is not supported.
+  void* GetShard(size_t shard_idx UNUSED) override { return nullptr; }
+
+ protected:
+  size_t LocalShardId(uint64_t key) const {
+    return (key % _sparse_table_shard_num) % _avg_local_shard_num;
+  }
+  // Run func(begin, end) over [0, num) in chunks on the task pool.
+  void ParallelFor(size_t num, const std::function<void(size_t, size_t)>& func);
+  // Push one key, buffer holds a value of _value_col floats.
+  void PushOne(uint64_t key, const float* update_data, float* buffer);
+
+  int _task_pool_size = 24;
+  int _avg_local_shard_num;
+  int _real_local_shard_num;
+  int _sparse_table_shard_num;
+  // floats of a value with and without embedx
+  size_t _value_col;
+  size_t _mf_value_col;
+  std::shared_ptr<::ThreadPool> _task_pool;
+  std::unique_ptr<shard_type[]> _local_shards;
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -70,6 +70,7 @@ int32_t MemorySparseTable::InitializeValue() {
   _task_pool_size = _sparse_table_shard_num;
 #endif
   _use_gpu_graph = _config.use_gpu_graph();
+  _enable_delta_checkpoint = _config.enable_delta_checkpoint();
   VLOG(1) << "memory sparse table _avg_local_shard_num: "
           << _avg_local_shard_num
           << " _real_local_shard_num: " << _real_local_shard_num
@@ -77,6 +78,8 @@ int32_t MemorySparseTable::InitializeValue() {
           << " _use_gpu_graph:" << _use_gpu_graph;
 
   _local_shards.reset(new shard_type[_real_local_shard_num]);
+  _delta_states.clear();
+  _delta_states.resize(_real_local_shard_num);
 
   if (_config.enable_revert()) {
     // calculate merged shard number based on config param;
@@ -146,6 +149,11 @@ int32_t MemorySparseTable::Load(const std::string &path,
     return LoadPatch(file_list, load_param);
   }
 
+  if (IsSparseCheckpoint(file_list) ||
+      IsSparseCheckpoint(file_list, SPARSE_CHECKPOINT_DELTA_SUFFIX)) {
+    return LoadBinaryCheckpoint(file_list);
+  }
+
   size_t file_start_idx = _shard_idx * _avg_local_shard_num;
 
   if (file_start_idx >= file_list.size()) {
@@ -211,6 +219,7 @@ int32_t MemorySparseTable::Load(const std::string &path,
         exit(-1);
       }
     } while (is_read_failed);
+    ResetDeltaState(i);
   }
   LOG(INFO) << "MemorySparseTable load success, path from "
             << file_list[file_start_idx] << " to "
@@ -218,6 +227,229 @@ int32_t MemorySparseTable::Load(const std::string &path,
   return 0;
 }
 
+int32_t MemorySparseTable::LoadBinaryCheckpoint(
+    const std::vector<std::string> &file_list) {
+  size_t file_start_idx = _shard_idx * _avg_local_shard_num;
+  if (file_start_idx >= file_list.size()) {
+    return 0;
+  }
+#ifdef PADDLE_WITH_HETERPS
+  int thread_num = _real_local_shard_num;
+#else
+  int thread_num = _real_local_shard_num < 15 ? _real_local_shard_num : 15;
+#endif
+  std::atomic<uint64_t> feasign_size_all{0};
+  omp_set_num_threads(thread_num);
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    const std::string &path = file_list[file_start_idx + i];
+    SparseCheckpointReader reader;
+    int retry_num = 0;
+    while (true) {
+      int ret = 0;
+      if (::paddle::framework::fs_select_internal(path) == 0) {
+        // local files are mapped, and copied to the shard without parsing
+        ret = reader.Map(path);
+      } else {
+        FsChannelConfig channel_config = {};
+        channel_config.path = path;
+        int err_no = 0;
+        auto read_channel = _afs_client.open_r(channel_config, 0, &err_no);
+        ret = reader.Read(read_channel.get());
+        read_channel->close();
+        if (err_no == -1) {
+          ret = -1;
+        }
+      }
+      if (ret == 0 && reader.Verify()) {
+        break;
+      }
+      ++retry_num;
+      LOG(ERROR) << "MemorySparseTable load binary checkpoint failed, retry "
+                 << "it! path:" << path << " , retry_num=" << retry_num;
+      if (retry_num > FLAGS_pserver_table_save_max_retry) {
+        LOG(ERROR) << "MemorySparseTable load failed reach max limit!";
+        exit(-1);
+      }
+    }
+    LoadShardCheckpoint(i, reader);
+    ResetDeltaState(i);
+    feasign_size_all += reader.key_num();
+  }
+  LOG(INFO) << "MemorySparseTable load binary checkpoint success, feasign "
+            << "size:" << feasign_size_all << ", path from "
+            << file_list[file_start_idx] << " to "
+            << file_list[file_start_idx + _real_local_shard_num - 1];
+  return 0;
+}
+
+int32_t MemorySparseTable::LoadShardCheckpoint(
+    int shard_id, const SparseCheckpointReader &reader) {
+  auto &shard = _local_shards[shard_id];
+  for (size_t i = 0; i < reader.key_num(); ++i) {
+    // erased by the delta
+    if (reader.value_size(i) == 0) {
+      shard.erase(reader.key(i));
+      continue;
+    }
+    auto &value = shard[reader.key(i)];
+    value.resize(reader.value_size(i));
+    memcpy(value.data(), reader.value(i), value.size() * sizeof(float));
+  }
+  return 0;
+}
+
+int32_t MemorySparseTable::SaveBinaryCheckpoint(const std::string &dirname,
+                                                int save_param) {
+  std::string table_path = TableDir(dirname);
+  _afs_client.remove(::paddle::string::format_string(
+      "%s/part-%03d-*", table_path.c_str(), _shard_idx));
+  std::atomic<uint64_t> feasign_size_all{0};
+  size_t file_start_idx = _avg_local_shard_num * _shard_idx;
+  bool is_delta = save_param == 6;
+
+#ifdef PADDLE_WITH_HETERPS
+  int thread_num = _real_local_shard_num;
+#else
+  int thread_num = _real_local_shard_num < 20 ? _real_local_shard_num : 20;
+#endif
+  omp_set_num_threads(thread_num);
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    // written without converter, the values are kept as they are
+    FsChannelConfig channel_config = {};
+    channel_config.path =
+        ::paddle::string::format_string("%s/part-%03d-%05d",
+                                        table_path.c_str(),
+                                        _shard_idx,
+                                        file_start_idx + i) +
+        (is_delta ? SPARSE_CHECKPOINT_DELTA_SUFFIX : SPARSE_CHECKPOINT_SUFFIX);
+    bool is_write_failed = false;
+    size_t feasign_size = 0;
+    int retry_num = 0;
+    do {
+      int err_no = 0;
+      auto write_channel =
+          _afs_client.open_w(channel_config, 1024 * 1024 * 40, &err_no);
+      SparseCheckpointWriter writer(write_channel.get());
+      int ret = writer.WriteHeader();
+      if (ret == 0) {
+        ret = is_delta ? SaveShardDelta(i, &writer)
+                       : SaveShardCheckpoint(i, save_param, &writer);
+      }
+      is_write_failed = ret != 0 || writer.Finish() != 0;
+      feasign_size = writer.key_num();
+      write_channel->close();
+      if (err_no == -1) {
+        is_write_failed = true;
+      }
+      if (is_write_failed) {
+        ++retry_num;
+        LOG(ERROR) << "MemorySparseTable save binary checkpoint failed, "
+                   << "retry it! path:" << channel_config.path
+                   << " , retry_num=" << retry_num;
+        _afs_client.remove(channel_config.path);
+      }
+      if (retry_num > FLAGS_pserver_table_save_max_retry) {
+        LOG(ERROR) << "MemorySparseTable save prefix failed reach max limit!";
+        exit(-1);
+      }
+    } while (is_write_failed);
+    feasign_size_all += feasign_size;
+    // the next delta starts from here
+    ResetDeltaState(i);
+    if (!is_delta) {
+      UpdateShardStatAfterSave(i, save_param);
+    }
+    LOG(INFO) << "MemorySparseTable save binary checkpoint success, path: "
+              << channel_config.path << " feasign_size: " << feasign_size;
+  }
+  LOG(INFO) << "MemorySparseTable save binary checkpoint, feasign size:"
+            << feasign_size_all;
+  return 0;
+}
+
+int32_t MemorySparseTable::SaveShardCheckpoint(int shard_id,
+                                               int save_param,
+                                               SparseCheckpointWriter *writer) {
+  auto &shard = _local_shards[shard_id];
+  for (auto it = shard.begin(); it != shard.end(); ++it) {
+    if (_value_accessor->Save(it.value().data(), save_param) &&
+        writer->Append(it.key(), it.value().data(), it.value().size()) != 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int32_t MemorySparseTable::SaveShardDelta(int shard_id,
+                                          SparseCheckpointWriter *writer) {
+  PADDLE_ENFORCE_EQ(_enable_delta_checkpoint,
+                    true,
+                    common::errors::PreconditionNotMet(
+                        "The delta checkpoint of table %d needs "
+                        "enable_delta_checkpoint in its TableParameter.",
+                        _config.table_id()));
+  auto &shard = _local_shards[shard_id];
+  auto &state = _delta_states[shard_id];
+  if (state.all_dirty) {
+    for (auto it = shard.begin(); it != shard.end(); ++it) {
+      int ret =
+          writer->Append(it.key(), it.value().data(), it.value().size());
+      if (ret != 0) {
+        return -1;
+      }
+    }
+  } else {
+    for (uint64_t key : state.dirty) {
+      auto it = shard.find(key);
+      if (it != shard.end() &&
+          writer->Append(key, it.value().data(), it.value().size()) != 0) {
+        return -1;
+      }
+    }
+  }
+  // the keys erased, and not created again
+  for (uint64_t key : state.deleted) {
+    if (shard.find(key) == shard.end() &&
+        writer->Append(key, nullptr, 0) != 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+void MemorySparseTable::ResetDeltaState(int shard_id) {
+  if (!_enable_delta_checkpoint) {
+    return;
+  }
+  auto &state = _delta_states[shard_id];
+  state.dirty.clear();
+  state.deleted.clear();
+  state.all_dirty = false;
+}
+
+void MemorySparseTable::UpdateShardStatAfterSave(int shard_id,
+                                                 int save_param) {
+  auto &shard = _local_shards[shard_id];
+  if (!_enable_delta_checkpoint) {
+    for (auto it = shard.begin(); it != shard.end(); ++it) {
+      _value_accessor->UpdateStatAfterSave(it.value().data(), save_param);
+    }
+    return;
+  }
+  std::vector<float> origin;
+  for (auto it = shard.begin(); it != shard.end(); ++it) {
+    float *value = it.value().data();
+    size_t size = it.value().size();
+    origin.assign(value, value + size);
+    _value_accessor->UpdateStatAfterSave(value, save_param);
+    if (memcmp(origin.data(), value, size * sizeof(float)) != 0) {
+      MarkDirty(shard_id, it.key());
+    }
+  }
+}
+
 int32_t MemorySparseTable::LoadPatch(const std::vector<std::string> &file_list,
                                      int load_param) {
   if (!_config.enable_revert()) {
@@ -357,6 +589,11 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
     return 0;
   }
 
+  // delta checkpoint, the values changed since the last checkpoint
+  if (save_param == 6 || (_config.binary_checkpoint() && save_param == 0)) {
+    return SaveBinaryCheckpoint(dirname, save_param);
+  }
+
   // cache model
   int64_t tk_size = LocalSize() * _config.sparse_table_cache_rate();
   TopkCalculator tk(_real_local_shard_num, tk_size);
@@ -400,9 +637,7 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
 #if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
     // for incremental training, batch_model increase unseenday before save
     if (_use_gpu_graph && save_param == 3) {
-      for (auto it = shard.begin(); it != shard.end(); ++it) {
-        _value_accessor->UpdateStatAfterSave(it.value().data(), save_param);
-      }
+      UpdateShardStatAfterSave(i, save_param);
     }
 #endif
     do {
@@ -451,14 +686,11 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
       }
     } while (is_write_failed);
     feasign_size_all += feasign_size;
-    if (!_use_gpu_graph) {
-      for (auto it = shard.begin(); it != shard.end(); ++it) {
-        _value_accessor->UpdateStatAfterSave(it.value().data(), save_param);
-      }
-    } else if (save_param != 3) {
-      for (auto it = shard.begin(); it != shard.end(); ++it) {
-        _value_accessor->UpdateStatAfterSave(it.value().data(), save_param);
-      }
+    if (save_param == 0) {
+      ResetDeltaState(i);
+    }
+    if (!_use_gpu_graph || save_param != 3) {
+      UpdateShardStatAfterSave(i, save_param);
     }
     LOG(INFO) << "MemorySparseTable save prefix success, path: "
               << channel_config.path << " feasign_size: " << feasign_size;
@@ -805,6 +1037,8 @@ int64_t MemorySparseTable::CacheShuffle(
     for (auto table_ptr : table_ptrs) {
       auto value_accessor = table_ptr->GetValueAccessor();
       shard_type *shard_ptr = static_cast<shard_type *>(table_ptr->GetShard(i));
+      // Tables of other shard types hand out none.
+      if (shard_ptr == nullptr) continue;
 
       for (auto it = shard_ptr->begin(); it != shard_ptr->end(); ++it) {
         if (value_accessor->SaveCache(
@@ -1049,6 +1283,7 @@ int32_t MemorySparseTable::PullSparse(float *pull_values,
                     _value_accessor->Create(&data_buffer_ptr, 1);
                     memcpy(
                         data_ptr, data_buffer_ptr, data_size * sizeof(float));
+                    MarkDirty(shard_id, key);
                   }
                 } else {
                   data_size = itr.value().size();
@@ -1122,6 +1357,8 @@ int32_t MemorySparseTable::PullSparsePtr(int shard_id,  // fake num
                 } else {
                   ret = itr.value_ptr();
                 }
+                // updated by the caller through the pointer
+                MarkDirty(shard_id, key);
                 int pull_data_idx = item.second;
                 pull_values[pull_data_idx] = reinterpret_cast<char *>(ret);
               }
@@ -1167,6 +1404,12 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
           auto &local_shard_new = _local_shards_new[shard_id];
           float data_buffer[value_col];  // NOLINT
           float *data_buffer_ptr = data_buffer;
+          // the values of full size are updated in place in one batch, the
+          // later pushes of a key are always in the batch after its earlier
+          // pushes, as values only grow
+          std::vector<uint64_t> batch_keys;
+          std::vector<float *> batch_values;
+          std::vector<const float *> batch_updates;
           for (auto &item : keys) {
             uint64_t key = item.first;
             uint64_t push_data_idx = item.second;
@@ -1188,24 +1431,27 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
               itr = local_shard.find(key);
             }
 
+            MarkDirty(shard_id, key);
             auto &feature_value = itr.value();
             float *value_data = feature_value.data();
             size_t value_size = feature_value.size();
 
             if (value_size == value_col) {  // 已拓展到最大size, 则就地update
-              _value_accessor->Update(&value_data, &update_data, 1);
-            } else {
-              // 拷入buffer区进行update，然后再回填，不需要的mf则回填时抛弃了
-              memcpy(data_buffer_ptr, value_data, value_size * sizeof(float));
-              _value_accessor->Update(&data_buffer_ptr, &update_data, 1);
-
-              if (_value_accessor->NeedExtendMF(data_buffer)) {
-                feature_value.resize(value_col);
-                value_data = feature_value.data();
-                _value_accessor->Create(&value_data, 1);
-              }
-              memcpy(value_data, data_buffer_ptr, value_size * sizeof(float));
+              batch_keys.push_back(key);
+              batch_values.push_back(value_data);
+              batch_updates.push_back(update_data);
+              continue;
+            }
+            // 拷入buffer区进行update，然后再回填，不需要的mf则回填时抛弃了
+            memcpy(data_buffer_ptr, value_data, value_size * sizeof(float));
+            _value_accessor->Update(&data_buffer_ptr, &update_data, 1);
+
+            if (_value_accessor->NeedExtendMF(data_buffer)) {
+              feature_value.resize(value_col);
+              value_data = feature_value.data();
+              _value_accessor->Create(&value_data, 1);
             }
+            memcpy(value_data, data_buffer_ptr, value_size * sizeof(float));
             if (_config.enable_revert()) {
               FixedFeatureValue *feature_value_new = &(local_shard_new[key]);
               auto new_size = feature_value.size();
@@ -1215,6 +1461,18 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
                      new_size * sizeof(float));
             }
           }
+          _value_accessor->Update(
+              batch_values.data(), batch_updates.data(), batch_values.size());
+          if (_config.enable_revert()) {
+            for (size_t i = 0; i < batch_keys.size(); ++i) {
+              FixedFeatureValue *feature_value_new =
+                  &(local_shard_new[batch_keys[i]]);
+              feature_value_new->resize(value_col);
+              memcpy(feature_value_new->data(),
+                     batch_values[i],
+                     value_col * sizeof(float));
+            }
+          }
           return 0;
         });
   }
@@ -1247,6 +1505,8 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
           auto &local_shard = _local_shards[shard_id];
           float data_buffer[value_col];  // NOLINT
           float *data_buffer_ptr = data_buffer;
+          std::vector<float *> batch_values;
+          std::vector<const float *> batch_updates;
           for (auto &item : keys) {
             uint64_t key = item.first;
             uint64_t push_data_idx = item.second;
@@ -1266,11 +1526,13 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
                      value_size * sizeof(float));
               itr = local_shard.find(key);
             }
+            MarkDirty(shard_id, key);
             auto &feature_value = itr.value();
             float *value_data = feature_value.data();
             size_t value_size = feature_value.size();
             if (value_size == value_col) {  // 已拓展到最大size, 则就地update
-              _value_accessor->Update(&value_data, &update_data, 1);
+              batch_values.push_back(value_data);
+              batch_updates.push_back(update_data);
             } else {
               // 拷入buffer区进行update，然后再回填，不需要的mf则回填时抛弃了
               memcpy(data_buffer_ptr, value_data, value_size * sizeof(float));
@@ -1283,6 +1545,8 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
               memcpy(value_data, data_buffer_ptr, value_size * sizeof(float));
             }
           }
+          _value_accessor->Update(
+              batch_values.data(), batch_updates.data(), batch_values.size());
           return 0;
         });
   }
@@ -1305,8 +1569,13 @@ int32_t MemorySparseTable::Shrink(const std::string &param) {
     // Shrink
     int feasign_size = 0;
     auto &shard = _local_shards[shard_id];
+    // shrink decays every value
+    if (_enable_delta_checkpoint) {
+      _delta_states[shard_id].all_dirty = true;
+    }
     for (auto it = shard.begin(); it != shard.end();) {
       if (_value_accessor->Shrink(it.value().data())) {
+        MarkDeleted(shard_id, it.key());
         it = shard.erase(it);
         ++feasign_size;
       } else {
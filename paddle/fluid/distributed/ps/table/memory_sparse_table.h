@@ -22,6 +22,7 @@
 #include <mutex>  // NOLINT
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -29,6 +30,7 @@
 #include "paddle/fluid/distributed/ps/table/accessor.h"
 #include "paddle/fluid/distributed/ps/table/common_table.h"
 #include "paddle/fluid/distributed/ps/table/depends/feature_value.h"
+#include "paddle/fluid/distributed/ps/table/depends/sparse_checkpoint.h"
 #include "paddle/utils/string/string_helper.h"
 
 #define PSERVER_SAVE_SUFFIX ".shard"
@@ -118,6 +120,33 @@ class MemorySparseTable : public Table {
   virtual int32_t SavePatch(const std::string& path, int save_param);
   virtual int32_t LoadPatch(const std::vector<std::string>& file_list,
                             int save_param);
+  // Binary checkpoint of TableParameter.binary_checkpoint, one file of
+  // depends/sparse_checkpoint.h per shard. With save_param 6 only the keys
+  // changed since the last checkpoint are written, see DeltaState.
+  int32_t SaveBinaryCheckpoint(const std::string& path, int save_param);
+  int32_t LoadBinaryCheckpoint(const std::vector<std::string>& file_list);
+  virtual int32_t SaveShardCheckpoint(int shard_id,
+                                      int save_param,
+                                      SparseCheckpointWriter* writer);
+  virtual int32_t LoadShardCheckpoint(int shard_id,
+                                      const SparseCheckpointReader& reader);
+  int32_t SaveShardDelta(int shard_id, SparseCheckpointWriter* writer);
+  // Record the keys changed by push, created by pull or erased by shrink.
+  // Only called by the task of the shard, or with the table idle.
+  void MarkDirty(int shard_id, uint64_t key) {
+    if (_enable_delta_checkpoint) {
+      _delta_states[shard_id].dirty.insert(key);
+    }
+  }
+  void MarkDeleted(int shard_id, uint64_t key) {
+    if (_enable_delta_checkpoint) {
+      _delta_states[shard_id].deleted.insert(key);
+    }
+  }
+  void ResetDeltaState(int shard_id);
+  // UpdateStatAfterSave of every value of the shard, the values it changes
+  // are dirty.
+  void UpdateShardStatAfterSave(int shard_id, int save_param);
 
   int _task_pool_size = 24;
   int _avg_local_shard_num;
@@ -137,6 +166,16 @@ class MemorySparseTable : public Table {
   std::unique_ptr<shard_type[]> _local_shards_patch_model;
   std::thread _save_patch_model_thread;
   bool _use_gpu_graph = false;
+
+  // for delta checkpoint
+  struct DeltaState {
+    std::unordered_set<uint64_t> dirty;
+    std::unordered_set<uint64_t> deleted;
+    // all values changed, e.g. decayed by shrink
+    bool all_dirty = false;
+  };
+  bool _enable_delta_checkpoint = false;
+  std::vector<DeltaState> _delta_states;
 };
 
 }  // namespace distributed
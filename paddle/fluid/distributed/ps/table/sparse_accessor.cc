@@ -215,6 +215,11 @@ int32_t SparseAccessor::Merge(float** update_values,
 int32_t SparseAccessor::Update(float** update_values,
                                const float** push_values,
                                size_t num) {
+  // the sgd rules update the values of the push in batches
+  thread_local SparseValueSGDBatch embed_batch;
+  thread_local SparseValueSGDBatch embedx_batch;
+  embed_batch.Clear();
+  embedx_batch.Clear();
   for (size_t value_item = 0; value_item < num; ++value_item) {
     float* update_value = update_values[value_item];
     const float* push_value = push_values[value_item];
@@ -228,17 +233,17 @@ int32_t SparseAccessor::Update(float** update_values,
         (push_show - push_click) * _config.ctr_accessor_param().nonclk_coeff() +
         push_click * _config.ctr_accessor_param().click_coeff();
     update_value[sparse_feature_value.UnseenDaysIndex()] = 0;
-    _embed_sgd_rule->UpdateValue(
-        update_value + sparse_feature_value.EmbedWIndex(),
-        update_value + sparse_feature_value.EmbedG2SumIndex(),
-        push_value + SparsePushValue::EmbedGIndex(),
-        push_show);
-    _embedx_sgd_rule->UpdateValue(
-        update_value + sparse_feature_value.EmbedxWIndex(),
-        update_value + sparse_feature_value.EmbedxG2SumIndex(),
-        push_value + SparsePushValue::EmbedxGIndex(),
-        push_show);
+    embed_batch.Add(update_value + sparse_feature_value.EmbedWIndex(),
+                    update_value + sparse_feature_value.EmbedG2SumIndex(),
+                    push_value + SparsePushValue::EmbedGIndex(),
+                    push_show);
+    embedx_batch.Add(update_value + sparse_feature_value.EmbedxWIndex(),
+                     update_value + sparse_feature_value.EmbedxG2SumIndex(),
+                     push_value + SparsePushValue::EmbedxGIndex(),
+                     push_show);
   }
+  embed_batch.Update(_embed_sgd_rule);
+  embedx_batch.Update(_embedx_sgd_rule);
   return 0;
 }
 
@@ -0,0 +1,107 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/sparse_checkpoint_compact.h"
+
+#include <memory>
+
+#include "glog/logging.h"
+#include "paddle/fluid/distributed/ps/table/depends/sparse_checkpoint.h"
+#include "paddle/fluid/framework/io/fs.h"
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+
+int OpenCheckpoint(const std::string& path, SparseCheckpointReader* reader) {
+  int ret = 0;
+  if (::paddle::framework::fs_select_internal(path) == 0) {
+    ret = reader->Map(path);
+  } else {
+    int err_no = 0;
+    FsReadChannel channel;
+    channel.open(::paddle::framework::fs_open_read(path, &err_no, ""),
+                 FsChannelConfig());
+    ret = reader->Read(&channel);
+    channel.close();
+    if (err_no == -1) {
+      ret = -1;
+    }
+  }
+  if (ret != 0 || !reader->Verify()) {
+    LOG(ERROR) << "CompactSparseCheckpoint bad checkpoint, path:" << path;
+    return -1;
+  }
+  return 0;
+}
+
+}  // namespace
+
+int64_t CompactSparseCheckpoint(const std::string& base_dir,
+                                const std::vector<std::string>& delta_dirs,
+                                const std::string& output_dir) {
+  std::vector<std::string> base_files;
+  for (auto& file : ::paddle::framework::fs_list(base_dir)) {
+    if (IsSparseCheckpoint({file})) {
+      base_files.push_back(file);
+    }
+  }
+  if (base_files.empty()) {
+    LOG(ERROR) << "CompactSparseCheckpoint no checkpoint in " << base_dir;
+    return -1;
+  }
+  ::paddle::framework::fs_mkdir(output_dir);
+  const std::string suffix = SPARSE_CHECKPOINT_SUFFIX;
+  int64_t key_num_all = 0;
+  for (auto& base_file : base_files) {
+    std::string name = base_file.substr(base_file.rfind('/') + 1);
+    std::string part = name.substr(0, name.size() - suffix.size());
+    // the base first, then the deltas in the order they were saved
+    std::vector<std::unique_ptr<SparseCheckpointReader>> readers;
+    std::vector<const SparseCheckpointReader*> inputs;
+    std::vector<std::string> paths = {base_file};
+    for (auto& delta_dir : delta_dirs) {
+      paths.push_back(delta_dir + "/" + part + SPARSE_CHECKPOINT_DELTA_SUFFIX);
+    }
+    for (auto& path : paths) {
+      readers.emplace_back(new SparseCheckpointReader());
+      if (OpenCheckpoint(path, readers.back().get()) != 0) {
+        return -1;
+      }
+      inputs.push_back(readers.back().get());
+    }
+
+    std::string output_path = output_dir + "/" + name;
+    int err_no = 0;
+    FsWriteChannel channel;
+    channel.open(::paddle::framework::fs_open_write(output_path, &err_no, ""),
+                 FsChannelConfig());
+    SparseCheckpointWriter writer(&channel);
+    int64_t key_num = MergeSparseCheckpoints(inputs, &writer);
+    channel.close();
+    if (key_num < 0 || err_no == -1) {
+      LOG(ERROR) << "CompactSparseCheckpoint write failed, path:"
+                 << output_path;
+      return -1;
+    }
+    LOG(INFO) << "CompactSparseCheckpoint merged " << paths.size()
+              << " files into " << output_path << ", key_num:" << key_num;
+    key_num_all += key_num;
+  }
+  return key_num_all;
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,35 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace distributed {
+
+// Fold the delta checkpoints of a sparse table into its base checkpoint,
+// offline. base_dir holds the part-*.bin files saved by the table, every dir
+// of delta_dirs, in the order they were saved, holds the part-*.delta files
+// of the same parts. The merged parts are written to output_dir with the
+// names of the base, so that it can be loaded as a base checkpoint. The dirs
+// may be local or on hdfs. Return the number of keys written or -1.
+int64_t CompactSparseCheckpoint(const std::string& base_dir,
+                                const std::vector<std::string>& delta_dirs,
+                                const std::string& output_dir);
+
+}  // namespace distributed
+}  // namespace paddle
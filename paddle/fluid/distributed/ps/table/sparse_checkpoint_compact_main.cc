@@ -0,0 +1,57 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/distributed/ps/table/sparse_checkpoint_compact.h"
+#include "paddle/utils/string/split.h"
+
+PD_DEFINE_string(base_dir, "", "The dir of the base checkpoint of a table.");
+PD_DEFINE_string(delta_dirs,
+                 "",
+                 "The dirs of the delta checkpoints, separated by commas, in "
+                 "the order they were saved.");
+PD_DEFINE_string(output_dir, "", "The dir of the compacted checkpoint.");
+
+// Fold the delta checkpoints of a sparse table saved with mode 6 into its
+// base checkpoint, offline. To use this tool, run command:
+// ./sparse_checkpoint_compact [options...]
+// Options:
+//     --base_dir: the dir of the base checkpoint of a table
+//     --delta_dirs: the dirs of the deltas, separated by commas
+//     --output_dir: the dir of the compacted checkpoint
+int main(int argc, char* argv[]) {
+  paddle::flags::ParseCommandLineFlags(&argc, &argv);
+  google::InitGoogleLogging(argv[0]);
+  if (FLAGS_base_dir.empty() || FLAGS_output_dir.empty()) {
+    LOG(ERROR) << "Both --base_dir and --output_dir are needed.";
+    return 1;
+  }
+  std::vector<std::string> delta_dirs;
+  if (!FLAGS_delta_dirs.empty()) {
+    delta_dirs = paddle::string::Split(FLAGS_delta_dirs, ',');
+  }
+  int64_t key_num = paddle::distributed::CompactSparseCheckpoint(
+      FLAGS_base_dir, delta_dirs, FLAGS_output_dir);
+  if (key_num < 0) {
+    LOG(ERROR) << "Compact the checkpoint in " << FLAGS_base_dir << " failed.";
+    return 1;
+  }
+  LOG(INFO) << "Compacted " << delta_dirs.size() << " deltas into "
+            << FLAGS_output_dir << ", key_num:" << key_num;
+  return 0;
+}
@@ -19,6 +19,7 @@
 #include "paddle/common/flags.h"
 
 #include "paddle/common/enforce.h"
+#include "paddle/phi/kernels/funcs/jit/kernels.h"
 
 PD_DEFINE_bool(enable_show_scale_gradient, true, "enable show scale gradient");
 
@@ -54,6 +55,22 @@ void SparseNaiveSGDRule::UpdateValueWork(float *w,
   }
 }
 
+void SparseNaiveSGDRule::UpdateValueBatchWork(float **w,
+                                              float **sgd,
+                                              const float **push_values,
+                                              const float *scales,
+                                              size_t num) {
+  phi::jit::sgd_attr_t attr(1, _embedding_dim, 1, _embedding_dim, 1);
+  auto sgd_func =
+      phi::jit::KernelFuncs<phi::jit::SgdTuple<float>, phi::CPUPlace>::Cache()
+          .At(attr);
+  int64_t rows_idx = 0;
+  for (size_t i = 0; i < num; ++i) {
+    sgd_func(&learning_rate_, w[i], push_values[i], &rows_idx, w[i], &attr);
+    BoundValues(w[i], _embedding_dim);
+  }
+}
+
 void SparseNaiveSGDRule::InitValueWork(float *value,
                                        float *sgd,
                                        bool zero_init) {
@@ -111,6 +128,33 @@ void SparseAdaGradSGDRule::UpdateValueWork(float *w,
   g2sum += add_g2sum / _embedding_dim;
 }
 
+void SparseAdaGradSGDRule::UpdateValueBatchWork(float **w,
+                                                float **sgd,
+                                                const float **grads,
+                                                const float *scales,
+                                                size_t num) {
+  phi::jit::sgd_attr_t attr(1, _embedding_dim, 1, _embedding_dim, 1);
+  auto sgd_func =
+      phi::jit::KernelFuncs<phi::jit::SgdTuple<float>, phi::CPUPlace>::Cache()
+          .At(attr);
+  int64_t rows_idx = 0;
+  for (size_t i = 0; i < num; ++i) {
+    float &g2sum = sgd[i][G2SumIndex()];
+    const float *grad = grads[i];
+    double add_g2sum = 0;
+    for (size_t j = 0; j < _embedding_dim; j++) {
+      double scaled_grad = grad[j] / scales[i];
+      add_g2sum += scaled_grad * scaled_grad;
+    }
+    // the scale and the adagrad decay of the key are folded into its lr
+    float lr = learning_rate_ / scales[i] *
+               sqrt(_initial_g2sum / (_initial_g2sum + g2sum));
+    sgd_func(&lr, w[i], grad, &rows_idx, w[i], &attr);
+    BoundValues(w[i], _embedding_dim);
+    g2sum += add_g2sum / _embedding_dim;
+  }
+}
+
 void SparseAdaGradSGDRule::InitValueWork(float *value,
                                          float *sgd,
                                          bool zero_init) {
@@ -236,6 +280,39 @@ void SparseAdamSGDRule::UpdateValueWork(float *w,
   (*beta2_pow) *= _beta2_decay_rate;
 }
 
+void SparseAdamSGDRule::UpdateValueBatchWork(float **w,
+                                             float **sgd,
+                                             const float **grads,
+                                             const float *scales,
+                                             size_t num) {
+  phi::jit::adam_attr_t attr(_beta1_decay_rate, _beta2_decay_rate);
+  auto adam =
+      phi::jit::KernelFuncs<phi::jit::AdamTuple<float>, phi::CPUPlace>::Cache()
+          .At(attr);
+  for (size_t i = 0; i < num; ++i) {
+    float *gsum = sgd[i] + GSumIndex();
+    float *g2sum = sgd[i] + G2SumIndex();
+    float *beta1_pow = sgd[i] + Beta1PowIndex();
+    float *beta2_pow = sgd[i] + Beta2PowIndex();
+    float lr = learning_rate_ * sqrt(1 - *beta2_pow) / (1 - *beta1_pow);
+    adam(_beta1_decay_rate,
+         _beta2_decay_rate,
+         -lr,
+         _ada_epsilon,
+         _embedding_dim,
+         grads[i],
+         gsum,
+         g2sum,
+         w[i],
+         gsum,
+         g2sum,
+         w[i]);
+    BoundValues(w[i], _embedding_dim);
+    (*beta1_pow) *= _beta1_decay_rate;
+    (*beta2_pow) *= _beta2_decay_rate;
+  }
+}
+
 void SparseAdamSGDRule::InitValueWork(float *value,
                                       float *sgd,
                                       bool zero_init) {
@@ -321,6 +398,41 @@ void SparseSharedAdamSGDRule::UpdateValueWork(float *w,
   (*beta2_pow) *= _beta2_decay_rate;
 }
 
+void SparseSharedAdamSGDRule::UpdateValueBatchWork(float **w,
+                                                   float **sgd,
+                                                   const float **grads,
+                                                   const float *scales,
+                                                   size_t num) {
+  for (size_t i = 0; i < num; ++i) {
+    float *gsum = sgd[i] + GSumIndex();
+    float *g2sum = sgd[i] + G2SumIndex();
+    float *beta1_pow = sgd[i] + Beta1PowIndex();
+    float *beta2_pow = sgd[i] + Beta2PowIndex();
+    const float *g = grads[i];
+    float lr = learning_rate_ * sqrt(1 - *beta2_pow) / (1 - *beta1_pow);
+    // the moments are shared by the dims, so the new moments are affine in
+    // g and g * g, and their means come from the sums of the grads
+    float gsum_base = _beta1_decay_rate * (*gsum);
+    float g2sum_base = _beta2_decay_rate * (*g2sum);
+    float beta1 = 1 - _beta1_decay_rate;
+    float beta2 = 1 - _beta2_decay_rate;
+    double sum_g = 0.0;
+    double sum_g2 = 0.0;
+    for (size_t j = 0; j < _embedding_dim; j++) {
+      float new_gsum = gsum_base + beta1 * g[j];
+      float new_g2sum = g2sum_base + beta2 * g[j] * g[j];
+      w[i][j] -= lr * (new_gsum / (sqrtf(new_g2sum) + _ada_epsilon));
+      sum_g += g[j];
+      sum_g2 += g[j] * g[j];
+    }
+    BoundValues(w[i], _embedding_dim);
+    (*gsum) = gsum_base + beta1 * sum_g / _embedding_dim;
+    (*g2sum) = g2sum_base + beta2 * sum_g2 / _embedding_dim;
+    (*beta1_pow) *= _beta1_decay_rate;
+    (*beta2_pow) *= _beta2_decay_rate;
+  }
+}
+
 void SparseSharedAdamSGDRule::InitValueWork(float *value,
                                             float *sgd,
                                             bool zero_init) {
@@ -39,6 +39,18 @@ class SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale) = 0;
+  // Update num values in one call, the i-th value is w[i] and sgd[i] updated
+  // by push_values[i] with scales[i]. The rules which have kernels over the
+  // whole batch override it.
+  virtual void UpdateValueBatchWork(float** w,
+                                    float** sgd,
+                                    const float** push_values,
+                                    const float* scales,
+                                    size_t num) {
+    for (size_t i = 0; i < num; ++i) {
+      UpdateValueWork(w[i], sgd[i], push_values[i], scales[i]);
+    }
+  }
   virtual void InitValueWork(float* value, float* sgd, bool zero_init) = 0;
   virtual size_t Dim() = 0;
   const std::string& GetName() const { return _name; }
@@ -51,6 +63,13 @@ class SparseValueSGDRule {
                    float scale = 1) {
     UpdateValueWork(w, sgd, push_value, scale);
   }
+  void UpdateValueBatch(float** w,
+                        float** sgd,
+                        const float** push_values,
+                        const float* scales,
+                        size_t num) {
+    UpdateValueBatchWork(w, sgd, push_values, scales, num);
+  }
   template <class T>
   void BoundValue(T& w) {  // NOLINT
     if (!(w >= _min_bound)) {
@@ -59,6 +78,11 @@ class SparseValueSGDRule {
       w = (T)_max_bound;
     }
   }
+  void BoundValues(float* w, size_t num) {
+    for (size_t i = 0; i < num; ++i) {
+      BoundValue(w[i]);
+    }
+  }
   float& MinBound() { return _min_bound; }
   float& MaxBound() { return _max_bound; }
 
@@ -74,6 +98,32 @@ class SparseValueSGDRule {
 
 REGISTER_PSCORE_REGISTERER(SparseValueSGDRule);
 
+// The values of a push gathered for one UpdateValueBatch of a rule. Kept
+// thread local by the accessors, so the buffers are reused.
+struct SparseValueSGDBatch {
+  void Clear() {
+    w.clear();
+    sgd.clear();
+    push_values.clear();
+    scales.clear();
+  }
+  void Add(float* w_ptr, float* sgd_ptr, const float* push_value, float scale) {
+    w.push_back(w_ptr);
+    sgd.push_back(sgd_ptr);
+    push_values.push_back(push_value);
+    scales.push_back(scale);
+  }
+  void Update(SparseValueSGDRule* rule) {
+    rule->UpdateValueBatch(
+        w.data(), sgd.data(), push_values.data(), scales.data(), w.size());
+  }
+
+  std::vector<float*> w;
+  std::vector<float*> sgd;
+  std::vector<const float*> push_values;
+  std::vector<float> scales;
+};
+
 class SparseNaiveSGDRule : public SparseValueSGDRule {
  public:
   virtual void LoadConfig(const SparseCommonSGDRuleParameter& param,
@@ -82,6 +132,11 @@ class SparseNaiveSGDRule : public SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale);
+  virtual void UpdateValueBatchWork(float** w,
+                                    float** sgd,
+                                    const float** push_values,
+                                    const float* scales,
+                                    size_t num);
   virtual void InitValueWork(float* value, float* sgd, bool zero_init);
   virtual size_t Dim() { return 0; }
 
@@ -97,6 +152,11 @@ class SparseAdaGradSGDRule : public SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale);
+  virtual void UpdateValueBatchWork(float** w,
+                                    float** sgd,
+                                    const float** push_values,
+                                    const float* scales,
+                                    size_t num);
   virtual void InitValueWork(float* value, float* sgd, bool zero_init);
   virtual size_t Dim() { return 1; }
   size_t G2SumIndex() { return 0; }
@@ -151,6 +211,11 @@ class SparseAdamSGDRule : public SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale);
+  virtual void UpdateValueBatchWork(float** w,
+                                    float** sgd,
+                                    const float** push_values,
+                                    const float* scales,
+                                    size_t num);
   virtual void InitValueWork(float* value, float* sgd, bool zero_init);
   virtual size_t Dim() { return _embedding_dim * 2 + 2; }
   size_t GSumIndex() { return 0; }
@@ -173,6 +238,11 @@ class SparseSharedAdamSGDRule : public SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale);
+  virtual void UpdateValueBatchWork(float** w,
+                                    float** sgd,
+                                    const float** push_values,
+                                    const float* scales,
+                                    size_t num);
   virtual void InitValueWork(float* value, float* sgd, bool zero_init);
   virtual size_t Dim() { return 4; }
   size_t GSumIndex() { return 0; }
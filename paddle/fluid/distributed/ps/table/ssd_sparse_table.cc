@@ -14,6 +14,9 @@
 
 #include "paddle/fluid/distributed/ps/table/ssd_sparse_table.h"
 
+#include <algorithm>
+#include <future>
+
 #include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/common/cost_timer.h"
 #include "paddle/fluid/distributed/common/local_random.h"
@@ -25,6 +28,17 @@ PD_DECLARE_bool(pserver_create_value_when_push);
 PD_DECLARE_bool(pserver_enable_create_feasign_randomly);
 PD_DEFINE_bool(pserver_open_strict_check, false, "pserver_open_strict_check");
 PD_DEFINE_int32(pserver_load_batch_size, 5000, "load batch size for ssd");
+PD_DEFINE_bool(pserver_ssd_tiered_mode,
+               false,
+               "only move the frequently pulled keys of ssd table to memory");
+PD_DEFINE_int32(pserver_ssd_admit_frequency,
+                2,
+                "pulls of a key in rocksdb before it is moved to memory, "
+                "used in the tiered mode of ssd table");
+PD_DEFINE_int64(pserver_ssd_hot_keys_per_shard,
+                0,
+                "keys kept in memory by a shard of ssd table in the tiered "
+                "mode, 0 means no limit");
 PHI_DEFINE_EXPORTED_string(rocksdb_path,
                            "database",
                            "path of sparse table rocksdb file");
@@ -36,7 +50,20 @@ int32_t SSDSparseTable::Initialize() {
   MemorySparseTable::Initialize();
   _db = ::paddle::distributed::RocksDBHandler::GetInstance();
   _db->initialize(FLAGS_rocksdb_path, _real_local_shard_num);
+  if (FLAGS_pserver_ssd_tiered_mode) {
+    _prefetch_pool.reset(new ::ThreadPool(_task_pool_size));
+    size_t sketch_size = FLAGS_pserver_ssd_hot_keys_per_shard > 0
+                             ? FLAGS_pserver_ssd_hot_keys_per_shard
+                             : 65536;
+    _hot_sketches.resize(_real_local_shard_num, FrequencySketch(sketch_size));
+  }
+  _evict_pending.reset(new std::atomic<bool>[_real_local_shard_num]);
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    _evict_pending[i] = false;
+  }
   VLOG(0) << "initialize SSDSparseTable succ";
+  VLOG(0) << "SSD FLAGS_pserver_ssd_tiered_mode:"
+          << FLAGS_pserver_ssd_tiered_mode;
   VLOG(0) << "SSD FLAGS_pserver_print_missed_key_num_every_push:"
           << FLAGS_pserver_print_missed_key_num_every_push;
 #if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
@@ -124,60 +151,127 @@ int32_t SSDSparseTable::PullSparse(float* pull_values,
                 auto& local_shard = _local_shards[shard_id];
                 float data_buffer[value_size];  // NOLINT
                 float* data_buffer_ptr = data_buffer;
+                // look all keys up in memory first, the missed ones are read
+                // from rocksdb in one batch while the others are selected
+                std::vector<FixedFeatureValue*> mem_values(keys.size());
+                RocksDBItem ssd_item;
                 for (size_t i = 0; i < keys.size(); ++i) {
-                  uint64_t key = keys[i].first;
-                  auto itr = local_shard.find(key);
-                  size_t data_size = value_size - mf_value_size;
+                  if (FLAGS_pserver_ssd_tiered_mode) {
+                    _hot_sketches[shard_id].Increment(keys[i].first);
+                  }
+                  auto itr = local_shard.find(keys[i].first);
                   if (itr == local_shard.end()) {
-                    // pull rocksdb
-                    std::string tmp_string("");
-                    if (_db->get(shard_id,
-                                 reinterpret_cast<char*>(&key),
-                                 sizeof(uint64_t),
-                                 tmp_string) > 0) {
-                      ++missed_keys;
-                      if (FLAGS_pserver_create_value_when_push) {
-                        memset(data_buffer, 0, sizeof(float) * data_size);
-                      } else {
-                        auto& feature_value = local_shard[key];
-                        feature_value.resize(data_size);
-                        float* data_ptr =
-                            const_cast<float*>(feature_value.data());
-                        _value_accessor->Create(&data_buffer_ptr, 1);
-                        memcpy(data_ptr,
-                               data_buffer_ptr,
-                               data_size * sizeof(float));
-                      }
+                    mem_values[i] = nullptr;
+                    ssd_item.batch_index.push_back(i);
+                    ssd_item.batch_keys.emplace_back(
+                        reinterpret_cast<const char*>(&keys[i].first),
+                        sizeof(uint64_t));
+                  } else {
+                    mem_values[i] = &itr.value();
+                  }
+                }
+                std::future<int> prefetch;
+                if (!ssd_item.batch_keys.empty()) {
+                  prefetch = PrefetchFromSSD(shard_id, &ssd_item);
+                }
+                auto select = [&](int pull_data_idx, size_t data_size) {
+                  for (size_t mf_idx = data_size; mf_idx < value_size;
+                       ++mf_idx) {
+                    data_buffer_ptr[mf_idx] = 0.0;
+                  }
+                  float* select_data =
+                      pull_values + pull_data_idx * select_value_size;
+                  _value_accessor->Select(
+                      &select_data, (const float**)&data_buffer_ptr, 1);
+                };
+                for (size_t i = 0; i < keys.size(); ++i) {
+                  if (mem_values[i] == nullptr) {
+                    continue;
+                  }
+                  size_t data_size = mem_values[i]->size();
+                  memcpy(data_buffer_ptr,
+                         mem_values[i]->data(),
+                         data_size * sizeof(float));
+                  select(keys[i].second, data_size);
+                }
+                _tier_stat.mem_hit +=
+                    keys.size() - ssd_item.batch_keys.size();
+                if (!prefetch.valid()) {
+                  return 0;
+                }
+                prefetch.wait();
+
+                std::vector<std::pair<char*, int>> admitted_keys;
+                // the new cold keys are created in rocksdb in tiered mode
+                std::vector<std::vector<float>> created_values;
+                std::vector<std::pair<char*, int>> created_keys;
+                for (size_t j = 0; j < ssd_item.batch_keys.size(); ++j) {
+                  auto& key_pair = keys[ssd_item.batch_index[j]];
+                  uint64_t key = key_pair.first;
+                  size_t data_size = value_size - mf_value_size;
+                  if (ssd_item.status[j].IsNotFound()) {
+                    ++missed_keys;
+                    ++_tier_stat.miss;
+                    if (FLAGS_pserver_create_value_when_push) {
+                      memset(data_buffer, 0, sizeof(float) * data_size);
+                    } else if (IsColdKey(shard_id, key)) {
+                      _value_accessor->Create(&data_buffer_ptr, 1);
+                      created_values.emplace_back(data_buffer_ptr,
+                                                  data_buffer_ptr + data_size);
+                      created_keys.emplace_back(
+                          reinterpret_cast<char*>(&key_pair.first),
+                          sizeof(uint64_t));
                     } else {
-                      data_size = tmp_string.size() / sizeof(float);
-                      memcpy(data_buffer_ptr,
-                             ::paddle::string::str_to_float(tmp_string),
-                             data_size * sizeof(float));
-                      // from rocksdb to mem
                       auto& feature_value = local_shard[key];
                       feature_value.resize(data_size);
-                      memcpy(const_cast<float*>(feature_value.data()),
+                      float* data_ptr =
+                          const_cast<float*>(feature_value.data());
+                      _value_accessor->Create(&data_buffer_ptr, 1);
+                      memcpy(data_ptr,
                              data_buffer_ptr,
                              data_size * sizeof(float));
-                      _db->del_data(shard_id,
-                                    reinterpret_cast<char*>(&key),
-                                    sizeof(uint64_t));
                     }
                   } else {
-                    data_size = itr.value().size();
+                    ++_tier_stat.ssd_hit;
+                    data_size = ssd_item.batch_values[j].size() / sizeof(float);
                     memcpy(data_buffer_ptr,
-                           itr.value().data(),
+                           ::paddle::string::str_to_float(
+                               ssd_item.batch_values[j].data()),
                            data_size * sizeof(float));
+                    // the cold keys are served from rocksdb in tiered mode
+                    if (!IsColdKey(shard_id, key)) {
+                      // from rocksdb to mem
+                      auto& feature_value = local_shard[key];
+                      feature_value.resize(data_size);
+                      memcpy(const_cast<float*>(feature_value.data()),
+                             data_buffer_ptr,
+                             data_size * sizeof(float));
+                      admitted_keys.emplace_back(
+                          reinterpret_cast<char*>(&key_pair.first),
+                          sizeof(uint64_t));
+                    }
                   }
-                  for (size_t mf_idx = data_size; mf_idx < value_size;
-                       ++mf_idx) {
-                    data_buffer[mf_idx] = 0.0;
+                  select(key_pair.second, data_size);
+                }
+                if (!admitted_keys.empty()) {
+                  _db->del_batch(
+                      shard_id, admitted_keys, admitted_keys.size());
+                  _tier_stat.admit += admitted_keys.size();
+                }
+                if (!created_keys.empty()) {
+                  std::vector<std::pair<char*, int>> created_data;
+                  for (auto& value : created_values) {
+                    created_data.emplace_back(
+                        reinterpret_cast<char*>(value.data()),
+                        value.size() * sizeof(float));
                   }
-                  int pull_data_idx = keys[i].second;
-                  float* select_data =
-                      pull_values + pull_data_idx * select_value_size;
-                  _value_accessor->Select(
-                      &select_data, (const float**)&data_buffer_ptr, 1);
+                  _db->put_batch(shard_id,
+                                 created_keys,
+                                 created_data,
+                                 created_keys.size());
+                }
+                if (NeedEviction(shard_id)) {
+                  ScheduleEviction(shard_id);
                 }
                 return 0;
               });
@@ -372,7 +466,20 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                update_value_col,
                values,
                &task_keys]() -> int {
-                auto& keys = task_keys[shard_id];
+                auto* push_keys = &task_keys[shard_id];
+                // the cold keys are updated in rocksdb in tiered mode
+                std::vector<std::pair<uint64_t, int>> hot_keys;
+                if (FLAGS_pserver_ssd_tiered_mode) {
+                  PushColdKeys(
+                      shard_id,
+                      *push_keys,
+                      [&](int idx) -> const float* {
+                        return values + idx * update_value_col;
+                      },
+                      &hot_keys);
+                  push_keys = &hot_keys;
+                }
+                auto& keys = *push_keys;
                 auto& local_shard = _local_shards[shard_id];
                 float data_buffer[value_col];  // NOLINT
                 float* data_buffer_ptr = data_buffer;
@@ -419,6 +526,9 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                            value_size * sizeof(float));
                   }
                 }
+                if (NeedEviction(shard_id)) {
+                  ScheduleEviction(shard_id);
+                }
                 return 0;
               });
     }
@@ -473,7 +583,18 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
           _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
               [this, shard_id, value_col, mf_value_col, values, &task_keys]()
                   -> int {
-                auto& keys = task_keys[shard_id];
+                auto* push_keys = &task_keys[shard_id];
+                // the cold keys are updated in rocksdb in tiered mode
+                std::vector<std::pair<uint64_t, int>> hot_keys;
+                if (FLAGS_pserver_ssd_tiered_mode) {
+                  PushColdKeys(
+                      shard_id,
+                      *push_keys,
+                      [&](int idx) -> const float* { return values[idx]; },
+                      &hot_keys);
+                  push_keys = &hot_keys;
+                }
+                auto& keys = *push_keys;
                 auto& local_shard = _local_shards[shard_id];
                 float data_buffer[value_col];  // NOLINT
                 float* data_buffer_ptr = data_buffer;
@@ -519,6 +640,9 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                            value_size * sizeof(float));
                   }
                 }
+                if (NeedEviction(shard_id)) {
+                  ScheduleEviction(shard_id);
+                }
                 return 0;
               });
     }
@@ -530,6 +654,7 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
 }
 
 int32_t SSDSparseTable::Shrink(const std::string& param) {
+  WaitEviction();
   int thread_num = _real_local_shard_num < 20 ? _real_local_shard_num : 20;
   omp_set_num_threads(thread_num);
 #pragma omp parallel for schedule(dynamic)
@@ -570,6 +695,7 @@ int32_t SSDSparseTable::Shrink(const std::string& param) {
 }
 
 int32_t SSDSparseTable::UpdateTable() {
+  WaitEviction();
   int count = 0;
   for (int i = 0; i < _real_local_shard_num; ++i) {
     auto& shard = _local_shards[i];
@@ -603,6 +729,7 @@ int64_t SSDSparseTable::LocalSize() {
 
 int32_t SSDSparseTable::Save(const std::string& path,
                              const std::string& param) {
+  WaitEviction();
 #if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
   // gpu graph mode
   if (_use_gpu_graph) {
@@ -624,6 +751,9 @@ int32_t SSDSparseTable::Save(const std::string& path,
   return ret;
 #else
   // CPUPS PSCORE
+  if (_config.binary_checkpoint() && atoi(param.c_str()) == 0) {
+    return SaveBinaryCheckpoint(path, 0);
+  }
   return SaveWithString(path, param);  // batch_model:0  xbox:1
 #endif
 }
@@ -631,6 +761,7 @@ int32_t SSDSparseTable::Save(const std::string& path,
 #if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
 int32_t SSDSparseTable::Save_v2(const std::string& path,
                                 const std::string& param) {
+  WaitEviction();
   std::lock_guard<std::mutex> guard(_table_mutex);
 #ifdef PADDLE_WITH_HETERPS
   int save_param = atoi(param.c_str());
@@ -2567,6 +2698,7 @@ int32_t SSDSparseTable::SaveCache(
 
 int32_t SSDSparseTable::Load(const std::string& path,
                              const std::string& param) {
+  WaitEviction();
   VLOG(0) << "LOAD FLAGS_rocksdb_path:" << FLAGS_rocksdb_path;
   std::string table_path = TableDir(path);
   auto file_list = _afs_client.list(table_path);
@@ -2583,6 +2715,18 @@ int32_t SSDSparseTable::Load(const std::string& path,
   }
   _value_accessor->SetDayId(_day_id);
   VLOG(1) << " Load Set Dayid:" << _day_id;
+  if (IsSparseCheckpoint(file_list)) {
+    std::sort(file_list.begin(), file_list.end());
+    size_t expect_shard_num = _sparse_table_shard_num;
+    if (file_list.size() != expect_shard_num) {
+      LOG(WARNING) << "SSDSparseTable file_size:" << file_list.size()
+                   << " not equal to expect_shard_num:" << expect_shard_num;
+      return -1;
+    }
+    int32_t ret = LoadBinaryCheckpoint(file_list);
+    _cache_tk_size = LocalSize() * _config.sparse_table_cache_rate();
+    return ret;
+  }
   if (load_param > 3) {
     size_t expect_shard_num = _sparse_table_shard_num;
     if (file_list.size() != expect_shard_num) {
@@ -2762,6 +2906,78 @@ int32_t SSDSparseTable::LoadWithString(
   return 0;
 }
 
+int32_t SSDSparseTable::SaveShardCheckpoint(int shard_id,
+                                            int save_param,
+                                            SparseCheckpointWriter* writer) {
+  if (MemorySparseTable::SaveShardCheckpoint(shard_id, save_param, writer) !=
+      0) {
+    return -1;
+  }
+  auto* it = _db->get_iterator(shard_id);
+  int ret = 0;
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    float* value = ::paddle::string::str_to_float(it->value().data());
+    bool need_save = _value_accessor->Save(value, save_param);
+    _value_accessor->UpdateStatAfterSave(value, save_param);
+    if (need_save &&
+        writer->Append(*(reinterpret_cast<const uint64_t*>(it->key().data())),
+                       value,
+                       it->value().size() / sizeof(float)) != 0) {
+      ret = -1;
+      break;
+    }
+  }
+  delete it;
+  return ret;
+}
+
+int32_t SSDSparseTable::LoadShardCheckpoint(
+    int shard_id, const SparseCheckpointReader& reader) {
+  auto& shard = _local_shards[shard_id];
+  std::vector<std::pair<char*, int>> ssd_keys;
+  std::vector<std::pair<char*, int>> ssd_values;
+  ssd_keys.reserve(FLAGS_pserver_load_batch_size);
+  ssd_values.reserve(FLAGS_pserver_load_batch_size);
+  uint64_t mem_count = 0;
+  uint64_t ssd_count = 0;
+  uint64_t filtered_count = 0;
+  for (size_t i = 0; i < reader.key_num(); ++i) {
+    float* value = const_cast<float*>(reader.value(i));
+    size_t value_size = reader.value_size(i);
+    if (_value_accessor->FilterSlot(value)) {
+      ++filtered_count;
+      continue;
+    }
+    if (_value_accessor->SaveSSD(value)) {
+      // put to rocksdb straight from the file
+      ssd_keys.emplace_back(
+          reinterpret_cast<char*>(const_cast<uint64_t*>(reader.key_data(i))),
+          sizeof(uint64_t));
+      ssd_values.emplace_back(reinterpret_cast<char*>(value),
+                              value_size * sizeof(float));
+      if (static_cast<int>(ssd_keys.size()) == FLAGS_pserver_load_batch_size) {
+        _db->put_batch(shard_id, ssd_keys, ssd_values, ssd_keys.size());
+        ssd_keys.clear();
+        ssd_values.clear();
+      }
+      ++ssd_count;
+    } else {
+      auto& feature_value = shard[reader.key(i)];
+      feature_value.resize(value_size);
+      memcpy(feature_value.data(), value, value_size * sizeof(float));
+      ++mem_count;
+    }
+  }
+  if (!ssd_keys.empty()) {
+    _db->put_batch(shard_id, ssd_keys, ssd_values, ssd_keys.size());
+  }
+  _db->flush(shard_id);
+  VLOG(0) << "Table>> load binary checkpoint done. ALL["
+          << mem_count + ssd_count << "] MEM[" << mem_count << "] SSD["
+          << ssd_count << "] FILTERED[" << filtered_count << "]";
+  return 0;
+}
+
 int32_t SSDSparseTable::LoadWithBinary(const std::string& path, int param) {
   size_t feature_value_size =
       _value_accessor->GetAccessorInfo().size / sizeof(float);
@@ -3016,10 +3232,227 @@ int32_t SSDSparseTable::LoadWithBinary(const std::string& path, int param) {
 
 std::pair<int64_t, int64_t> SSDSparseTable::PrintTableStat() {
   int64_t feasign_size = LocalSize();
+  SSDTierStat stat = GetTierStat();
+  uint64_t pull_num = stat.mem_hit + stat.ssd_hit + stat.miss;
+  LOG(INFO) << "SSDSparseTable pull keys:" << pull_num
+            << " mem_hit:" << stat.mem_hit << " ssd_hit:" << stat.ssd_hit
+            << " miss:" << stat.miss << " mem_hit_rate:"
+            << (pull_num > 0 ? static_cast<double>(stat.mem_hit) / pull_num
+                             : 0.0)
+            << " admit:" << stat.admit << " evict:" << stat.evict
+            << " prefetch_num:" << stat.prefetch_num << " prefetch_avg_us:"
+            << (stat.prefetch_num > 0 ? stat.prefetch_us / stat.prefetch_num
+                                      : 0);
   return {feasign_size, -1};
 }
 
+SSDTierStat SSDSparseTable::GetTierStat() const {
+  SSDTierStat stat;
+  stat.mem_hit = _tier_stat.mem_hit.load();
+  stat.ssd_hit = _tier_stat.ssd_hit.load();
+  stat.miss = _tier_stat.miss.load();
+  stat.admit = _tier_stat.admit.load();
+  stat.evict = _tier_stat.evict.load();
+  stat.prefetch_num = _tier_stat.prefetch_num.load();
+  stat.prefetch_us = _tier_stat.prefetch_us.load();
+  return stat;
+}
+
+std::future<int> SSDSparseTable::PrefetchFromSSD(int shard_id,
+                                                 RocksDBItem* item) {
+  item->batch_values.resize(item->batch_keys.size());
+  item->status.resize(item->batch_keys.size());
+  auto read = [this, shard_id, item]() -> int {
+    uint64_t begin = butil::gettimeofday_us();
+    _db->multi_get(shard_id,
+                   item->batch_keys.size(),
+                   item->batch_keys.data(),
+                   item->batch_values.data(),
+                   item->status.data(),
+                   false);
+    _tier_stat.prefetch_us += butil::gettimeofday_us() - begin;
+    ++_tier_stat.prefetch_num;
+    return 0;
+  };
+  if (_prefetch_pool == nullptr) {
+    // still one batch, read by the shard task when it waits for it
+    return std::async(std::launch::deferred, read);
+  }
+  return _prefetch_pool->enqueue(read);
+}
+
+void SSDSparseTable::PushColdKeys(
+    int shard_id,
+    const std::vector<std::pair<uint64_t, int>>& keys,
+    const std::function<const float*(int)>& update_data_of,
+    std::vector<std::pair<uint64_t, int>>* hot_keys) {
+  size_t value_col = _value_accessor->GetAccessorInfo().size / sizeof(float);
+  size_t mf_value_col =
+      _value_accessor->GetAccessorInfo().mf_size / sizeof(float);
+  auto& local_shard = _local_shards[shard_id];
+  RocksDBItem ssd_item;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (local_shard.find(keys[i].first) == local_shard.end()) {
+      ssd_item.batch_index.push_back(i);
+      ssd_item.batch_keys.emplace_back(
+          reinterpret_cast<const char*>(&keys[i].first), sizeof(uint64_t));
+    } else {
+      hot_keys->push_back(keys[i]);
+    }
+  }
+  if (ssd_item.batch_keys.empty()) {
+    return;
+  }
+  PrefetchFromSSD(shard_id, &ssd_item).wait();
+
+  float data_buffer[value_col];    // NOLINT
+  float extend_buffer[value_col];  // NOLINT
+  float* data_buffer_ptr = data_buffer;
+  float* extend_buffer_ptr = extend_buffer;
+  std::vector<std::pair<char*, int>> admitted_keys;
+  std::vector<std::vector<float>> cold_values;
+  std::vector<std::pair<char*, int>> ssd_keys;
+  std::vector<std::pair<char*, int>> ssd_values;
+  cold_values.reserve(ssd_item.batch_keys.size());
+  for (size_t j = 0; j < ssd_item.batch_keys.size(); ++j) {
+    const auto& key_pair = keys[ssd_item.batch_index[j]];
+    char* key_ptr =
+        const_cast<char*>(reinterpret_cast<const char*>(&key_pair.first));
+    bool in_ssd = !ssd_item.status[j].IsNotFound();
+    // the admitted keys are moved to memory, or created there, and updated
+    // by the caller
+    if (!IsColdKey(shard_id, key_pair.first)) {
+      if (in_ssd) {
+        size_t data_size = ssd_item.batch_values[j].size() / sizeof(float);
+        auto& feature_value = local_shard[key_pair.first];
+        feature_value.resize(data_size);
+        memcpy(const_cast<float*>(feature_value.data()),
+               ::paddle::string::str_to_float(ssd_item.batch_values[j].data()),
+               data_size * sizeof(float));
+        admitted_keys.emplace_back(key_ptr, sizeof(uint64_t));
+      }
+      hot_keys->push_back(key_pair);
+      continue;
+    }
+    const float* update_data = update_data_of(key_pair.second);
+    size_t value_size = value_col - mf_value_col;
+    if (in_ssd) {
+      value_size = ssd_item.batch_values[j].size() / sizeof(float);
+      memcpy(data_buffer_ptr,
+             ::paddle::string::str_to_float(ssd_item.batch_values[j].data()),
+             value_size * sizeof(float));
+    } else {
+      if (FLAGS_pserver_enable_create_feasign_randomly &&
+          !_value_accessor->CreateValue(1, update_data)) {
+        continue;
+      }
+      _value_accessor->Create(&data_buffer_ptr, 1);
+    }
+    _value_accessor->Update(&data_buffer_ptr, &update_data, 1);
+    float* value_data = data_buffer_ptr;
+    if (value_size < value_col && _value_accessor->NeedExtendMF(data_buffer)) {
+      _value_accessor->Create(&extend_buffer_ptr, 1);
+      memcpy(extend_buffer_ptr, data_buffer_ptr, value_size * sizeof(float));
+      value_data = extend_buffer_ptr;
+      value_size = value_col;
+    }
+    cold_values.emplace_back(value_data, value_data + value_size);
+    ssd_keys.emplace_back(key_ptr, sizeof(uint64_t));
+    ssd_values.emplace_back(reinterpret_cast<char*>(cold_values.back().data()),
+                            value_size * sizeof(float));
+  }
+  if (!admitted_keys.empty()) {
+    _db->del_batch(shard_id, admitted_keys, admitted_keys.size());
+    _tier_stat.admit += admitted_keys.size();
+  }
+  if (!ssd_keys.empty()) {
+    _db->put_batch(shard_id, ssd_keys, ssd_values, ssd_keys.size());
+  }
+}
+
+bool SSDSparseTable::IsColdKey(int shard_id, uint64_t key) {
+  return FLAGS_pserver_ssd_tiered_mode &&
+         _hot_sketches[shard_id].Estimate(key) <
+             FLAGS_pserver_ssd_admit_frequency;
+}
+
+bool SSDSparseTable::NeedEviction(int shard_id) {
+  return FLAGS_pserver_ssd_tiered_mode &&
+         FLAGS_pserver_ssd_hot_keys_per_shard > 0 &&
+         _local_shards[shard_id].size() >
+             static_cast<size_t>(FLAGS_pserver_ssd_hot_keys_per_shard);
+}
+
+void SSDSparseTable::ScheduleEviction(int shard_id) {
+  if (_evict_pending[shard_id].exchange(true)) {
+    return;
+  }
+  // runs after the tasks already queued for the shard, the caller does not
+  // wait for it
+  _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
+      [this, shard_id]() -> int {
+        int ret = EvictColdKeys(shard_id);
+        _evict_pending[shard_id] = false;
+        return ret;
+      });
+}
+
+int SSDSparseTable::EvictColdKeys(int shard_id) {
+  if (!NeedEviction(shard_id)) {
+    return 0;
+  }
+  auto& local_shard = _local_shards[shard_id];
+  auto& sketch = _hot_sketches[shard_id];
+  // evict to 90% of the limit, so that the next eviction is not due at once
+  size_t keep_num = FLAGS_pserver_ssd_hot_keys_per_shard / 10 * 9;
+  size_t evict_num = local_shard.size() - keep_num;
+  std::vector<std::pair<int, uint64_t>> candidates;
+  candidates.reserve(local_shard.size());
+  for (auto it = local_shard.begin(); it != local_shard.end(); ++it) {
+    candidates.emplace_back(sketch.Estimate(it.key()), it.key());
+  }
+  std::nth_element(candidates.begin(),
+                   candidates.begin() + evict_num,
+                   candidates.end());
+
+  const size_t batch_size = 1024;
+  std::vector<std::pair<char*, int>> ssd_keys;
+  std::vector<std::pair<char*, int>> ssd_values;
+  for (size_t begin = 0; begin < evict_num; begin += batch_size) {
+    size_t end = std::min(begin + batch_size, evict_num);
+    ssd_keys.clear();
+    ssd_values.clear();
+    for (size_t i = begin; i < end; ++i) {
+      auto& feature_value = local_shard.find(candidates[i].second).value();
+      ssd_keys.emplace_back(reinterpret_cast<char*>(&candidates[i].second),
+                            sizeof(uint64_t));
+      ssd_values.emplace_back(reinterpret_cast<char*>(feature_value.data()),
+                              feature_value.size() * sizeof(float));
+    }
+    _db->put_batch(shard_id, ssd_keys, ssd_values, ssd_keys.size());
+    for (size_t i = begin; i < end; ++i) {
+      local_shard.erase(candidates[i].second);
+    }
+  }
+  _tier_stat.evict += evict_num;
+  VLOG(1) << "SSDSparseTable evict shard:" << shard_id
+          << " keys:" << evict_num;
+  return 0;
+}
+
+void SSDSparseTable::WaitEviction() {
+  // the evictions are queued on the task pools of their shards
+  std::vector<std::future<int>> tasks;
+  for (auto& task_pool : _shards_task_pool) {
+    tasks.push_back(task_pool->enqueue([]() -> int { return 0; }));
+  }
+  for (auto& task : tasks) {
+    task.wait();
+  }
+}
+
 int32_t SSDSparseTable::CacheTable(uint16_t pass_id) {
+  WaitEviction();
   std::lock_guard<std::mutex> guard(_table_mutex);
   VLOG(0) << "cache_table";
   std::atomic<uint32_t> count{0};
@@ -14,7 +14,10 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "paddle/common/flags.h"
+#include "paddle/fluid/distributed/common/frequency_sketch.h"
 #include "paddle/fluid/distributed/ps/table/depends/rocksdb_warpper.h"
 #include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
 
@@ -60,11 +63,32 @@ class MemRegion {
   char* _buf;
 };
 
+// Counters of the keys pulled from SSDSparseTable, and of the batched reads
+// of rocksdb which serve the keys missed in memory.
+struct SSDTierStat {
+  uint64_t mem_hit = 0;
+  uint64_t ssd_hit = 0;
+  // keys found neither in memory nor in rocksdb
+  uint64_t miss = 0;
+  // keys moved from rocksdb to memory, and back by eviction
+  uint64_t admit = 0;
+  uint64_t evict = 0;
+  uint64_t prefetch_num = 0;
+  uint64_t prefetch_us = 0;
+};
+
+// With FLAGS_pserver_ssd_tiered_mode, memory is a cache of the hot keys over
+// rocksdb: a key pulled or pushed is only moved to, or created in, memory
+// once a FrequencySketch of the shard has seen it pulled
+// FLAGS_pserver_ssd_admit_frequency times, the cold keys are served and
+// updated in rocksdb. The shards over FLAGS_pserver_ssd_hot_keys_per_shard
+// keys write their least frequent keys back to rocksdb in the background.
 class SSDSparseTable : public MemorySparseTable {
  public:
   typedef SparseTableShard<uint64_t, FixedFeatureValue> shard_type;
   SSDSparseTable() {}
-  virtual ~SSDSparseTable() {}
+  // the evictions still queued use the sketches
+  virtual ~SSDSparseTable() { WaitEviction(); }
 
   int32_t Initialize() override;
   int32_t InitializeShard() override;
@@ -88,6 +112,7 @@ class SSDSparseTable : public MemorySparseTable {
   int32_t Flush() override { return 0; }
   int32_t Shrink(const std::string& param) override;
   void Clear() override {
+    WaitEviction();
     for (int i = 0; i < _real_local_shard_num; ++i) {
       _local_shards[i].clear();
     }
@@ -134,8 +159,53 @@ class SSDSparseTable : public MemorySparseTable {
 
   void SetDayId(int day_id) override;
 
+  SSDTierStat GetTierStat() const;
+
+ protected:
+  int32_t SaveShardCheckpoint(int shard_id,
+                              int save_param,
+                              SparseCheckpointWriter* writer) override;
+  int32_t LoadShardCheckpoint(int shard_id,
+                              const SparseCheckpointReader& reader) override;
+
  private:
+  // Read the batch_keys of item from rocksdb on the prefetch pool, which is
+  // only created in tiered mode. Otherwise they are read when the future is
+  // waited for.
+  std::future<int> PrefetchFromSSD(int shard_id, RocksDBItem* item);
+  // Update the keys of a push which are not in memory and not admitted by
+  // the sketch of the shard in rocksdb, creating the new ones there. The
+  // others are appended to hot_keys, after the admitted keys of rocksdb are
+  // moved to memory, for the caller to update them in memory.
+  void PushColdKeys(int shard_id,
+                    const std::vector<std::pair<uint64_t, int>>& keys,
+                    const std::function<const float*(int)>& update_data_of,
+                    std::vector<std::pair<uint64_t, int>>* hot_keys);
+  // Whether a key out of memory stays in rocksdb, it is never so out of
+  // tiered mode.
+  bool IsColdKey(int shard_id, uint64_t key);
+  bool NeedEviction(int shard_id);
+  void ScheduleEviction(int shard_id);
+  // Write the least frequent keys of the shard back to rocksdb, runs on the
+  // task pool of the shard.
+  int EvictColdKeys(int shard_id);
+  // Wait for the scheduled evictions.
+  void WaitEviction();
+
   RocksDBHandler* _db;
+  std::shared_ptr<::ThreadPool> _prefetch_pool;
+  // only accessed by the task pool of the shard
+  std::vector<FrequencySketch> _hot_sketches;
+  std::unique_ptr<std::atomic<bool>[]> _evict_pending;
+  struct {
+    std::atomic<uint64_t> mem_hit{0};
+    std::atomic<uint64_t> ssd_hit{0};
+    std::atomic<uint64_t> miss{0};
+    std::atomic<uint64_t> admit{0};
+    std::atomic<uint64_t> evict{0};
+    std::atomic<uint64_t> prefetch_num{0};
+    std::atomic<uint64_t> prefetch_us{0};
+  } _tier_stat;
   int64_t _cache_tk_size;
   double _local_show_threshold{0.0};
   std::vector<paddle::framework::Channel<std::string>> _fs_channel;
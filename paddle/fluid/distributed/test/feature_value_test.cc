@@ -14,8 +14,11 @@ limitations under the License. */
 
 #include "paddle/fluid/distributed/ps/table/depends/feature_value.h"
 
+#include <thread>  // NOLINT
 #include <vector>
 
+#include "paddle/fluid/distributed/ps/table/depends/concurrent_feature_value.h"
+
 #include "gtest/gtest.h"
 
 namespace paddle::distributed {
@@ -45,4 +48,70 @@ TEST(BENCHMARK, LargeScaleKV) {
   ASSERT_FLOAT_EQ(value_data[3], 0.3);
 }
 
+TEST(ConcurrentSparseTableShard, FindWhileInsert) {
+  typedef ConcurrentSparseTableShard<uint64_t> shard_type;
+  shard_type shard;
+  size_t size = 0;
+  ASSERT_TRUE(shard.Find(1, &size) == nullptr);
+
+  const uint64_t key_num = 20000;
+  const int writer_num = 4;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < writer_num; ++t) {
+    threads.emplace_back([&shard, t, key_num]() {
+      for (uint64_t key = t; key < key_num; key += writer_num) {
+        std::vector<float> init = {static_cast<float>(key), 0.0, 1.0};
+        std::lock_guard<shard_type::mutex_type> guard(shard.Mutex(key));
+        size_t size = 0;
+        shard.EmplaceLocked(key, init.data(), 2, &size);
+        if (key % 2 == 0) {
+          // moves the value to the entries of 3 floats
+          shard.ResizeLocked(key, init.data(), init.size());
+        }
+      }
+    });
+  }
+  // readers never see a partially created or moved value
+  threads.emplace_back([&shard, key_num]() {
+    for (uint64_t key = 0; key < key_num; ++key) {
+      size_t size = 0;
+      float* data = shard.Find(key, &size);
+      if (data != nullptr) {
+        ASSERT_GE(size, 2UL);
+        ASSERT_FLOAT_EQ(data[0], static_cast<float>(key));
+      }
+    }
+  });
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(shard.size(), key_num);
+  for (uint64_t key = 0; key < key_num; ++key) {
+    float* data = shard.Find(key, &size);
+    ASSERT_TRUE(data != nullptr);
+    ASSERT_EQ(size, key % 2 == 0 ? 3UL : 2UL);
+    ASSERT_FLOAT_EQ(data[0], static_cast<float>(key));
+  }
+
+  // compacts the pages, the moved values are kept
+  size_t erased = shard.EraseIf([](const uint64_t& key, float*, size_t) {
+    return key % 4 == 0;
+  });
+  ASSERT_EQ(erased, key_num / 4);
+  ASSERT_EQ(shard.size(), key_num - key_num / 4);
+  ASSERT_TRUE(shard.Find(4, &size) == nullptr);
+  float* data = shard.Find(6, &size);
+  ASSERT_TRUE(data != nullptr);
+  ASSERT_EQ(size, 3UL);
+  ASSERT_FLOAT_EQ(data[2], 1.0);
+
+  size_t visited = 0;
+  shard.ForEach([&visited](const uint64_t& key, float* data, size_t size) {
+    ASSERT_FLOAT_EQ(data[0], static_cast<float>(key));
+    ++visited;
+  });
+  ASSERT_EQ(visited, shard.size());
+}
+
 }  // namespace paddle::distributed
@@ -0,0 +1,64 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/common/frequency_sketch.h"
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace distributed {
+
+TEST(FrequencySketch, Estimate) {
+  FrequencySketch sketch(1024);
+  for (uint64_t key = 0; key < 1000; ++key) {
+    for (uint64_t i = 0; i <= key % 8; ++i) {
+      sketch.Increment(key);
+    }
+  }
+  int exact = 0;
+  for (uint64_t key = 0; key < 1000; ++key) {
+    int frequency = sketch.Estimate(key);
+    // a count-min sketch never underestimates
+    ASSERT_GE(frequency, static_cast<int>(key % 8 + 1));
+    if (frequency == static_cast<int>(key % 8 + 1)) {
+      ++exact;
+    }
+  }
+  ASSERT_GT(exact, 900);
+  ASSERT_EQ(sketch.Estimate(1000000), 0);
+}
+
+TEST(FrequencySketch, Saturate) {
+  FrequencySketch sketch(16);
+  for (int i = 0; i < 100; ++i) {
+    sketch.Increment(7);
+  }
+  ASSERT_EQ(sketch.Estimate(7), FrequencySketch::kMaxFrequency);
+}
+
+TEST(FrequencySketch, Decay) {
+  FrequencySketch sketch(16);
+  for (int i = 0; i < 8; ++i) {
+    sketch.Increment(1);
+  }
+  ASSERT_EQ(sketch.Estimate(1), 8);
+  // the counters are halved after 10 increments per word
+  for (uint64_t key = 100; key < 100 + 16 * 10; ++key) {
+    sketch.Increment(key);
+  }
+  ASSERT_LT(sketch.Estimate(1), 8);
+}
+
+}  // namespace distributed
+}  // namespace paddle
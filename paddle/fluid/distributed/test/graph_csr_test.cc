@@ -0,0 +1,136 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/table/common_graph_table.h"
+#include "paddle/fluid/distributed/ps/table/graph/graph_csr.h"
+
+namespace distributed = paddle::distributed;
+
+namespace {
+
+// Node i has 40 * i neighbors 1000 * i + j, the odd ones weighted 0.
+void BuildShard(distributed::GraphShard *shard) {
+  for (uint64_t i = 0; i < 5; ++i) {
+    auto *node = shard->add_graph_node(i);
+    node->build_edges(true);
+    for (uint64_t j = 0; j < 40 * i; ++j) {
+      node->add_edge(1000 * i + j, j % 2 ? 0.0 : 1.0 + j);
+    }
+    node->build_sampler("weighted");
+  }
+}
+
+}  // namespace
+
+TEST(GraphCSR, FreezeAndThaw) {
+  distributed::GraphShard shard;
+  BuildShard(&shard);
+  shard.freeze(true);
+  ASSERT_TRUE(shard.is_frozen());
+  const distributed::GraphCSR *csr = shard.get_csr();
+  ASSERT_EQ(csr->get_row_num(), 5UL);
+  ASSERT_EQ(csr->get_edge_num(), 400UL);
+  for (uint64_t i = 0; i < 5; ++i) {
+    auto *node = shard.find_node(i);
+    ASSERT_EQ(node->get_neighbor_size(), 40 * i);
+    for (size_t j = 0; j < node->get_neighbor_size(); ++j) {
+      ASSERT_EQ(node->get_neighbor_id(j), 1000 * i + j);
+      ASSERT_FLOAT_EQ(static_cast<float>(node->get_neighbor_weight(j)),
+                      j % 2 ? 0.0 : 1.0 + j);
+    }
+  }
+
+  // A frozen shard rejects new nodes and edges until it is thawed, the
+  // frozen edges are kept.
+  ASSERT_THROW(shard.add_neighbor(1, 7, 1.0), common::enforce::EnforceNotMet);
+  ASSERT_THROW(shard.add_graph_node(5), common::enforce::EnforceNotMet);
+  ASSERT_EQ(shard.get_size(), 5UL);
+  shard.thaw();
+  ASSERT_FALSE(shard.is_frozen());
+  shard.add_neighbor(1, 7, 1.0);
+  auto *node = shard.find_node(1);
+  ASSERT_EQ(node->get_neighbor_size(), 41UL);
+  ASSERT_EQ(node->get_neighbor_id(39), 1039UL);
+  ASSERT_EQ(node->get_neighbor_id(40), 7UL);
+}
+
+TEST(GraphCSR, SampleK) {
+  distributed::GraphShard shard;
+  BuildShard(&shard);
+  shard.freeze(true);
+  auto rng = std::make_shared<std::mt19937_64>(1);
+  for (const char *sample_type : {"random", "weighted"}) {
+    shard.set_sample_type(sample_type);
+    for (uint64_t i = 0; i < 5; ++i) {
+      auto *node = shard.find_node(i);
+      int degree = static_cast<int>(node->get_neighbor_size());
+      for (int k : {0, 3, 70, 100, 200}) {
+        auto res = node->sample_k(k, rng);
+        std::unordered_set<int> unique(res.begin(), res.end());
+        ASSERT_EQ(unique.size(), res.size());
+        ASSERT_EQ(static_cast<int>(res.size()), std::min(k, degree));
+        for (int idx : res) {
+          ASSERT_GE(idx, 0);
+          ASSERT_LT(idx, degree);
+          // The neighbors weighted 0 are only sampled when the others are
+          // not enough.
+          if (std::string(sample_type) == "weighted" && 2 * k <= degree) {
+            ASSERT_EQ(idx % 2, 0);
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(GraphCSR, WeightedSampleKBatch) {
+  // Neighbor j is weighted j, so neighbor 0 is never sampled.
+  distributed::GraphShard shard;
+  auto *node = shard.add_graph_node(0);
+  node->build_edges(true);
+  for (uint64_t j = 0; j < 10; ++j) {
+    node->add_edge(j, j);
+  }
+  shard.freeze(true);
+  shard.set_sample_type("weighted");
+  const distributed::GraphCSR *csr = shard.get_csr();
+  auto rng = std::make_shared<std::mt19937_64>(1);
+
+  std::vector<size_t> rows(45000, 0);
+  std::vector<std::vector<int>> res;
+  csr->sample_k_batch(rows, 1, rng, &res);
+  std::vector<int> counts(10, 0);
+  for (auto &sampled : res) {
+    ASSERT_EQ(sampled.size(), 1UL);
+    counts[sampled[0]]++;
+  }
+  for (int j = 0; j < 10; ++j) {
+    ASSERT_NEAR(counts[j], 1000 * j, 250);
+  }
+
+  csr->sample_k_batch(rows, 4, rng, &res);
+  for (auto &sampled : res) {
+    std::unordered_set<int> unique(sampled.begin(), sampled.end());
+    ASSERT_EQ(unique.size(), 4UL);
+    ASSERT_EQ(unique.count(0), 0UL);
+  }
+}
@@ -0,0 +1,106 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_sample_cache.h"
+
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+
+struct TestResult {
+  size_t actual_size;
+  int value;
+};
+
+using TestCache = GraphSampleCache<uint64_t, TestResult>;
+
+}  // namespace
+
+TEST(GraphSampleCache, TTL) {
+  TestCache cache(1, 100, 3);
+  std::vector<std::pair<uint64_t, TestResult>> res;
+  uint64_t key = 5;
+  TestResult result{8, 1};
+  ASSERT_EQ(cache.query(0, &key, 1, res), LRUResponse::ok);
+  ASSERT_TRUE(res.empty());
+  ASSERT_EQ(cache.insert(0, &key, &result, 1), LRUResponse::ok);
+  for (size_t i = 0; i < cache.get_ttl(); ++i) {
+    res.clear();
+    cache.query(0, &key, 1, res);
+    ASSERT_EQ(res.size(), 1UL);
+    ASSERT_EQ(res[0].second.value, 1);
+  }
+  res.clear();
+  cache.query(0, &key, 1, res);
+  ASSERT_TRUE(res.empty());
+
+  SampleCacheStat stat = cache.get_stat();
+  ASSERT_EQ(stat.hit, 3UL);
+  ASSERT_EQ(stat.miss, 2UL);
+  ASSERT_EQ(stat.expire, 1UL);
+  ASSERT_EQ(stat.size, 0UL);
+  ASSERT_EQ(stat.memory_size, 0UL);
+}
+
+TEST(GraphSampleCache, HotKeysSurviveScan) {
+  TestCache cache(1, 100, 1000000);
+  std::vector<std::pair<uint64_t, TestResult>> res;
+  std::vector<uint64_t> hot_keys;
+  for (uint64_t key = 0; key < 50; ++key) {
+    hot_keys.push_back(key);
+    TestResult result{8, static_cast<int>(key)};
+    for (int i = 0; i < 5; ++i) {
+      cache.query(0, &key, 1, res);
+    }
+    cache.insert(0, &key, &result, 1);
+  }
+  // A scan of cold keys, the hot keys still being queried now and then.
+  for (uint64_t key = 1000; key < 11000; ++key) {
+    TestResult result{8, 0};
+    cache.query(0, &key, 1, res);
+    cache.insert(0, &key, &result, 1);
+    if (key % 200 == 0) {
+      cache.query(0, hot_keys.data(), hot_keys.size(), res);
+    }
+  }
+  res.clear();
+  cache.query(0, hot_keys.data(), hot_keys.size(), res);
+  ASSERT_GE(res.size(), 45UL);
+
+  SampleCacheStat stat = cache.get_stat();
+  ASSERT_LE(stat.size, 100UL);
+  ASSERT_GT(stat.reject, 9000UL);
+}
+
+TEST(GraphSampleCache, MemoryLimit) {
+  TestCache cache(2, 1000000, 5, 20000);
+  std::vector<std::pair<uint64_t, TestResult>> res;
+  for (uint64_t key = 0; key < 1000; ++key) {
+    TestResult result{1000, 0};
+    cache.query(key % 2, &key, 1, res);
+    cache.insert(key % 2, &key, &result, 1);
+  }
+  SampleCacheStat stat = cache.get_stat();
+  ASSERT_LE(stat.memory_size, 20000UL);
+  ASSERT_GT(stat.size, 0UL);
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,142 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/service/push_codec.h"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+
+COMMON_DECLARE_double(pserver_push_topk_ratio);
+
+namespace distributed = paddle::distributed;
+
+namespace {
+
+std::vector<float> RandomValues(size_t num) {
+  std::mt19937 rng(1);
+  std::normal_distribution<float> dist(0, 1);
+  std::vector<float> values(num);
+  for (auto &value : values) {
+    value = dist(rng);
+  }
+  return values;
+}
+
+}  // namespace
+
+TEST(PushCodec, RoundTrip) {
+  // 1000 values are 3 int8 blocks, the last one partial.
+  auto values = RandomValues(1000);
+  std::vector<float> decoded(values.size());
+  for (const char *name : {"Fp16PushCodec", "Bf16PushCodec", "Int8PushCodec"}) {
+    distributed::PushCodec *codec =
+        CREATE_PSCORE_CLASS(distributed::PushCodec, name);
+    std::unique_ptr<distributed::PushCodec> encoder(codec);
+    const distributed::PushCodec *decoder =
+        distributed::GetThreadLocalPushDecoder(name);
+    ASSERT_NE(decoder, nullptr);
+    std::string data;
+    encoder->Encode(values.data(), values.size(), &data);
+    ASSERT_LT(data.size(), values.size() * sizeof(float));
+    ASSERT_EQ(
+        decoder->Decode(data.data(), data.size(), decoded.data(), 1000), 0);
+    for (size_t i = 0; i < values.size(); ++i) {
+      ASSERT_NEAR(decoded[i], values[i], 0.04) << name;
+    }
+    ASSERT_EQ(
+        decoder->Decode(data.data(), data.size() - 1, decoded.data(), 1000),
+        -1);
+  }
+  ASSERT_EQ(distributed::GetThreadLocalPushDecoder("NoSuchCodec"), nullptr);
+}
+
+TEST(PushCodec, TopKErrorFeedback) {
+  auto values = RandomValues(1000);
+  std::vector<float> decoded(values.size());
+  std::vector<float> pushed(values.size(), 0);
+  distributed::TopKPushCodec codec;
+  ASSERT_TRUE(codec.IsPositional());
+  FLAGS_pserver_push_topk_ratio = 0.1;
+  std::string data;
+  for (int round = 0; round < 50; ++round) {
+    codec.Encode(values.data(), values.size(), &data);
+    ASSERT_EQ(data.size(), sizeof(uint32_t) + 100 * 2 * sizeof(float));
+    ASSERT_EQ(codec.Decode(data.data(), data.size(), decoded.data(), 1000), 0);
+    for (size_t i = 0; i < values.size(); ++i) {
+      pushed[i] += decoded[i];
+    }
+  }
+
+  // The values held back are all in the residual, pushing it whole makes
+  // up the sum of the gradients.
+  FLAGS_pserver_push_topk_ratio = 1.0;
+  std::vector<float> zeros(values.size(), 0);
+  codec.Encode(zeros.data(), zeros.size(), &data);
+  ASSERT_EQ(codec.Decode(data.data(), data.size(), decoded.data(), 1000), 0);
+  for (size_t i = 0; i < values.size(); ++i) {
+    ASSERT_NEAR(pushed[i] + decoded[i], 50 * values[i], 1e-3);
+  }
+  ASSERT_EQ(codec.Decode(data.data(), 3, decoded.data(), 1000), -1);
+  FLAGS_pserver_push_topk_ratio = 0.01;
+}
+
+TEST(PushCodec, TopKConcurrentEncode) {
+  // The push threads of a table share its encoder.
+  auto values = RandomValues(1000);
+  distributed::TopKPushCodec codec;
+  FLAGS_pserver_push_topk_ratio = 0.1;
+  const int thread_num = 4;
+  std::vector<std::vector<float>> pushed(thread_num,
+                                         std::vector<float>(values.size(), 0));
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_num; ++t) {
+    threads.emplace_back([&, t]() {
+      std::string data;
+      std::vector<float> decoded(values.size());
+      for (int round = 0; round < 50; ++round) {
+        codec.Encode(values.data(), values.size(), &data);
+        if (codec.Decode(data.data(), data.size(), decoded.data(), 1000) != 0) {
+          return;
+        }
+        for (size_t i = 0; i < values.size(); ++i) {
+          pushed[t][i] += decoded[i];
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  FLAGS_pserver_push_topk_ratio = 1.0;
+  std::vector<float> zeros(values.size(), 0);
+  std::vector<float> decoded(values.size());
+  std::string data;
+  codec.Encode(zeros.data(), zeros.size(), &data);
+  ASSERT_EQ(codec.Decode(data.data(), data.size(), decoded.data(), 1000), 0);
+  for (size_t i = 0; i < values.size(); ++i) {
+    float sum = decoded[i];
+    for (int t = 0; t < thread_num; ++t) {
+      sum += pushed[t][i];
+    }
+    ASSERT_NEAR(sum, thread_num * 50 * values[i], 1e-2);
+  }
+  FLAGS_pserver_push_topk_ratio = 0.01;
+}
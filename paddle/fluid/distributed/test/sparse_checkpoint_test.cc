@@ -0,0 +1,229 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/table/depends/sparse_checkpoint.h"
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/table/sparse_checkpoint_compact.h"
+#include "paddle/fluid/framework/io/fs.h"
+
+namespace paddle {
+namespace distributed {
+
+static void WriteCheckpoint(const std::string& path, size_t key_num) {
+  std::shared_ptr<FILE> fp(fopen(path.c_str(), "wb"), fclose);
+  ASSERT_NE(fp, nullptr);
+  FsWriteChannel channel;
+  channel.open(fp, FsChannelConfig());
+  SparseCheckpointWriter writer(&channel);
+  ASSERT_EQ(writer.WriteHeader(), 0);
+  std::vector<float> value(16);
+  for (size_t i = 0; i < key_num; ++i) {
+    size_t size = i % 2 == 0 ? 8 : 16;
+    for (size_t j = 0; j < size; ++j) {
+      value[j] = i * 100 + j;
+    }
+    ASSERT_EQ(writer.Append(i * 7, value.data(), size), 0);
+  }
+  ASSERT_EQ(writer.Finish(), 0);
+  channel.close();
+}
+
+// Every key of the delta gets the value {key}, or is erased if the key is odd.
+static void WriteDelta(const std::string& path,
+                       const std::vector<uint64_t>& keys) {
+  std::shared_ptr<FILE> fp(fopen(path.c_str(), "wb"), fclose);
+  ASSERT_NE(fp, nullptr);
+  FsWriteChannel channel;
+  channel.open(fp, FsChannelConfig());
+  SparseCheckpointWriter writer(&channel);
+  ASSERT_EQ(writer.WriteHeader(), 0);
+  for (uint64_t key : keys) {
+    float value = key;
+    ASSERT_EQ(writer.Append(key, &value, key % 2 == 0 ? 1 : 0), 0);
+  }
+  ASSERT_EQ(writer.Finish(), 0);
+  channel.close();
+}
+
+static void CheckCheckpoint(const SparseCheckpointReader& reader,
+                            size_t key_num) {
+  ASSERT_TRUE(reader.Verify());
+  ASSERT_EQ(reader.key_num(), key_num);
+  for (size_t i = 0; i < key_num; ++i) {
+    ASSERT_EQ(reader.key(i), i * 7);
+    ASSERT_EQ(reader.value_size(i), i % 2 == 0 ? 8UL : 16UL);
+    for (size_t j = 0; j < reader.value_size(i); ++j) {
+      ASSERT_EQ(reader.value(i)[j], i * 100 + j);
+    }
+  }
+}
+
+TEST(SparseCheckpoint, MapAndRead) {
+  std::string path = "sparse_checkpoint_test" SPARSE_CHECKPOINT_SUFFIX;
+  WriteCheckpoint(path, 1001);
+
+  SparseCheckpointReader mapped;
+  ASSERT_EQ(mapped.Map(path), 0);
+  CheckCheckpoint(mapped, 1001);
+
+  std::shared_ptr<FILE> fp(fopen(path.c_str(), "rb"), fclose);
+  FsReadChannel channel;
+  channel.open(fp, FsChannelConfig());
+  SparseCheckpointReader read;
+  ASSERT_EQ(read.Read(&channel), 0);
+  CheckCheckpoint(read, 1001);
+  remove(path.c_str());
+}
+
+TEST(SparseCheckpoint, Corrupted) {
+  std::string path = "sparse_checkpoint_corrupted" SPARSE_CHECKPOINT_SUFFIX;
+  WriteCheckpoint(path, 10);
+  {
+    std::shared_ptr<FILE> fp(fopen(path.c_str(), "r+b"), fclose);
+    fseek(fp.get(), kSparseCheckpointAlign + 4, SEEK_SET);
+    float bad = -1;
+    fwrite(&bad, sizeof(float), 1, fp.get());
+  }
+  SparseCheckpointReader reader;
+  ASSERT_EQ(reader.Map(path), 0);
+  ASSERT_FALSE(reader.Verify());
+
+  // truncated files are rejected before the blocks are touched
+  ASSERT_EQ(truncate(path.c_str(), 100), 0);
+  ASSERT_NE(reader.Map(path), 0);
+  remove(path.c_str());
+}
+
+TEST(SparseCheckpoint, MergeDelta) {
+  std::string base_path = "sparse_checkpoint_base" SPARSE_CHECKPOINT_SUFFIX;
+  std::string delta_path =
+      "sparse_checkpoint_delta" SPARSE_CHECKPOINT_DELTA_SUFFIX;
+  std::string merged_path =
+      "sparse_checkpoint_merged" SPARSE_CHECKPOINT_SUFFIX;
+  WriteCheckpoint(base_path, 10);
+  {
+    std::shared_ptr<FILE> fp(fopen(delta_path.c_str(), "wb"), fclose);
+    FsWriteChannel channel;
+    channel.open(fp, FsChannelConfig());
+    SparseCheckpointWriter writer(&channel);
+    std::vector<float> value(4, -1.0);
+    ASSERT_EQ(writer.WriteHeader(), 0);
+    // updated, erased and created
+    ASSERT_EQ(writer.Append(14, value.data(), value.size()), 0);
+    ASSERT_EQ(writer.Append(21, nullptr, 0), 0);
+    ASSERT_EQ(writer.Append(1000, value.data(), value.size()), 0);
+    ASSERT_EQ(writer.Finish(), 0);
+    channel.close();
+  }
+  SparseCheckpointReader base;
+  SparseCheckpointReader delta;
+  ASSERT_EQ(base.Map(base_path), 0);
+  ASSERT_EQ(delta.Map(delta_path), 0);
+  {
+    std::shared_ptr<FILE> fp(fopen(merged_path.c_str(), "wb"), fclose);
+    FsWriteChannel channel;
+    channel.open(fp, FsChannelConfig());
+    SparseCheckpointWriter writer(&channel);
+    ASSERT_EQ(MergeSparseCheckpoints({&base, &delta}, &writer), 10);
+    channel.close();
+  }
+
+  SparseCheckpointReader merged;
+  ASSERT_EQ(merged.Map(merged_path), 0);
+  ASSERT_TRUE(merged.Verify());
+  std::vector<uint64_t> keys;
+  for (size_t i = 0; i < merged.key_num(); ++i) {
+    keys.push_back(merged.key(i));
+  }
+  ASSERT_EQ(keys,
+            std::vector<uint64_t>({0, 7, 28, 35, 42, 49, 56, 63, 14, 1000}));
+  ASSERT_EQ(merged.value_size(2), 8UL);
+  ASSERT_EQ(merged.value(2)[7], 407);
+  ASSERT_EQ(merged.value_size(8), 4UL);
+  ASSERT_EQ(merged.value(8)[0], -1.0);
+  remove(base_path.c_str());
+  remove(delta_path.c_str());
+  remove(merged_path.c_str());
+}
+
+TEST(SparseCheckpoint, Compact) {
+  std::string base_dir = "sparse_checkpoint_compact_base";
+  std::vector<std::string> delta_dirs = {"sparse_checkpoint_compact_delta_0",
+                                         "sparse_checkpoint_compact_delta_1"};
+  std::string output_dir = "sparse_checkpoint_compact_output";
+  for (auto& dir : {base_dir, delta_dirs[0], delta_dirs[1], output_dir}) {
+    ::paddle::framework::localfs_remove(dir);
+    ::paddle::framework::localfs_mkdir(dir);
+  }
+  // part 0 has keys 0, 7 .. 63, part 1 has keys 0, 7 .. 28
+  WriteCheckpoint(base_dir + "/part-000-00000" SPARSE_CHECKPOINT_SUFFIX, 10);
+  WriteCheckpoint(base_dir + "/part-000-00001" SPARSE_CHECKPOINT_SUFFIX, 5);
+  // 14 is updated by both deltas, 7 and 21 are erased, 1000 is created
+  WriteDelta(delta_dirs[0] + "/part-000-00000" SPARSE_CHECKPOINT_DELTA_SUFFIX,
+             {14, 21, 7});
+  WriteDelta(delta_dirs[1] + "/part-000-00000" SPARSE_CHECKPOINT_DELTA_SUFFIX,
+             {1000, 14});
+  WriteDelta(delta_dirs[0] + "/part-000-00001" SPARSE_CHECKPOINT_DELTA_SUFFIX,
+             {});
+  WriteDelta(delta_dirs[1] + "/part-000-00001" SPARSE_CHECKPOINT_DELTA_SUFFIX,
+             {0, 28});
+
+  // a delta of a part is missing
+  ASSERT_EQ(CompactSparseCheckpoint(
+                base_dir, {delta_dirs[0], base_dir}, output_dir),
+            -1);
+  ASSERT_EQ(CompactSparseCheckpoint(base_dir, delta_dirs, output_dir), 14);
+
+  SparseCheckpointReader part_0;
+  ASSERT_EQ(
+      part_0.Map(output_dir + "/part-000-00000" SPARSE_CHECKPOINT_SUFFIX), 0);
+  ASSERT_TRUE(part_0.Verify());
+  std::vector<uint64_t> keys;
+  for (size_t i = 0; i < part_0.key_num(); ++i) {
+    keys.push_back(part_0.key(i));
+  }
+  ASSERT_EQ(keys, std::vector<uint64_t>({0, 28, 35, 42, 49, 56, 63, 1000, 14}));
+  ASSERT_EQ(part_0.value_size(1), 8UL);
+  ASSERT_EQ(part_0.value(1)[7], 407);
+  ASSERT_EQ(part_0.value_size(8), 1UL);
+  ASSERT_EQ(part_0.value(8)[0], 14);
+
+  SparseCheckpointReader part_1;
+  ASSERT_EQ(
+      part_1.Map(output_dir + "/part-000-00001" SPARSE_CHECKPOINT_SUFFIX), 0);
+  ASSERT_TRUE(part_1.Verify());
+  keys.clear();
+  for (size_t i = 0; i < part_1.key_num(); ++i) {
+    keys.push_back(part_1.key(i));
+  }
+  ASSERT_EQ(keys, std::vector<uint64_t>({7, 14, 21, 0, 28}));
+  ASSERT_EQ(part_1.value_size(3), 1UL);
+  ASSERT_EQ(part_1.value(3)[0], 0);
+  ASSERT_EQ(part_1.value_size(4), 1UL);
+  ASSERT_EQ(part_1.value(4)[0], 28);
+
+  part_0.Close();
+  part_1.Close();
+  for (auto& dir : {base_dir, delta_dirs[0], delta_dirs[1], output_dir}) {
+    ::paddle::framework::localfs_remove(dir);
+  }
+}
+
+}  // namespace distributed
+}  // namespace paddle
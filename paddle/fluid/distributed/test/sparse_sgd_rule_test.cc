@@ -16,6 +16,7 @@ limitations under the License. */
 
 #include <cmath>
 #include <iostream>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "paddle/fluid/distributed/the_one_ps.pb.h"
@@ -205,5 +206,80 @@ TEST(downpour_sparse_adam_test, test_init_and_update) {
     ASSERT_FLOAT_EQ(value[i], label[i]) << "i is " << i;
   }
 }
+
+// UpdateValueBatch gives the values of UpdateValue one by one.
+static void CheckUpdateValueBatch(SparseValueSGDRule* rule,
+                                  size_t embed_dim) {
+  const size_t kNum = 17;
+  const size_t value_dim = embed_dim + rule->Dim();
+  std::vector<float> values(kNum * value_dim);
+  std::vector<float> grads(kNum * embed_dim);
+  std::vector<float> scales(kNum);
+  for (size_t i = 0; i < kNum; ++i) {
+    rule->InitValue(&values[i * value_dim],
+                    &values[i * value_dim + embed_dim],
+                    false);
+    scales[i] = static_cast<float>(i % 3 + 1);
+    for (size_t j = 0; j < embed_dim; ++j) {
+      grads[i * embed_dim + j] = std::sin(static_cast<float>(i * 31 + j));
+    }
+  }
+  std::vector<float> batch_values = values;
+  std::vector<float*> w(kNum);
+  std::vector<float*> sgd(kNum);
+  std::vector<const float*> push_values(kNum);
+  for (size_t i = 0; i < kNum; ++i) {
+    w[i] = &batch_values[i * value_dim];
+    sgd[i] = w[i] + embed_dim;
+    push_values[i] = &grads[i * embed_dim];
+  }
+  for (int step = 0; step < 3; ++step) {
+    for (size_t i = 0; i < kNum; ++i) {
+      rule->UpdateValue(&values[i * value_dim],
+                        &values[i * value_dim + embed_dim],
+                        &grads[i * embed_dim],
+                        scales[i]);
+    }
+    rule->UpdateValueBatch(
+        w.data(), sgd.data(), push_values.data(), scales.data(), kNum);
+  }
+  for (size_t i = 0; i < values.size(); ++i) {
+    ASSERT_NEAR(batch_values[i], values[i], 1e-5 + std::fabs(values[i]) * 1e-5)
+        << "i is " << i;
+  }
+}
+
+TEST(sparse_sgd_rule_batch_test, update_value_batch) {
+  // 16 dims for the vectorized kernels, 9 dims for the tails
+  for (size_t embed_dim : {16, 9}) {
+    SparseCommonSGDRuleParameter param;
+    param.mutable_naive()->set_learning_rate(0.1);
+    param.mutable_naive()->set_initial_range(0.3);
+    SparseNaiveSGDRule naive_rule;
+    naive_rule.LoadConfig(param, embed_dim);
+    CheckUpdateValueBatch(&naive_rule, embed_dim);
+
+    param.mutable_adagrad()->set_learning_rate(0.1);
+    param.mutable_adagrad()->set_initial_g2sum(3.0);
+    param.mutable_adagrad()->set_initial_range(0.3);
+    SparseAdaGradSGDRule adagrad_rule;
+    adagrad_rule.LoadConfig(param, embed_dim);
+    CheckUpdateValueBatch(&adagrad_rule, embed_dim);
+
+    param.mutable_adam()->set_learning_rate(0.1);
+    param.mutable_adam()->set_initial_range(0.3);
+    param.mutable_adam()->set_beta1_decay_rate(0.9);
+    param.mutable_adam()->set_beta2_decay_rate(0.999);
+    param.mutable_adam()->set_ada_epsilon(1e-08);
+    SparseAdamSGDRule adam_rule;
+    adam_rule.LoadConfig(param, embed_dim);
+    CheckUpdateValueBatch(&adam_rule, embed_dim);
+
+    SparseSharedAdamSGDRule shared_adam_rule;
+    shared_adam_rule.LoadConfig(param, embed_dim);
+    CheckUpdateValueBatch(&shared_adam_rule, embed_dim);
+  }
+}
+
 }  // namespace distributed
 }  // namespace paddle
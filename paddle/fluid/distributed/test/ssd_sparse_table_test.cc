@@ -0,0 +1,162 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/table/ssd_sparse_table.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+#include "paddle/fluid/framework/io/fs.h"
+
+PD_DECLARE_bool(pserver_ssd_tiered_mode);
+PD_DECLARE_int32(pserver_ssd_admit_frequency);
+PD_DECLARE_int64(pserver_ssd_hot_keys_per_shard);
+PD_DECLARE_string(rocksdb_path);
+
+namespace paddle {
+namespace distributed {
+
+static const int kEmbedxDim = 8;
+
+static std::unique_ptr<SSDSparseTable> CreateTable() {
+  TableParameter table_config;
+  table_config.set_table_class("SSDSparseTable");
+  table_config.set_shard_num(10);
+  FsClientParameter fs_config;
+  std::unique_ptr<SSDSparseTable> table(new SSDSparseTable());
+  table->SetShard(0, 1);
+
+  TableAccessorParameter *accessor_config = table_config.mutable_accessor();
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(11);
+  accessor_config->set_embedx_dim(kEmbedxDim);
+  accessor_config->set_embedx_threshold(5);
+  accessor_config->mutable_ctr_accessor_param()->set_nonclk_coeff(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_click_coeff(1);
+  accessor_config->mutable_ctr_accessor_param()->set_base_threshold(0.5);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_threshold(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_keep_days(16);
+  accessor_config->mutable_ctr_accessor_param()->set_show_click_decay_rate(
+      0.99);
+  for (auto *sgd_param : {accessor_config->mutable_embed_sgd_param(),
+                          accessor_config->mutable_embedx_sgd_param()}) {
+    sgd_param->set_name("SparseNaiveSGDRule");
+    auto *naive_param = sgd_param->mutable_naive();
+    naive_param->set_learning_rate(0.1);
+    naive_param->set_initial_range(0.3);
+    naive_param->add_weight_bounds(-10.0);
+    naive_param->add_weight_bounds(10.0);
+  }
+  EXPECT_EQ(table->Initialize(table_config, fs_config), 0);
+  return table;
+}
+
+// Return the shows of the keys.
+static std::vector<float> Pull(SSDSparseTable *table,
+                               std::vector<uint64_t> keys) {
+  std::vector<uint32_t> frequencies(keys.size(), 1);
+  std::vector<float> values(keys.size() * (kEmbedxDim + 3));
+  TableContext context;
+  context.value_type = Sparse;
+  context.pull_context.pull_value =
+      PullSparseValue(keys, frequencies, kEmbedxDim);
+  context.pull_context.values = values.data();
+  EXPECT_EQ(table->Pull(context), 0);
+  std::vector<float> shows;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    shows.push_back(values[i * (kEmbedxDim + 3)]);
+  }
+  return shows;
+}
+
+// Push a show of 1 for every key.
+static void Push(SSDSparseTable *table, std::vector<uint64_t> keys) {
+  std::vector<float> values(keys.size() * (kEmbedxDim + 4), 0.1);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    values[i * (kEmbedxDim + 4)] = 0;      // slot
+    values[i * (kEmbedxDim + 4) + 1] = 1;  // show
+    values[i * (kEmbedxDim + 4) + 2] = 0;  // click
+  }
+  TableContext context;
+  context.value_type = Sparse;
+  context.push_context.keys = keys.data();
+  context.push_context.values = values.data();
+  context.num = keys.size();
+  EXPECT_EQ(table->Push(context), 0);
+}
+
+TEST(SSDSparseTable, TieredMode) {
+  FLAGS_rocksdb_path = "ssd_sparse_table_test_db";
+  ::paddle::framework::localfs_remove(FLAGS_rocksdb_path);
+  FLAGS_pserver_ssd_tiered_mode = true;
+  FLAGS_pserver_ssd_admit_frequency = 2;
+  FLAGS_pserver_ssd_hot_keys_per_shard = 10;
+  auto table = CreateTable();
+
+  // the keys pulled once are cold, they are created and updated in rocksdb
+  std::vector<uint64_t> keys = {1, 2, 3, 4, 5};
+  Pull(table.get(), keys);
+  Push(table.get(), keys);
+  EXPECT_EQ(table->LocalSize(), 0);
+  SSDTierStat stat = table->GetTierStat();
+  EXPECT_EQ(stat.miss, 5UL);
+  EXPECT_EQ(stat.admit, 0UL);
+
+  // admitted by the second pull, with the show pushed to rocksdb
+  std::vector<float> shows = Pull(table.get(), keys);
+  EXPECT_EQ(shows, std::vector<float>(keys.size(), 1));
+  EXPECT_EQ(table->LocalSize(), 5);
+  stat = table->GetTierStat();
+  EXPECT_EQ(stat.ssd_hit, 5UL);
+  EXPECT_EQ(stat.admit, 5UL);
+
+  // a hot key is updated in memory
+  Push(table.get(), keys);
+  shows = Pull(table.get(), keys);
+  EXPECT_EQ(shows, std::vector<float>(keys.size(), 2));
+  EXPECT_EQ(table->LocalSize(), 5);
+
+  // 12 keys of shard 0 are admitted, over the limit of 10, and the shard
+  // evicts to 9 keys. 10 is pulled once more to be kept.
+  std::vector<uint64_t> shard_keys;
+  for (uint64_t key = 10; key <= 120; key += 10) {
+    shard_keys.push_back(key);
+  }
+  Pull(table.get(), shard_keys);
+  Push(table.get(), shard_keys);
+  Pull(table.get(), {10});
+  Pull(table.get(), shard_keys);
+  // queued after the eviction on the task pool of shard 0
+  Pull(table.get(), {10});
+  stat = table->GetTierStat();
+  EXPECT_EQ(stat.admit, 17UL);
+  EXPECT_EQ(stat.evict, 3UL);
+  EXPECT_EQ(table->LocalSize(), 5 + 9);
+  // the evicted keys are served from rocksdb, and admitted again
+  shows = Pull(table.get(), shard_keys);
+  EXPECT_EQ(shows, std::vector<float>(shard_keys.size(), 1));
+  stat = table->GetTierStat();
+  EXPECT_EQ(stat.admit, 20UL);
+
+  table->Clear();
+  FLAGS_pserver_ssd_tiered_mode = false;
+  FLAGS_pserver_ssd_hot_keys_per_shard = 0;
+}
+
+}  // namespace distributed
+}  // namespace paddle
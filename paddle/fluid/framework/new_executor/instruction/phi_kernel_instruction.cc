@@ -27,6 +27,7 @@
 #include "paddle/phi/core/infermeta_utils.h"
 #include "paddle/phi/core/meta_tensor.h"
 #include "paddle/phi/core/platform/device_context.h"
+#include "paddle/phi/core/tensor_utils.h"
 #include "paddle/phi/core/type_defs.h"
 #include "paddle/pir/include/core/builtin_attribute.h"
 #include "paddle/pir/include/core/operation.h"
@@ -175,17 +176,106 @@ PhiKernelInstruction::PhiKernelInstruction(
   }
   SetNoNeedBuffer(no_need_buffer_values);
   VLOG(6) << "finish process no need buffer";
+
+  InitInferMetaCache(yaml_info_parser);
 }
 
 PhiKernelInstruction::~PhiKernelInstruction() { delete phi_kernel_; }
 
+void PhiKernelInstruction::InitInferMetaCache(
+    const paddle::dialect::OpYamlInfoParser& yaml_info_parser) {
+  if (!infer_meta_interface_) return;
+  // The mutable attributes are read from the values of tensors.
+  auto& name2id = yaml_info_parser.InputName2Id();
+  for (auto& t : yaml_info_parser.AttrParams(false)) {
+    if (name2id.count(t)) return;
+  }
+  for (auto value : op_->operands_source()) {
+    if (!IsInvalid(value)) {
+      meta_inputs_.push_back(nullptr);
+      continue;
+    }
+    Variable* var = value_exec_info_->GetVarByValue(value);
+    if (!value.type().isa<paddle::dialect::AllocatedDenseTensorType>() ||
+        var == nullptr || !var->IsType<phi::DenseTensor>()) {
+      meta_inputs_.clear();
+      return;
+    }
+    meta_inputs_.push_back(&(var->Get<phi::DenseTensor>()));
+  }
+  for (auto value : op_->results()) {
+    if (!IsInvalid(value)) {
+      meta_outputs_.push_back(nullptr);
+      continue;
+    }
+    Variable* var = value_exec_info_->GetVarByValue(value);
+    if (!value.type().isa<paddle::dialect::AllocatedDenseTensorType>() ||
+        var == nullptr || !var->IsType<phi::DenseTensor>()) {
+      meta_inputs_.clear();
+      meta_outputs_.clear();
+      return;
+    }
+    meta_outputs_.push_back(var->GetMutable<phi::DenseTensor>());
+  }
+  infer_meta_cacheable_ = true;
+}
+
+void PhiKernelInstruction::SetShapeBucketCache(
+    interpreter::ShapeBucketCache* cache) {
+  if (!infer_meta_cacheable_) return;
+  shape_bucket_cache_ = cache;
+  infer_meta_cache_.clear();
+  if (cache != nullptr) {
+    infer_meta_cache_.resize(cache->capacity());
+  }
+}
+
+void PhiKernelInstruction::RunInferMeta() {
+  if (shape_bucket_cache_ == nullptr) {
+    infer_meta_interface_->infer_meta_(&(infer_meta_context_));
+    return;
+  }
+  auto& entry = infer_meta_cache_[shape_bucket_cache_->slot()];
+  bool hit = entry.generation == shape_bucket_cache_->generation();
+  for (size_t i = 0; hit && i < meta_inputs_.size(); ++i) {
+    hit = meta_inputs_[i] == nullptr ||
+          entry.inputs[i] == meta_inputs_[i]->meta();
+  }
+  if (hit) {
+    for (size_t i = 0; i < meta_outputs_.size(); ++i) {
+      if (meta_outputs_[i] == nullptr) continue;
+      // The offset is where the holder is viewed from, not a meta to infer.
+      auto* meta = phi::DenseTensorUtils::GetMutableMeta(meta_outputs_[i]);
+      size_t offset = meta->offset;
+      *meta = entry.outputs[i];
+      meta->offset = offset;
+    }
+    shape_bucket_cache_->AddInferMetaHit();
+    return;
+  }
+
+  entry.inputs.resize(meta_inputs_.size());
+  for (size_t i = 0; i < meta_inputs_.size(); ++i) {
+    if (meta_inputs_[i] != nullptr) entry.inputs[i] = meta_inputs_[i]->meta();
+  }
+  infer_meta_interface_->infer_meta_(&(infer_meta_context_));
+  entry.outputs.resize(meta_outputs_.size());
+  for (size_t i = 0; i < meta_outputs_.size(); ++i) {
+    if (meta_outputs_[i] != nullptr) {
+      entry.outputs[i] = meta_outputs_[i]->meta();
+    }
+  }
+  entry.generation = shape_bucket_cache_->generation();
+  shape_bucket_cache_->AddInferMetaMiss();
+}
+
 void PhiKernelInstruction::Run() {
   VLOG(6) << "Begin run op " << phi_op_name_ << " infer meta.";
   if (infer_meta_interface_) {
     phi::RecordEvent record_event("PhiKernelInstruction::infermeta",
                                   phi::TracerEventType::UserDefined,
                                   1);
-    infer_meta_interface_->infer_meta_(&(infer_meta_context_));
+    RunInferMeta();
   }
   VLOG(6) << "End run op " << phi_op_name_ << " infer meta.";
   for (auto& pair : this->InplaceInfo()) {
@@ -15,11 +15,18 @@
 #pragma once
 
 #include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
+#include "paddle/fluid/framework/new_executor/interpreter/shape_bucket_cache.h"
 
 namespace pir {
 class Operation;
 }  // namespace pir
 
+namespace paddle {
+namespace dialect {
+class OpYamlInfoParser;
+}  // namespace dialect
+}  // namespace paddle
+
 namespace paddle {
 namespace framework {
 class Scope;
@@ -52,7 +59,16 @@ class PhiKernelInstruction : public InstructionBase {
 
   const std::string& Name() const override { return phi_op_name_; }
 
+  // Reuse the inferred meta of the runs of the same input metas, only for
+  // the instructions whose meta depends on the metas of their inputs alone.
+  void SetShapeBucketCache(interpreter::ShapeBucketCache* cache);
+
  private:
+  void InitInferMetaCache(
+      const paddle::dialect::OpYamlInfoParser& yaml_info_parser);
+
+  void RunInferMeta();
+
   paddle::dialect::InferMetaInterface::Concept* infer_meta_interface_{
       nullptr};  // not owned
 
@@ -69,6 +85,18 @@ class PhiKernelInstruction : public InstructionBase {
   ::pir::Operation* op_{nullptr};  // not owned
 
   const ValueExecutionInfo* value_exec_info_;  // not owned
+
+  bool infer_meta_cacheable_{false};
+
+  interpreter::ShapeBucketCache* shape_bucket_cache_{nullptr};  // not owned
+
+  // The tensors of the operands and results, nullptr for the null ones.
+  std::vector<const phi::DenseTensor*> meta_inputs_;
+
+  std::vector<phi::DenseTensor*> meta_outputs_;
+
+  // One entry per slot of shape_bucket_cache_.
+  std::vector<interpreter::InferMetaCacheEntry> infer_meta_cache_;
 };
 
 }  // namespace framework
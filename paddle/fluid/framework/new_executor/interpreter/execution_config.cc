@@ -14,6 +14,7 @@
 
 #include "paddle/fluid/framework/new_executor/interpreter/execution_config.h"
 
+#include <algorithm>
 #include <set>
 #include <thread>
 
@@ -23,12 +24,14 @@
 #include "paddle/phi/backends/xpu/xpu_info.h"
 
 PD_DECLARE_bool(new_executor_serial_run);
+PD_DECLARE_bool(new_executor_use_work_stealing);
 
 namespace paddle::framework::interpreter {
 
 static constexpr size_t kHostNumThreads = 4;
 static constexpr size_t kDeviceNumThreads = 1;
 static constexpr size_t kNumGcThreads = 1;
+static constexpr int kMaxWorkStealingHostNumThreads = 16;
 
 // By default, one interpretercore contains:
 // 1-size thread pool for device kernel launch (or 0 for cpu execution),
@@ -47,6 +50,15 @@ inline std::tuple<int, int> GetThreadPoolConfig(const phi::Place& place,
   if (phi::is_cpu_place(place)) {
     num_device_threads = 0;
     num_host_threads = 4;
+    // With work stealing, wide graphs can use more host threads. Every
+    // interpretercore has its own pool, so it still gets half of the cores
+    // at most, and no more than kMaxWorkStealingHostNumThreads.
+    if (FLAGS_new_executor_use_work_stealing) {
+      processor_count = static_cast<int>(std::thread::hardware_concurrency());
+      num_host_threads = std::max(
+          num_host_threads,
+          std::min(processor_count / 2, kMaxWorkStealingHostNumThreads));
+    }
   } else {
     processor_count = static_cast<int>(std::thread::hardware_concurrency());
     if (processor_count) {
@@ -113,8 +125,13 @@ inline std::tuple<int, int> GetThreadPoolConfig(const phi::Place& place,
 void ExecutionConfig::AnalyzeThreadPoolConfig(const phi::Place& place,
                                               size_t op_num) {
   if (host_num_threads == 0 || device_num_threads == 0) {
-    std::tie(host_num_threads, device_num_threads) =
+    size_t num_host_threads = 0;
+    std::tie(num_host_threads, device_num_threads) =
         GetThreadPoolConfig(place, op_num);
+    // A host pool size given in the config is kept, unless in serial run.
+    if (host_num_threads == 0 || FLAGS_new_executor_serial_run) {
+      host_num_threads = num_host_threads;
+    }
   }
 }
 
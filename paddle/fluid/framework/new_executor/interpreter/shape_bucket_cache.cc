@@ -0,0 +1,83 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/new_executor/interpreter/shape_bucket_cache.h"
+
+#include "paddle/common/enforce.h"
+
+namespace paddle {
+namespace framework {
+namespace interpreter {
+
+ShapeBucketCache::ShapeBucketCache(size_t capacity) : capacity_(capacity) {
+  PADDLE_ENFORCE_GT(capacity,
+                    0UL,
+                    common::errors::InvalidArgument(
+                        "The capacity of ShapeBucketCache should be larger "
+                        "than 0."));
+}
+
+void ShapeBucketCache::Select(
+    const std::vector<const phi::DenseTensor*>& feeds) {
+  auto matches = [&feeds](const Bucket& bucket) {
+    if (bucket.feeds.size() != feeds.size()) return false;
+    for (size_t i = 0; i < feeds.size(); ++i) {
+      if (!(bucket.feeds[i] == feeds[i]->meta())) return false;
+    }
+    return true;
+  };
+  for (auto it = buckets_.begin(); it != buckets_.end(); ++it) {
+    if (matches(*it)) {
+      buckets_.splice(buckets_.begin(), buckets_, it);
+      slot_ = buckets_.front().slot;
+      generation_ = buckets_.front().generation;
+      ++bucket_hits_;
+      return;
+    }
+  }
+
+  ++bucket_misses_;
+  Bucket bucket;
+  if (buckets_.size() < capacity_) {
+    bucket.slot = buckets_.size();
+  } else {
+    bucket.slot = buckets_.back().slot;
+    buckets_.pop_back();
+  }
+  // A new generation makes the entries of the slot left by the evicted
+  // bucket stale.
+  bucket.generation = next_generation_++;
+  bucket.feeds.reserve(feeds.size());
+  for (auto* feed : feeds) {
+    bucket.feeds.push_back(feed->meta());
+  }
+  slot_ = bucket.slot;
+  generation_ = bucket.generation;
+  buckets_.push_front(std::move(bucket));
+  VLOG(6) << "New shape bucket in slot " << slot_ << " of generation "
+          << generation_;
+}
+
+ShapeBucketCacheStats ShapeBucketCache::GetStats() const {
+  ShapeBucketCacheStats stats;
+  stats.bucket_hits = bucket_hits_;
+  stats.bucket_misses = bucket_misses_;
+  stats.infer_meta_hits = infer_meta_hits_.load(std::memory_order_relaxed);
+  stats.infer_meta_misses = infer_meta_misses_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+}  // namespace interpreter
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,93 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <vector>
+
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace paddle {
+namespace framework {
+namespace interpreter {
+
+struct ShapeBucketCacheStats {
+  // Runs whose feed metas were in the cache or not.
+  uint64_t bucket_hits{0};
+  uint64_t bucket_misses{0};
+  // Instructions that reused the cached meta or ran InferMeta.
+  uint64_t infer_meta_hits{0};
+  uint64_t infer_meta_misses{0};
+};
+
+// The metas of the inputs and outputs of one instruction in one bucket.
+struct InferMetaCacheEntry {
+  // 0 if the entry is empty.
+  uint64_t generation{0};
+  std::vector<phi::DenseTensorMeta> inputs;
+  std::vector<phi::DenseTensorMeta> outputs;
+};
+
+// ShapeBucketCache keeps the buckets of the feed metas of the recent runs,
+// at most capacity of them, the least recently used one is given to new
+// feed metas. Each instruction keeps its InferMetaCacheEntry per slot of
+// the cache, and reuses it if it has the generation of the slot and its
+// inputs have the same metas as now.
+class ShapeBucketCache {
+ public:
+  explicit ShapeBucketCache(size_t capacity);
+
+  // Selects the bucket of the current metas of feeds.
+  void Select(const std::vector<const phi::DenseTensor*>& feeds);
+
+  size_t capacity() const { return capacity_; }
+  size_t slot() const { return slot_; }
+  uint64_t generation() const { return generation_; }
+
+  void AddInferMetaHit() {
+    infer_meta_hits_.fetch_add(1, std::memory_order_relaxed);
+  }
+  void AddInferMetaMiss() {
+    infer_meta_misses_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  ShapeBucketCacheStats GetStats() const;
+
+ private:
+  struct Bucket {
+    std::vector<phi::DenseTensorMeta> feeds;
+    size_t slot;
+    uint64_t generation;
+  };
+
+  size_t capacity_;
+  // Most recently used first.
+  std::list<Bucket> buckets_;
+  uint64_t next_generation_{1};
+
+  size_t slot_{0};
+  uint64_t generation_{0};
+
+  uint64_t bucket_hits_{0};
+  uint64_t bucket_misses_{0};
+  std::atomic<uint64_t> infer_meta_hits_{0};
+  std::atomic<uint64_t> infer_meta_misses_{0};
+};
+
+}  // namespace interpreter
+}  // namespace framework
+}  // namespace paddle
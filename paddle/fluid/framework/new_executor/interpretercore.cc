@@ -23,6 +23,13 @@ PHI_DEFINE_EXPORTED_bool(
     new_executor_serial_run,
     false,
     "Enable serial execution for standalone executor, used for debug.");
+PHI_DEFINE_EXPORTED_bool(
+    new_executor_use_work_stealing,
+    false,
+    "Enable work stealing scheduling for standalone executor. Ready host "
+    "instructions of the same scheduling priority are ordered by their "
+    "critical path length, and spread over the host thread pool so that idle "
+    "threads can steal them.");
 PHI_DEFINE_EXPORTED_bool(
     new_executor_static_build,
     false,
@@ -349,6 +349,10 @@ namespace interpreter {
 static constexpr char kMemcpyH2D[] = "memcpy_h2d";
 static constexpr char kMemcpyD2H[] = "memcpy_d2h";
 static constexpr char kFetchVarName[] = "fetch";
+// Set by memory_plan_pass: the offsets in the arena of the results of an op,
+// -1 for the results not planned, and the arena size on the module op.
+static constexpr char kMemoryPlanOffsets[] = "memory_plan_offsets";
+static constexpr char kMemoryPlanArenaSize[] = "memory_plan_arena_size";
 
 // static_ref_ is the numer of last live ops calculated to statically after
 // `build` the Instructions. dynamic_ref_  is the runtime version ref which will
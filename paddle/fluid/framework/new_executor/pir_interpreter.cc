@@ -14,7 +14,9 @@
 
 #include "paddle/fluid/framework/new_executor/pir_interpreter.h"
 
+#include <algorithm>
 #include <chrono>
+#include <numeric>
 #include <unordered_set>
 
 #include "paddle/common/flags.h"
@@ -28,6 +30,7 @@
 #include "paddle/fluid/platform/profiler/supplement_tracing.h"
 #include "paddle/phi/common/place.h"
 #include "paddle/phi/core/kernel_context.h"
+#include "paddle/phi/core/memory/malloc.h"
 #include "paddle/phi/core/os_info.h"
 #include "paddle/phi/core/platform/device/gpu/gpu_info.h"
 #include "paddle/phi/core/sparse_coo_tensor.h"
@@ -88,6 +91,7 @@ COMMON_DECLARE_bool(dynamic_static_unified_comm);
 COMMON_DECLARE_bool(enable_pir_in_executor);
 COMMON_DECLARE_bool(enable_pir_in_executor_trace_run);
 COMMON_DECLARE_bool(enable_collect_shape);
+COMMON_DECLARE_int32(pir_interpreter_shape_bucket_cache_size);
 COMMON_DECLARE_int32(low_precision_op_list);
 
 #define CREATE_INSTR(instr_name)                                   \
@@ -1092,6 +1096,91 @@ void PirInterpreter::BuildInstructionDependences() {
       }
     }
   }
+
+  if (FLAGS_new_executor_use_work_stealing) {
+    BuildCriticalPathLength(downstream_map);
+  }
+}
+
+void PirInterpreter::BuildCriticalPathLength(
+    const std::map<size_t, std::set<size_t>>& downstream_map) {
+  // The critical path length of an instruction is the length of the longest
+  // path from it to a sink. It only breaks the ties of the scheduling
+  // priorities, which keep the explicit order of communication ops.
+  size_t instr_num = vec_instruction_base_.size();
+  std::vector<size_t> in_degree(instr_num, 0);
+  for (auto& pair : downstream_map) {
+    for (size_t next_instr_id : pair.second) {
+      ++in_degree[next_instr_id];
+    }
+  }
+
+  std::vector<size_t> topo_order;
+  topo_order.reserve(instr_num);
+  for (size_t instr_id = 0; instr_id < instr_num; ++instr_id) {
+    if (in_degree[instr_id] == 0) {
+      topo_order.push_back(instr_id);
+    }
+  }
+  for (size_t i = 0; i < topo_order.size(); ++i) {
+    auto iter = downstream_map.find(topo_order[i]);
+    if (iter == downstream_map.end()) {
+      continue;
+    }
+    for (size_t next_instr_id : iter->second) {
+      if (--in_degree[next_instr_id] == 0) {
+        topo_order.push_back(next_instr_id);
+      }
+    }
+  }
+
+  std::vector<SchedulingPriority> path_length(instr_num, 1);
+  for (auto it = topo_order.rbegin(); it != topo_order.rend(); ++it) {
+    auto iter = downstream_map.find(*it);
+    if (iter == downstream_map.end()) {
+      continue;
+    }
+    for (size_t next_instr_id : iter->second) {
+      path_length[*it] =
+          std::max(path_length[*it], path_length[next_instr_id] + 1);
+    }
+  }
+
+  VLOG(4) << "Critical path length: "
+          << (instr_num == 0 ? 0
+                             : *std::max_element(path_length.begin(),
+                                                 path_length.end()));
+  critical_path_length_.swap(path_length);
+}
+
+bool PirInterpreter::WorkStealingPriorityLess(size_t lhs, size_t rhs) const {
+  SchedulingPriority lhs_scheduling_priority =
+      vec_instruction_base_[lhs]->GetSchedulingPriority();
+  SchedulingPriority rhs_scheduling_priority =
+      vec_instruction_base_[rhs]->GetSchedulingPriority();
+  if (lhs_scheduling_priority != rhs_scheduling_priority) {
+    return lhs_scheduling_priority > rhs_scheduling_priority;
+  }
+  if (lhs < critical_path_length_.size() &&
+      rhs < critical_path_length_.size() &&
+      critical_path_length_[lhs] != critical_path_length_[rhs]) {
+    return critical_path_length_[lhs] < critical_path_length_[rhs];
+  }
+  return lhs > rhs;
+}
+
+std::vector<::pir::Operation*> PirInterpreter::GetWorkStealingOrder() const {
+  std::vector<size_t> instr_ids(vec_instruction_base_.size());
+  std::iota(instr_ids.begin(), instr_ids.end(), 0);
+  std::sort(instr_ids.begin(), instr_ids.end(), [this](size_t lhs, size_t rhs) {
+    return WorkStealingPriorityLess(rhs, lhs);
+  });
+  std::vector<::pir::Operation*> order;
+  order.reserve(instr_ids.size());
+  for (size_t instr_id : instr_ids) {
+    order.push_back(vec_instruction_base_[instr_id]->Operation());
+  }
+  return order;
 }
 
 void PirInterpreter::RecordMemcpyD2H(InstructionBase* instr_node) {
@@ -1470,6 +1559,10 @@ paddle::framework::FetchList PirInterpreter::Run(
     PreAnalysis();
     VLOG(4) << "Done PreAnalysis";
 
+    BuildMemoryPlan();
+
+    BuildShapeBucketCache();
+
     if (FLAGS_enable_pir_in_executor_trace_run || onednn_op_num_ ||
         execution_config_.used_for_inference ||
         ((execution_config_.used_for_jit || execution_config_.used_for_cinn) &&
@@ -1554,6 +1647,10 @@ FetchList PirInterpreter::Run(const std::vector<std::string>& feed_names,
     PreAnalysis();
     VLOG(4) << "Done PreAnalysis";
 
+    BuildMemoryPlan();
+
+    BuildShapeBucketCache();
+
     // Run
     if (FLAGS_enable_pir_in_executor_trace_run || onednn_op_num_ ||
         execution_config_.used_for_inference ||
@@ -1607,6 +1704,8 @@ void PirInterpreter::TraceRunImpl() {
   }
 
   interpreter::ResetAtomicGuard guard(&deps_, &refs_);
+  BindMemoryPlan();
+  SelectShapeBucket();
   VLOG(4) << "Tracing Instruction List";
 
   TraceRunInstructionList(vec_instruction_base_);
@@ -1625,6 +1724,7 @@ void PirInterpreter::MultiThreadRunImpl() {
   }
 
   interpreter::ResetAtomicGuard guard(&deps_, &refs_);
+  SelectShapeBucket();
   VLOG(4) << "Multi Thread Run Instruction List";
 
   async_work_queue_ = GetWorkQueue();
@@ -1834,11 +1934,56 @@ void PirInterpreter::RunNextInstructions(InstructionBase* instr,
     return deps_[next_id]->CheckAndDecrease();
   };
 
+  auto AddTask = [this](size_t next_instr_id) {
+    async_work_queue_->AddTask(
+        vec_instruction_base_[next_instr_id]->KernelType(),
+        [this, next_instr_id]() { RunInstructionBaseAsync(next_instr_id); });
+  };
+
+  if (FLAGS_new_executor_use_work_stealing) {
+    // Ready host instructions are collected and ordered by priority. The most
+    // critical one runs next on this thread to keep its inputs in cache, the
+    // others go to the host pool. A pool worker pushes to the front of its
+    // own queue while idle workers steal from the back of a random victim,
+    // so they are pushed from the most to the least critical one.
+    SchedulingQueue ready_host_ops([this](size_t lhs, size_t rhs) {
+      return WorkStealingPriorityLess(lhs, rhs);
+    });
+    auto Dispatch = [&](size_t next_instr_id, bool same_thread) {
+      if (vec_instruction_base_[next_instr_id]->KernelType() !=
+          OpFuncType::kGpuAsync) {
+        ready_host_ops.push(next_instr_id);
+      } else if (same_thread) {
+        reserved_next_ops->push(next_instr_id);
+      } else {
+        AddTask(next_instr_id);
+      }
+    };
+    for (size_t next_instr_id : instr->NextInstrsInDifferenceThread()) {
+      if (IsReady(next_instr_id)) {
+        Dispatch(next_instr_id, /*same_thread=*/false);
+      }
+    }
+    for (size_t next_instr_id : instr->NextInstrsInSameThread()) {
+      if (IsReady(next_instr_id)) {
+        Dispatch(next_instr_id, /*same_thread=*/true);
+      }
+    }
+    if (!ready_host_ops.empty() &&
+        instr->KernelType() != OpFuncType::kGpuAsync) {
+      reserved_next_ops->push(ready_host_ops.top());
+      ready_host_ops.pop();
+    }
+    while (!ready_host_ops.empty()) {
+      AddTask(ready_host_ops.top());
+      ready_host_ops.pop();
+    }
+    return;
+  }
+
   for (size_t next_instr_id : instr->NextInstrsInDifferenceThread()) {
     if (IsReady(next_instr_id)) {
-      async_work_queue_->AddTask(
-          vec_instruction_base_[next_instr_id]->KernelType(),
-          [this, next_instr_id]() { RunInstructionBaseAsync(next_instr_id); });
+      AddTask(next_instr_id);
     }
   }
 
@@ -2003,6 +2148,137 @@ void PirInterpreter::PreAnalysis() {
   VLOG(4) << "Done UpdateOneDNNOpNum";
 }
 
+namespace {
+
+// A slice of the arena of the memory plan, which keeps the arena alive as
+// long as a tensor holds it.
+class ArenaSliceAllocation : public phi::Allocation {
+ public:
+  ArenaSliceAllocation(void* ptr,
+                       size_t size,
+                       const phi::Place& place,
+                       std::shared_ptr<phi::Allocation> arena)
+      : phi::Allocation(ptr, size, place), arena_(std::move(arena)) {}
+
+ private:
+  std::shared_ptr<phi::Allocation> arena_;
+};
+
+}  // namespace
+
+void PirInterpreter::BuildMemoryPlan() {
+  memory_plan_holders_.clear();
+  memory_plan_arena_.reset();
+  // The plan holds for the order of the ops in the block, which only the
+  // trace mode of inference keeps.
+  ::pir::Operation* module_op = ir_block_->GetParentOp();
+  if (!execution_config_.used_for_inference || !phi::is_cpu_place(place_) ||
+      module_op == nullptr ||
+      !module_op->HasAttribute(interpreter::kMemoryPlanArenaSize)) {
+    return;
+  }
+  int64_t arena_size =
+      module_op
+          ->attribute<::pir::Int64Attribute>(interpreter::kMemoryPlanArenaSize)
+          .data();
+  memory_plan_arena_ = memory::AllocShared(place_, arena_size);
+  auto* arena_ptr = static_cast<uint8_t*>(memory_plan_arena_->ptr());
+  Scope* inner_scope = InnerScope();
+  for (auto& instr : vec_instruction_base_) {
+    ::pir::Operation* op = instr->Operation();
+    if (!op->HasAttribute(interpreter::kMemoryPlanOffsets)) continue;
+    auto offsets =
+        op->attribute<::pir::ArrayAttribute>(interpreter::kMemoryPlanOffsets);
+    for (size_t i = 0; i < offsets.size() && i < op->num_results(); ++i) {
+      int64_t offset = offsets.at(i).dyn_cast<::pir::Int64Attribute>().data();
+      if (offset < 0) continue;
+      auto type = op->result(i)
+                      .type()
+                      .dyn_cast<paddle::dialect::AllocatedDenseTensorType>();
+      auto* var =
+          inner_scope->FindVar(value_exe_info_->GetVarName(op->result(i)));
+      if (!type || var == nullptr || !var->IsType<phi::DenseTensor>()) {
+        continue;
+      }
+      int64_t size =
+          common::product(type.dims()) *
+          phi::SizeOf(paddle::dialect::TransToPhiDataType(type.dtype()));
+      PADDLE_ENFORCE_LE(
+          offset + size,
+          arena_size,
+          common::errors::InvalidArgument(
+              "The memory plan of %s ends at %d, beyond the arena of %d bytes.",
+              instr->Name(),
+              offset + size,
+              arena_size));
+      memory_plan_holders_.emplace_back(
+          var->GetMutable<phi::DenseTensor>(),
+          std::make_shared<ArenaSliceAllocation>(
+              arena_ptr + offset, size, place_, memory_plan_arena_));
+    }
+  }
+  if (memory_plan_holders_.empty()) {
+    memory_plan_arena_.reset();
+    return;
+  }
+  trace_execute_order_.resize(vec_instruction_base_.size());
+  std::iota(trace_execute_order_.begin(), trace_execute_order_.end(), 0);
+  VLOG(4) << "Bind " << memory_plan_holders_.size()
+          << " tensors to a memory plan of " << arena_size << " bytes";
+}
+
+void PirInterpreter::BindMemoryPlan() {
+  // The holders are released by GC after their last use, or replaced by
+  // kernels that need more memory than planned, so bind them every run.
+  for (auto& [tensor, slice] : memory_plan_holders_) {
+    tensor->clear();
+    tensor->ResetHolder(slice);
+  }
+}
+
+void PirInterpreter::BuildShapeBucketCache() {
+  shape_bucket_cache_.reset();
+  shape_bucket_feeds_.clear();
+  // The runs of inference are the ones of many shapes on one program.
+  if (!execution_config_.used_for_inference ||
+      FLAGS_pir_interpreter_shape_bucket_cache_size <= 0) {
+    return;
+  }
+  Scope* inner_scope = InnerScope();
+  for (auto& op : *ir_block_) {
+    if (!op.isa<paddle::dialect::PhiKernelOp>()) continue;
+    auto op_name = op.dyn_cast<paddle::dialect::PhiKernelOp>().op_name();
+    if (op_name != "pd_op.data" && op_name != "pd_op.feed") continue;
+    auto* var =
+        inner_scope->FindVar(value_exe_info_->GetVarName(op.result(0)));
+    if (var != nullptr && var->IsType<phi::DenseTensor>()) {
+      shape_bucket_feeds_.push_back(&(var->Get<phi::DenseTensor>()));
+    }
+  }
+  shape_bucket_cache_ = std::make_unique<interpreter::ShapeBucketCache>(
+      FLAGS_pir_interpreter_shape_bucket_cache_size);
+  for (auto& instr : vec_instruction_base_) {
+    auto* phi_instr = dynamic_cast<PhiKernelInstruction*>(instr.get());
+    if (phi_instr != nullptr) {
+      phi_instr->SetShapeBucketCache(shape_bucket_cache_.get());
+    }
+  }
+}
+
+void PirInterpreter::SelectShapeBucket() {
+  if (shape_bucket_cache_) {
+    shape_bucket_cache_->Select(shape_bucket_feeds_);
+  }
+}
+
+interpreter::ShapeBucketCacheStats PirInterpreter::GetShapeBucketCacheStats()
+    const {
+  if (!shape_bucket_cache_) {
+    return interpreter::ShapeBucketCacheStats();
+  }
+  return shape_bucket_cache_->GetStats();
+}
+
 ::pir::Value PirInterpreter::GetValueByName(const std::string& var_name) {
   for (auto kv : value_exe_info_->GetValue2VarName()) {
     if (kv.second == var_name) {
@@ -15,6 +15,7 @@
 #pragma once
 #include <memory>
 #include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
+#include "paddle/fluid/framework/new_executor/interpreter/shape_bucket_cache.h"
 #include "paddle/fluid/framework/new_executor/interpreter_base_impl.h"
 #include "paddle/pir/include/core/value.h"
 
@@ -110,6 +111,14 @@ class PirInterpreter : public InterpreterBaseImpl {
 
   std::string GetNameByValue(::pir::Value value) const;
 
+  // The hits of the shape buckets and of the cached InferMeta, all zeros if
+  // the cache is disabled.
+  interpreter::ShapeBucketCacheStats GetShapeBucketCacheStats() const;
+
+  // The operations of the instructions in the order work stealing dispatches
+  // them when they are ready at once. Only for test.
+  std::vector<::pir::Operation*> GetWorkStealingOrder() const;
+
   // Only for debug
   Variable* DebugVar(const std::string& name) const override;
 
@@ -222,8 +231,27 @@ class PirInterpreter : public InterpreterBaseImpl {
 
   void BuildInstruction();
 
+  // Bind the tensors planned by memory_plan_pass to their slices of one
+  // arena, and run the instructions in the order they were planned in.
+  void BuildMemoryPlan();
+
+  void BindMemoryPlan();
+
+  // Cache the inferred meta of the kernel instructions per bucket of the
+  // metas of the feeds, see ShapeBucketCache.
+  void BuildShapeBucketCache();
+
+  void SelectShapeBucket();
+
   void BuildInstructionDependences();
 
+  void BuildCriticalPathLength(
+      const std::map<size_t, std::set<size_t>>& downstream_map);
+
+  // The order of ready host instructions in work stealing mode: by the
+  // scheduling priority first, then by the longer critical path.
+  bool WorkStealingPriorityLess(size_t lhs, size_t rhs) const;
+
   void TraceRunImpl();
 
   void TraceRunInstructionList(
@@ -257,6 +285,9 @@ class PirInterpreter : public InterpreterBaseImpl {
 
   InstructionSchedulingPriorityLess ir_instruction_scheduling_priority_less;
 
+  // Built only if FLAGS_new_executor_use_work_stealing.
+  std::vector<SchedulingPriority> critical_path_length_;
+
   const ::pir::Block* ir_block_{nullptr};
 
   std::unordered_map<::pir::Block*, PirInterpreter*> sub_blocks_;  // Not owned
@@ -278,6 +309,13 @@ class PirInterpreter : public InterpreterBaseImpl {
   // belongs to a parameter and cannot GC.
   std::unordered_set<std::string> parameter_var_names_;
 
+  std::shared_ptr<phi::Allocation> memory_plan_arena_;
+  std::vector<std::pair<phi::DenseTensor*, std::shared_ptr<phi::Allocation>>>
+      memory_plan_holders_;
+
+  std::unique_ptr<interpreter::ShapeBucketCache> shape_bucket_cache_;
+  std::vector<const phi::DenseTensor*> shape_bucket_feeds_;
+
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   std::unique_ptr<phi::CalculateStreamTimer> calculate_stream_timer_;
 #endif
@@ -473,6 +473,7 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(model_from_memory_);  // the memory model reuses prog_file_ and
                                   // params_file_ fields.
   CP_MEMBER(save_optimized_model_);
+  CP_MEMBER(mmap_params_);
   CP_MEMBER(opt_cache_dir_);
   CP_MEMBER(prog_file_);
   CP_MEMBER(params_file_);
@@ -566,6 +567,7 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(use_optimized_model_);
 
   CP_MEMBER(cpu_math_library_num_threads_);
+  CP_MEMBER(cpu_intra_op_num_threads_);
 
   CP_MEMBER(serialized_info_cache_);
 
@@ -1072,6 +1074,7 @@ std::string AnalysisConfig::SerializeInfoCache() {
   ss << prog_file_;
   ss << params_file_;
   ss << save_optimized_model_;
+  ss << mmap_params_;
 
   ss << use_gpu_;
   ss << enable_gpu_mixed_;
@@ -1130,6 +1133,7 @@ std::string AnalysisConfig::SerializeInfoCache() {
 
   ss << specify_input_name_;
   ss << cpu_math_library_num_threads_;
+  ss << cpu_intra_op_num_threads_;
 
   ss << use_xpu_;
   ss << xpu_config_.device_id;
@@ -1183,6 +1187,18 @@ void AnalysisConfig::SetCpuMathLibraryNumThreads(
   Update();
 }
 
+void AnalysisConfig::SetCpuIntraOpNumThreads(int cpu_intra_op_num_threads) {
+  PADDLE_ENFORCE_GT(cpu_intra_op_num_threads,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The number of intra op threads should be larger "
+                        "than 0, but got %d.",
+                        cpu_intra_op_num_threads));
+  cpu_intra_op_num_threads_ = cpu_intra_op_num_threads;
+
+  Update();
+}
+
 float AnalysisConfig::fraction_of_gpu_memory_for_pool() const {
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   // Get the GPU memory details and calculate the fraction of memory for the
@@ -1273,11 +1289,16 @@ std::string AnalysisConfig::Summary() {
   if (model_from_memory_) {
     os.InsertRow({"model_from_memory", params_file_});
   }
+  if (mmap_params_) {
+    os.InsertRow({"mmap_params", "true"});
+  }
   os.InsetDivider();
 
   // cpu info
   os.InsertRow(
       {"cpu_math_thread", std::to_string(cpu_math_library_num_threads_)});
+  os.InsertRow(
+      {"cpu_intra_op_thread", std::to_string(cpu_intra_op_num_threads_)});
   os.InsertRow({"enable_mkldnn", use_mkldnn_ ? "true" : "false"});
   os.InsertRow(
       {"mkldnn_cache_capacity", std::to_string(mkldnn_cache_capacity_)});
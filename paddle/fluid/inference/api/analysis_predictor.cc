@@ -49,6 +49,7 @@
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/api/paddle_inference_pass.h"
 #include "paddle/fluid/inference/api/resource_manager.h"
+#include "paddle/fluid/inference/io.h"
 #include "paddle/fluid/inference/utils/io_utils.h"
 #include "paddle/fluid/inference/utils/model_utils.h"
 #include "paddle/fluid/inference/utils/singleton.h"
@@ -58,6 +59,7 @@
 #include "paddle/phi/api/include/context_pool.h"
 #include "paddle/phi/api/include/tensor.h"
 #include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/common/backend.h"
 #include "paddle/phi/common/data_type.h"
 #include "paddle/phi/common/place.h"
@@ -69,6 +71,7 @@
 
 #include "paddle/phi/core/generator.h"
 #include "paddle/phi/kernels/funcs/data_type_transform.h"
+#include "paddle/phi/kernels/funcs/packed_gemm.h"
 #include "paddle/utils/string/split.h"
 
 #if defined(PADDLE_WITH_DISTRIBUTE) && defined(PADDLE_WITH_PSCORE)
@@ -119,6 +122,7 @@
 #include "paddle/fluid/pir/transforms/general/constant_folding_pass.h"
 #include "paddle/fluid/pir/transforms/general/dead_code_elimination_pass.h"
 #include "paddle/fluid/pir/transforms/general/inplace_pass.h"
+#include "paddle/fluid/pir/transforms/general/memory_plan_pass.h"
 #include "paddle/fluid/pir/transforms/general/params_sync_among_devices_pass.h"
 #include "paddle/fluid/pir/transforms/general/remove_shadow_feed_pass.h"
 #include "paddle/fluid/pir/transforms/general/replace_fetch_with_shadow_output_pass.h"
@@ -135,6 +139,7 @@
 
 COMMON_DECLARE_bool(pir_apply_inplace_pass);
 COMMON_DECLARE_bool(enable_pir_api);
+COMMON_DECLARE_bool(cpu_gemm_pack_weight);
 
 namespace paddle {
 namespace {
@@ -441,6 +446,7 @@ bool AnalysisPredictor::Init(
 
   // no matter with or without OneDNN
   paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
+  phi::SetIntraOpNumThreads(config_.cpu_intra_op_num_threads());
 
   std::string model_path = config_.prog_file();
   load_pir_model_ =
@@ -1011,6 +1017,16 @@ void AnalysisPredictor::OptimizeInferencePirProgram() {
   if (FLAGS_pir_apply_inplace_pass) {
     lowered_pm.AddPass(::pir::CreateInplacePass());
   }
+  // Plan the intermediates into one arena once the kernels are chosen, so
+  // that fixed shape models on CPU run without allocations.
+  if (config_.enable_memory_optim() && phi::is_cpu_place(place_)) {
+    auto memory_plan_pass = ::pir::CreateMemoryPlanPass();
+    if (std::find(config_.deleted_passes_.begin(),
+                  config_.deleted_passes_.end(),
+                  memory_plan_pass->name()) == config_.deleted_passes_.end()) {
+      lowered_pm.AddPass(std::move(memory_plan_pass));
+    }
+  }
   if (!config_.glog_info_disabled()) {
     lowered_pm.EnablePrintStatistics();
   }
@@ -1108,7 +1124,9 @@ bool AnalysisPredictor::SaveOrLoadPirParameters(bool for_save) {
     pir::SaveCombineFunction(
         const_tensor_out, param_names, optimized_params, true, false, true);
     LOG(INFO) << "Optimized params saved to " << optimized_params;
-  } else {
+  } else if (!(config_.mmap_params_ && phi::is_cpu_place(place_) &&
+                 inference::LoadCombinedParamsByMmap(
+                     config_.params_file(), param_names, tensor_out))) {
     pir::LoadCombineFunction(
         config_.params_file(), param_names, &tensor_out, false, place_);
   }
@@ -1292,9 +1310,34 @@ bool AnalysisPredictor::PrepareExecutor() {
             root_predictor_id_, "memory_optimize_pass");
     executor_->MakeReusePlan(reuse_table);
   }
+  MarkPackableWeights();
   return true;
 }
 
+void AnalysisPredictor::MarkPackableWeights() {
+  if (!FLAGS_cpu_gemm_pack_weight || !phi::is_cpu_place(place_)) return;
+  // The passes have already run, so these are the final parameters.
+  std::vector<std::string> param_names;
+  if (config_.new_ir_enabled()) {
+    for (auto op : pir_program_->block()->ops()) {
+      if (op->isa<::pir::ParameterOp>()) {
+        param_names.push_back(
+            op->attribute<pir::StrAttribute>("parameter_name").AsString());
+      }
+    }
+  } else {
+    for (auto *var : inference_program_->Block(0).AllVars()) {
+      if (IsPersistable(var)) param_names.push_back(var->Name());
+    }
+  }
+  for (const auto &name : param_names) {
+    auto *var = sub_scope_->FindVar(name);
+    if (var != nullptr && var->IsType<phi::DenseTensor>()) {
+      phi::funcs::MarkPackableWeight(var->Get<phi::DenseTensor>());
+    }
+  }
+}
+
 #if defined(PADDLE_WITH_DISTRIBUTE) && defined(PADDLE_WITH_PSCORE)
 bool AnalysisPredictor::PrepareFleetExecutor() {
   VLOG(3) << "AnalysisPredictor::PrepareFleetExecutor()";
@@ -1658,6 +1701,7 @@ bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
                             std::vector<PaddleTensor> *output_data,
                             int batch_size) {
   paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
+  phi::SetIntraOpNumThreads(config_.cpu_intra_op_num_threads());
 #ifdef PADDLE_WITH_DNNL
   if (config_.use_mkldnn_) MkldnnPreSet(inputs);
 #endif
@@ -1714,6 +1758,7 @@ bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
   // recover the cpu_math_library_num_threads to 1, in order to avoid thread
   // conflict when integrating it into deployment service.
   paddle::platform::SetNumThreads(1);
+  phi::SetIntraOpNumThreads(1);
 #ifdef PADDLE_WITH_DNNL
   if (config_.use_mkldnn_) MkldnnPostReset();
 #endif
@@ -1735,6 +1780,7 @@ bool AnalysisPredictor::Run(const std::vector<paddle::Tensor> &inputs,
     pool.SyncDeviceContext(place_);
   }
   paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
+  phi::SetIntraOpNumThreads(config_.cpu_intra_op_num_threads());
 #ifdef PADDLE_WITH_DNNL
   if (config_.use_mkldnn_) MkldnnPreSet(inputs);
 #endif
@@ -1837,6 +1883,7 @@ bool AnalysisPredictor::Run(const std::vector<paddle::Tensor> &inputs,
   // recover the cpu_math_library_num_threads to 1, in order to avoid thread
   // conflict when integrating it into deployment service.
   paddle::platform::SetNumThreads(1);
+  phi::SetIntraOpNumThreads(1);
   if (private_context_) {
     phi::DeviceContextPool::SetDeviceContexts(nullptr);
   }
@@ -2035,6 +2082,7 @@ void AnalysisPredictor::PrepareArgument() {
   argument_->SetEnableIrOptim(config_.enable_ir_optim_);
   argument_->SetEnableMemoryOptim(config_.enable_memory_optim());
   argument_->SetModelFromMemory(config_.model_from_memory_);
+  argument_->SetMmapParams(config_.mmap_params_);
   argument_->SetUsePIR(config_.new_ir_enabled());
   // Analyze inference_program
   argument_->SetPredictorID(predictor_id_);
@@ -2698,6 +2746,7 @@ bool AnalysisPredictor::ZeroCopyRun(bool switch_stream) {
     pool.SyncDeviceContext(place_);
   }
   paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
+  phi::SetIntraOpNumThreads(config_.cpu_intra_op_num_threads());
 #ifdef PADDLE_WITH_DNNL
   if (config_.use_mkldnn_) {
     std::vector<std::vector<int>> shape_vector;
@@ -2786,6 +2835,7 @@ bool AnalysisPredictor::ZeroCopyRun(bool switch_stream) {
   // recover the cpu_math_library_num_threads to 1, in order to avoid thread
   // conflict when integrating it into deployment service.
   paddle::platform::SetNumThreads(1);
+  phi::SetIntraOpNumThreads(1);
   if (private_context_) {
     phi::DeviceContextPool::SetDeviceContexts(nullptr);
   }
@@ -3080,6 +3130,14 @@ bool AnalysisPredictor::LoadParameters() {
                           common::errors::PreconditionNotMet(
                               "The inference program should be loaded first."));
 
+  if (config_.mmap_params_ && !config_.params_file().empty() &&
+      !config_.model_from_memory() && phi::is_cpu_place(place_) &&
+      inference::LoadCombinedParamsByMmap(
+          scope_.get(), *inference_program_, config_.params_file())) {
+    VLOG(3) << "get " << scope_->LocalVarNames().size() << " vars after mmap";
+    return true;
+  }
+
   const auto &global_block = inference_program_->MutableBlock(0);
 
   // create a temporary program to load parameters.
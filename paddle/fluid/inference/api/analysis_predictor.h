@@ -371,6 +371,11 @@ class AnalysisPredictor : public PaddlePredictor {
   /// \return Whether the function executed successfully
   ///
   bool PrepareExecutor();
+  ///
+  /// \brief Marks the parameters as constant, so the CPU GEMMs may keep
+  /// packed copies of them, see FLAGS_cpu_gemm_pack_weight.
+  ///
+  void MarkPackableWeights();
 
   ///
   /// \brief Load model program.
@@ -206,6 +206,9 @@ void Tensor::CopyFromCpu(const T *data) {
   if (place_ == PlaceType::kCPU) {
     auto *t_data = tensor->mutable_data<T>(phi::CPUPlace());
     std::memcpy(static_cast<void *>(t_data), data, ele_size);
+    // Tells the packed weight cache of the CPU GEMMs that a parameter
+    // written here has changed.
+    tensor->InplaceVersionCounter().Bump();
   } else if (place_ == PlaceType::kGPU) {
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 
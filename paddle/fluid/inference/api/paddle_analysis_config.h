@@ -246,6 +246,22 @@ struct PD_INFER_DECL AnalysisConfig {
   /// \param x params file path.
   ///
   void SetParamsFile(const std::string& x) { params_file_ = x; }
+  ///
+  /// \brief Load the params file of a combined model by mapping it. The
+  /// params on CPU share the pages of the file, with the params of the
+  /// other predictors mapping the same file, instead of holding a copy.
+  /// Only supported on Linux and macOS, params of types other than
+  /// DenseTensor fall back to a copy.
+  ///
+  /// \param x whether to map the params file.
+  ///
+  void EnableMmapParams(bool x = true) { mmap_params_ = x; }
+  ///
+  /// \brief A boolean state telling whether the params file is mapped.
+  ///
+  /// \return bool Whether the params file is mapped.
+  ///
+  bool mmap_params_enabled() const { return mmap_params_; }
 
   ///
   /// \brief Save optimized model.
@@ -943,6 +959,23 @@ struct PD_INFER_DECL AnalysisConfig {
     return cpu_math_library_num_threads_;
   }
 
+  ///
+  /// \brief Set the number of threads the CPU kernels may use within one op,
+  /// such as the Eigen reductions and softmax. The predictors with the same
+  /// number share one pool of threads.
+  ///
+  /// \param cpu_intra_op_num_threads The number of intra op threads, 1 to
+  /// run every op serially.
+  ///
+  void SetCpuIntraOpNumThreads(int cpu_intra_op_num_threads);
+  ///
+  /// \brief An int state telling how many threads the CPU kernels use
+  /// within one op.
+  ///
+  /// \return int The number of intra op threads.
+  ///
+  int cpu_intra_op_num_threads() const { return cpu_intra_op_num_threads_; }
+
   ///
   /// \brief Transform the AnalysisConfig to NativeConfig.
   ///
@@ -1037,6 +1070,8 @@ struct PD_INFER_DECL AnalysisConfig {
   ///
   /// \brief Turn on memory optimize
   /// NOTE still in development.
+  /// With PIR on CPU, the intermediate tensors of static shapes are planned
+  /// into one arena allocated once.
   ///
   /// \param x Whether to enable memory optimize.
   ///
@@ -1298,6 +1333,7 @@ struct PD_INFER_DECL AnalysisConfig {
   bool specify_input_name_{false};
 
   int cpu_math_library_num_threads_{1};
+  int cpu_intra_op_num_threads_{1};
 
   bool with_profile_{false};
 
@@ -1362,6 +1398,7 @@ struct PD_INFER_DECL AnalysisConfig {
   // So we release the memory when the predictor is set up.
   mutable bool is_valid_{true};
   bool save_optimized_model_{false};
+  bool mmap_params_{false};
   std::string opt_cache_dir_;
   friend class paddle_infer::experimental::InternalUtils;
 
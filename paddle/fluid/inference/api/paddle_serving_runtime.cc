@@ -0,0 +1,632 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/paddle_serving_runtime.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "glog/logging.h"
+#include "paddle/common/enforce.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+
+namespace paddle_infer {
+namespace services {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+size_t SizeOfDataType(DataType dtype) {
+  switch (dtype) {
+    case DataType::FLOAT64:
+      return sizeof(double);
+    case DataType::FLOAT32:
+      return sizeof(float);
+    case DataType::INT64:
+      return sizeof(int64_t);
+    case DataType::INT32:
+      return sizeof(int32_t);
+    case DataType::UINT8:
+      return sizeof(uint8_t);
+    case DataType::INT8:
+      return sizeof(int8_t);
+    case DataType::FLOAT16:
+      return sizeof(phi::dtype::float16);
+    case DataType::BFLOAT16:
+      return sizeof(phi::dtype::bfloat16);
+    case DataType::BOOL:
+      return sizeof(bool);
+    default:
+      PADDLE_THROW(common::errors::Unimplemented(
+          "ServingRuntime does not support data type %d.",
+          static_cast<int>(dtype)));
+  }
+}
+
+// Calls func with a null pointer of the C++ type of dtype.
+template <typename Func>
+void VisitDataType(DataType dtype, Func &&func) {
+  switch (dtype) {
+    case DataType::FLOAT64:
+      return func(static_cast<double *>(nullptr));
+    case DataType::FLOAT32:
+      return func(static_cast<float *>(nullptr));
+    case DataType::INT64:
+      return func(static_cast<int64_t *>(nullptr));
+    case DataType::INT32:
+      return func(static_cast<int32_t *>(nullptr));
+    case DataType::UINT8:
+      return func(static_cast<uint8_t *>(nullptr));
+    case DataType::INT8:
+      return func(static_cast<int8_t *>(nullptr));
+    case DataType::FLOAT16:
+      return func(static_cast<phi::dtype::float16 *>(nullptr));
+    case DataType::BFLOAT16:
+      return func(static_cast<phi::dtype::bfloat16 *>(nullptr));
+    case DataType::BOOL:
+      return func(static_cast<bool *>(nullptr));
+    default:
+      PADDLE_THROW(common::errors::Unimplemented(
+          "ServingRuntime does not support data type %d.",
+          static_cast<int>(dtype)));
+  }
+}
+
+int64_t ElementNum(const std::vector<int> &shape) {
+  return std::accumulate(
+      shape.begin(), shape.end(), int64_t{1}, std::multiplies<int64_t>());
+}
+
+// Parses a sysfs cpu list like "0-3,8,10-11".
+std::vector<int> ParseCpuList(const std::string &list) {
+  std::vector<int> cores;
+  std::stringstream stream(list);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    if (range.empty() || range == "\n") {
+      continue;
+    }
+    size_t dash = range.find('-');
+    int first = std::stoi(range.substr(0, dash));
+    int last = dash == std::string::npos ? first
+                                         : std::stoi(range.substr(dash + 1));
+    for (int core = first; core <= last; ++core) {
+      cores.push_back(core);
+    }
+  }
+  return cores;
+}
+
+std::vector<int> NumaNodeCores(int node) {
+  std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) +
+                     "/cpulist");
+  PADDLE_ENFORCE_EQ(file.is_open(),
+                    true,
+                    common::errors::NotFound(
+                        "Can not read the cores of NUMA node %d.", node));
+  std::string list;
+  std::getline(file, list);
+  return ParseCpuList(list);
+}
+
+void PinThisThread(const std::vector<int> &cores) {
+  if (cores.empty()) {
+    return;
+  }
+#ifdef __linux__
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (int core : cores) {
+    CPU_SET(core, &cpu_set);
+  }
+  int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+  if (ret != 0) {
+    LOG(WARNING) << "Failed to pin the predictor thread, error " << ret;
+  }
+#else
+  LOG(WARNING) << "Pinning predictor threads is only supported on Linux.";
+#endif
+}
+
+// A histogram filled by many threads.
+class AtomicHistogram {
+ public:
+  void Add(uint64_t us) {
+    counts_[LatencyHistogram::BucketOf(us)].fetch_add(
+        1, std::memory_order_relaxed);
+    sum_us_.fetch_add(us, std::memory_order_relaxed);
+  }
+
+  LatencyHistogram Snapshot() const {
+    LatencyHistogram histogram;
+    for (int i = 0; i < LatencyHistogram::kBucketNum; ++i) {
+      histogram.counts[i] = counts_[i].load(std::memory_order_relaxed);
+    }
+    histogram.sum_us = sum_us_.load(std::memory_order_relaxed);
+    return histogram;
+  }
+
+ private:
+  std::atomic<uint64_t> counts_[LatencyHistogram::kBucketNum] = {};
+  std::atomic<uint64_t> sum_us_{0};
+};
+
+uint64_t MicrosecondsSince(Clock::time_point start, Clock::time_point end) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+      .count();
+}
+
+}  // namespace
+
+LatencyHistogram::LatencyHistogram() : counts(kBucketNum, 0) {}
+
+int LatencyHistogram::BucketOf(uint64_t us) {
+  if (us < 4) {
+    return static_cast<int>(us);
+  }
+  int exponent = 2;
+  while (exponent < 63 && (us >> (exponent + 1)) != 0) {
+    ++exponent;
+  }
+  int bucket =
+      4 * (exponent - 1) + static_cast<int>((us >> (exponent - 2)) & 3);
+  return std::min(bucket, kBucketNum - 1);
+}
+
+uint64_t LatencyHistogram::LowerBound(int bucket) {
+  if (bucket < 4) {
+    return bucket;
+  }
+  int exponent = bucket / 4 + 1;
+  return static_cast<uint64_t>(4 + bucket % 4) << (exponent - 2);
+}
+
+uint64_t LatencyHistogram::Count() const {
+  return std::accumulate(counts.begin(), counts.end(), uint64_t{0});
+}
+
+double LatencyHistogram::Mean() const {
+  uint64_t count = Count();
+  return count == 0 ? 0 : static_cast<double>(sum_us) / count;
+}
+
+uint64_t LatencyHistogram::Percentile(double quantile) const {
+  uint64_t count = Count();
+  if (count == 0) {
+    return 0;
+  }
+  quantile = std::min(std::max(quantile, 0.0), 1.0);
+  uint64_t rank = std::max<uint64_t>(
+      static_cast<uint64_t>(std::ceil(quantile * count)), 1);
+  uint64_t seen = 0;
+  for (int i = 0; i < kBucketNum; ++i) {
+    seen += counts[i];
+    if (seen >= rank) {
+      return i + 1 < kBucketNum ? LowerBound(i + 1) - 1 : LowerBound(i);
+    }
+  }
+  return LowerBound(kBucketNum - 1);
+}
+
+struct ServingRuntime::Impl {
+  struct Request {
+    std::vector<paddle::PaddleTensor> inputs;
+    std::promise<std::vector<paddle::PaddleTensor>> promise;
+    Clock::time_point enqueue_time;
+    // Requests of equal non-empty keys can be batched.
+    std::string batch_key;
+    int rows{0};
+  };
+  using RequestPtr = std::unique_ptr<Request>;
+
+  Impl(const Config &config, const ServingConfig &serving_config)
+      : serving_config(serving_config),
+        pool(config, std::max<size_t>(serving_config.num_predictors, 1)) {
+    PADDLE_ENFORCE_GE(serving_config.max_batch_size,
+                      1,
+                      common::errors::InvalidArgument(
+                          "The max batch size of ServingRuntime should be "
+                          "greater than 0, but got %d.",
+                          serving_config.max_batch_size));
+    size_t num = std::max<size_t>(serving_config.num_predictors, 1);
+    input_names = pool.Retrieve(0)->GetInputNames();
+    // resolved before any worker starts, so that a bad core or numa node
+    // throws with no thread to join
+    std::vector<std::vector<int>> worker_cores;
+    for (size_t i = 0; i < num; ++i) {
+      worker_cores.push_back(CoresOf(i, num));
+    }
+    workers.reserve(num);
+    for (size_t i = 0; i < num; ++i) {
+      workers.emplace_back(&Impl::Work, this, i, std::move(worker_cores[i]));
+    }
+  }
+
+  ~Impl() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    cv.notify_all();
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  }
+
+  std::vector<int> CoresOf(size_t index, size_t num) const {
+    const auto &cores = serving_config.cpu_cores;
+    if (!cores.empty()) {
+      size_t per_predictor = std::max<size_t>(cores.size() / num, 1);
+      size_t begin = index * per_predictor % cores.size();
+      size_t end = std::min(begin + per_predictor, cores.size());
+      return std::vector<int>(cores.begin() + begin, cores.begin() + end);
+    }
+    const auto &nodes = serving_config.numa_nodes;
+    if (!nodes.empty()) {
+      return NumaNodeCores(nodes[index % nodes.size()]);
+    }
+    return {};
+  }
+
+  // The rows of a request and the key of the requests it can be batched
+  // with, empty when it has to run alone.
+  void SetBatchKey(Request *request) {
+    auto &inputs = request->inputs;
+    PADDLE_ENFORCE_EQ(
+        inputs.size(),
+        input_names.size(),
+        common::errors::InvalidArgument(
+            "The model has %d inputs, but the request has %d.",
+            input_names.size(),
+            inputs.size()));
+    request->rows = inputs.empty() || inputs[0].shape.empty()
+                        ? 0
+                        : inputs[0].shape[0];
+    std::string key;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      auto &input = inputs[i];
+      if (input.name.empty()) {
+        input.name = input_names[i];
+      }
+      size_t bytes = ElementNum(input.shape) * SizeOfDataType(input.dtype);
+      PADDLE_ENFORCE_EQ(
+          input.data.length(),
+          bytes,
+          common::errors::InvalidArgument(
+              "The input %s should have %d bytes, but got %d.",
+              input.name,
+              bytes,
+              input.data.length()));
+      if (!input.lod.empty() || input.shape.empty() ||
+          input.shape[0] != request->rows) {
+        request->rows = 0;
+      }
+      key += input.name;
+      key += ':' + std::to_string(static_cast<int>(input.dtype));
+      for (size_t d = 1; d < input.shape.size(); ++d) {
+        key += ',' + std::to_string(input.shape[d]);
+      }
+      key += ';';
+    }
+    if (request->rows > 0 && serving_config.max_batch_size > 1) {
+      request->batch_key = std::move(key);
+    }
+  }
+
+  std::future<std::vector<paddle::PaddleTensor>> Submit(
+      std::vector<paddle::PaddleTensor> inputs) {
+    RequestPtr request(new Request);
+    auto future = request->promise.get_future();
+    request->inputs = std::move(inputs);
+    try {
+      SetBatchKey(request.get());
+    } catch (...) {
+      request->promise.set_exception(std::current_exception());
+      return future;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (serving_config.max_queue_size > 0 &&
+          queue.size() >= serving_config.max_queue_size) {
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        try {
+          PADDLE_THROW(common::errors::ResourceExhausted(
+              "The ServingRuntime queue is full with %d requests.",
+              queue.size()));
+        } catch (...) {
+          request->promise.set_exception(std::current_exception());
+        }
+        return future;
+      }
+      request->enqueue_time = Clock::now();
+      queue.push_back(std::move(request));
+    }
+    cv.notify_one();
+    return future;
+  }
+
+  // Takes the oldest request and the requests it can be batched with. A
+  // batch that is not full waits until the oldest request times out.
+  // Returns an empty batch when stopped with nothing queued.
+  std::vector<RequestPtr> NextBatch() {
+    std::unique_lock<std::mutex> lock(mutex);
+    std::vector<RequestPtr> batch;
+    while (true) {
+      cv.wait(lock, [this] { return stop || !queue.empty(); });
+      if (queue.empty()) {
+        return batch;
+      }
+      const Request &head = *queue.front();
+      if (head.batch_key.empty() || stop) {
+        break;
+      }
+      int rows = 0;
+      for (auto &request : queue) {
+        if (request->batch_key == head.batch_key) {
+          rows += request->rows;
+        }
+      }
+      auto deadline =
+          head.enqueue_time +
+          std::chrono::microseconds(serving_config.batch_timeout_us);
+      if (rows >= serving_config.max_batch_size || Clock::now() >= deadline) {
+        break;
+      }
+      cv.wait_until(lock, deadline);
+    }
+    batch.push_back(std::move(queue.front()));
+    queue.pop_front();
+    const std::string &key = batch[0]->batch_key;
+    int rows = batch[0]->rows;
+    if (!key.empty()) {
+      for (auto iter = queue.begin(); iter != queue.end();) {
+        if ((*iter)->batch_key == key &&
+            rows + (*iter)->rows <= serving_config.max_batch_size) {
+          rows += (*iter)->rows;
+          batch.push_back(std::move(*iter));
+          iter = queue.erase(iter);
+        } else {
+          ++iter;
+        }
+      }
+    }
+    bool more = !queue.empty();
+    lock.unlock();
+    if (more) {
+      cv.notify_one();
+    }
+    return batch;
+  }
+
+  void Work(size_t index, std::vector<int> cores) {
+    PinThisThread(cores);
+    Predictor *predictor = pool.Retrieve(index);
+    std::vector<char> buffer;
+    while (true) {
+      auto batch = NextBatch();
+      if (batch.empty()) {
+        return;
+      }
+      auto start = Clock::now();
+      for (auto &request : batch) {
+        queue_latency.Add(MicrosecondsSince(request->enqueue_time, start));
+      }
+      std::vector<std::vector<paddle::PaddleTensor>> outputs(batch.size());
+      std::vector<std::exception_ptr> errors(batch.size());
+      if (!RunOrFail(predictor,
+                     batch,
+                     0,
+                     batch.size(),
+                     &buffer,
+                     &outputs,
+                     &errors)) {
+        // The outputs do not keep the rows in dim 0, run each alone.
+        for (size_t r = 0; r < batch.size(); ++r) {
+          RunOrFail(predictor, batch, r, r + 1, &buffer, &outputs, &errors);
+        }
+      }
+      compute_latency.Add(MicrosecondsSince(start, Clock::now()));
+      requests.fetch_add(batch.size(), std::memory_order_relaxed);
+      batches.fetch_add(1, std::memory_order_relaxed);
+      for (size_t r = 0; r < batch.size(); ++r) {
+        if (errors[r]) {
+          batch[r]->promise.set_exception(errors[r]);
+        } else {
+          batch[r]->promise.set_value(std::move(outputs[r]));
+        }
+      }
+    }
+  }
+
+  // Runs the requests [begin, end) of the batch, an exception fails them.
+  bool RunOrFail(Predictor *predictor,
+                 const std::vector<RequestPtr> &batch,
+                 size_t begin,
+                 size_t end,
+                 std::vector<char> *buffer,
+                 std::vector<std::vector<paddle::PaddleTensor>> *outputs,
+                 std::vector<std::exception_ptr> *errors) {
+    try {
+      return RunBatch(predictor, batch, begin, end, buffer, outputs);
+    } catch (...) {
+      for (size_t r = begin; r < end; ++r) {
+        (*errors)[r] = std::current_exception();
+      }
+      return true;
+    }
+  }
+
+  // Runs the requests [begin, end) of the batch at once, and splits the
+  // outputs by request. Returns false when several requests are run and
+  // the outputs can not be split by rows.
+  bool RunBatch(Predictor *predictor,
+                const std::vector<RequestPtr> &batch,
+                size_t begin,
+                size_t end,
+                std::vector<char> *buffer,
+                std::vector<std::vector<paddle::PaddleTensor>> *outputs) {
+    const auto &first = batch[begin]->inputs;
+    bool alone = end - begin == 1;
+    int rows = 0;
+    for (size_t r = begin; r < end; ++r) {
+      rows += batch[r]->rows;
+    }
+    for (size_t i = 0; i < first.size(); ++i) {
+      auto tensor = predictor->GetInputHandle(first[i].name);
+      const void *data = first[i].data.data();
+      std::vector<int> shape = first[i].shape;
+      if (!alone) {
+        shape[0] = rows;
+        buffer->resize(ElementNum(shape) * SizeOfDataType(first[i].dtype));
+        char *dst = buffer->data();
+        for (size_t r = begin; r < end; ++r) {
+          const auto &buf = batch[r]->inputs[i].data;
+          std::memcpy(dst, buf.data(), buf.length());
+          dst += buf.length();
+        }
+        data = buffer->data();
+      }
+      tensor->Reshape(shape);
+      if (!first[i].lod.empty()) {
+        tensor->SetLoD(first[i].lod);
+      }
+      VisitDataType(first[i].dtype, [&](auto *type) {
+        using T = std::remove_pointer_t<decltype(type)>;
+        tensor->CopyFromCpu(static_cast<const T *>(data));
+      });
+    }
+    PADDLE_ENFORCE_EQ(
+        predictor->Run(),
+        true,
+        common::errors::Fatal("The predictor failed to run the batch."));
+
+    auto output_names = predictor->GetOutputNames();
+    std::vector<std::unique_ptr<Tensor>> tensors;
+    for (auto &name : output_names) {
+      tensors.push_back(predictor->GetOutputHandle(name));
+      auto shape = tensors.back()->shape();
+      if (!alone && (shape.empty() || shape[0] != rows)) {
+        return false;
+      }
+    }
+    for (size_t i = 0; i < tensors.size(); ++i) {
+      auto &tensor = tensors[i];
+      DataType dtype = tensor->type();
+      std::vector<int> shape = tensor->shape();
+      size_t bytes = ElementNum(shape) * SizeOfDataType(dtype);
+      if (alone) {
+        auto &output = (*outputs)[begin].emplace_back();
+        output.name = output_names[i];
+        output.shape = shape;
+        output.dtype = dtype;
+        output.lod = tensor->lod();
+        output.data.Resize(bytes);
+        VisitDataType(dtype, [&](auto *type) {
+          using T = std::remove_pointer_t<decltype(type)>;
+          tensor->CopyToCpu(static_cast<T *>(output.data.data()));
+        });
+        continue;
+      }
+      buffer->resize(bytes);
+      VisitDataType(dtype, [&](auto *type) {
+        using T = std::remove_pointer_t<decltype(type)>;
+        tensor->CopyToCpu(reinterpret_cast<T *>(buffer->data()));
+      });
+      const char *data = buffer->data();
+      size_t row_bytes = bytes / rows;
+      for (size_t r = begin; r < end; ++r) {
+        auto &output = (*outputs)[r].emplace_back();
+        output.name = output_names[i];
+        output.shape = shape;
+        output.shape[0] = batch[r]->rows;
+        output.dtype = dtype;
+        output.data.Resize(row_bytes * batch[r]->rows);
+        std::memcpy(output.data.data(), data, output.data.length());
+        data += output.data.length();
+      }
+    }
+    return true;
+  }
+
+  ServingConfig serving_config;
+  PredictorPool pool;
+  std::vector<std::string> input_names;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<RequestPtr> queue;
+  bool stop{false};
+  std::vector<std::thread> workers;
+
+  AtomicHistogram queue_latency;
+  AtomicHistogram compute_latency;
+  std::atomic<uint64_t> requests{0};
+  std::atomic<uint64_t> batches{0};
+  std::atomic<uint64_t> rejected{0};
+};
+
+ServingRuntime::ServingRuntime(const Config &config,
+                               const ServingConfig &serving_config)
+    : impl_(new Impl(config, serving_config)) {}
+
+ServingRuntime::~ServingRuntime() = default;
+
+std::future<std::vector<paddle::PaddleTensor>> ServingRuntime::Submit(
+    std::vector<paddle::PaddleTensor> inputs) {
+  return impl_->Submit(std::move(inputs));
+}
+
+bool ServingRuntime::Run(std::vector<paddle::PaddleTensor> inputs,
+                         std::vector<paddle::PaddleTensor> *outputs) {
+  try {
+    *outputs = Submit(std::move(inputs)).get();
+  } catch (const std::exception &e) {
+    LOG(ERROR) << "ServingRuntime failed to run the request: " << e.what();
+    return false;
+  }
+  return true;
+}
+
+ServingStats ServingRuntime::GetStats() const {
+  ServingStats stats;
+  stats.queue_latency = impl_->queue_latency.Snapshot();
+  stats.compute_latency = impl_->compute_latency.Snapshot();
+  stats.requests = impl_->requests.load(std::memory_order_relaxed);
+  stats.batches = impl_->batches.load(std::memory_order_relaxed);
+  stats.rejected = impl_->rejected.load(std::memory_order_relaxed);
+  return stats;
+}
+
+}  // namespace services
+}  // namespace paddle_infer
@@ -0,0 +1,153 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "paddle_inference_api.h"  // NOLINT
+
+///
+/// \file paddle_serving_runtime.h
+///
+/// \brief An in-process serving runtime on top of PredictorPool.
+///
+/// \since 3.0.0
+///
+
+namespace paddle_infer {
+namespace services {
+
+///
+/// \class LatencyHistogram
+///
+/// \brief A snapshot of a latency distribution in microseconds. Each power
+/// of two is split into 4 buckets, so a percentile is off by 25% at most.
+///
+class PD_INFER_DECL LatencyHistogram {
+ public:
+  static constexpr int kBucketNum = 144;
+
+  LatencyHistogram();
+
+  /// \brief The bucket of a latency of \param us microseconds.
+  static int BucketOf(uint64_t us);
+  /// \brief The smallest latency in microseconds of bucket \param bucket.
+  static uint64_t LowerBound(int bucket);
+
+  /// \brief The number of latencies recorded.
+  uint64_t Count() const;
+  /// \brief The mean latency in microseconds.
+  double Mean() const;
+  /// \brief The upper bound in microseconds of the latencies of quantile
+  /// \param quantile, in [0, 1].
+  uint64_t Percentile(double quantile) const;
+
+  /// \brief The number of latencies of each bucket.
+  std::vector<uint64_t> counts;
+  uint64_t sum_us{0};
+};
+
+struct PD_INFER_DECL ServingStats {
+  /// The time requests waited in the queue.
+  LatencyHistogram queue_latency;
+  /// The time batches ran on the predictors.
+  LatencyHistogram compute_latency;
+  uint64_t requests{0};
+  uint64_t batches{0};
+  /// Requests refused because the queue was full.
+  uint64_t rejected{0};
+};
+
+struct PD_INFER_DECL ServingConfig {
+  /// The number of predictors, each one runs on its own thread.
+  size_t num_predictors{1};
+  /// The largest number of rows, the dim 0 of the inputs, run at once.
+  /// Requests are only batched when all their inputs but dim 0 have the
+  /// same names, types and shapes, and have no LoD.
+  int max_batch_size{1};
+  /// How long a request may wait for others to batch with.
+  int64_t batch_timeout_us{0};
+  /// Requests arriving when this many are queued are refused, 0 for no
+  /// limit.
+  size_t max_queue_size{0};
+  /// The CPU cores the predictor threads are pinned to, split evenly among
+  /// the predictors. Empty to not pin.
+  std::vector<int> cpu_cores;
+  /// The NUMA nodes the predictor threads are pinned to, predictor i runs
+  /// on the cores of numa_nodes[i % numa_nodes.size()]. Ignored when
+  /// cpu_cores is set. Pinning is only supported on Linux.
+  std::vector<int> numa_nodes;
+};
+
+///
+/// \class ServingRuntime
+///
+/// \brief ServingRuntime owns a PredictorPool and serves requests submitted
+/// from any thread. Requests of the same shape are batched along dim 0, up
+/// to ServingConfig::max_batch_size rows or until the oldest of them has
+/// waited ServingConfig::batch_timeout_us, then run by an idle predictor and
+/// split back. Models whose outputs do not keep the rows in dim 0 run every
+/// request alone.
+///
+/// \code{cpp}
+/// paddle_infer::services::ServingConfig serving_config;
+/// serving_config.num_predictors = 4;
+/// serving_config.max_batch_size = 16;
+/// serving_config.batch_timeout_us = 2000;
+/// paddle_infer::services::ServingRuntime runtime(config, serving_config);
+/// auto outputs = runtime.Submit(std::move(inputs)).get();
+/// \endcode
+///
+class PD_INFER_DECL ServingRuntime {
+ public:
+  ServingRuntime(const Config& config, const ServingConfig& serving_config);
+  ServingRuntime(const ServingRuntime&) = delete;
+  ServingRuntime& operator=(const ServingRuntime&) = delete;
+
+  /// \brief Runs the queued requests, then stops the predictor threads.
+  ~ServingRuntime();
+
+  ///
+  /// \brief Queue a request. The inputs are matched to the model inputs by
+  /// name, or by position when their names are empty.
+  ///
+  /// \param inputs The input tensors, on CPU.
+  /// \return The output tensors, in the order of the model outputs. The
+  /// future holds the exception of a failed run, or a refused request.
+  ///
+  std::future<std::vector<paddle::PaddleTensor>> Submit(
+      std::vector<paddle::PaddleTensor> inputs);
+
+  ///
+  /// \brief Run a request and wait for it.
+  ///
+  /// \return Whether the request succeeded.
+  ///
+  bool Run(std::vector<paddle::PaddleTensor> inputs,
+           std::vector<paddle::PaddleTensor>* outputs);
+
+  /// \brief The latencies and counters since the runtime started.
+  ServingStats GetStats() const;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace services
+}  // namespace paddle_infer
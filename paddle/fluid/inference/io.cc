@@ -15,16 +15,24 @@ limitations under the License. */
 #include "paddle/fluid/inference/io.h"
 
 #include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <vector>
 
 #include "paddle/fluid/framework/block_desc.h"
+#include "paddle/fluid/framework/convert_utils.h"
+#include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/feed_fetch_type.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/version.h"
 #include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/pybind/pybind.h"
+#ifndef _WIN32
+#include <sys/stat.h>
+
+#include "paddle/phi/core/memory/allocation/mmap_allocator.h"
+#endif
 
 // phi
 #include "paddle/phi/kernels/declarations.h"
@@ -136,6 +144,185 @@ void LoadPersistables(framework::Executor* executor,
   delete load_program;
 }
 
+#ifndef _WIN32
+namespace {
+
+// Reads the fields of a combined params file in place, the layout is the
+// one written by save_combine.
+class MappedParamsReader {
+ public:
+  MappedParamsReader(const char* data, size_t size, const std::string& file)
+      : data_(data), size_(size), file_(file) {}
+
+  template <typename T>
+  T Read() {
+    T value;
+    std::memcpy(&value, Skip(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  const char* Skip(size_t size) {
+    PADDLE_ENFORCE_LE(
+        size,
+        size_ - pos_,
+        common::errors::InvalidArgument(
+            "The params file %s is damaged, it ends at %d bytes while %d "
+            "more bytes are expected at %d.",
+            file_,
+            size_,
+            size,
+            pos_));
+    const char* begin = data_ + pos_;
+    pos_ += size;
+    return begin;
+  }
+
+  size_t pos() const { return pos_; }
+  bool eof() const { return pos_ == size_; }
+
+ private:
+  const char* data_;
+  size_t size_;
+  size_t pos_{0};
+  const std::string& file_;
+};
+
+// Returns the number of bytes copied instead of mapped.
+size_t ReadMappedTensor(MappedParamsReader* reader,
+                        const std::shared_ptr<phi::Allocation>& holder,
+                        const std::string& name,
+                        phi::DenseTensor* tensor) {
+  uint32_t version = reader->Read<uint32_t>();
+  PADDLE_ENFORCE_EQ(version,
+                    0U,
+                    common::errors::InvalidArgument(
+                        "Tensor version %u of %s is not supported.",
+                        version,
+                        name));
+  framework::LoD lod(reader->Read<uint64_t>());
+  for (auto& level : lod) {
+    uint64_t size = reader->Read<uint64_t>();
+    // The offsets may be unaligned in the file as well.
+    const char* begin = reader->Skip(size);
+    level.resize(size / sizeof(size_t));
+    std::memcpy(level.data(), begin, level.size() * sizeof(size_t));
+  }
+  version = reader->Read<uint32_t>();
+  PADDLE_ENFORCE_EQ(version,
+                    0U,
+                    common::errors::InvalidArgument(
+                        "Tensor version %u of %s is not supported.",
+                        version,
+                        name));
+  int32_t desc_size = reader->Read<int32_t>();
+  PADDLE_ENFORCE_GE(desc_size,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The desc size of %s is negative.", name));
+  framework::proto::VarType::TensorDesc desc;
+  PADDLE_ENFORCE_EQ(
+      desc.ParseFromArray(reader->Skip(desc_size), desc_size),
+      true,
+      common::errors::InvalidArgument("Cannot parse tensor desc of %s.", name));
+
+  auto dtype = framework::TransToPhiDataType(desc.data_type());
+  std::vector<int64_t> dims(desc.dims().begin(), desc.dims().end());
+  tensor->clear();
+  tensor->set_lod(lod);
+  tensor->Resize(common::make_ddim(dims));
+  size_t type_size = framework::SizeOfType(desc.data_type());
+  size_t offset = reader->pos();
+  size_t data_size = tensor->numel() * type_size;
+  const char* data = reader->Skip(data_size);
+  // The data follows a desc of any size, so it is often not aligned to its
+  // element size. The mapping starts at a page, so only the data at an
+  // aligned offset is shared; the rest is copied, kernels need aligned
+  // pointers.
+  if (offset % type_size == 0) {
+    // Share the mapping, the page is only copied when a pass writes to it.
+    tensor->set_offset(offset);
+    tensor->ResetHolderWithType(holder, dtype);
+    return 0;
+  }
+  std::memcpy(tensor->mutable_data(phi::CPUPlace(), dtype), data, data_size);
+  return data_size;
+}
+
+}  // namespace
+#endif
+
+bool LoadCombinedParamsByMmap(const std::string& param_filename,
+                              const std::vector<std::string>& names,
+                              const std::vector<phi::DenseTensor*>& tensors) {
+#ifdef _WIN32
+  return false;
+#else
+  PADDLE_ENFORCE_EQ(names.size(),
+                    tensors.size(),
+                    common::errors::InvalidArgument(
+                        "The number of names %d and tensors %d of the params "
+                        "should be the same.",
+                        names.size(),
+                        tensors.size()));
+  if (names.empty()) return false;
+  struct stat file_stat;
+  if (param_filename.empty() || stat(param_filename.c_str(), &file_stat) != 0 ||
+      file_stat.st_size == 0) {
+    VLOG(3) << "The params file " << param_filename
+            << " is missing or empty, it is not mapped.";
+    return false;
+  }
+  auto holder = memory::allocation::MapFileReaderAllocation(param_filename);
+  MappedParamsReader reader(
+      static_cast<const char*>(holder->ptr()), holder->size(), param_filename);
+  size_t copied_bytes = 0;
+  size_t copied_num = 0;
+  for (size_t i = 0; i < names.size(); ++i) {
+    size_t bytes = ReadMappedTensor(&reader, holder, names[i], tensors[i]);
+    if (bytes > 0) {
+      copied_bytes += bytes;
+      ++copied_num;
+    }
+  }
+  PADDLE_ENFORCE_EQ(reader.eof(),
+                    true,
+                    common::errors::Unavailable(
+                        "Not allowed to load partial data via mmap, the "
+                        "params file %s has %d bytes more than the %d params.",
+                        param_filename,
+                        holder->size() - reader.pos(),
+                        names.size()));
+  VLOG(3) << "Mapped " << names.size() - copied_num << " params of "
+          << param_filename << ", copied " << copied_num
+          << " unaligned ones of " << copied_bytes << " bytes.";
+  return true;
+#endif
+}
+
+bool LoadCombinedParamsByMmap(framework::Scope* scope,
+                              const framework::ProgramDesc& main_program,
+                              const std::string& param_filename) {
+  std::vector<std::string> param_list;
+  for (auto* var : main_program.Block(0).AllVars()) {
+    if (!IsPersistable(var)) continue;
+    if (var->GetType() != framework::proto::VarType::LOD_TENSOR) {
+      VLOG(3) << "Params of type " << var->GetType()
+              << " can not be mapped, load " << param_filename
+              << " instead.";
+      return false;
+    }
+    param_list.push_back(var->Name());
+  }
+  // save_combine writes the params in the order of their names.
+  std::sort(param_list.begin(), param_list.end());
+  std::vector<phi::DenseTensor*> tensors;
+  tensors.reserve(param_list.size());
+  for (auto& name : param_list) {
+    tensors.push_back(scope->Var(name)->GetMutable<phi::DenseTensor>());
+  }
+  return LoadCombinedParamsByMmap(param_filename, param_list, tensors);
+}
+
 std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
                                              framework::Scope* scope,
                                              const std::string& dirname) {
@@ -166,7 +353,8 @@ std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
                                              framework::Scope* scope,
                                              const std::string& prog_filename,
                                              const std::string& param_filename,
-                                             bool load_params) {
+                                             bool load_params,
+                                             bool mmap_params) {
   std::string program_desc_str;
   ReadBinaryFile(prog_filename, &program_desc_str);
 
@@ -177,7 +365,9 @@ std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
       true,
       common::errors::Unavailable("Model version %ld is not supported.",
                                   main_program->Version()));
-  if (load_params) {
+  if (load_params &&
+      !(mmap_params &&
+        LoadCombinedParamsByMmap(scope, *main_program, param_filename))) {
     LoadPersistables(executor,
                      scope,
                      *main_program,
@@ -43,7 +43,22 @@ std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
                                              framework::Scope* scope,
                                              const std::string& prog_filename,
                                              const std::string& param_filename,
-                                             bool load_params = true);
+                                             bool load_params = true,
+                                             bool mmap_params = false);
+
+// Load the params of a combined params file by mapping it, the tensors
+// whose data is aligned in the file share its pages instead of copying
+// them, the others are copied into aligned memory. Return false when
+// the params can not be mapped, e.g. the file is missing or empty, and
+// should be loaded by load_combine.
+bool LoadCombinedParamsByMmap(const std::string& param_filename,
+                              const std::vector<std::string>& names,
+                              const std::vector<phi::DenseTensor*>& tensors);
+
+// Map the persistable params of main_program, in the order of their names.
+bool LoadCombinedParamsByMmap(framework::Scope* scope,
+                              const framework::ProgramDesc& main_program,
+                              const std::string& param_filename);
 
 std::unique_ptr<framework::ProgramDesc> LoadFromMemory(
     framework::Executor* executor,
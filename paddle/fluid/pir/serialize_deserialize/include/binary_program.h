@@ -0,0 +1,88 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/pir/serialize_deserialize/include/third_party.h"
+
+namespace pir {
+/**
+ * The binary format of a serialized program holds the same json objects as
+ * the text format, so that the patches of older versions are applied to it
+ * the same way. Every string and every type or attribute used more than once
+ * is stored only once, and the ops of the top level block are indexed, so a
+ * reader decodes them one by one in place instead of parsing the whole file.
+ *
+ * All integers are little endian:
+ *   header:    magic "PIRBIN\0\0", uint32 format version, uint32 reserved,
+ *              uint64 offsets of the strings, the shared values, the base
+ *              code, the program and the op index, uint64 number of ops
+ *   strings:   varint count, then varint size and bytes of each string
+ *   shared:    varint count, then varint size and encoding of each value
+ *   base code: encoded value
+ *   program:   encoded value, the top level block has no ops
+ *   ops:       encoded value of each op of the top level block
+ *   op index:  uint64 offset of each op
+ */
+constexpr uint32_t kBinaryProgramFormatVersion = 1;
+
+/** IsBinaryProgram checks whether data starts with the binary magic. */
+bool IsBinaryProgram(const char* data, size_t size);
+
+/** EncodeBinaryProgram encodes the base code and program json objects
+ * written by ProgramWriter. */
+std::string EncodeBinaryProgram(const Json& base_code,
+                                const Json& program_json);
+
+/**
+ * BinaryProgramView decodes a binary program in place. It does not own the
+ * data, which should outlive the view, so the data can also be a mapped
+ * file.
+ */
+class BinaryProgramView {
+ public:
+  BinaryProgramView(const char* data, size_t size);
+
+  BinaryProgramView(const BinaryProgramView&) = delete;
+  BinaryProgramView& operator=(const BinaryProgramView&) = delete;
+
+  Json BaseCode();
+  /** Program returns the program json whose top level block has no ops. */
+  Json Program();
+  size_t NumOps() const { return num_ops_; }
+  /** Op decodes the json of the index-th op of the top level block. */
+  Json Op(size_t index);
+
+  ~BinaryProgramView();
+
+ private:
+  class Decoder;
+
+  const char* data_;
+  size_t size_;
+  uint64_t base_code_offset_;
+  uint64_t program_offset_;
+  uint64_t op_index_offset_;
+  uint64_t num_ops_;
+
+  std::vector<std::string> strings_;
+  /** The byte ranges of the shared values and the ones decoded so far. */
+  std::vector<std::pair<uint64_t, uint64_t>> shared_ranges_;
+  std::vector<std::unique_ptr<Json>> shared_values_;
+};
+
+}  // namespace pir
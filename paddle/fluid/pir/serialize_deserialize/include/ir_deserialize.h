@@ -15,6 +15,7 @@
 
 #include <fstream>
 #include "paddle/common/enforce.h"
+#include "paddle/fluid/pir/serialize_deserialize/include/binary_program.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/schema.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/third_party.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/version_compat.h"
@@ -37,6 +38,11 @@ class ProgramReader {
   void RecoverProgram(Json* program_json,
                       pir::Program* recover_program,
                       pir::PatchBuilder* builder);
+  /** RecoverProgram of a binary program reads the ops of the top level
+   * block one by one, each op json is freed once its op is built. */
+  void RecoverProgram(BinaryProgramView* program_view,
+                      pir::Program* recover_program,
+                      pir::PatchBuilder* builder);
   pir::Type RecoverType(Json* type_json);
   pir::AttributeMap RecoverOpAttributesMap(Json* attrs_json);
   ~ProgramReader() = default;
@@ -49,6 +55,7 @@ class ProgramReader {
   void ReadProgram(Json* program_json, pir::Program* program);
   void ReadRegion(Json* region_json, pir::Region* region);
   void ReadBlock(Json* block_json, pir::Block* block);
+  void ReadBlockArgs(Json* block_json, pir::Block* block);
   pir::Operation* ReadOp(Json* op_json);
   pir::AttributeMap ReadAttributesMap(
       Json* attrs_json,
@@ -0,0 +1,522 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/pir/serialize_deserialize/include/binary_program.h"
+#include <cstring>
+#include <unordered_map>
+#include "paddle/common/enforce.h"
+#include "paddle/fluid/pir/serialize_deserialize/include/schema.h"
+
+namespace pir {
+
+namespace {
+
+constexpr char kMagic[8] = {'P', 'I', 'R', 'B', 'I', 'N', '\0', '\0'};
+// magic, format version, reserved, 5 offsets and the number of ops.
+constexpr size_t kHeaderSize = 8 + 4 + 4 + 6 * 8;
+// Bounds the recursion on damaged files.
+constexpr int kMaxDepth = 1024;
+
+enum Tag : uint8_t {
+  kNull = 0,
+  kFalse = 1,
+  kTrue = 2,
+  kInt = 3,
+  kUint = 4,
+  kFloat = 5,
+  kString = 6,
+  kArray = 7,
+  kObject = 8,
+  kShared = 9,
+};
+
+void WriteFixed(uint64_t value, size_t bytes, std::string* out) {
+  for (size_t i = 0; i < bytes; ++i) {
+    out->push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+void PatchFixed64(uint64_t value, size_t pos, std::string* out) {
+  for (size_t i = 0; i < 8; ++i) {
+    (*out)[pos + i] = static_cast<char>((value >> (8 * i)) & 0xff);
+  }
+}
+
+void WriteVarint(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+// The types and attributes are the values repeated the most in a program.
+bool IsShareCandidate(const std::string& key) {
+  return key == TYPE_TYPE || key == ATTR_TYPE;
+}
+
+class Encoder {
+ public:
+  void Collect(const Json& value) {
+    switch (value.type()) {
+      case Json::value_t::string:
+        InternString(value.get_ref<const std::string&>());
+        break;
+      case Json::value_t::array:
+        for (auto& item : value) Collect(item);
+        break;
+      case Json::value_t::object:
+        for (auto& item : value.items()) {
+          InternString(item.key());
+          if (IsShareCandidate(item.key())) CollectCandidate(item.value());
+          Collect(item.value());
+        }
+        break;
+      case Json::value_t::binary:
+      case Json::value_t::discarded:
+        PADDLE_THROW(common::errors::Unimplemented(
+            "Json of type %s can not be saved as binary.", value.type_name()));
+      default:
+        break;
+    }
+  }
+
+  void WriteStrings(std::string* out) const {
+    WriteVarint(strings_.size(), out);
+    for (auto* str : strings_) {
+      WriteVarint(str->size(), out);
+      out->append(*str);
+    }
+  }
+
+  // Gives the candidates used more than once their ids, and writes them.
+  void WriteShared(std::string* out) {
+    int64_t num_shared = 0;
+    for (auto* candidate : candidates_) {
+      if (candidate->count > 1) candidate->id = num_shared++;
+    }
+    WriteVarint(num_shared, out);
+    std::string encoded;
+    for (auto* candidate : candidates_) {
+      if (candidate->id < 0) continue;
+      encoded.clear();
+      Encode(*candidate->value, /*allow_shared=*/false, &encoded);
+      WriteVarint(encoded.size(), out);
+      out->append(encoded);
+    }
+  }
+
+  void Encode(const Json& value, bool allow_shared, std::string* out) const {
+    if (allow_shared) {
+      auto it = candidate_of_.find(&value);
+      if (it != candidate_of_.end() && it->second->id >= 0) {
+        out->push_back(kShared);
+        WriteVarint(it->second->id, out);
+        return;
+      }
+    }
+    switch (value.type()) {
+      case Json::value_t::null:
+        out->push_back(kNull);
+        break;
+      case Json::value_t::boolean:
+        out->push_back(value.get<bool>() ? kTrue : kFalse);
+        break;
+      case Json::value_t::number_integer: {
+        int64_t number = value.get<int64_t>();
+        out->push_back(kInt);
+        // zigzag, so that small negative numbers stay short.
+        WriteVarint((static_cast<uint64_t>(number) << 1) ^
+                        static_cast<uint64_t>(number >> 63),
+                    out);
+        break;
+      }
+      case Json::value_t::number_unsigned:
+        out->push_back(kUint);
+        WriteVarint(value.get<uint64_t>(), out);
+        break;
+      case Json::value_t::number_float: {
+        double number = value.get<double>();
+        uint64_t bits;
+        std::memcpy(&bits, &number, sizeof(bits));
+        out->push_back(kFloat);
+        WriteFixed(bits, 8, out);
+        break;
+      }
+      case Json::value_t::string:
+        out->push_back(kString);
+        WriteVarint(string_ids_.at(value.get_ref<const std::string&>()), out);
+        break;
+      case Json::value_t::array:
+        out->push_back(kArray);
+        WriteVarint(value.size(), out);
+        for (auto& item : value) Encode(item, true, out);
+        break;
+      case Json::value_t::object:
+        out->push_back(kObject);
+        WriteVarint(value.size(), out);
+        for (auto& item : value.items()) {
+          WriteVarint(string_ids_.at(item.key()), out);
+          Encode(item.value(), true, out);
+        }
+        break;
+      default:
+        PADDLE_THROW(common::errors::Unimplemented(
+            "Json of type %s can not be saved as binary.", value.type_name()));
+    }
+  }
+
+ private:
+  struct Candidate {
+    const Json* value;
+    int64_t count{0};
+    int64_t id{-1};
+  };
+
+  void InternString(const std::string& str) {
+    auto result = string_ids_.emplace(str, strings_.size());
+    if (result.second) strings_.push_back(&result.first->first);
+  }
+
+  void CollectCandidate(const Json& value) {
+    auto result = candidate_by_dump_.emplace(value.dump(), Candidate{&value});
+    Candidate* candidate = &result.first->second;
+    if (result.second) candidates_.push_back(candidate);
+    candidate->count++;
+    candidate_of_[&value] = candidate;
+  }
+
+  std::unordered_map<std::string, uint64_t> string_ids_;
+  std::vector<const std::string*> strings_;
+  std::unordered_map<std::string, Candidate> candidate_by_dump_;
+  // In the order they are first seen, to keep the output deterministic.
+  std::vector<Candidate*> candidates_;
+  std::unordered_map<const Json*, Candidate*> candidate_of_;
+};
+
+}  // namespace
+
+bool IsBinaryProgram(const char* data, size_t size) {
+  return size >= sizeof(kMagic) &&
+         std::memcmp(data, kMagic, sizeof(kMagic)) == 0;
+}
+
+std::string EncodeBinaryProgram(const Json& base_code,
+                                const Json& program_json) {
+  PADDLE_ENFORCE_EQ(
+      program_json.contains(REGIONS) && program_json.at(REGIONS).size() == 1 &&
+          program_json.at(REGIONS).at(0).at(BLOCKS).size() == 1,
+      true,
+      common::errors::InvalidArgument(
+          "The program to save should have one region with one block."));
+  // The ops of the top level block are written one by one after the rest
+  // of the program.
+  Json program = program_json;
+  Json& block = program.at(REGIONS).at(0).at(BLOCKS).at(0);
+  Json ops = std::move(block.at(BLOCKOPS));
+  block[BLOCKOPS] = Json::array();
+
+  Encoder encoder;
+  encoder.Collect(base_code);
+  encoder.Collect(program);
+  encoder.Collect(ops);
+
+  std::string out(kHeaderSize, '\0');
+  std::memcpy(&out[0], kMagic, sizeof(kMagic));
+  // The format version, followed by the reserved zeros.
+  PatchFixed64(kBinaryProgramFormatVersion, sizeof(kMagic), &out);
+  uint64_t strings_offset = out.size();
+  encoder.WriteStrings(&out);
+  uint64_t shared_offset = out.size();
+  encoder.WriteShared(&out);
+  uint64_t base_code_offset = out.size();
+  encoder.Encode(base_code, true, &out);
+  uint64_t program_offset = out.size();
+  encoder.Encode(program, true, &out);
+  std::vector<uint64_t> op_offsets;
+  op_offsets.reserve(ops.size());
+  for (auto& op : ops) {
+    op_offsets.push_back(out.size());
+    encoder.Encode(op, true, &out);
+  }
+  uint64_t op_index_offset = out.size();
+  for (auto offset : op_offsets) {
+    WriteFixed(offset, 8, &out);
+  }
+
+  size_t pos = sizeof(kMagic) + 8;
+  for (uint64_t field : {strings_offset,
+                         shared_offset,
+                         base_code_offset,
+                         program_offset,
+                         op_index_offset,
+                         static_cast<uint64_t>(op_offsets.size())}) {
+    PatchFixed64(field, pos, &out);
+    pos += 8;
+  }
+  VLOG(6) << "Encode binary program of " << op_offsets.size() << " ops into "
+          << out.size() << " bytes.";
+  return out;
+}
+
+class BinaryProgramView::Decoder {
+ public:
+  Decoder(BinaryProgramView* view, uint64_t begin, uint64_t end)
+      : view_(view), pos_(begin), end_(end) {
+    PADDLE_ENFORCE_EQ(
+        begin <= end && end <= view->size_,
+        true,
+        common::errors::InvalidArgument(
+            "The binary program is damaged, the range [%d, %d) is out of "
+            "the %d bytes.",
+            begin,
+            end,
+            view->size_));
+  }
+
+  uint64_t ReadFixed(size_t bytes) {
+    Require(bytes);
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+      value |= static_cast<uint64_t>(
+                   static_cast<uint8_t>(view_->data_[pos_ + i]))
+               << (8 * i);
+    }
+    pos_ += bytes;
+    return value;
+  }
+
+  uint64_t ReadVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      Require(1);
+      uint8_t byte = static_cast<uint8_t>(view_->data_[pos_++]);
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) return value;
+    }
+    PADDLE_THROW(common::errors::InvalidArgument(
+        "The binary program is damaged, a varint is too long at %d.", pos_));
+  }
+
+  // The count of the items that follow, each taking one byte at least.
+  uint64_t ReadCount() {
+    uint64_t count = ReadVarint();
+    Require(count);
+    return count;
+  }
+
+  std::string ReadBytes() {
+    uint64_t size = ReadCount();
+    std::string bytes(view_->data_ + pos_, size);
+    pos_ += size;
+    return bytes;
+  }
+
+  const std::string& ReadString() {
+    uint64_t id = ReadVarint();
+    PADDLE_ENFORCE_LT(id,
+                      view_->strings_.size(),
+                      common::errors::InvalidArgument(
+                          "The binary program is damaged, string %d is out "
+                          "of the %d strings.",
+                          id,
+                          view_->strings_.size()));
+    return view_->strings_[id];
+  }
+
+  Json ReadValue(int depth) {
+    PADDLE_ENFORCE_LT(
+        depth,
+        kMaxDepth,
+        common::errors::InvalidArgument(
+            "The binary program is damaged, values nest too deep."));
+    uint8_t tag = static_cast<uint8_t>(ReadFixed(1));
+    switch (tag) {
+      case kNull:
+        return Json();
+      case kFalse:
+        return Json(false);
+      case kTrue:
+        return Json(true);
+      case kInt: {
+        uint64_t zigzag = ReadVarint();
+        return Json(static_cast<int64_t>((zigzag >> 1) ^ (~(zigzag & 1) + 1)));
+      }
+      case kUint:
+        return Json(ReadVarint());
+      case kFloat: {
+        uint64_t bits = ReadFixed(8);
+        double number;
+        std::memcpy(&number, &bits, sizeof(number));
+        return Json(number);
+      }
+      case kString:
+        return Json(ReadString());
+      case kArray: {
+        uint64_t size = ReadCount();
+        Json array = Json::array();
+        for (uint64_t i = 0; i < size; ++i) {
+          array.emplace_back(ReadValue(depth + 1));
+        }
+        return array;
+      }
+      case kObject: {
+        uint64_t size = ReadCount();
+        Json object = Json::object();
+        for (uint64_t i = 0; i < size; ++i) {
+          const std::string& key = ReadString();
+          object[key] = ReadValue(depth + 1);
+        }
+        return object;
+      }
+      case kShared:
+        return ReadShared(ReadVarint(), depth + 1);
+      default:
+        PADDLE_THROW(common::errors::InvalidArgument(
+            "The binary program is damaged, unknown tag %d at %d.",
+            tag,
+            pos_ - 1));
+    }
+  }
+
+  void Skip(uint64_t bytes) {
+    Require(bytes);
+    pos_ += bytes;
+  }
+
+  uint64_t pos() const { return pos_; }
+
+ private:
+  void Require(uint64_t bytes) const {
+    PADDLE_ENFORCE_LE(bytes,
+                      end_ - pos_,
+                      common::errors::InvalidArgument(
+                          "The binary program is damaged, %d bytes are "
+                          "needed at %d but the section ends at %d.",
+                          bytes,
+                          pos_,
+                          end_));
+  }
+
+  Json ReadShared(uint64_t id, int depth) {
+    PADDLE_ENFORCE_LT(id,
+                      view_->shared_ranges_.size(),
+                      common::errors::InvalidArgument(
+                          "The binary program is damaged, shared value %d is "
+                          "out of the %d shared values.",
+                          id,
+                          view_->shared_ranges_.size()));
+    auto& value = view_->shared_values_[id];
+    if (!value) {
+      auto range = view_->shared_ranges_[id];
+      Decoder decoder(view_, range.first, range.second);
+      value = std::make_unique<Json>(decoder.ReadValue(depth));
+    }
+    return *value;
+  }
+
+  BinaryProgramView* view_;
+  uint64_t pos_;
+  uint64_t end_;
+};
+
+BinaryProgramView::BinaryProgramView(const char* data, size_t size)
+    : data_(data), size_(size) {
+  PADDLE_ENFORCE_EQ(
+      IsBinaryProgram(data, size) && size >= kHeaderSize,
+      true,
+      common::errors::InvalidArgument("Invalid binary model file."));
+  Decoder header(this, sizeof(kMagic), kHeaderSize);
+  uint64_t format_version = header.ReadFixed(4);
+  PADDLE_ENFORCE_LE(
+      format_version,
+      kBinaryProgramFormatVersion,
+      common::errors::Unimplemented(
+          "The binary model file of format version %d is newer than the "
+          "supported version %d.",
+          format_version,
+          kBinaryProgramFormatVersion));
+  header.ReadFixed(4);
+  uint64_t strings_offset = header.ReadFixed(8);
+  uint64_t shared_offset = header.ReadFixed(8);
+  base_code_offset_ = header.ReadFixed(8);
+  program_offset_ = header.ReadFixed(8);
+  op_index_offset_ = header.ReadFixed(8);
+  num_ops_ = header.ReadFixed(8);
+  PADDLE_ENFORCE_EQ(
+      strings_offset <= shared_offset && shared_offset <= base_code_offset_ &&
+          base_code_offset_ <= program_offset_ &&
+          program_offset_ <= op_index_offset_ && op_index_offset_ <= size_ &&
+          num_ops_ <= (size_ - op_index_offset_) / 8,
+      true,
+      common::errors::InvalidArgument(
+          "The binary program is damaged, its sections are out of order."));
+
+  Decoder strings(this, strings_offset, shared_offset);
+  uint64_t num_strings = strings.ReadCount();
+  strings_.reserve(num_strings);
+  for (uint64_t i = 0; i < num_strings; ++i) {
+    strings_.push_back(strings.ReadBytes());
+  }
+
+  Decoder shared(this, shared_offset, base_code_offset_);
+  uint64_t num_shared = shared.ReadCount();
+  shared_ranges_.reserve(num_shared);
+  for (uint64_t i = 0; i < num_shared; ++i) {
+    uint64_t value_size = shared.ReadVarint();
+    uint64_t begin = shared.pos();
+    PADDLE_ENFORCE_LE(
+        value_size,
+        base_code_offset_ - begin,
+        common::errors::InvalidArgument(
+            "The binary program is damaged, shared value %d is out of its "
+            "section.",
+            i));
+    shared_ranges_.emplace_back(begin, begin + value_size);
+    shared.Skip(value_size);
+  }
+  shared_values_.resize(num_shared);
+}
+
+BinaryProgramView::~BinaryProgramView() = default;
+
+Json BinaryProgramView::BaseCode() {
+  Decoder decoder(this, base_code_offset_, program_offset_);
+  return decoder.ReadValue(0);
+}
+
+Json BinaryProgramView::Program() {
+  uint64_t end = op_index_offset_;
+  if (num_ops_ > 0) {
+    Decoder index(this, op_index_offset_, op_index_offset_ + 8);
+    end = index.ReadFixed(8);
+  }
+  Decoder decoder(this, program_offset_, end);
+  return decoder.ReadValue(0);
+}
+
+Json BinaryProgramView::Op(size_t index) {
+  PADDLE_ENFORCE_LT(index,
+                    num_ops_,
+                    common::errors::OutOfRange(
+                        "Op %d is out of the %d ops.", index, num_ops_));
+  Decoder op_index(this, op_index_offset_ + 8 * index, size_);
+  uint64_t begin = op_index.ReadFixed(8);
+  uint64_t end = index + 1 < num_ops_ ? op_index.ReadFixed(8)
+                                      : op_index_offset_;
+  Decoder decoder(this, begin, end);
+  return decoder.ReadValue(0);
+}
+
+}  // namespace pir
@@ -15,7 +15,9 @@
 #include "paddle/fluid/pir/serialize_deserialize/include/interface.h"
 #include <stdio.h>
 #include <filesystem>
+#include <iterator>
 #include "paddle/common/enforce.h"
+#include "paddle/fluid/pir/serialize_deserialize/include/binary_program.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/ir_deserialize.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/ir_serialize.h"
 #include "paddle/phi/common/port.h"
@@ -32,7 +34,8 @@ void WriteModule(const pir::Program& program,
                  uint64_t pir_version,
                  bool overwrite,
                  bool readable,
-                 bool trainable) {
+                 bool trainable,
+                 bool binary) {
   PADDLE_ENFORCE_EQ(
       FileExists(file_path) && !overwrite,
       false,
@@ -51,7 +54,9 @@ void WriteModule(const pir::Program& program,
   // write program
   total[PROGRAM] = writer.GetProgramJson(&program);
   std::string total_str;
-  if (readable) {
+  if (binary) {
+    total_str = EncodeBinaryProgram(total[BASE_CODE], total[PROGRAM]);
+  } else if (readable) {
     total_str = total.dump(4);
   } else {
     total_str = total.dump();
@@ -67,40 +72,71 @@ void WriteModule(const pir::Program& program,
   fout.close();
 }
 
+namespace {
+
+// Checks the base code, and builds the patches if the file is of another
+// version. Returns whether the program is trainable.
+bool ReadBaseCode(const Json& base_code,
+                  int64_t pir_version,
+                  PatchBuilder* builder) {
+  if (base_code.contains(MAGIC) && base_code[MAGIC] == PIR) {
+    uint64_t file_version = base_code.at(PIRVERSION).template get<uint64_t>();
+    if (file_version != (uint64_t)pir_version) {
+      builder->SetFileVersion(file_version);
+      std::filesystem::path patch_path = std::filesystem::path(PATCH_PATH);
+      VLOG(8) << "Patch path: " << patch_path;
+      builder->BuildPatch(patch_path.string());
+    }
+  } else {
+    PADDLE_THROW(common::errors::InvalidArgument("Invalid model file."));
+  }
+
+  if (base_code.contains(TRAINABLE)) {
+    return base_code[TRAINABLE].get<bool>();
+  } else {
+    return false;
+  }
+}
+
+}  // namespace
+
 bool ReadModule(const std::string& file_path,
                 pir::Program* program,
                 int64_t pir_version) {
-  std::ifstream f(file_path);
-  Json data = Json::parse(f);
+  std::ifstream f(file_path, std::ios::binary);
+  PADDLE_ENFORCE_EQ(static_cast<bool>(f),
+                    true,
+                    common::errors::Unavailable(
+                        "Cannot open %s to load the program.", file_path));
   if (pir_version < 0) {
     pir_version = GetPirVersion();
     VLOG(6) << "pir_version is null, get pir_version: " << pir_version;
   }
 
   PatchBuilder builder(pir_version);
+  ProgramReader reader(pir_version);
 
-  if (data.contains(BASE_CODE) && data[BASE_CODE].contains(MAGIC) &&
-      data[BASE_CODE][MAGIC] == PIR) {
-    uint64_t file_version =
-        data.at(BASE_CODE).at(PIRVERSION).template get<uint64_t>();
-    if (file_version != (uint64_t)pir_version) {
-      builder.SetFileVersion(file_version);
-      std::filesystem::path patch_path = std::filesystem::path(PATCH_PATH);
-      VLOG(8) << "Patch path: " << patch_path;
-      builder.BuildPatch(patch_path.string());
-    }
-  } else {
-    PADDLE_THROW(common::errors::InvalidArgument("Invalid model file."));
+  char magic[8] = {0};
+  f.read(magic, sizeof(magic));
+  size_t magic_size = static_cast<size_t>(f.gcount());
+  f.clear();
+  f.seekg(0);
+  if (IsBinaryProgram(magic, magic_size)) {
+    std::string data((std::istreambuf_iterator<char>(f)),
+                     std::istreambuf_iterator<char>());
+    BinaryProgramView view(data.data(), data.size());
+    bool trainable = ReadBaseCode(view.BaseCode(), pir_version, &builder);
+    reader.RecoverProgram(&view, program, &builder);
+    return trainable;
   }
 
-  ProgramReader reader(pir_version);
-  reader.RecoverProgram(&(data[PROGRAM]), program, &builder);
-
-  if (data[BASE_CODE].contains(TRAINABLE)) {
-    return data[BASE_CODE][TRAINABLE].get<bool>();
-  } else {
-    return false;
+  Json data = Json::parse(f);
+  if (!data.contains(BASE_CODE)) {
+    PADDLE_THROW(common::errors::InvalidArgument("Invalid model file."));
   }
+  bool trainable = ReadBaseCode(data[BASE_CODE], pir_version, &builder);
+  reader.RecoverProgram(&(data[PROGRAM]), program, &builder);
+  return trainable;
 }
 
 }  // namespace pir
@@ -26,6 +26,28 @@ void ProgramReader::RecoverProgram(Json* program_json,
   return;
 }
 
+void ProgramReader::RecoverProgram(BinaryProgramView* program_view,
+                                   pir::Program* recover_program,
+                                   pir::PatchBuilder* builder) {
+  id_value_map[0] = pir::Value();
+  patch_builder = builder;
+  Json program_json = program_view->Program();
+  PADDLE_ENFORCE_EQ(
+      program_json.at(REGIONS).size(),
+      1,
+      common::errors::InvalidArgument(
+          "The redions size of program module should be 1 but got %d.",
+          program_json.at(REGIONS).size()));
+  auto& block_json = program_json.at(REGIONS).at(0).at(BLOCKS).at(0);
+  auto& block = recover_program->module_op().block();
+  ReadBlockArgs(&block_json, &block);
+  for (size_t i = 0; i < program_view->NumOps(); ++i) {
+    Json op_json = program_view->Op(i);
+    block.push_back(ReadOp(&op_json));
+  }
+  VLOG(6) << "Finish binary to program.";
+}
+
 pir::Type ProgramReader::RecoverType(Json* type_json) {
   return ReadType(type_json);
 }
@@ -65,7 +87,21 @@ void ProgramReader::ReadRegion(Json* region_json, pir::Region* region) {
 
 void ProgramReader::ReadBlock(Json* block_json, pir::Block* block) {
   auto block_name = block_json->at(ID).template get<std::string>();
+  ReadBlockArgs(block_json, block);
+
+  Json& ops_json = block_json->at(BLOCKOPS);
+  if (!ops_json.empty()) {
+    for (auto& op_json : ops_json) {
+      block->push_back(ReadOp(&op_json));
+    }
+    VLOG(6) << "read block size" << block->size() << ".";
+  }
 
+  VLOG(4) << "Finish Read " << block_name << ".";
+  return;
+}
+
+void ProgramReader::ReadBlockArgs(Json* block_json, pir::Block* block) {
   Json& args_json = block_json->at(BLOCKARGS);
   if (!args_json.empty()) {
     for (auto& arg_json : args_json) {
@@ -90,17 +126,6 @@ void ProgramReader::ReadBlock(Json* block_json, pir::Block* block) {
       VLOG(6) << "Finish Read keyword blockarguments. ";
     }
   }
-
-  Json& ops_json = block_json->at(BLOCKOPS);
-  if (!ops_json.empty()) {
-    for (auto& op_json : ops_json) {
-      block->push_back(ReadOp(&op_json));
-    }
-    VLOG(6) << "read block size" << block->size() << ".";
-  }
-
-  VLOG(4) << "Finish Read " << block_name << ".";
-  return;
 }
 pir::ArrayAttribute GetOneBoolArrayAttribute(pir::IrContext* ctx,
                                              Json* attr_json) {
@@ -0,0 +1,376 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/pir/transforms/general/memory_plan_pass.h"
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/fluid/framework/new_executor/new_executor_defs.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_dialect.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_op.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_type.h"
+#include "paddle/fluid/pir/dialect/operator/interface/op_yaml_info.h"
+#include "paddle/fluid/pir/dialect/operator/utils/op_yaml_info_parser.h"
+#include "paddle/fluid/pir/dialect/operator/utils/utils.h"
+#include "paddle/pir/include/core/builtin_attribute.h"
+#include "paddle/pir/include/core/builtin_op.h"
+#include "paddle/pir/include/pass/pass.h"
+#include "paddle/pir/include/pass/pass_registry.h"
+
+namespace {
+
+using TensorType = paddle::dialect::AllocatedDenseTensorType;
+
+// The offsets are aligned for the vectorized kernels.
+constexpr int64_t kAlignment = 64;
+
+// Kernels that may share the buffer of their inputs without declaring a
+// view or an inplace in their yaml.
+const std::unordered_set<std::string> kMayShareInputOps = {
+    "pd_op.transfer_layout",
+    "pd_op.onednn_to_paddle_layout",
+    "pd_op.npu_identity",
+    "pd_op.share_data",
+    "pd_op.share_data_",
+    "pd_op.array_read",
+};
+
+// The values that share one buffer: the outputs of view and inplace ops
+// and their inputs, and the values through the ops whose buffer sharing is
+// unknown.
+class AliasSets {
+ public:
+  pir::Value Find(pir::Value value) {
+    auto it = parent_.find(value);
+    if (it == parent_.end() || it->second == value) return value;
+    pir::Value root = Find(it->second);
+    parent_[value] = root;
+    return root;
+  }
+
+  void Union(pir::Value a, pir::Value b) {
+    if (!a || !b) return;
+    pir::Value root_a = Find(a);
+    pir::Value root_b = Find(b);
+    if (root_a != root_b) parent_[root_b] = root_a;
+  }
+
+ private:
+  std::unordered_map<pir::Value, pir::Value> parent_;
+};
+
+struct Buffer {
+  pir::Value value;
+  int64_t size;
+  // The indices of the first and the last op the buffer is live in.
+  size_t begin;
+  size_t end;
+  int64_t offset{-1};
+};
+
+int64_t AlignedSize(pir::Value value) {
+  if (!value || !value.type() || !value.type().isa<TensorType>()) return -1;
+  auto type = value.type().dyn_cast<TensorType>();
+  if (type.place().GetType() != phi::AllocationType::CPU) return -1;
+  int64_t numel = 1;
+  for (int i = 0; i < type.dims().size(); ++i) {
+    if (type.dims()[i] < 0) return -1;
+    numel *= type.dims()[i];
+  }
+  auto dtype = paddle::dialect::TransToPhiDataType(type.dtype());
+  if (dtype == phi::DataType::UNDEFINED) return -1;
+  int64_t size = numel * static_cast<int64_t>(phi::SizeOf(dtype));
+  return (size + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+bool IsPersistable(pir::Value value) {
+  auto attr = value.attribute<pir::BoolAttribute>(kAttrIsPersistable);
+  return attr && attr.data();
+}
+
+void UnionViewAndInplace(pir::Operation* op,
+                         const std::string& op_name,
+                         AliasSets* aliases) {
+  pir::OpInfo op_info =
+      pir::IrContext::Instance()->GetRegisteredOpInfo(op_name);
+  paddle::dialect::OpYamlInfoInterface::Concept* info_interface = nullptr;
+  if (op_info) {
+    info_interface =
+        op_info.GetInterfaceImpl<paddle::dialect::OpYamlInfoInterface>();
+  }
+  if (!info_interface) {
+    for (auto result : op->results()) {
+      for (auto operand : op->operands_source()) {
+        aliases->Union(operand, result);
+      }
+    }
+    return;
+  }
+  paddle::dialect::OpYamlInfoParser info_parser(
+      info_interface->get_op_info_(op_name),
+      paddle::dialect::IsLegacyOp(op_name));
+  const auto& output_names = info_parser.OutputNames();
+  for (size_t i = 0; i < output_names.size() && i < op->num_results(); ++i) {
+    const std::string* input_name = nullptr;
+    if (info_parser.HasInplace(output_names[i])) {
+      input_name = &info_parser.InplaceName(output_names[i]);
+    } else if (info_parser.HasView(output_names[i])) {
+      input_name = &info_parser.ViewName(output_names[i]);
+    }
+    if (input_name == nullptr) continue;
+    uint32_t input_id = info_parser.InputName2Id().at(*input_name);
+    if (input_id < op->num_operands()) {
+      aliases->Union(op->operand_source(input_id), op->result(i));
+    }
+  }
+}
+
+// Places the buffers largest first, each one in the smallest gap between
+// the buffers already placed that are live at the same time.
+int64_t PackBuffers(std::vector<Buffer>* buffers) {
+  std::vector<Buffer*> order;
+  order.reserve(buffers->size());
+  for (auto& buffer : *buffers) order.push_back(&buffer);
+  std::stable_sort(order.begin(), order.end(), [](Buffer* a, Buffer* b) {
+    return a->size > b->size;
+  });
+
+  int64_t arena_size = 0;
+  std::vector<Buffer*> placed;
+  std::vector<Buffer*> live;
+  for (auto* buffer : order) {
+    live.clear();
+    for (auto* other : placed) {
+      if (other->begin <= buffer->end && buffer->begin <= other->end) {
+        live.push_back(other);
+      }
+    }
+    std::sort(live.begin(), live.end(), [](Buffer* a, Buffer* b) {
+      return a->offset < b->offset;
+    });
+    int64_t best_offset = -1;
+    int64_t best_gap = std::numeric_limits<int64_t>::max();
+    int64_t gap_begin = 0;
+    for (auto* other : live) {
+      int64_t gap = other->offset - gap_begin;
+      if (gap >= buffer->size && gap < best_gap) {
+        best_gap = gap;
+        best_offset = gap_begin;
+      }
+      gap_begin = std::max(gap_begin, other->offset + other->size);
+    }
+    buffer->offset = best_offset >= 0 ? best_offset : gap_begin;
+    arena_size = std::max(arena_size, buffer->offset + buffer->size);
+    placed.push_back(buffer);
+  }
+  return arena_size;
+}
+
+class MemoryPlanPass : public pir::Pass {
+ public:
+  MemoryPlanPass() : pir::Pass("memory_plan_pass", 3) {}
+
+  void Run(pir::Operation* op) override {
+    auto module_op = op->dyn_cast<pir::ModuleOp>();
+    pir::Block& block = module_op.block();
+
+    std::vector<pir::Operation*> ops;
+    std::unordered_map<pir::Value, size_t> def_index;
+    std::unordered_map<pir::Value, size_t> last_use;
+    std::unordered_set<pir::Value> skip_values;
+    AliasSets aliases;
+    for (auto& inner_op : block) {
+      size_t index = ops.size();
+      ops.push_back(&inner_op);
+      for (auto result : inner_op.results()) {
+        def_index[result] = index;
+      }
+      for (auto operand : inner_op.operands_source()) {
+        if (operand) last_use[operand] = index;
+      }
+      // The values used in sub blocks may live as long as the sub blocks
+      // are run by their own interpreters.
+      for (size_t i = 0; i < inner_op.num_regions(); ++i) {
+        for (auto& sub_block : inner_op.region(i)) {
+          for (auto& sub_op : sub_block) {
+            sub_op.Walk([&](pir::Operation* nested_op) {
+              for (auto operand : nested_op->operands_source()) {
+                skip_values.insert(operand);
+              }
+            });
+          }
+        }
+      }
+    }
+
+    for (size_t index = 0; index < ops.size(); ++index) {
+      auto* inner_op = ops[index];
+      if (inner_op->isa<paddle::dialect::PhiKernelOp>()) {
+        auto kernel_op = inner_op->dyn_cast<paddle::dialect::PhiKernelOp>();
+        std::string op_name = kernel_op.op_name();
+        if (op_name == "pd_op.fetch") {
+          skip_values.insert(inner_op->operand_source(0));
+        } else if (op_name == "pd_op.data" || op_name == "pd_op.feed" ||
+                   op_name == "pd_op.shadow_feed") {
+          skip_values.insert(inner_op->result(0));
+        }
+        if (kMayShareInputOps.count(op_name)) {
+          for (auto result : inner_op->results()) {
+            for (auto operand : inner_op->operands_source()) {
+              aliases.Union(operand, result);
+            }
+          }
+        } else {
+          UnionViewAndInplace(inner_op, op_name, &aliases);
+        }
+      } else if (inner_op->isa<pir::CombineOp>() &&
+                 AllUsersAreKernels(inner_op->result(0))) {
+        // The vector is only read by kernels, its items live as long as it.
+        auto result = inner_op->result(0);
+        for (auto operand : inner_op->operands_source()) {
+          if (last_use.count(result)) {
+            last_use[operand] = std::max(last_use[operand], last_use[result]);
+          }
+        }
+      } else {
+        if (inner_op->name() == "builtin.shadow_output") {
+          skip_values.insert(inner_op->operand_source(0));
+        }
+        for (auto result : inner_op->results()) {
+          for (auto operand : inner_op->operands_source()) {
+            aliases.Union(operand, result);
+          }
+        }
+      }
+    }
+
+    // Collect the live range of every alias set, the set is planned as one
+    // buffer when its first value is an intermediate planned result.
+    struct AliasInfo {
+      pir::Value first;
+      size_t begin{std::numeric_limits<size_t>::max()};
+      size_t end{0};
+      bool skip{false};
+    };
+    std::unordered_map<pir::Value, AliasInfo> alias_infos;
+    auto visit_value = [&](pir::Value value) {
+      auto& info = alias_infos[aliases.Find(value)];
+      auto def_it = def_index.find(value);
+      if (def_it == def_index.end() || skip_values.count(value) ||
+          IsPersistable(value)) {
+        info.skip = true;
+        return;
+      }
+      if (def_it->second < info.begin) {
+        info.begin = def_it->second;
+        info.first = value;
+      }
+      info.end = std::max(info.end, def_it->second);
+      auto use_it = last_use.find(value);
+      if (use_it != last_use.end()) {
+        info.end = std::max(info.end, use_it->second);
+      }
+    };
+    for (auto* inner_op : ops) {
+      for (auto operand : inner_op->operands_source()) {
+        if (operand) visit_value(operand);
+      }
+      for (auto result : inner_op->results()) {
+        visit_value(result);
+      }
+    }
+
+    std::vector<Buffer> buffers;
+    int64_t total_size = 0;
+    for (auto& [root, info] : alias_infos) {
+      if (info.skip || !info.first || !IsPlannable(info.first)) continue;
+      int64_t size = AlignedSize(info.first);
+      if (size <= 0) continue;
+      buffers.push_back(Buffer{info.first, size, info.begin, info.end});
+      total_size += size;
+    }
+    if (buffers.empty()) {
+      AddStatistics(0);
+      return;
+    }
+    // Keep the plan deterministic whatever the order of the hash map.
+    std::sort(
+        buffers.begin(), buffers.end(), [](const Buffer& a, const Buffer& b) {
+          if (a.begin != b.begin) return a.begin < b.begin;
+          return a.value.dyn_cast<pir::OpResult>().index() <
+                 b.value.dyn_cast<pir::OpResult>().index();
+        });
+    int64_t arena_size = PackBuffers(&buffers);
+
+    pir::IrContext* ctx = pir::IrContext::Instance();
+    std::unordered_map<pir::Operation*, std::vector<int64_t>> op_offsets;
+    for (auto& buffer : buffers) {
+      auto* def_op = buffer.value.defining_op();
+      auto& offsets = op_offsets[def_op];
+      offsets.resize(def_op->num_results(), -1);
+      offsets[buffer.value.dyn_cast<pir::OpResult>().index()] = buffer.offset;
+    }
+    for (auto& [def_op, offsets] : op_offsets) {
+      std::vector<pir::Attribute> attrs;
+      attrs.reserve(offsets.size());
+      for (auto offset : offsets) {
+        attrs.push_back(pir::Int64Attribute::get(ctx, offset));
+      }
+      def_op->set_attribute(paddle::framework::interpreter::kMemoryPlanOffsets,
+                            pir::ArrayAttribute::get(ctx, attrs));
+    }
+    op->set_attribute(paddle::framework::interpreter::kMemoryPlanArenaSize,
+                      pir::Int64Attribute::get(ctx, arena_size));
+    VLOG(3) << "Planned " << buffers.size() << " buffers of " << total_size
+            << " bytes into an arena of " << arena_size << " bytes";
+    AddStatistics(static_cast<int64_t>(buffers.size()));
+  }
+
+  bool CanApplyOn(pir::Operation* op) const override {
+    return op->isa<pir::ModuleOp>() && op->num_regions() > 0;
+  }
+
+ private:
+  static bool AllUsersAreKernels(pir::Value value) {
+    for (auto it = value.use_begin(); it != value.use_end(); ++it) {
+      if (!it->owner()->isa<paddle::dialect::PhiKernelOp>()) return false;
+    }
+    return true;
+  }
+
+  // The results of phi kernels on CPU, allocated by the kernels.
+  static bool IsPlannable(pir::Value value) {
+    auto* def_op = value.defining_op();
+    if (!def_op || !def_op->isa<paddle::dialect::PhiKernelOp>()) return false;
+    auto kernel_op = def_op->dyn_cast<paddle::dialect::PhiKernelOp>();
+    return kernel_op.kernel_key().backend() == phi::Backend::CPU;
+  }
+};
+
+}  // namespace
+
+namespace pir {
+
+std::unique_ptr<Pass> CreateMemoryPlanPass() {
+  return std::make_unique<MemoryPlanPass>();
+}
+
+}  // namespace pir
+
+REGISTER_IR_PASS(memory_plan_pass, MemoryPlanPass);
@@ -879,6 +879,10 @@ void BindAnalysisConfig(py::module *m) {
       .def("enable_save_optim_model",
            &AnalysisConfig::EnableSaveOptimModel,
            py::arg("save_optimized_model") = false)
+      .def("enable_mmap_params",
+           &AnalysisConfig::EnableMmapParams,
+           py::arg("x") = true)
+      .def("mmap_params_enabled", &AnalysisConfig::mmap_params_enabled)
       .def("set_optim_cache_dir", &AnalysisConfig::SetOptimCacheDir)
       .def("switch_use_feed_fetch_ops",
            &AnalysisConfig::SwitchUseFeedFetchOps,
@@ -973,6 +977,10 @@ void BindAnalysisConfig(py::module *m) {
            &AnalysisConfig::SetCpuMathLibraryNumThreads)
       .def("cpu_math_library_num_threads",
            &AnalysisConfig::cpu_math_library_num_threads)
+      .def("set_cpu_intra_op_num_threads",
+           &AnalysisConfig::SetCpuIntraOpNumThreads)
+      .def("cpu_intra_op_num_threads",
+           &AnalysisConfig::cpu_intra_op_num_threads)
       .def("to_native_config", &AnalysisConfig::ToNativeConfig)
       .def("enable_mkldnn_bfloat16", &AnalysisConfig::EnableMkldnnBfloat16)
 #ifdef PADDLE_WITH_DNNL
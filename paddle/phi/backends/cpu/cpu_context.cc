@@ -14,8 +14,12 @@
 
 #include "paddle/phi/backends/cpu/cpu_context.h"
 
+#include <mutex>
+#include <unordered_map>
+
 #include "paddle/phi/common/place.h"
 #include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/threadpool.h"
 
 // NOTE: The paddle framework should add WITH_EIGEN option to support compile
 // without eigen.
@@ -24,6 +28,41 @@
 
 namespace phi {
 
+namespace {
+
+thread_local int thread_intra_op_num_threads = 1;
+thread_local ThreadPool* thread_intra_op_pool = nullptr;
+
+// The pools live as long as the process, the threads of a predictor come
+// and go with its requests.
+ThreadPool* GetIntraOpPool(int num_threads) {
+  static std::mutex mutex;
+  static std::unordered_map<int, std::unique_ptr<ThreadPool>> pools;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& pool = pools[num_threads];
+  if (!pool) {
+    pool = std::make_unique<ThreadPool>(num_threads - 1);
+  }
+  return pool.get();
+}
+
+}  // namespace
+
+void SetIntraOpNumThreads(int num_threads) {
+  PADDLE_ENFORCE_GT(num_threads,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The number of intra op threads should be larger "
+                        "than 0, but got %d.",
+                        num_threads));
+  if (num_threads == thread_intra_op_num_threads) return;
+  thread_intra_op_num_threads = num_threads;
+  thread_intra_op_pool =
+      num_threads > 1 ? GetIntraOpPool(num_threads) : nullptr;
+}
+
+int GetIntraOpNumThreads() { return thread_intra_op_num_threads; }
+
 struct CPUContext::Impl {
   Impl() : place_(CPUPlace()) {}
 
@@ -75,6 +114,12 @@ Eigen::DefaultDevice* CPUContext::eigen_device() const {
 
 const Place& CPUContext::GetPlace() const { return impl_->place_; }
 
+int CPUContext::intra_op_num_threads() const {
+  return thread_intra_op_num_threads;
+}
+
+ThreadPool* CPUContext::intra_op_pool() const { return thread_intra_op_pool; }
+
 void CPUContext::SetEigenDevice(Eigen::DefaultDevice* device) {
   impl_->eigen_device_ = device;
 }
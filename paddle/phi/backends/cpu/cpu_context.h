@@ -24,6 +24,15 @@ limitations under the License. */
 
 namespace phi {
 
+class ThreadPool;
+
+// Sets the number of threads the CPU kernels run by the calling thread may
+// use within one op, 1 (the default) runs every op serially. The threads
+// beyond the calling one come from a pool shared by the threads of the same
+// number.
+PADDLE_API void SetIntraOpNumThreads(int num_threads);
+PADDLE_API int GetIntraOpNumThreads();
+
 class PADDLE_API CPUContext : public DeviceContext,
                               public TypeInfoTraits<DeviceContext, CPUContext> {
  public:
@@ -35,6 +44,11 @@ class PADDLE_API CPUContext : public DeviceContext,
   Eigen::DefaultDevice* eigen_device() const;
   const Place& GetPlace() const override;
 
+  // The number of threads of the calling thread for one op, and the pool to
+  // run all but one of them, nullptr if it is 1. See funcs::ParallelFor.
+  int intra_op_num_threads() const;
+  ThreadPool* intra_op_pool() const;
+
   static const char* name() { return "CPUContext"; }
 
  protected:
@@ -26,6 +26,7 @@
 #include "paddle/phi/core/memory/allocation/cpu_allocator.h"
 #include "paddle/phi/core/memory/allocation/naive_best_fit_allocator.h"
 #include "paddle/phi/core/memory/allocation/retry_allocator.h"
+#include "paddle/phi/core/memory/allocation/size_class_cpu_allocator.h"
 #include "paddle/phi/core/memory/allocation/stat_allocator.h"
 #include "paddle/phi/core/platform/device_context.h"
 
@@ -339,6 +340,39 @@ class AllocatorFacadePrivate {
         break;
       }
 
+      case AllocatorStrategy::kSizeClass: {
+        // NOTE: size_class only changes the CPU allocator, it is meant for
+        // CPU-only inference hosts. Other places fall back to naive_best_fit.
+        InitSizeClassCPUAllocator();
+#ifdef PADDLE_WITH_IPU
+        for (int dev_id = 0; dev_id < platform::GetIPUDeviceCount(); ++dev_id) {
+          InitNaiveBestFitIPUAllocator(phi::IPUPlace(dev_id));
+        }
+#endif
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+        for (int dev_id = 0; dev_id < platform::GetGPUDeviceCount(); ++dev_id) {
+          InitNaiveBestFitCUDAAllocator(phi::GPUPlace(dev_id));
+        }
+        InitNaiveBestFitCUDAPinnedAllocator();
+#endif
+#ifdef PADDLE_WITH_XPU
+        for (int dev_id = 0; dev_id < platform::GetXPUDeviceCount(); ++dev_id) {
+          InitNaiveBestFitXPUAllocator(phi::XPUPlace(dev_id));
+        }
+#endif
+#ifdef PADDLE_WITH_CUSTOM_DEVICE
+        auto device_types = phi::DeviceManager::GetAllCustomDeviceTypes();
+        for (const auto& dev_type : device_types) {
+          for (auto& dev_id :
+               phi::DeviceManager::GetSelectedDeviceList(dev_type)) {
+            InitNaiveBestFitCustomDeviceAllocator(
+                phi::CustomPlace(dev_type, dev_id));
+          }
+        }
+#endif
+        break;
+      }
+
       default: {
         PADDLE_THROW(common::errors::InvalidArgument(
             "Unsupported allocator strategy: %d", static_cast<int>(strategy_)));
@@ -831,6 +865,11 @@ class AllocatorFacadePrivate {
 #endif
   }
 
+  void InitSizeClassCPUAllocator() {
+    allocators_[phi::CPUPlace()] = std::make_shared<SizeClassCPUAllocator>(
+        std::make_shared<CPUAllocator>());
+  }
+
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   void InitNaiveBestFitCUDAPinnedAllocator() {
     if (FLAGS_use_auto_growth_pinned_allocator) {
@@ -18,6 +18,7 @@
 
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <cstdlib>
 
 #include <atomic>
@@ -259,6 +260,10 @@ MemoryMapReaderAllocation::~MemoryMapReaderAllocation() {
     common::errors::Unavailable("could not unmap the shared memory file %s",
                                 this->ipc_name());
   }
+  if (from_file_) {
+    VLOG(3) << "~MemoryMapReaderAllocation: unmap file " << this->ipc_name();
+    return;
+  }
 
   /* Here we do not pay attention to the result of shm_unlink,
      because the memory mapped file may have been cleared due to the
@@ -325,6 +330,34 @@ std::shared_ptr<MemoryMapReaderAllocation> RebuildMemoryMapReaderAllocation(
   return std::make_shared<MemoryMapReaderAllocation>(ptr, size, ipc_name);
 }
 
+std::shared_ptr<MemoryMapReaderAllocation> MapFileReaderAllocation(
+    const std::string &filename) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  PADDLE_ENFORCE_NE(
+      fd,
+      -1,
+      common::errors::Unavailable("Failed to open file %s.", filename));
+  struct stat file_stat;
+  int ret = fstat(fd, &file_stat);
+  if (ret == -1 || file_stat.st_size == 0) {
+    close(fd);
+    PADDLE_THROW(common::errors::Unavailable(
+        "Failed to map file %s, it is empty or can not be read.", filename));
+  }
+  size_t size = file_stat.st_size;
+  // Writable but private, so the pages changed in place are copied and the
+  // file is never written.
+  void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  PADDLE_ENFORCE_NE(
+      ptr,
+      MAP_FAILED,
+      common::errors::Unavailable("Memory map failed for file %s.", filename));
+  VLOG(3) << "Map file " << filename << " of " << size << " bytes";
+  return std::make_shared<MemoryMapReaderAllocation>(
+      ptr, size, filename, true /* from_file */);
+}
+
 MemoryMapFdSet &MemoryMapFdSet::Instance() {  // NOLINT
   static MemoryMapFdSet set;
   return set;
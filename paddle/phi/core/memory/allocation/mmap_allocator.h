@@ -132,20 +132,26 @@ class MemoryMapWriterAllocation : public Allocation {
 
 class MemoryMapReaderAllocation : public Allocation {
  public:
+  // A mapping of a regular file rather than a shared memory object is only
+  // unmapped when released, the file is kept.
   explicit MemoryMapReaderAllocation(void *ptr,
                                      size_t size,
-                                     std::string ipc_name)
+                                     std::string ipc_name,
+                                     bool from_file = false)
       : Allocation(ptr, size, phi::CPUPlace()),
-        ipc_name_(std::move(ipc_name)) {}
+        ipc_name_(std::move(ipc_name)),
+        from_file_(from_file) {}
 
   inline const std::string &ipc_name() const { return ipc_name_; }
   inline const int shared_fd() const { return fd_; }
+  inline bool from_file() const { return from_file_; }
 
   ~MemoryMapReaderAllocation() override;
 
  private:
   std::string ipc_name_;
   int fd_ = -1;
+  bool from_file_ = false;
 };
 
 std::shared_ptr<MemoryMapWriterAllocation> AllocateMemoryMapWriterAllocation(
@@ -154,6 +160,11 @@ std::shared_ptr<MemoryMapWriterAllocation> AllocateMemoryMapWriterAllocation(
 std::shared_ptr<MemoryMapReaderAllocation> RebuildMemoryMapReaderAllocation(
     const std::string &ipc_name, size_t size);
 
+// Maps the whole file copy-on-write: the pages not written to are shared
+// through the page cache with every other process mapping the file.
+std::shared_ptr<MemoryMapReaderAllocation> MapFileReaderAllocation(
+    const std::string &filename);
+
 class MemoryMapFdSet {
  public:
   static MemoryMapFdSet &Instance();  // NOLINT
@@ -0,0 +1,317 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/core/memory/allocation/size_class_cpu_allocator.h"
+
+#include <algorithm>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <utility>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+#include "paddle/common/flags.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/memory/stats.h"
+
+COMMON_DECLARE_bool(size_class_cpu_allocator_use_huge_page);
+COMMON_DECLARE_uint64(size_class_cpu_allocator_idle_limit_in_mb);
+
+namespace paddle::memory::allocation {
+
+namespace {
+
+constexpr size_t kSmallClassStep = 64;
+constexpr size_t kSmallClassMax = 1024;
+constexpr size_t kNumSmallClasses = kSmallClassMax / kSmallClassStep;
+// Each power of two above kSmallClassMax is split into this many classes.
+constexpr size_t kClassesPerPow2 = 4;
+constexpr int kSmallClassMaxLog2 = 10;
+
+// The number of blocks a thread cache moves from/to the central list at
+// once. Small classes move more blocks, so the central lock is amortized,
+// while large classes keep the per-thread idle memory bounded.
+size_t BatchSize(size_t class_size) {
+  constexpr size_t kBatchBytes = 64UL << 10;
+  return std::max<size_t>(
+      2, std::min<size_t>(32, kBatchBytes / class_size));  // NOLINT
+}
+
+}  // namespace
+
+size_t SizeClassArena::SizeClassIndex(size_t size) {
+  if (size <= kSmallClassMax) {
+    return size == 0 ? 0 : (size - 1) / kSmallClassStep;
+  }
+  // lg = floor(log2(size - 1)), at most a few iterations since
+  // kSmallClassMax < size <= kMaxClassSize.
+  int lg = kSmallClassMaxLog2;
+  while ((size - 1) >> (lg + 1)) {
+    ++lg;
+  }
+  size_t sub = (size - 1 - (1UL << lg)) >> (lg - 2);
+  return kNumSmallClasses + (lg - kSmallClassMaxLog2) * kClassesPerPow2 + sub;
+}
+
+size_t SizeClassArena::ClassSize(size_t index) {
+  if (index < kNumSmallClasses) {
+    return (index + 1) * kSmallClassStep;
+  }
+  size_t lg = kSmallClassMaxLog2 + (index - kNumSmallClasses) / kClassesPerPow2;
+  size_t sub = (index - kNumSmallClasses) % kClassesPerPow2;
+  return (1UL << lg) + (sub + 1) * (1UL << (lg - 2));
+}
+
+// Per-thread free lists. Blocks freed on a thread go to that thread's cache
+// whichever thread allocated them, and everything is flushed back to the
+// central lists when the thread exits.
+class SizeClassThreadCache {
+ public:
+  static SizeClassThreadCache& Get() {
+    static thread_local SizeClassThreadCache cache;
+    return cache;
+  }
+
+  ~SizeClassThreadCache() {
+    auto& arena = SizeClassArena::Instance();
+    for (size_t i = 0; i < SizeClassArena::kNumClasses; ++i) {
+      if (!free_lists_[i].empty()) {
+        arena.ReturnToCentral(i, free_lists_[i].data(), free_lists_[i].size());
+        free_lists_[i].clear();
+      }
+    }
+  }
+
+  void* Allocate(size_t index) {
+    auto& list = free_lists_[index];
+    if (UNLIKELY(list.empty())) {
+      SizeClassArena::Instance().FetchFromCentral(
+          index, BatchSize(SizeClassArena::ClassSize(index)), &list);
+    }
+    void* ptr = list.back();
+    list.pop_back();
+    return ptr;
+  }
+
+  void Free(size_t index, void* ptr) {
+    auto& list = free_lists_[index];
+    list.push_back(ptr);
+    size_t batch = BatchSize(SizeClassArena::ClassSize(index));
+    if (UNLIKELY(list.size() >= 2 * batch)) {
+      // Keep the most recently freed (cache hot) blocks on this thread.
+      SizeClassArena::Instance().ReturnToCentral(index, list.data(), batch);
+      list.erase(list.begin(), list.begin() + batch);
+    }
+  }
+
+ private:
+  SizeClassThreadCache() = default;
+
+  std::array<std::vector<void*>, SizeClassArena::kNumClasses> free_lists_;
+};
+
+SizeClassArena& SizeClassArena::Instance() {
+  // Intentionally leaked, thread caches may flush into the arena during
+  // process exit.
+  static SizeClassArena* arena = new SizeClassArena();
+  return *arena;
+}
+
+SizeClassArena::SizeClassArena()
+    : idle_limit_(FLAGS_size_class_cpu_allocator_idle_limit_in_mb << 20),
+      use_huge_page_(FLAGS_size_class_cpu_allocator_use_huge_page) {
+  PADDLE_ENFORCE_EQ(
+      SizeClassIndex(kMaxClassSize),
+      kNumClasses - 1,
+      common::errors::PreconditionNotMet(
+          "The size classes of SizeClassArena are inconsistent."));
+  for (auto& list : central_) {
+    list.trim_watermark = idle_limit_;
+  }
+}
+
+void* SizeClassArena::MapSlab() {
+  void* slab = nullptr;
+#ifdef _WIN32
+  slab = _aligned_malloc(kSlabSize, kSlabSize);
+  PADDLE_ENFORCE_NOT_NULL(
+      slab,
+      common::errors::ResourceExhausted(
+          "Fail to alloc a slab of %ld bytes for SizeClassArena.", kSlabSize));
+#else
+  // Over-map so that the slab can be aligned to kSlabSize, which lets the
+  // owning slab of a block be computed by masking its address.
+  size_t map_size = kSlabSize * 2;
+  void* base = mmap(nullptr,
+                    map_size,
+                    PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS,
+                    -1,
+                    0);
+  PADDLE_ENFORCE_NE(
+      base,
+      MAP_FAILED,
+      common::errors::ResourceExhausted(
+          "Fail to map a slab of %ld bytes for SizeClassArena.", kSlabSize));
+  auto addr = reinterpret_cast<uintptr_t>(base);
+  auto aligned = (addr + kSlabSize - 1) & ~(kSlabSize - 1);
+  if (aligned > addr) {
+    munmap(base, aligned - addr);
+  }
+  size_t tail = addr + map_size - (aligned + kSlabSize);
+  if (tail > 0) {
+    munmap(reinterpret_cast<void*>(aligned + kSlabSize), tail);
+  }
+  slab = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+  if (use_huge_page_) {
+    madvise(slab, kSlabSize, MADV_HUGEPAGE);
+  }
+#endif
+#endif
+  reserved_bytes_ += kSlabSize;
+  HOST_MEMORY_STAT_UPDATE(Reserved, 0, kSlabSize);
+  return slab;
+}
+
+void SizeClassArena::UnmapSlab(void* slab) {
+#ifdef _WIN32
+  _aligned_free(slab);
+#else
+  munmap(slab, kSlabSize);
+#endif
+  reserved_bytes_ -= kSlabSize;
+  HOST_MEMORY_STAT_UPDATE(Reserved, 0, -static_cast<int64_t>(kSlabSize));
+}
+
+void SizeClassArena::GrowLocked(size_t index, CentralFreeList* list) {
+  size_t class_size = ClassSize(index);
+  auto* slab = static_cast<uint8_t*>(MapSlab());
+  list->slabs.insert(reinterpret_cast<uintptr_t>(slab));
+  size_t num_blocks = kSlabSize / class_size;
+  list->blocks.reserve(list->blocks.size() + num_blocks);
+  // Push in reverse order so blocks are handed out by increasing address.
+  for (size_t i = num_blocks; i > 0; --i) {
+    list->blocks.push_back(slab + (i - 1) * class_size);
+  }
+  VLOG(10) << "SizeClassArena grows class " << index << " (" << class_size
+           << " bytes) by " << num_blocks << " blocks";
+}
+
+void SizeClassArena::FetchFromCentral(size_t index,
+                                      size_t num,
+                                      std::vector<void*>* out) {
+  auto& list = central_[index];
+  std::lock_guard<SpinLock> guard(list.lock);
+  if (list.blocks.empty()) {
+    GrowLocked(index, &list);
+  }
+  num = std::min(num, list.blocks.size());
+  out->insert(out->end(), list.blocks.end() - num, list.blocks.end());
+  list.blocks.resize(list.blocks.size() - num);
+}
+
+void SizeClassArena::ReturnToCentral(size_t index,
+                                     void* const* blocks,
+                                     size_t num) {
+  auto& list = central_[index];
+  std::lock_guard<SpinLock> guard(list.lock);
+  list.blocks.insert(list.blocks.end(), blocks, blocks + num);
+  size_t idle_bytes = list.blocks.size() * ClassSize(index);
+  if (UNLIKELY(idle_bytes > list.trim_watermark)) {
+    TrimLocked(index, &list);
+    // Back off when the idle blocks are spread over live slabs, otherwise
+    // every flush of this class would rescan the central list.
+    list.trim_watermark = std::max(
+        idle_limit_, 2 * list.blocks.size() * ClassSize(index));  // NOLINT
+  }
+}
+
+uint64_t SizeClassArena::TrimLocked(size_t index, CentralFreeList* list) {
+  size_t blocks_per_slab = kSlabSize / ClassSize(index);
+  std::unordered_map<uintptr_t, size_t> free_count;
+  for (void* block : list->blocks) {
+    ++free_count[reinterpret_cast<uintptr_t>(block) & ~(kSlabSize - 1)];
+  }
+  std::unordered_set<uintptr_t> empty_slabs;
+  for (auto& pair : free_count) {
+    if (pair.second == blocks_per_slab) {
+      empty_slabs.insert(pair.first);
+    }
+  }
+  if (empty_slabs.empty()) {
+    return 0;
+  }
+  auto new_end = std::remove_if(
+      list->blocks.begin(), list->blocks.end(), [&](void* block) {
+        return empty_slabs.count(reinterpret_cast<uintptr_t>(block) &
+                                 ~(kSlabSize - 1)) > 0;
+      });
+  list->blocks.erase(new_end, list->blocks.end());
+  for (auto slab : empty_slabs) {
+    list->slabs.erase(slab);
+    UnmapSlab(reinterpret_cast<void*>(slab));
+  }
+  VLOG(10) << "SizeClassArena trims " << empty_slabs.size()
+           << " slabs of class " << index;
+  return empty_slabs.size() * kSlabSize;
+}
+
+uint64_t SizeClassArena::Trim() {
+  uint64_t released = 0;
+  for (size_t i = 0; i < kNumClasses; ++i) {
+    auto& list = central_[i];
+    std::lock_guard<SpinLock> guard(list.lock);
+    released += TrimLocked(i, &list);
+    list.trim_watermark = idle_limit_;
+  }
+  return released;
+}
+
+void* SizeClassArena::Allocate(size_t size) {
+  return SizeClassThreadCache::Get().Allocate(SizeClassIndex(size));
+}
+
+void SizeClassArena::Free(void* ptr, size_t size) {
+  SizeClassThreadCache::Get().Free(SizeClassIndex(size), ptr);
+}
+
+SizeClassCPUAllocator::SizeClassCPUAllocator(
+    std::shared_ptr<Allocator> underlying)
+    : underlying_allocator_(std::move(underlying)),
+      arena_(&SizeClassArena::Instance()) {}
+
+phi::Allocation* SizeClassCPUAllocator::AllocateImpl(size_t size) {
+  if (size > SizeClassArena::kMaxClassSize) {
+    return underlying_allocator_->Allocate(size).release();
+  }
+  return new Allocation(arena_->Allocate(size), size, phi::CPUPlace());
+}
+
+void SizeClassCPUAllocator::FreeImpl(phi::Allocation* allocation) {
+  if (allocation->size() > SizeClassArena::kMaxClassSize) {
+    underlying_allocator_->Free(allocation);
+    return;
+  }
+  arena_->Free(allocation->ptr(), allocation->size());
+  delete allocation;
+}
+
+uint64_t SizeClassCPUAllocator::ReleaseImpl(const phi::Place& place) {
+  return arena_->Trim() + underlying_allocator_->Release(place);
+}
+
+}  // namespace paddle::memory::allocation
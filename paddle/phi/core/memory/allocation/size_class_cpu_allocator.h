@@ -0,0 +1,111 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/phi/core/memory/allocation/allocator.h"
+#include "paddle/phi/core/memory/allocation/spin_lock.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// A tcmalloc-like arena for host memory.
+//
+// Requests up to kMaxClassSize are rounded up to one of kNumClasses size
+// classes. Every thread keeps a small free list per class, so the common
+// Allocate/Free pair touches no lock at all. Thread caches exchange blocks
+// in batches with a central free list per class, which carves new blocks
+// out of kSlabSize slabs mapped from the system (optionally advised to use
+// transparent huge pages). When the idle memory of a class grows beyond
+// FLAGS_size_class_cpu_allocator_idle_limit_in_mb, slabs whose blocks are
+// all back in the central list are returned to the system.
+//
+// Larger requests are forwarded to the underlying allocator.
+class SizeClassArena {
+ public:
+  static constexpr size_t kSlabSize = 2UL << 20;
+  static constexpr size_t kMaxClassSize = 256UL << 10;
+  static constexpr size_t kNumClasses = 48;
+
+  static SizeClassArena& Instance();
+
+  static size_t SizeClassIndex(size_t size);
+  static size_t ClassSize(size_t index);
+
+  void* Allocate(size_t size);
+  void Free(void* ptr, size_t size);
+
+  // Return all completely free slabs to the system and return the number of
+  // released bytes.
+  uint64_t Trim();
+
+  // Return the bytes of all slabs currently mapped by the arena.
+  uint64_t ReservedBytes() const { return reserved_bytes_.load(); }
+
+ private:
+  struct CentralFreeList {
+    SpinLock lock;
+    std::vector<void*> blocks;
+    std::unordered_set<uintptr_t> slabs;
+    size_t trim_watermark{0};
+  };
+
+  friend class SizeClassThreadCache;
+
+  SizeClassArena();
+
+  // Move up to `num` blocks of class `index` into `out`, growing the class
+  // by a new slab if the central list is empty.
+  void FetchFromCentral(size_t index, size_t num, std::vector<void*>* out);
+  void ReturnToCentral(size_t index, void* const* blocks, size_t num);
+
+  void GrowLocked(size_t index, CentralFreeList* list);
+  uint64_t TrimLocked(size_t index, CentralFreeList* list);
+
+  void* MapSlab();
+  void UnmapSlab(void* slab);
+
+  std::array<CentralFreeList, kNumClasses> central_;
+  std::atomic<uint64_t> reserved_bytes_{0};
+  size_t idle_limit_;
+  bool use_huge_page_;
+};
+
+class SizeClassCPUAllocator : public Allocator {
+ public:
+  explicit SizeClassCPUAllocator(std::shared_ptr<Allocator> underlying);
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+ protected:
+  phi::Allocation* AllocateImpl(size_t size) override;
+  void FreeImpl(phi::Allocation* allocation) override;
+  uint64_t ReleaseImpl(const phi::Place& place) override;
+
+ private:
+  std::shared_ptr<Allocator> underlying_allocator_;
+  SizeClassArena* arena_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
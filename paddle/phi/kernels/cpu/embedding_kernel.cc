@@ -19,6 +19,7 @@
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/funcs/embedding_util.h"
+#include "paddle/phi/kernels/funcs/parallel_for.h"
 #include "paddle/phi/kernels/p_norm_kernel.h"
 
 namespace phi {
@@ -72,18 +73,28 @@ struct EmbeddingCPUFunctor {
       }
     }
 
+    auto copy_rows = [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        if (padding_idx_ != kNoPadding && ids[i] == padding_idx_) {
+          memset(output + i * row_width, 0, row_width * sizeof(T));
+        } else {
+          memcpy(output + i * row_width,
+                 table + ids[i] * row_width,
+                 row_width * sizeof(T));
+        }
+      }
+    };
+    if (dev_ctx_.intra_op_num_threads() > 1) {
+      funcs::ParallelFor(dev_ctx_, 0, ids_numel, row_width, copy_rows);
+      return;
+    }
+
 #if defined(_OPENMP) && !defined(PADDLE_WITH_CUDA)
 #pragma omp parallel for
 #endif
 
     for (int64_t i = 0; i < ids_numel; ++i) {
-      if (padding_idx_ != kNoPadding && ids[i] == padding_idx_) {
-        memset(output + i * row_width, 0, row_width * sizeof(T));
-      } else {
-        memcpy(output + i * row_width,
-               table + ids[i] * row_width,
-               row_width * sizeof(T));
-      }
+      copy_rows(i, i + 1);
     }
   }
 
@@ -18,6 +18,7 @@
 
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/funcs/parallel_for.h"
 
 namespace phi {
 
@@ -42,23 +43,33 @@ void FlipKernel(const Context& dev_ctx,
   auto numel = x.numel();
   const T* x_data = x.data<T>();
   T* out_data = dev_ctx.template Alloc<T>(out);
+  auto flip = [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      int64_t cur_indices = i;
+      int64_t rem = 0;
+      int64_t dst_offset = 0;
+
+      for (int d = 0; d < total_dims; ++d) {
+        int64_t temp = cur_indices;
+        cur_indices = cur_indices / x_strides[d];
+        rem = temp - cur_indices * x_strides[d];
+        dst_offset += dim_bitset[d]
+                          ? (x_dims[d] - 1 - cur_indices) * x_strides[d]
+                          : cur_indices * x_strides[d];
+        cur_indices = rem;
+      }
+      out_data[i] = x_data[dst_offset];
+    }
+  };
+  if (dev_ctx.intra_op_num_threads() > 1) {
+    funcs::ParallelFor(dev_ctx, 0, numel, total_dims, flip);
+    return;
+  }
 #ifdef PADDLE_WITH_MKLML
 #pragma omp parallel for
 #endif
   for (int64_t i = 0; i < numel; ++i) {
-    int64_t cur_indices = i;
-    int64_t rem = 0;
-    int64_t dst_offset = 0;
-
-    for (int d = 0; d < total_dims; ++d) {
-      int64_t temp = cur_indices;
-      cur_indices = cur_indices / x_strides[d];
-      rem = temp - cur_indices * x_strides[d];
-      dst_offset += dim_bitset[d] ? (x_dims[d] - 1 - cur_indices) * x_strides[d]
-                                  : cur_indices * x_strides[d];
-      cur_indices = rem;
-    }
-    out_data[i] = x_data[dst_offset];
+    flip(i, i + 1);
   }
 }
 
@@ -14,17 +14,10 @@
 
 #include "paddle/phi/kernels/layer_norm_kernel.h"
 
-#include "paddle/phi/kernels/cpu/elementwise.h"
-#include "paddle/phi/kernels/funcs/layer_norm_util.h"
-#if !defined(PADDLE_WITH_CUDA) && !defined(_WIN32) && !defined(__APPLE__) && \
-    !defined(__OSX__)
-#include "paddle/phi/kernels/funcs/jit/kernels.h"
-#endif
 #include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/common/amp_type_traits.h"
 #include "paddle/phi/core/kernel_registry.h"
-#include "paddle/phi/kernels/funcs/elementwise_base.h"
-#include "paddle/phi/kernels/funcs/elementwise_functor.h"
-#include "paddle/phi/kernels/funcs/math_function.h"
+#include "paddle/phi/kernels/funcs/fused_norm.h"
 
 namespace phi {
 
@@ -38,81 +31,13 @@ void LayerNormKernel(const Context& dev_ctx,
                      DenseTensor* y,
                      DenseTensor* mean,
                      DenseTensor* var) {
-  const auto x_dims = x.dims();
+  using AccT = typename phi::dtype::MPTypeTrait<T>::Type;
   auto* scale = scale_opt.get_ptr();
   auto* bias = bias_opt.get_ptr();
 
-  dev_ctx.template Alloc<T>(y);
-  dev_ctx.template Alloc<T>(mean);
-  dev_ctx.template Alloc<T>(var);
-
-  auto matrix_dim = common::flatten_to_2d(x_dims, begin_norm_axis);
-  int left = static_cast<int>(matrix_dim[0]);
-  int right = static_cast<int>(matrix_dim[1]);
-  DDim matrix_shape({left, right});
-  DDim normalized_shape({left});
-
-  auto x_tmp = x;
-  x_tmp.Resize(matrix_shape);
-  DenseTensor out;
-  out.ShareDataWith(*y);
-  out.Resize(matrix_shape);
-  // resize mean and var to match the shape of resized x_tmp for broadcast
-  DenseTensor mean_tmp;
-  mean_tmp.ShareDataWith(*mean);
-  mean_tmp.Resize(normalized_shape);
-  DenseTensor var_tmp;
-  var_tmp.ShareDataWith(*var);
-  var_tmp.Resize(normalized_shape);
-
-#if defined(PADDLE_WITH_CUDA) || defined(_WIN32) || defined(__APPLE__) || \
-    defined(__OSX__)
-
-  funcs::RowwiseMean2D<phi::CPUContext, T> row_mean(left, right, dev_ctx);
-
-  // get mean
-  row_mean(dev_ctx, x_tmp, &mean_tmp);
-
-  // get variance
-
-  phi::funcs::ElementwiseCompute<funcs::SubAndSquareFunctor<T>, T>(
-      dev_ctx, x_tmp, mean_tmp, funcs::SubAndSquareFunctor<T>(), &out, 0);
-
-  row_mean(dev_ctx, out, &var_tmp);
-
-  // get x_norm
-  phi::funcs::ElementwiseCompute<funcs::SubtractFunctor<T>, T>(
-      dev_ctx, x_tmp, mean_tmp, funcs::SubtractFunctor<T>(), &out, 0);
-
-  phi::funcs::ElementwiseCompute<funcs::DivAndSqrtFunctor<T>, T>(
-      dev_ctx,
-      out,
-      var_tmp,
-      funcs::DivAndSqrtFunctor<T>(static_cast<T>(epsilon)),
-      &out,
-      0);
-
-  if (scale) {
-    phi::funcs::ElementwiseCompute<funcs::MultiplyFunctor<T>, T>(
-        dev_ctx, out, *scale, funcs::MultiplyFunctor<T>(), &out, 1);
-  }
-  if (bias) {
-    phi::funcs::ElementwiseCompute<funcs::AddFunctor<T>, T>(
-        dev_ctx, out, *bias, funcs::AddFunctor<T>(), &out, 1);
-  }
-#else
-  PADDLE_ENFORCE_EQ(mean_tmp.numel(),
-                    left,
-                    common::errors::InvalidArgument(
-                        "mean's length (%d) is not equal with expected (%d).",
-                        mean_tmp.numel(),
-                        left));
-  PADDLE_ENFORCE_EQ(var_tmp.numel(),
-                    left,
-                    common::errors::InvalidArgument(
-                        "var's length (%d) is not equal with expected (%d).",
-                        var_tmp.numel(),
-                        left));
+  auto matrix_dim = common::flatten_to_2d(x.dims(), begin_norm_axis);
+  const int64_t left = matrix_dim[0];
+  const int64_t right = matrix_dim[1];
   if (scale) {
     PADDLE_ENFORCE_EQ(
         scale->numel(),
@@ -131,25 +56,42 @@ void LayerNormKernel(const Context& dev_ctx,
                           right));
   }
 
-  auto ker =
-      phi::jit::KernelFuncs<phi::jit::LayerNormTuple<T>, phi::CPUPlace>::Cache()
-          .At(right);
-  ker(x_tmp.data<T>(),
-      out.data<T>(),
-      mean_tmp.data<T>(),
-      var_tmp.data<T>(),
-      scale ? scale->data<T>() : nullptr,
-      bias ? bias->data<T>() : nullptr,
-      static_cast<int>(left),
-      static_cast<float>(epsilon),
-      right);
-#endif
+  T* y_data = dev_ctx.template Alloc<T>(y);
+  AccT* mean_data = dev_ctx.template Alloc<AccT>(mean);
+  AccT* var_data = dev_ctx.template Alloc<AccT>(var);
+
+  DenseTensor scale_buf;
+  DenseTensor bias_buf;
+  const AccT* scale_data =
+      funcs::GetNormParam<AccT>(dev_ctx, scale, &scale_buf);
+  const AccT* bias_data = funcs::GetNormParam<AccT>(dev_ctx, bias, &bias_buf);
+
+  funcs::NormForwardCPU<T, AccT>(dev_ctx,
+                                 funcs::NormType::kLayerNorm,
+                                 x.data<T>(),
+                                 /*residual=*/nullptr,
+                                 /*bias=*/nullptr,
+                                 scale_data,
+                                 bias_data,
+                                 left,
+                                 right,
+                                 epsilon,
+                                 /*residual_out=*/nullptr,
+                                 y_data,
+                                 mean_data,
+                                 var_data,
+                                 /*rstd=*/nullptr);
 }
 
 }  // namespace phi
 
-PD_REGISTER_KERNEL(
-    layer_norm, CPU, ALL_LAYOUT, phi::LayerNormKernel, float, double) {
+PD_REGISTER_KERNEL(layer_norm,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::LayerNormKernel,
+                   float,
+                   double,
+                   phi::dtype::bfloat16) {
   kernel->OutputAt(1).SetDataType(phi::DataType::UNDEFINED);
   kernel->OutputAt(2).SetDataType(phi::DataType::UNDEFINED);
 }
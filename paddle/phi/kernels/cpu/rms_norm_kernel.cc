@@ -0,0 +1,101 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/rms_norm_kernel.h"
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/common/amp_type_traits.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/funcs/fused_norm.h"
+
+namespace phi {
+
+template <typename T, typename Context>
+void RmsNormKernel(const Context& dev_ctx,
+                   const DenseTensor& x,
+                   const paddle::optional<DenseTensor>& bias,
+                   const paddle::optional<DenseTensor>& residual,
+                   const DenseTensor& norm_weight,
+                   const paddle::optional<DenseTensor>& norm_bias,
+                   const float epsilon,
+                   const int begin_norm_axis,
+                   const float quant_scale,
+                   const int quant_round_type UNUSED,
+                   const float quant_max_bound UNUSED,
+                   const float quant_min_bound UNUSED,
+                   DenseTensor* out,
+                   DenseTensor* residual_out,
+                   DenseTensor* inv_var) {
+  using AccT = typename phi::dtype::MPTypeTrait<T>::Type;
+  if (quant_scale > 0.0f) {
+    PADDLE_THROW(common::errors::Unimplemented(
+        "The quantized output of rms_norm is not supported on CPU."));
+  }
+
+  auto matrix_dim = common::flatten_to_2d(x.dims(), begin_norm_axis);
+  const int64_t rows = matrix_dim[0];
+  const int64_t cols = matrix_dim[1];
+  PADDLE_ENFORCE_EQ(
+      norm_weight.numel(),
+      cols,
+      common::errors::InvalidArgument(
+          "norm_weight's length (%d) is not equal with expected (%d).",
+          norm_weight.numel(),
+          cols));
+
+  // Like the GPU kernel, bias is only added to the residual.
+  const T* residual_data = nullptr;
+  const T* bias_data = nullptr;
+  T* residual_out_data = nullptr;
+  if (residual) {
+    residual_data = residual->data<T>();
+    bias_data = bias ? bias->data<T>() : nullptr;
+    residual_out_data = dev_ctx.template Alloc<T>(residual_out);
+  }
+  T* out_data = dev_ctx.template Alloc<T>(out);
+  AccT* inv_var_data =
+      inv_var ? dev_ctx.template Alloc<AccT>(inv_var) : nullptr;
+
+  DenseTensor norm_weight_buf;
+  DenseTensor norm_bias_buf;
+  const AccT* norm_weight_data =
+      funcs::GetNormParam<AccT>(dev_ctx, &norm_weight, &norm_weight_buf);
+  const AccT* norm_bias_data =
+      funcs::GetNormParam<AccT>(dev_ctx, norm_bias.get_ptr(), &norm_bias_buf);
+
+  funcs::NormForwardCPU<T, AccT>(dev_ctx,
+                                 funcs::NormType::kRmsNorm,
+                                 x.data<T>(),
+                                 residual_data,
+                                 bias_data,
+                                 norm_weight_data,
+                                 norm_bias_data,
+                                 rows,
+                                 cols,
+                                 epsilon,
+                                 residual_out_data,
+                                 out_data,
+                                 /*mean=*/nullptr,
+                                 /*var=*/nullptr,
+                                 inv_var_data);
+}
+
+}  // namespace phi
+
+PD_REGISTER_KERNEL(rms_norm,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::RmsNormKernel,
+                   float,
+                   phi::dtype::bfloat16) {}
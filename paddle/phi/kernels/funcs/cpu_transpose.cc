@@ -0,0 +1,435 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/funcs/cpu_transpose.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <utility>
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/kernels/funcs/parallel_for.h"
+
+namespace phi {
+namespace funcs {
+namespace {
+
+struct alignas(8) Bytes16 {
+  uint64_t data[2];
+};
+
+// The bytes of a tile row. Four cache lines per row let every dst line of
+// a strip be written whole while its src rows still sit in L1; a single
+// line per row measured about twice as slow on (8, 256, 3136) -> (0, 2, 1).
+constexpr int64_t kTileBytes = 256;
+
+template <typename T>
+constexpr int64_t TileSize() {
+  return std::max<int64_t>(kTileBytes / static_cast<int64_t>(sizeof(T)), 4);
+}
+
+// The SIMD micro kernel that transposes a kSize x kSize block, if any.
+template <typename T>
+struct MicroKernel {
+  static constexpr int64_t kSize = 0;
+  static void Run(const T*, int64_t, T*, int64_t) {}
+};
+
+#ifdef __AVX__
+template <>
+struct MicroKernel<uint32_t> {
+  static constexpr int64_t kSize = 8;
+  static void Run(const uint32_t* src,
+                  int64_t ld_src,
+                  uint32_t* dst,
+                  int64_t ld_dst) {
+    // The float shuffles only move the bits.
+    const float* in = reinterpret_cast<const float*>(src);
+    float* out = reinterpret_cast<float*>(dst);
+    __m256 r0 = _mm256_loadu_ps(in);
+    __m256 r1 = _mm256_loadu_ps(in + ld_src);
+    __m256 r2 = _mm256_loadu_ps(in + 2 * ld_src);
+    __m256 r3 = _mm256_loadu_ps(in + 3 * ld_src);
+    __m256 r4 = _mm256_loadu_ps(in + 4 * ld_src);
+    __m256 r5 = _mm256_loadu_ps(in + 5 * ld_src);
+    __m256 r6 = _mm256_loadu_ps(in + 6 * ld_src);
+    __m256 r7 = _mm256_loadu_ps(in + 7 * ld_src);
+    const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+    const __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+    const __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+    const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+    const __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+    const __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+    const __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+    const __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+    const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+    r0 = _mm256_permute2f128_ps(s0, s4, 0x20);
+    r1 = _mm256_permute2f128_ps(s1, s5, 0x20);
+    r2 = _mm256_permute2f128_ps(s2, s6, 0x20);
+    r3 = _mm256_permute2f128_ps(s3, s7, 0x20);
+    r4 = _mm256_permute2f128_ps(s0, s4, 0x31);
+    r5 = _mm256_permute2f128_ps(s1, s5, 0x31);
+    r6 = _mm256_permute2f128_ps(s2, s6, 0x31);
+    r7 = _mm256_permute2f128_ps(s3, s7, 0x31);
+    _mm256_storeu_ps(out, r0);
+    _mm256_storeu_ps(out + ld_dst, r1);
+    _mm256_storeu_ps(out + 2 * ld_dst, r2);
+    _mm256_storeu_ps(out + 3 * ld_dst, r3);
+    _mm256_storeu_ps(out + 4 * ld_dst, r4);
+    _mm256_storeu_ps(out + 5 * ld_dst, r5);
+    _mm256_storeu_ps(out + 6 * ld_dst, r6);
+    _mm256_storeu_ps(out + 7 * ld_dst, r7);
+  }
+};
+
+template <>
+struct MicroKernel<uint64_t> {
+  static constexpr int64_t kSize = 4;
+  static void Run(const uint64_t* src,
+                  int64_t ld_src,
+                  uint64_t* dst,
+                  int64_t ld_dst) {
+    const double* in = reinterpret_cast<const double*>(src);
+    double* out = reinterpret_cast<double*>(dst);
+    const __m256d r0 = _mm256_loadu_pd(in);
+    const __m256d r1 = _mm256_loadu_pd(in + ld_src);
+    const __m256d r2 = _mm256_loadu_pd(in + 2 * ld_src);
+    const __m256d r3 = _mm256_loadu_pd(in + 3 * ld_src);
+    const __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+    const __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+    const __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+    const __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+    _mm256_storeu_pd(out, _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(out + ld_dst, _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(out + 2 * ld_dst, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(out + 3 * ld_dst, _mm256_permute2f128_pd(t1, t3, 0x31));
+  }
+};
+#endif
+
+// dst[j * ld_dst + i] = src[i * ld_src + j] for a rows x cols block.
+template <typename T>
+void TransposeBlock(const T* src,
+                    int64_t ld_src,
+                    T* dst,
+                    int64_t ld_dst,
+                    int64_t rows,
+                    int64_t cols) {
+  for (int64_t j = 0; j < cols; ++j) {
+    for (int64_t i = 0; i < rows; ++i) {
+      dst[j * ld_dst + i] = src[i * ld_src + j];
+    }
+  }
+}
+
+// Transposes a strip of at most TileSize<T>() rows, one tile at a time.
+template <typename T>
+void TransposeStrip(const T* src,
+                    int64_t ld_src,
+                    T* dst,
+                    int64_t ld_dst,
+                    int64_t rows,
+                    int64_t cols) {
+  constexpr int64_t kTile = TileSize<T>();
+  constexpr int64_t kMicro = MicroKernel<T>::kSize;
+  for (int64_t j0 = 0; j0 < cols; j0 += kTile) {
+    const int64_t tile_cols = std::min(kTile, cols - j0);
+    const T* tile_src = src + j0;
+    T* tile_dst = dst + j0 * ld_dst;
+    if constexpr (kMicro == 0) {
+      TransposeBlock(tile_src, ld_src, tile_dst, ld_dst, rows, tile_cols);
+    } else {
+      const int64_t full_rows = rows / kMicro * kMicro;
+      const int64_t full_cols = tile_cols / kMicro * kMicro;
+      for (int64_t i = 0; i < full_rows; i += kMicro) {
+        for (int64_t j = 0; j < full_cols; j += kMicro) {
+          MicroKernel<T>::Run(tile_src + i * ld_src + j,
+                              ld_src,
+                              tile_dst + j * ld_dst + i,
+                              ld_dst);
+        }
+      }
+      // The edges the micro kernel does not cover.
+      TransposeBlock(tile_src + full_cols,
+                     ld_src,
+                     tile_dst + full_cols * ld_dst,
+                     ld_dst,
+                     full_rows,
+                     tile_cols - full_cols);
+      TransposeBlock(tile_src + full_rows * ld_src,
+                     ld_src,
+                     tile_dst + full_rows,
+                     ld_dst,
+                     rows - full_rows,
+                     tile_cols);
+    }
+  }
+}
+
+// The offset of the elements of dims, in row major order, where each dim
+// has the given stride.
+class StridedOffset {
+ public:
+  StridedOffset(const std::vector<int64_t>& dims,
+                const std::vector<int64_t>& strides,
+                int64_t index)
+      : dims_(dims), strides_(strides), counter_(dims.size(), 0) {
+    for (int k = static_cast<int>(dims_.size()) - 1; k >= 0; --k) {
+      counter_[k] = index % dims_[k];
+      index /= dims_[k];
+      offset_ += counter_[k] * strides_[k];
+    }
+  }
+
+  int64_t offset() const { return offset_; }
+
+  void Next() {
+    for (int k = static_cast<int>(dims_.size()) - 1; k >= 0; --k) {
+      ++counter_[k];
+      offset_ += strides_[k];
+      if (counter_[k] < dims_[k]) return;
+      offset_ -= counter_[k] * strides_[k];
+      counter_[k] = 0;
+    }
+  }
+
+ private:
+  const std::vector<int64_t>& dims_;
+  const std::vector<int64_t>& strides_;
+  std::vector<int64_t> counter_;
+  int64_t offset_{0};
+};
+
+// Drops the dims of size 1 and merges the input dims which are next to
+// each other in the output as well.
+void SimplifyTranspose(const DDim& in_dims,
+                       const std::vector<int>& axis,
+                       std::vector<int64_t>* dims,
+                       std::vector<int>* perm) {
+  const int rank = static_cast<int>(axis.size());
+  std::vector<int> kept_index(rank, -1);
+  std::vector<int64_t> kept_dims;
+  for (int i = 0; i < rank; ++i) {
+    if (in_dims[i] != 1) {
+      kept_index[i] = static_cast<int>(kept_dims.size());
+      kept_dims.push_back(in_dims[i]);
+    }
+  }
+  std::vector<int> kept_axis;
+  for (int i = 0; i < rank; ++i) {
+    if (kept_index[axis[i]] >= 0) kept_axis.push_back(kept_index[axis[i]]);
+  }
+
+  // The groups of merged input dims in output order, by their first input
+  // dim and size.
+  std::vector<std::pair<int, int64_t>> groups;
+  for (size_t k = 0; k < kept_axis.size(); ++k) {
+    if (k > 0 && kept_axis[k] == kept_axis[k - 1] + 1) {
+      groups.back().second *= kept_dims[kept_axis[k]];
+    } else {
+      groups.emplace_back(kept_axis[k], kept_dims[kept_axis[k]]);
+    }
+  }
+  std::vector<int> in_order(groups.size());
+  std::iota(in_order.begin(), in_order.end(), 0);
+  std::sort(in_order.begin(), in_order.end(), [&groups](int a, int b) {
+    return groups[a].first < groups[b].first;
+  });
+  std::vector<int> in_position(groups.size());
+  dims->resize(groups.size());
+  for (size_t j = 0; j < in_order.size(); ++j) {
+    in_position[in_order[j]] = static_cast<int>(j);
+    (*dims)[j] = groups[in_order[j]].second;
+  }
+  perm->resize(groups.size());
+  for (size_t k = 0; k < groups.size(); ++k) {
+    (*perm)[k] = in_position[k];
+  }
+}
+
+template <typename T>
+void TransposeImpl(const phi::CPUContext& dev_ctx,
+                   const T* in,
+                   T* out,
+                   const std::vector<int64_t>& dims,
+                   const std::vector<int>& perm) {
+  const int rank = static_cast<int>(dims.size());
+  const int64_t numel = std::accumulate(
+      dims.begin(), dims.end(), int64_t(1), std::multiplies<int64_t>());
+  if (rank <= 1) {
+    ParallelFor(dev_ctx, 0, numel, 1, [&](int64_t begin, int64_t end) {
+      std::memcpy(out + begin, in + begin, (end - begin) * sizeof(T));
+    });
+    return;
+  }
+
+  std::vector<int64_t> in_strides(rank, 1);
+  for (int i = rank - 2; i >= 0; --i) {
+    in_strides[i] = in_strides[i + 1] * dims[i + 1];
+  }
+  std::vector<int64_t> out_dims(rank);
+  std::vector<int64_t> out_strides(rank, 1);
+  for (int k = 0; k < rank; ++k) out_dims[k] = dims[perm[k]];
+  for (int k = rank - 2; k >= 0; --k) {
+    out_strides[k] = out_strides[k + 1] * out_dims[k + 1];
+  }
+
+  if (perm[rank - 1] == rank - 1) {
+    // Copies each row of the innermost dim.
+    const int64_t inner = dims[rank - 1];
+    std::vector<int64_t> outer_dims(out_dims.begin(), out_dims.end() - 1);
+    std::vector<int64_t> outer_in_strides(rank - 1);
+    for (int k = 0; k < rank - 1; ++k) {
+      outer_in_strides[k] = in_strides[perm[k]];
+    }
+    ParallelFor(
+        dev_ctx, 0, numel / inner, inner, [&](int64_t begin, int64_t end) {
+          StridedOffset in_offset(outer_dims, outer_in_strides, begin);
+          for (int64_t row = begin; row < end; ++row) {
+            std::memcpy(out + row * inner,
+                        in + in_offset.offset(),
+                        inner * sizeof(T));
+            in_offset.Next();
+          }
+        });
+    return;
+  }
+
+  // src rows are the input dim which is innermost in out, src cols are the
+  // innermost input dim, and every other dim is a batch of them.
+  const int row_dim = perm[rank - 1];
+  const int col_position = static_cast<int>(
+      std::find(perm.begin(), perm.end(), rank - 1) - perm.begin());
+  const int64_t rows = dims[row_dim];
+  const int64_t cols = dims[rank - 1];
+  const int64_t ld_src = in_strides[row_dim];
+  const int64_t ld_dst = out_strides[col_position];
+  std::vector<int64_t> batch_dims;
+  std::vector<int64_t> batch_in_strides;
+  std::vector<int64_t> batch_out_strides;
+  for (int k = 0; k < rank - 1; ++k) {
+    if (k == col_position) continue;
+    batch_dims.push_back(out_dims[k]);
+    batch_in_strides.push_back(in_strides[perm[k]]);
+    batch_out_strides.push_back(out_strides[k]);
+  }
+
+  constexpr int64_t kTile = TileSize<T>();
+  const int64_t strips = (rows + kTile - 1) / kTile;
+  const int64_t batches = numel / (rows * cols);
+  ParallelFor(
+      dev_ctx,
+      0,
+      batches * strips,
+      kTile * cols,
+      [&](int64_t begin, int64_t end) {
+        int64_t batch = begin / strips;
+        StridedOffset in_offset(batch_dims, batch_in_strides, batch);
+        StridedOffset out_offset(batch_dims, batch_out_strides, batch);
+        for (int64_t unit = begin; unit < end; ++unit) {
+          if (unit / strips != batch) {
+            ++batch;
+            in_offset.Next();
+            out_offset.Next();
+          }
+          const int64_t row = unit % strips * kTile;
+          TransposeStrip(in + in_offset.offset() + row * ld_src,
+                         ld_src,
+                         out + out_offset.offset() + row,
+                         ld_dst,
+                         std::min(kTile, rows - row),
+                         cols);
+        }
+      });
+}
+
+}  // namespace
+
+void TransposeCPU(const phi::CPUContext& dev_ctx,
+                  const void* in,
+                  void* out,
+                  size_t elem_size,
+                  const DDim& in_dims,
+                  const std::vector<int>& axis) {
+  PADDLE_ENFORCE_EQ(
+      static_cast<int>(axis.size()),
+      in_dims.size(),
+      common::errors::InvalidArgument(
+          "The size of axis (%d) of transpose should be equal to the rank of "
+          "the input (%d).",
+          axis.size(),
+          in_dims.size()));
+  if (common::product(in_dims) == 0) return;
+
+  std::vector<int64_t> dims;
+  std::vector<int> perm;
+  SimplifyTranspose(in_dims, axis, &dims, &perm);
+  switch (elem_size) {
+    case 1:
+      TransposeImpl(dev_ctx,
+                    static_cast<const uint8_t*>(in),
+                    static_cast<uint8_t*>(out),
+                    dims,
+                    perm);
+      break;
+    case 2:
+      TransposeImpl(dev_ctx,
+                    static_cast<const uint16_t*>(in),
+                    static_cast<uint16_t*>(out),
+                    dims,
+                    perm);
+      break;
+    case 4:
+      TransposeImpl(dev_ctx,
+                    static_cast<const uint32_t*>(in),
+                    static_cast<uint32_t*>(out),
+                    dims,
+                    perm);
+      break;
+    case 8:
+      TransposeImpl(dev_ctx,
+                    static_cast<const uint64_t*>(in),
+                    static_cast<uint64_t*>(out),
+                    dims,
+                    perm);
+      break;
+    case 16:
+      TransposeImpl(dev_ctx,
+                    static_cast<const Bytes16*>(in),
+                    static_cast<Bytes16*>(out),
+                    dims,
+                    perm);
+      break;
+    default:
+      PADDLE_THROW(common::errors::Unimplemented(
+          "Transpose on CPU does not support elements of %d bytes.",
+          elem_size));
+  }
+}
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,44 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/ddim.h"
+
+namespace phi {
+namespace funcs {
+
+// TransposeCPU writes in, whose dims are in_dims, to out with its dims
+// permuted by axis, for elements of elem_size bytes and any rank.
+//
+// The dims of size 1 are dropped and the dims that stay next to each other
+// are merged first, so most transposes end up with a rank of 2 or 3. If the
+// innermost dim stays in place, rows of it are copied as a whole. Otherwise
+// the two innermost dims of in and out form a 2D transpose, which is done
+// in tiles of 256 bytes per row, with SIMD micro kernels for 4 and 8 byte
+// elements. Strips of tiles run on the intra op threads of dev_ctx.
+void TransposeCPU(const phi::CPUContext& dev_ctx,
+                  const void* in,
+                  void* out,
+                  size_t elem_size,
+                  const DDim& in_dims,
+                  const std::vector<int>& axis);
+
+}  // namespace funcs
+}  // namespace phi
@@ -14,6 +14,12 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
 #include "paddle/common/ddim.h"
 #include "paddle/phi/core/dense_tensor.h"
 
@@ -152,7 +158,7 @@ struct BroadcastDimsSimplifier {
   // Merge sequential dimension to shrink calculation cost for
   // offset computation in CUDA Kernel.
   template <typename MergeFunctor>
-  __inline__ void MergeDimensions(MergeFunctor merge_func, int N) {
+  inline void MergeDimensions(MergeFunctor merge_func, int N) {
     auto VectorReorganise = [](DimVector *vec, int l_idx, int m_idx) {
       (*vec)[m_idx - 1] = std::accumulate(vec->begin() + l_idx,
                                           vec->begin() + m_idx,
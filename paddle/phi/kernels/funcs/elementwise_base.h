@@ -19,8 +19,10 @@ limitations under the License. */
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/kernels/empty_kernel.h"
 #include "paddle/phi/kernels/funcs/common_shape.h"
+#include "paddle/phi/kernels/funcs/dims_simplifier.h"
 #include "paddle/phi/kernels/funcs/elementwise_utils.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
+#include "paddle/phi/kernels/funcs/parallel_for.h"
 
 #if defined(__NVCC__) || defined(__HIPCC__) || defined(__xpu__)
 #include "paddle/phi/backends/gpu/gpu_launch_config.h"
@@ -270,99 +272,122 @@ class TransformFunctor {
   bool is_xsize_larger_;
 };
 
+// Computes one innermost row of a broadcast, an operand of stride 0 is the
+// same element for the whole row. The loops are kept plain so that the
+// compiler vectorizes them.
+template <typename Functor, typename T, typename OutType>
+inline void BroadcastRowCPU(const T *x,
+                            bool x_contiguous,
+                            const T *y,
+                            bool y_contiguous,
+                            int64_t n,
+                            OutType *out,
+                            Functor func) {
+  if (x_contiguous && y_contiguous) {
+    for (int64_t i = 0; i < n; ++i) {
+      out[i] = func(x[i], y[i]);
+    }
+  } else if (x_contiguous) {
+    const T y_value = *y;
+    for (int64_t i = 0; i < n; ++i) {
+      out[i] = func(x[i], y_value);
+    }
+  } else if (y_contiguous) {
+    const T x_value = *x;
+    for (int64_t i = 0; i < n; ++i) {
+      out[i] = func(x_value, y[i]);
+    }
+  } else {
+    const OutType value = func(*x, *y);
+    std::fill(out, out + n, value);
+  }
+}
+
+// Computes z = func(x, y) with x and y broadcast to out_dims. The dims are
+// first merged by BroadcastDimsSimplifier, so that the innermost dim is as
+// long as possible and every operand is either contiguous or of stride 0
+// along it, then the rows of the innermost dim are split over the intra op
+// threads.
 template <typename Functor, typename T, typename OutType = T>
-void CommonForwardBroadcastCPU(const DenseTensor &x,
-                               const DenseTensor &y,
-                               DenseTensor *z,
-                               int *x_dims_array,
-                               int *y_dims_array,
-                               int *out_dims_array,
-                               int max_dim,
-                               const CPUContext &ctx,
-                               Functor func,
-                               const bool is_xsize_larger = true) {
-  std::vector<int> index_array(max_dim, 0);
+void BroadcastCPU(const CPUContext &dev_ctx,
+                  const DenseTensor &x,
+                  const DenseTensor &y,
+                  const DDim &out_dims,
+                  int axis,
+                  Functor func,
+                  DenseTensor *z) {
+  OutType *out_data = dev_ctx.Alloc<OutType>(z);
+  // A dim of 0 broadcast against 1 is -1 in out_dims, so the size of z
+  // tells an empty output.
+  const int64_t numel = z->numel();
+  if (numel == 0) return;
   const T *x_data = x.data<T>();
   const T *y_data = y.data<T>();
   PADDLE_ENFORCE_NOT_NULL(
       x_data, errors::InvalidArgument("The input X should not be empty."));
   PADDLE_ENFORCE_NOT_NULL(
       y_data, errors::InvalidArgument("The input Y should not be empty."));
-  OutType *out_data = ctx.Alloc<OutType>(z);
-
-  const int out_size = std::accumulate(
-      out_dims_array, out_dims_array + max_dim, 1, std::multiplies<int>());
-  int x_index, y_index;
-  for (int out_index = 0; out_index < out_size; ++out_index) {
-    x_index = GetElementwiseIndex(x_dims_array, max_dim, index_array.data());
-    y_index = GetElementwiseIndex(y_dims_array, max_dim, index_array.data());
-    if (is_xsize_larger) {
-      out_data[out_index] = func(x_data[x_index], y_data[y_index]);
-    } else {
-      out_data[out_index] = func(y_data[y_index], x_data[x_index]);
-    }
-
-    UpdateElementwiseIndexArray(out_dims_array, max_dim, index_array.data());
-  }
-}
 
-template <typename Functor, typename T, typename OutType = T>
-void CommonElementwiseBroadcastForward(const CPUContext &dev_ctx,
-                                       const DenseTensor &x,
-                                       const DenseTensor &y,
-                                       DenseTensor *z,
-                                       const DDim &x_dims,
-                                       const DDim &y_dims,
-                                       Functor func,
-                                       int axis,
-                                       const bool is_xsize_larger = true) {
-  int max_dim = (std::max)(x_dims.size(), y_dims.size());
-  axis = (axis == -1 ? std::abs(x_dims.size() - y_dims.size()) : axis);
-  PADDLE_ENFORCE_GE(
-      axis,
-      0,
-      common::errors::InvalidArgument(
-          "Axis should be great than or equal to 0, but received axis is %d.",
-          axis));
-  PADDLE_ENFORCE_LE(
-      axis,
-      max_dim,
-      common::errors::InvalidArgument(
-          "Axis should be less than or equal to %d, but received axis is %d.",
-          max_dim,
-          axis));
-  std::vector<int> x_dims_array(max_dim);
-  std::vector<int> y_dims_array(max_dim);
-  std::vector<int> out_dims_array(max_dim);
-  GetBroadcastDimsArrays(x_dims,
-                         y_dims,
-                         x_dims_array.data(),
-                         y_dims_array.data(),
-                         out_dims_array.data(),
-                         max_dim,
-                         axis);
-
-  CommonForwardBroadcastCPU<Functor, T, OutType>(x,
-                                                 y,
-                                                 z,
-                                                 x_dims_array.data(),
-                                                 y_dims_array.data(),
-                                                 out_dims_array.data(),
-                                                 max_dim,
-                                                 dev_ctx,
-                                                 func,
-                                                 is_xsize_larger);
+  // The simplified dims are innermost first.
+  BroadcastDimsSimplifier simplifier({&x, &y}, out_dims, axis);
+  const int rank = simplifier.rank;
+  const std::vector<int64_t> &dims = simplifier.out_dims;
+  std::vector<int64_t> x_strides(rank);
+  std::vector<int64_t> y_strides(rank);
+  int64_t x_stride = 1;
+  int64_t y_stride = 1;
+  for (int i = 0; i < rank; ++i) {
+    const int64_t x_dim = simplifier.in_dims[0][i];
+    const int64_t y_dim = simplifier.in_dims[1][i];
+    x_strides[i] = x_dim == 1 ? 0 : x_stride;
+    y_strides[i] = y_dim == 1 ? 0 : y_stride;
+    x_stride *= x_dim;
+    y_stride *= y_dim;
+  }
+
+  const int64_t inner = dims[0];
+  const bool x_contiguous = x_strides[0] != 0;
+  const bool y_contiguous = y_strides[0] != 0;
+  ParallelFor(
+      dev_ctx, 0, numel / inner, inner, [&](int64_t begin, int64_t end) {
+        // The index of the row over the outer dims, advanced row by row.
+        std::vector<int64_t> index(rank, 0);
+        int64_t x_offset = 0;
+        int64_t y_offset = 0;
+        int64_t rest = begin;
+        for (int i = 1; i < rank; ++i) {
+          index[i] = rest % dims[i];
+          rest /= dims[i];
+          x_offset += index[i] * x_strides[i];
+          y_offset += index[i] * y_strides[i];
+        }
+        for (int64_t row = begin; row < end; ++row) {
+          BroadcastRowCPU<Functor, T, OutType>(x_data + x_offset,
+                                               x_contiguous,
+                                               y_data + y_offset,
+                                               y_contiguous,
+                                               inner,
+                                               out_data + row * inner,
+                                               func);
+          for (int i = 1; i < rank; ++i) {
+            x_offset += x_strides[i];
+            y_offset += y_strides[i];
+            if (++index[i] < dims[i]) break;
+            x_offset -= x_strides[i] * dims[i];
+            y_offset -= y_strides[i] * dims[i];
+            index[i] = 0;
+          }
+        }
+      });
 }
 
 // It is a common CPU implementation to compute binary calculation with the
 // support of broadcast. Note:
-// 1. CPU implementation cannot support the case when x needs broadcast, thus
-//    this function need to be called with XxxFunctor and XxxInverseFunctor,
-//    like AddFunctor and InverseAddFunctor.
+// 1. CPU implementation calls func with the operand of the larger rank
+//    first, thus this function need to be called with XxxFunctor and
+//    XxxInverseFunctor, like AddFunctor and InverseAddFunctor.
 // 2. The corresponding GPU implementation supports all the broadcast cases,
 //    thus there is no need to define and call with XxxInverseFunctor.
-// TODO(liuyiqun): optimize the CPU implementation to support all broadcast
-// cases and avoid the need of XxxInverseFunctor.
 template <typename Functor, typename T, typename OutType = T>
 void ElementwiseCompute(const CPUContext &dev_ctx,
                         const DenseTensor &x,
@@ -379,9 +404,9 @@ void ElementwiseCompute(const CPUContext &dev_ctx,
     is_xsize_larger = false;
     max_dim = y_dims.size();
   }
-  TransformFunctor<Functor, T, CPUContext, OutType> functor(
-      x, y, z, dev_ctx, func, is_xsize_larger);
   if (x_dims == y_dims) {
+    TransformFunctor<Functor, T, CPUContext, OutType> functor(
+        x, y, z, dev_ctx, func, is_xsize_larger);
     functor.Run();
     return;
   }
@@ -401,44 +426,27 @@ void ElementwiseCompute(const CPUContext &dev_ctx,
           max_dim,
           axis));
 
-  int pre, n, post, is_run_common_broadcast, axis_trim = 0;
-  if (is_xsize_larger) {
-    auto y_dims_trimed = TrimTrailingSingularDims(y_dims);
-    axis_trim = (y_dims_trimed.size() == 0) ? x_dims.size() : axis;
-    GetMidDims(x_dims,
-               y_dims_trimed,
-               axis_trim,
-               &pre,
-               &n,
-               &post,
-               &is_run_common_broadcast);
-  } else {
-    auto x_dims_trimed = TrimTrailingSingularDims(x_dims);
-    axis_trim = (x_dims_trimed.size() == 0) ? y_dims.size() : axis;
-    GetMidDims(y_dims,
-               x_dims_trimed,
-               axis_trim,
-               &pre,
-               &n,
-               &post,
-               &is_run_common_broadcast);
-  }
-  // special case for common implementation.
-  // case 1: x=[2,3,1,5], y=[2,1,4,1]
-  // case 2: x=[2,3,4], y=[1,1,4]
-  if (is_run_common_broadcast == 1) {
-    CommonElementwiseBroadcastForward<Functor, T, OutType>(
-        dev_ctx, x, y, z, x_dims, y_dims, func, axis, is_xsize_larger);
-    return;
-  }
+  // The trailing 1-dims of the operand of the smaller rank are dropped,
+  // they may end past the other one, e.g. y of [3, 1] at axis 1 of x of
+  // [2, 3].
+  const DenseTensor &larger = is_xsize_larger ? x : y;
+  DenseTensor smaller = is_xsize_larger ? y : x;
+  smaller.Resize(TrimTrailingSingularDims(smaller.dims()));
+  if (smaller.dims().size() == 0) axis = max_dim;
 
-  if (post == 1) {
-    functor.RunRowWise(n);
-    return;
-  } else {
-    functor.RunMidWise(n, post);
-    return;
-  }
+  std::vector<int> x_dims_array(max_dim);
+  std::vector<int> y_dims_array(max_dim);
+  std::vector<int> out_dims_array(max_dim);
+  GetBroadcastDimsArrays(larger.dims(),
+                         smaller.dims(),
+                         x_dims_array.data(),
+                         y_dims_array.data(),
+                         out_dims_array.data(),
+                         max_dim,
+                         axis);
+  const DDim out_dims = common::make_ddim(out_dims_array);
+  BroadcastCPU<Functor, T, OutType>(
+      dev_ctx, larger, smaller, out_dims, axis, func, z);
 }
 
 // for broadcast backwards
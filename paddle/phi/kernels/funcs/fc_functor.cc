@@ -17,6 +17,7 @@ limitations under the License. */
 #include "paddle/phi/backends/all_context.h"
 #include "paddle/phi/kernels/funcs/blas/blas.h"
 #include "paddle/phi/kernels/funcs/jit/kernels.h"
+#include "paddle/phi/kernels/funcs/packed_gemm.h"
 
 namespace phi {
 namespace funcs {
@@ -31,8 +32,11 @@ void FCFunctor<DeviceContext, T>::operator()(const DeviceContext& context,
                                              T* Y,
                                              const T* B,
                                              bool relu,
-                                             bool padding_weights) {
+                                             bool padding_weights,
+                                             const DenseTensor* weight) {
   auto blas = GetBlas<DeviceContext, T>(context);
+  // fc only runs in inference, where its weight is a parameter.
+  if (weight != nullptr) MarkPackableWeight(*weight);
   phi::DenseTensor Y1;
   T* Y1_data = nullptr;
   if (padding_weights) {
@@ -50,20 +54,48 @@ void FCFunctor<DeviceContext, T>::operator()(const DeviceContext& context,
     for (int i = 0; i < M; i++) {
       memcpy(X1_data + i * KK, X + i * K, K * sizeof(T));
     }
-    blas.GEMM(false,
-              false,
-              M,
-              N,
-              K,
-              static_cast<T>(1.0),
-              X1_data,
-              KK,
-              W,
-              NN,
-              static_cast<T>(0.0),
-              Y1_data,
-              NN);
-  } else {
+    if (weight == nullptr ||
+        !GEMMWithPackedWeight<T>(context,
+                                 false,
+                                 M,
+                                 N,
+                                 K,
+                                 X1_data,
+                                 KK,
+                                 *weight,
+                                 false,
+                                 NN,
+                                 static_cast<T>(0.0),
+                                 Y1_data,
+                                 NN)) {
+      blas.GEMM(false,
+                false,
+                M,
+                N,
+                K,
+                static_cast<T>(1.0),
+                X1_data,
+                KK,
+                W,
+                NN,
+                static_cast<T>(0.0),
+                Y1_data,
+                NN);
+    }
+  } else if (weight == nullptr ||
+             !GEMMWithPackedWeight<T>(context,
+                                      false,
+                                      M,
+                                      N,
+                                      K,
+                                      X,
+                                      K,
+                                      *weight,
+                                      false,
+                                      N,
+                                      static_cast<T>(0.0),
+                                      Y,
+                                      N)) {
     blas.MatMul(M, N, K, X, W, Y);
   }
   if (B == nullptr) {
@@ -345,7 +345,8 @@ void FCFunctor<DeviceContext, T>::operator()(const DeviceContext& context,
                                              T* Y,
                                              const T* B,
                                              bool relu,
-                                             bool padding_weights) {
+                                             bool padding_weights,
+                                             const DenseTensor* weight) {
   PADDLE_ENFORCE_EQ(padding_weights,
                     false,
                     errors::PermissionDenied(
@@ -25,6 +25,9 @@ namespace funcs {
 template <typename DeviceContext, typename T>
 class FCFunctor {
  public:
+  // weight is the tensor W points to, if it is a whole parameter. On CPU it
+  // is marked constant, so the GEMM may reuse a packed copy of W, see
+  // funcs::GEMMWithPackedWeight.
   void operator()(const DeviceContext& context,
                   const int M,
                   const int N,
@@ -34,7 +37,8 @@ class FCFunctor {
                   T* Y,
                   const T* B = nullptr,
                   bool relu = false,
-                  bool weight_pass = false);
+                  bool weight_pass = false,
+                  const DenseTensor* weight = nullptr);
 };
 
 template <typename DeviceContext, typename T>
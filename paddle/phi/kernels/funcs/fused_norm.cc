@@ -0,0 +1,132 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/funcs/fused_norm.h"
+
+#include "paddle/phi/backends/cpu/cpu_info.h"
+
+namespace phi {
+namespace funcs {
+namespace {
+
+template <typename AccT>
+void MomentsRef(const AccT* x, int64_t n, AccT* mean, AccT* var) {
+  int64_t count = 0;
+  AccT m = 0;
+  AccT m2 = 0;
+  for (int64_t i = 0; i < n; ++i) {
+    detail::WelfordUpdate(x[i], &count, &m, &m2);
+  }
+  *mean = m;
+  *var = n > 0 ? m2 / static_cast<AccT>(n) : AccT(0);
+}
+
+template <typename AccT>
+AccT MeanSquareRef(const AccT* x, int64_t n) {
+  AccT sum = 0;
+  for (int64_t i = 0; i < n; ++i) {
+    sum += x[i] * x[i];
+  }
+  return n > 0 ? sum / static_cast<AccT>(n) : AccT(0);
+}
+
+template <typename AccT>
+void NormalizeRef(const AccT* x,
+                  int64_t n,
+                  AccT mean,
+                  AccT rstd,
+                  const AccT* gamma,
+                  const AccT* beta,
+                  AccT* y) {
+  for (int64_t i = 0; i < n; ++i) {
+    AccT value = (x[i] - mean) * rstd;
+    if (gamma != nullptr) value *= gamma[i];
+    if (beta != nullptr) value += beta[i];
+    y[i] = value;
+  }
+}
+
+template <typename AccT>
+void BackwardSumsRef(const AccT* dy,
+                     const AccT* x,
+                     const AccT* gamma,
+                     int64_t n,
+                     AccT mean,
+                     AccT rstd,
+                     AccT* sum_g,
+                     AccT* sum_gx) {
+  AccT g_total = 0;
+  AccT gx_total = 0;
+  for (int64_t i = 0; i < n; ++i) {
+    const AccT g = gamma != nullptr ? dy[i] * gamma[i] : dy[i];
+    g_total += g;
+    gx_total += g * (x[i] - mean) * rstd;
+  }
+  *sum_g = g_total;
+  *sum_gx = gx_total;
+}
+
+template <typename AccT>
+void BackwardDxRef(const AccT* dy,
+                   const AccT* x,
+                   const AccT* gamma,
+                   int64_t n,
+                   AccT mean,
+                   AccT rstd,
+                   AccT c1,
+                   AccT c2,
+                   AccT* dx,
+                   AccT* dgamma,
+                   AccT* dbeta) {
+  for (int64_t i = 0; i < n; ++i) {
+    const AccT xhat = (x[i] - mean) * rstd;
+    const AccT g = gamma != nullptr ? dy[i] * gamma[i] : dy[i];
+    dx[i] = rstd * (g - c1 - xhat * c2);
+    if (dgamma != nullptr) dgamma[i] += dy[i] * xhat;
+    if (dbeta != nullptr) dbeta[i] += dy[i];
+  }
+}
+
+template <typename AccT>
+const NormRowFuncs<AccT> kNormRowFuncsRef = {MomentsRef<AccT>,
+                                             MeanSquareRef<AccT>,
+                                             NormalizeRef<AccT>,
+                                             BackwardSumsRef<AccT>,
+                                             BackwardDxRef<AccT>};
+
+}  // namespace
+
+template <>
+const NormRowFuncs<float>& GetNormRowFuncs<float>() {
+  static const NormRowFuncs<float>* row_funcs = []() {
+    using backends::cpu::MayIUse;
+    const NormRowFuncs<float>* best = nullptr;
+    if (MayIUse(backends::cpu::avx512f)) {
+      best = detail::GetNormRowFuncsAVX512();
+    }
+    if (best == nullptr && MayIUse(backends::cpu::avx2)) {
+      best = detail::GetNormRowFuncsAVX2();
+    }
+    return best != nullptr ? best : &kNormRowFuncsRef<float>;
+  }();
+  return *row_funcs;
+}
+
+template <>
+const NormRowFuncs<double>& GetNormRowFuncs<double>() {
+  return kNormRowFuncsRef<double>;
+}
+
+}  // namespace funcs
+}  // namespace phi
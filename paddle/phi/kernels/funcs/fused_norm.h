@@ -0,0 +1,385 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/data_type.h"
+#include "paddle/phi/common/float16.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/kernels/funcs/parallel_for.h"
+
+namespace phi {
+namespace funcs {
+
+// The fused row-wise engine of LayerNorm and RMSNorm on CPU. Each row is
+// read once for its statistics and once more, while still in cache, to be
+// normalized, scaled and shifted; the backward pass needs the same two
+// reads of x and dy. Rows of low precision types are converted to their
+// accumulation type a row at a time.
+enum class NormType { kLayerNorm, kRmsNorm };
+
+// The row functions of the engine. gamma, beta, dgamma and dbeta may be
+// nullptr. RMSNorm uses them with mean 0.
+template <typename AccT>
+struct NormRowFuncs {
+  // Welford mean and biased variance of x.
+  void (*moments)(const AccT* x, int64_t n, AccT* mean, AccT* var);
+  // Mean of the squares of x.
+  AccT (*mean_square)(const AccT* x, int64_t n);
+  // y = (x - mean) * rstd * gamma + beta, y may be x.
+  void (*normalize)(const AccT* x,
+                    int64_t n,
+                    AccT mean,
+                    AccT rstd,
+                    const AccT* gamma,
+                    const AccT* beta,
+                    AccT* y);
+  // sum_g = sum(dy * gamma) and sum_gx = sum(dy * gamma * xhat), where
+  // xhat = (x - mean) * rstd.
+  void (*backward_sums)(const AccT* dy,
+                        const AccT* x,
+                        const AccT* gamma,
+                        int64_t n,
+                        AccT mean,
+                        AccT rstd,
+                        AccT* sum_g,
+                        AccT* sum_gx);
+  // dx = rstd * (dy * gamma - c1 - xhat * c2), dgamma += dy * xhat and
+  // dbeta += dy.
+  void (*backward_dx)(const AccT* dy,
+                      const AccT* x,
+                      const AccT* gamma,
+                      int64_t n,
+                      AccT mean,
+                      AccT rstd,
+                      AccT c1,
+                      AccT c2,
+                      AccT* dx,
+                      AccT* dgamma,
+                      AccT* dbeta);
+};
+
+// Returns the row functions of the widest instruction set of this CPU.
+template <typename AccT>
+const NormRowFuncs<AccT>& GetNormRowFuncs();
+
+template <>
+const NormRowFuncs<float>& GetNormRowFuncs<float>();
+
+template <>
+const NormRowFuncs<double>& GetNormRowFuncs<double>();
+
+namespace detail {
+
+// The row functions of one instruction set, nullptr if this build has no
+// code for it. They do not check the CPU.
+const NormRowFuncs<float>* GetNormRowFuncsAVX2();
+const NormRowFuncs<float>* GetNormRowFuncsAVX512();
+
+// Adds x to the Welford state (count, mean, m2).
+template <typename AccT>
+inline void WelfordUpdate(AccT x, int64_t* count, AccT* mean, AccT* m2) {
+  ++*count;
+  const AccT delta = x - *mean;
+  *mean += delta / static_cast<AccT>(*count);
+  *m2 += delta * (x - *mean);
+}
+
+// Merges the Welford state (count_b, mean_b, m2_b) into (count, mean, m2).
+template <typename AccT>
+inline void WelfordMerge(int64_t count_b,
+                         AccT mean_b,
+                         AccT m2_b,
+                         int64_t* count,
+                         AccT* mean,
+                         AccT* m2) {
+  if (count_b == 0) return;
+  const int64_t total = *count + count_b;
+  const AccT delta = mean_b - *mean;
+  const AccT ratio_b =
+      static_cast<AccT>(count_b) / static_cast<AccT>(total);
+  *mean += delta * ratio_b;
+  *m2 += m2_b + delta * delta * static_cast<AccT>(*count) * ratio_b;
+  *count = total;
+}
+
+template <typename T, typename AccT>
+const AccT* LoadNormRow(const T* row, int64_t n, std::vector<AccT>* buf) {
+  if constexpr (std::is_same<T, AccT>::value) {
+    return row;
+  } else {
+    AccT* data = buf->data();
+    for (int64_t i = 0; i < n; ++i) {
+      data[i] = static_cast<AccT>(row[i]);
+    }
+    return data;
+  }
+}
+
+template <typename T, typename AccT>
+void StoreNormRow(const AccT* row, int64_t n, T* out) {
+  for (int64_t i = 0; i < n; ++i) {
+    out[i] = static_cast<T>(row[i]);
+  }
+}
+
+template <typename SrcT, typename DstT>
+void ConvertNormParam(const SrcT* src, int64_t n, DstT* dst) {
+  for (int64_t i = 0; i < n; ++i) {
+    dst[i] = static_cast<DstT>(src[i]);
+  }
+}
+
+// Calls func(static_cast<SrcT*>(nullptr)) with the type of dtype.
+template <typename Function>
+void VisitNormParamType(DataType dtype, const Function& func) {
+  switch (dtype) {
+    case DataType::FLOAT32:
+      func(static_cast<float*>(nullptr));
+      break;
+    case DataType::FLOAT64:
+      func(static_cast<double*>(nullptr));
+      break;
+    case DataType::BFLOAT16:
+      func(static_cast<phi::dtype::bfloat16*>(nullptr));
+      break;
+    case DataType::FLOAT16:
+      func(static_cast<phi::dtype::float16*>(nullptr));
+      break;
+    default:
+      PADDLE_THROW(common::errors::Unimplemented(
+          "The scale and bias of a norm do not support data type %s.",
+          DataTypeToString(dtype)));
+  }
+}
+
+}  // namespace detail
+
+// Returns the data of param as AccT, converted into buf if param has
+// another data type, or nullptr if there is no param.
+template <typename AccT>
+const AccT* GetNormParam(const CPUContext& dev_ctx,
+                         const DenseTensor* param,
+                         DenseTensor* buf) {
+  if (param == nullptr) return nullptr;
+  if (param->dtype() == phi::CppTypeToDataType<AccT>::Type()) {
+    return param->data<AccT>();
+  }
+  buf->Resize(param->dims());
+  AccT* data = dev_ctx.template Alloc<AccT>(buf);
+  detail::VisitNormParamType(param->dtype(), [&](auto* type_tag) {
+    using SrcT = std::remove_pointer_t<decltype(type_tag)>;
+    detail::ConvertNormParam(param->data<SrcT>(), param->numel(), data);
+  });
+  return data;
+}
+
+// Allocates the gradient of a scale or bias, and returns where the engine
+// writes it as AccT: grad itself, or buf if grad has another data type, in
+// which case CopyNormParamGrad copies buf to grad. nullptr if there is no
+// grad.
+template <typename AccT>
+AccT* AllocNormParamGrad(const CPUContext& dev_ctx,
+                         DenseTensor* grad,
+                         DenseTensor* buf) {
+  if (grad == nullptr) return nullptr;
+  if (grad->dtype() == phi::CppTypeToDataType<AccT>::Type() ||
+      grad->dtype() == DataType::UNDEFINED) {
+    return dev_ctx.template Alloc<AccT>(grad);
+  }
+  dev_ctx.Alloc(grad, grad->dtype());
+  buf->Resize(grad->dims());
+  return dev_ctx.template Alloc<AccT>(buf);
+}
+
+template <typename AccT>
+void CopyNormParamGrad(const DenseTensor& buf, DenseTensor* grad) {
+  if (grad == nullptr || !buf.initialized()) return;
+  detail::VisitNormParamType(grad->dtype(), [&](auto* type_tag) {
+    using DstT = std::remove_pointer_t<decltype(type_tag)>;
+    detail::ConvertNormParam(
+        buf.data<AccT>(), buf.numel(), grad->data<DstT>());
+  });
+}
+
+// Normalizes the rows of x, or of x + residual + bias if there is a
+// residual, which is then written to residual_out. mean and var are the
+// statistics of LayerNorm, rstd is 1 / sqrt(var + epsilon), or of the mean
+// square for RMSNorm; each may be nullptr.
+template <typename T, typename AccT>
+void NormForwardCPU(const CPUContext& dev_ctx,
+                    NormType type,
+                    const T* x,
+                    const T* residual,
+                    const T* bias,
+                    const AccT* gamma,
+                    const AccT* beta,
+                    int64_t rows,
+                    int64_t cols,
+                    float epsilon,
+                    T* residual_out,
+                    T* y,
+                    AccT* mean,
+                    AccT* var,
+                    AccT* rstd) {
+  constexpr bool kSameType = std::is_same<T, AccT>::value;
+  const auto& row_funcs = GetNormRowFuncs<AccT>();
+  ParallelFor(dev_ctx, 0, rows, cols, [&](int64_t begin, int64_t end) {
+    std::vector<AccT> buf;
+    if (!kSameType || residual != nullptr) buf.resize(cols);
+    for (int64_t i = begin; i < end; ++i) {
+      const T* x_row = x + i * cols;
+      const AccT* src = nullptr;
+      if (residual != nullptr) {
+        const T* residual_row = residual + i * cols;
+        T* residual_out_row = residual_out + i * cols;
+        for (int64_t j = 0; j < cols; ++j) {
+          AccT sum = static_cast<AccT>(x_row[j]) +
+                     static_cast<AccT>(residual_row[j]);
+          if (bias != nullptr) sum += static_cast<AccT>(bias[j]);
+          residual_out_row[j] = static_cast<T>(sum);
+          buf[j] = sum;
+        }
+        src = buf.data();
+      } else {
+        src = detail::LoadNormRow(x_row, cols, &buf);
+      }
+
+      AccT row_mean = 0;
+      AccT row_var = 0;
+      if (type == NormType::kLayerNorm) {
+        row_funcs.moments(src, cols, &row_mean, &row_var);
+      } else {
+        row_var = row_funcs.mean_square(src, cols);
+      }
+      const AccT row_rstd =
+          static_cast<AccT>(1) /
+          std::sqrt(row_var + static_cast<AccT>(epsilon));
+      if (mean != nullptr) mean[i] = row_mean;
+      if (var != nullptr) var[i] = row_var;
+      if (rstd != nullptr) rstd[i] = row_rstd;
+
+      if constexpr (kSameType) {
+        row_funcs.normalize(
+            src, cols, row_mean, row_rstd, gamma, beta, y + i * cols);
+      } else {
+        row_funcs.normalize(
+            src, cols, row_mean, row_rstd, gamma, beta, buf.data());
+        detail::StoreNormRow(buf.data(), cols, y + i * cols);
+      }
+    }
+  });
+}
+
+// The gradients of NormForwardCPU without a residual. mean is nullptr for
+// RMSNorm. dx, dgamma and dbeta may be nullptr; dgamma and dbeta have cols
+// elements and are overwritten.
+template <typename T, typename AccT>
+void NormBackwardCPU(const CPUContext& dev_ctx,
+                     NormType type,
+                     const T* x,
+                     const T* dy,
+                     const AccT* gamma,
+                     const AccT* mean,
+                     const AccT* rstd,
+                     int64_t rows,
+                     int64_t cols,
+                     T* dx,
+                     AccT* dgamma,
+                     AccT* dbeta) {
+  constexpr bool kSameType = std::is_same<T, AccT>::value;
+  const auto& row_funcs = GetNormRowFuncs<AccT>();
+  // The dgamma and dbeta summed by each chunk, by its first row. They are
+  // added up in row order after the last chunk, so that the result does not
+  // depend on which chunk ends first.
+  std::map<int64_t, std::pair<std::vector<AccT>, std::vector<AccT>>> partials;
+  std::mutex mutex;
+  ParallelFor(dev_ctx, 0, rows, 2 * cols, [&](int64_t begin, int64_t end) {
+    std::vector<AccT> dgamma_acc(dgamma != nullptr ? cols : 0);
+    std::vector<AccT> dbeta_acc(dbeta != nullptr ? cols : 0);
+    std::vector<AccT> x_buf(kSameType ? 0 : cols);
+    std::vector<AccT> dy_buf(kSameType ? 0 : cols);
+    std::vector<AccT> dx_buf(kSameType && dx != nullptr ? 0 : cols);
+    const AccT inv_cols = static_cast<AccT>(1) / static_cast<AccT>(cols);
+    for (int64_t i = begin; i < end; ++i) {
+      const AccT* x_row = detail::LoadNormRow(x + i * cols, cols, &x_buf);
+      const AccT* dy_row = detail::LoadNormRow(dy + i * cols, cols, &dy_buf);
+      const AccT row_mean = type == NormType::kLayerNorm ? mean[i] : AccT(0);
+      const AccT row_rstd = rstd[i];
+
+      AccT c1 = 0;
+      AccT c2 = 0;
+      if (dx != nullptr) {
+        AccT sum_g = 0;
+        AccT sum_gx = 0;
+        row_funcs.backward_sums(
+            dy_row, x_row, gamma, cols, row_mean, row_rstd, &sum_g, &sum_gx);
+        if (type == NormType::kLayerNorm) c1 = sum_g * inv_cols;
+        c2 = sum_gx * inv_cols;
+      }
+
+      AccT* dx_row = dx_buf.data();
+      if constexpr (kSameType) {
+        if (dx != nullptr) dx_row = dx + i * cols;
+      }
+      row_funcs.backward_dx(dy_row,
+                            x_row,
+                            gamma,
+                            cols,
+                            row_mean,
+                            row_rstd,
+                            c1,
+                            c2,
+                            dx_row,
+                            dgamma != nullptr ? dgamma_acc.data() : nullptr,
+                            dbeta != nullptr ? dbeta_acc.data() : nullptr);
+      if constexpr (!kSameType) {
+        if (dx != nullptr) detail::StoreNormRow(dx_row, cols, dx + i * cols);
+      }
+    }
+
+    if (dgamma == nullptr && dbeta == nullptr) return;
+    std::lock_guard<std::mutex> guard(mutex);
+    partials.emplace(
+        begin, std::make_pair(std::move(dgamma_acc), std::move(dbeta_acc)));
+  });
+
+  if (dgamma != nullptr) std::fill(dgamma, dgamma + cols, AccT(0));
+  if (dbeta != nullptr) std::fill(dbeta, dbeta + cols, AccT(0));
+  for (const auto& partial : partials) {
+    const std::vector<AccT>& dgamma_acc = partial.second.first;
+    const std::vector<AccT>& dbeta_acc = partial.second.second;
+    for (int64_t j = 0; j < static_cast<int64_t>(dgamma_acc.size()); ++j) {
+      dgamma[j] += dgamma_acc[j];
+    }
+    for (int64_t j = 0; j < static_cast<int64_t>(dbeta_acc.size()); ++j) {
+      dbeta[j] += dbeta_acc[j];
+    }
+  }
+}
+
+}  // namespace funcs
+}  // namespace phi
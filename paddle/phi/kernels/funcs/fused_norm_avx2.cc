@@ -0,0 +1,221 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This file is built with the AVX2 and FMA flags when the compiler has
+// them, see paddle/phi/CMakeLists.txt.
+
+#include "paddle/phi/kernels/funcs/fused_norm.h"
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#include <immintrin.h>
+#define PADDLE_FUSED_NORM_AVX2
+#endif
+
+namespace phi {
+namespace funcs {
+namespace detail {
+
+#ifdef PADDLE_FUSED_NORM_AVX2
+namespace {
+
+constexpr int64_t kBlock = 8;
+
+inline float HorizontalSum(__m256 v) {
+  __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v),
+                          _mm256_extractf128_ps(v, 1));
+  sum = _mm_hadd_ps(sum, sum);
+  sum = _mm_hadd_ps(sum, sum);
+  return _mm_cvtss_f32(sum);
+}
+
+// Every lane keeps the Welford state of every 8th element, the lanes are
+// merged at the end.
+void MomentsAVX2(const float* x, int64_t n, float* mean, float* var) {
+  __m256 lane_mean = _mm256_setzero_ps();
+  __m256 lane_m2 = _mm256_setzero_ps();
+  int64_t lane_count = 0;
+  int64_t i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    ++lane_count;
+    const __m256 vx = _mm256_loadu_ps(x + i);
+    const __m256 delta = _mm256_sub_ps(vx, lane_mean);
+    lane_mean = _mm256_fmadd_ps(
+        delta, _mm256_set1_ps(1.0f / lane_count), lane_mean);
+    lane_m2 = _mm256_fmadd_ps(delta, _mm256_sub_ps(vx, lane_mean), lane_m2);
+  }
+  alignas(32) float means[kBlock];
+  alignas(32) float m2s[kBlock];
+  _mm256_store_ps(means, lane_mean);
+  _mm256_store_ps(m2s, lane_m2);
+  int64_t count = 0;
+  float m = 0.0f;
+  float m2 = 0.0f;
+  for (int64_t lane = 0; lane < kBlock; ++lane) {
+    WelfordMerge(lane_count, means[lane], m2s[lane], &count, &m, &m2);
+  }
+  for (; i < n; ++i) {
+    WelfordUpdate(x[i], &count, &m, &m2);
+  }
+  *mean = m;
+  *var = n > 0 ? m2 / static_cast<float>(n) : 0.0f;
+}
+
+float MeanSquareAVX2(const float* x, int64_t n) {
+  __m256 sum0 = _mm256_setzero_ps();
+  __m256 sum1 = _mm256_setzero_ps();
+  int64_t i = 0;
+  for (; i + 2 * kBlock <= n; i += 2 * kBlock) {
+    const __m256 x0 = _mm256_loadu_ps(x + i);
+    const __m256 x1 = _mm256_loadu_ps(x + i + kBlock);
+    sum0 = _mm256_fmadd_ps(x0, x0, sum0);
+    sum1 = _mm256_fmadd_ps(x1, x1, sum1);
+  }
+  for (; i + kBlock <= n; i += kBlock) {
+    const __m256 x0 = _mm256_loadu_ps(x + i);
+    sum0 = _mm256_fmadd_ps(x0, x0, sum0);
+  }
+  float sum = HorizontalSum(_mm256_add_ps(sum0, sum1));
+  for (; i < n; ++i) {
+    sum += x[i] * x[i];
+  }
+  return n > 0 ? sum / static_cast<float>(n) : 0.0f;
+}
+
+void NormalizeAVX2(const float* x,
+                   int64_t n,
+                   float mean,
+                   float rstd,
+                   const float* gamma,
+                   const float* beta,
+                   float* y) {
+  const __m256 vmean = _mm256_set1_ps(mean);
+  const __m256 vrstd = _mm256_set1_ps(rstd);
+  int64_t i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    __m256 value =
+        _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(x + i), vmean), vrstd);
+    if (gamma != nullptr) {
+      value = _mm256_mul_ps(value, _mm256_loadu_ps(gamma + i));
+    }
+    if (beta != nullptr) {
+      value = _mm256_add_ps(value, _mm256_loadu_ps(beta + i));
+    }
+    _mm256_storeu_ps(y + i, value);
+  }
+  for (; i < n; ++i) {
+    float value = (x[i] - mean) * rstd;
+    if (gamma != nullptr) value *= gamma[i];
+    if (beta != nullptr) value += beta[i];
+    y[i] = value;
+  }
+}
+
+void BackwardSumsAVX2(const float* dy,
+                      const float* x,
+                      const float* gamma,
+                      int64_t n,
+                      float mean,
+                      float rstd,
+                      float* sum_g,
+                      float* sum_gx) {
+  const __m256 vmean = _mm256_set1_ps(mean);
+  const __m256 vrstd = _mm256_set1_ps(rstd);
+  __m256 vsum_g = _mm256_setzero_ps();
+  __m256 vsum_gx = _mm256_setzero_ps();
+  int64_t i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    __m256 g = _mm256_loadu_ps(dy + i);
+    if (gamma != nullptr) g = _mm256_mul_ps(g, _mm256_loadu_ps(gamma + i));
+    const __m256 xhat =
+        _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(x + i), vmean), vrstd);
+    vsum_g = _mm256_add_ps(vsum_g, g);
+    vsum_gx = _mm256_fmadd_ps(g, xhat, vsum_gx);
+  }
+  float g_total = HorizontalSum(vsum_g);
+  float gx_total = HorizontalSum(vsum_gx);
+  for (; i < n; ++i) {
+    const float g = gamma != nullptr ? dy[i] * gamma[i] : dy[i];
+    g_total += g;
+    gx_total += g * (x[i] - mean) * rstd;
+  }
+  *sum_g = g_total;
+  *sum_gx = gx_total;
+}
+
+void BackwardDxAVX2(const float* dy,
+                    const float* x,
+                    const float* gamma,
+                    int64_t n,
+                    float mean,
+                    float rstd,
+                    float c1,
+                    float c2,
+                    float* dx,
+                    float* dgamma,
+                    float* dbeta) {
+  const __m256 vmean = _mm256_set1_ps(mean);
+  const __m256 vrstd = _mm256_set1_ps(rstd);
+  const __m256 vc1 = _mm256_set1_ps(c1);
+  const __m256 vc2 = _mm256_set1_ps(c2);
+  int64_t i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    const __m256 vdy = _mm256_loadu_ps(dy + i);
+    const __m256 xhat =
+        _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(x + i), vmean), vrstd);
+    const __m256 g = gamma != nullptr
+                         ? _mm256_mul_ps(vdy, _mm256_loadu_ps(gamma + i))
+                         : vdy;
+    // rstd * (g - c1 - xhat * c2)
+    const __m256 value = _mm256_fnmadd_ps(xhat, vc2, _mm256_sub_ps(g, vc1));
+    _mm256_storeu_ps(dx + i, _mm256_mul_ps(value, vrstd));
+    if (dgamma != nullptr) {
+      _mm256_storeu_ps(
+          dgamma + i,
+          _mm256_fmadd_ps(vdy, xhat, _mm256_loadu_ps(dgamma + i)));
+    }
+    if (dbeta != nullptr) {
+      _mm256_storeu_ps(dbeta + i,
+                       _mm256_add_ps(vdy, _mm256_loadu_ps(dbeta + i)));
+    }
+  }
+  for (; i < n; ++i) {
+    const float xhat = (x[i] - mean) * rstd;
+    const float g = gamma != nullptr ? dy[i] * gamma[i] : dy[i];
+    dx[i] = rstd * (g - c1 - xhat * c2);
+    if (dgamma != nullptr) dgamma[i] += dy[i] * xhat;
+    if (dbeta != nullptr) dbeta[i] += dy[i];
+  }
+}
+
+const NormRowFuncs<float> kNormRowFuncsAVX2 = {MomentsAVX2,
+                                               MeanSquareAVX2,
+                                               NormalizeAVX2,
+                                               BackwardSumsAVX2,
+                                               BackwardDxAVX2};
+
+}  // namespace
+
+const NormRowFuncs<float>* GetNormRowFuncsAVX2() {
+  return &kNormRowFuncsAVX2;
+}
+
+#else
+
+const NormRowFuncs<float>* GetNormRowFuncsAVX2() { return nullptr; }
+
+#endif
+
+}  // namespace detail
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,204 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This file is built with the AVX512F flags when the compiler has them, see
+// paddle/phi/CMakeLists.txt.
+
+#include "paddle/phi/kernels/funcs/fused_norm.h"
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#define PADDLE_FUSED_NORM_AVX512
+#endif
+
+namespace phi {
+namespace funcs {
+namespace detail {
+
+#ifdef PADDLE_FUSED_NORM_AVX512
+namespace {
+
+constexpr int64_t kBlock = 16;
+
+inline __mmask16 TailMask(int64_t rest) {
+  return static_cast<__mmask16>((1u << rest) - 1);
+}
+
+// Every lane keeps the Welford state of every 16th element, the lanes are
+// merged at the end. The tail is added one by one, since the lanes of a
+// masked block would have different counts.
+void MomentsAVX512(const float* x, int64_t n, float* mean, float* var) {
+  __m512 lane_mean = _mm512_setzero_ps();
+  __m512 lane_m2 = _mm512_setzero_ps();
+  int64_t lane_count = 0;
+  int64_t i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    ++lane_count;
+    const __m512 vx = _mm512_loadu_ps(x + i);
+    const __m512 delta = _mm512_sub_ps(vx, lane_mean);
+    lane_mean = _mm512_fmadd_ps(
+        delta, _mm512_set1_ps(1.0f / lane_count), lane_mean);
+    lane_m2 = _mm512_fmadd_ps(delta, _mm512_sub_ps(vx, lane_mean), lane_m2);
+  }
+  alignas(64) float means[kBlock];
+  alignas(64) float m2s[kBlock];
+  _mm512_store_ps(means, lane_mean);
+  _mm512_store_ps(m2s, lane_m2);
+  int64_t count = 0;
+  float m = 0.0f;
+  float m2 = 0.0f;
+  for (int64_t lane = 0; lane < kBlock; ++lane) {
+    WelfordMerge(lane_count, means[lane], m2s[lane], &count, &m, &m2);
+  }
+  for (; i < n; ++i) {
+    WelfordUpdate(x[i], &count, &m, &m2);
+  }
+  *mean = m;
+  *var = n > 0 ? m2 / static_cast<float>(n) : 0.0f;
+}
+
+float MeanSquareAVX512(const float* x, int64_t n) {
+  __m512 sum0 = _mm512_setzero_ps();
+  __m512 sum1 = _mm512_setzero_ps();
+  int64_t i = 0;
+  for (; i + 2 * kBlock <= n; i += 2 * kBlock) {
+    const __m512 x0 = _mm512_loadu_ps(x + i);
+    const __m512 x1 = _mm512_loadu_ps(x + i + kBlock);
+    sum0 = _mm512_fmadd_ps(x0, x0, sum0);
+    sum1 = _mm512_fmadd_ps(x1, x1, sum1);
+  }
+  for (; i < n; i += kBlock) {
+    const __mmask16 mask = TailMask(std::min(kBlock, n - i));
+    const __m512 x0 = _mm512_maskz_loadu_ps(mask, x + i);
+    sum0 = _mm512_fmadd_ps(x0, x0, sum0);
+  }
+  const float sum = _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1));
+  return n > 0 ? sum / static_cast<float>(n) : 0.0f;
+}
+
+void NormalizeAVX512(const float* x,
+                     int64_t n,
+                     float mean,
+                     float rstd,
+                     const float* gamma,
+                     const float* beta,
+                     float* y) {
+  const __m512 vmean = _mm512_set1_ps(mean);
+  const __m512 vrstd = _mm512_set1_ps(rstd);
+  for (int64_t i = 0; i < n; i += kBlock) {
+    const __mmask16 mask = TailMask(std::min(kBlock, n - i));
+    __m512 value = _mm512_mul_ps(
+        _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, x + i), vmean), vrstd);
+    if (gamma != nullptr) {
+      value = _mm512_mul_ps(value, _mm512_maskz_loadu_ps(mask, gamma + i));
+    }
+    if (beta != nullptr) {
+      value = _mm512_add_ps(value, _mm512_maskz_loadu_ps(mask, beta + i));
+    }
+    _mm512_mask_storeu_ps(y + i, mask, value);
+  }
+}
+
+void BackwardSumsAVX512(const float* dy,
+                        const float* x,
+                        const float* gamma,
+                        int64_t n,
+                        float mean,
+                        float rstd,
+                        float* sum_g,
+                        float* sum_gx) {
+  const __m512 vmean = _mm512_set1_ps(mean);
+  const __m512 vrstd = _mm512_set1_ps(rstd);
+  __m512 vsum_g = _mm512_setzero_ps();
+  __m512 vsum_gx = _mm512_setzero_ps();
+  for (int64_t i = 0; i < n; i += kBlock) {
+    const __mmask16 mask = TailMask(std::min(kBlock, n - i));
+    __m512 g = _mm512_maskz_loadu_ps(mask, dy + i);
+    if (gamma != nullptr) {
+      g = _mm512_mul_ps(g, _mm512_maskz_loadu_ps(mask, gamma + i));
+    }
+    // The masked out lanes of g are 0, so are their products.
+    const __m512 xhat = _mm512_mul_ps(
+        _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, x + i), vmean), vrstd);
+    vsum_g = _mm512_add_ps(vsum_g, g);
+    vsum_gx = _mm512_fmadd_ps(g, xhat, vsum_gx);
+  }
+  *sum_g = _mm512_reduce_add_ps(vsum_g);
+  *sum_gx = _mm512_reduce_add_ps(vsum_gx);
+}
+
+void BackwardDxAVX512(const float* dy,
+                      const float* x,
+                      const float* gamma,
+                      int64_t n,
+                      float mean,
+                      float rstd,
+                      float c1,
+                      float c2,
+                      float* dx,
+                      float* dgamma,
+                      float* dbeta) {
+  const __m512 vmean = _mm512_set1_ps(mean);
+  const __m512 vrstd = _mm512_set1_ps(rstd);
+  const __m512 vc1 = _mm512_set1_ps(c1);
+  const __m512 vc2 = _mm512_set1_ps(c2);
+  for (int64_t i = 0; i < n; i += kBlock) {
+    const __mmask16 mask = TailMask(std::min(kBlock, n - i));
+    const __m512 vdy = _mm512_maskz_loadu_ps(mask, dy + i);
+    const __m512 xhat = _mm512_mul_ps(
+        _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, x + i), vmean), vrstd);
+    const __m512 g =
+        gamma != nullptr
+            ? _mm512_mul_ps(vdy, _mm512_maskz_loadu_ps(mask, gamma + i))
+            : vdy;
+    // rstd * (g - c1 - xhat * c2)
+    const __m512 value = _mm512_fnmadd_ps(xhat, vc2, _mm512_sub_ps(g, vc1));
+    _mm512_mask_storeu_ps(dx + i, mask, _mm512_mul_ps(value, vrstd));
+    if (dgamma != nullptr) {
+      _mm512_mask_storeu_ps(
+          dgamma + i,
+          mask,
+          _mm512_fmadd_ps(
+              vdy, xhat, _mm512_maskz_loadu_ps(mask, dgamma + i)));
+    }
+    if (dbeta != nullptr) {
+      _mm512_mask_storeu_ps(
+          dbeta + i,
+          mask,
+          _mm512_add_ps(vdy, _mm512_maskz_loadu_ps(mask, dbeta + i)));
+    }
+  }
+}
+
+const NormRowFuncs<float> kNormRowFuncsAVX512 = {MomentsAVX512,
+                                                 MeanSquareAVX512,
+                                                 NormalizeAVX512,
+                                                 BackwardSumsAVX512,
+                                                 BackwardDxAVX512};
+
+}  // namespace
+
+const NormRowFuncs<float>* GetNormRowFuncsAVX512() {
+  return &kNormRowFuncsAVX512;
+}
+
+#else
+
+const NormRowFuncs<float>* GetNormRowFuncsAVX512() { return nullptr; }
+
+#endif
+
+}  // namespace detail
+}  // namespace funcs
+}  // namespace phi
@@ -472,6 +472,60 @@ void BenchKernelVBroadcast() {
   }
 }
 
+template <typename KernelTuple, typename PlaceType>
+void BenchKernelXYZNBF16() {
+  using T = typename KernelTuple::data_type;
+  for (int d : TestSizes()) {
+    std::vector<float> x(d), y(d);
+    RandomVec<float>(d, x.data());
+    RandomVec<float>(d, y.data());
+    std::vector<T> x_bf16(x.begin(), x.end()), y_bf16(y.begin(), y.end());
+    std::vector<T> z(d);
+    BenchAllImpls<KernelTuple, PlaceType>(
+        d, x_bf16.data(), y_bf16.data(), z.data(), d);
+  }
+}
+
+template <typename KernelTuple, typename PlaceType>
+void BenchKernelMatMulBF16() {
+  using T = typename KernelTuple::data_type;
+  for (int m : {1, 2, 4}) {
+    for (int n : {16, 64, 256}) {
+      for (int k : TestSizes()) {
+        std::vector<float> a(m * k), b(k * n);
+        RandomVec<float>(m * k, a.data(), -2.f, 2.f);
+        RandomVec<float>(k * n, b.data(), -2.f, 2.f);
+        std::vector<T> a_bf16(a.begin(), a.end()), b_bf16(b.begin(), b.end());
+        std::vector<float> c(m * n);
+        const jit::matmul_attr_t attr{m, n, k};
+        BenchAllImpls<KernelTuple, PlaceType>(
+            attr, a_bf16.data(), b_bf16.data(), c.data(), &attr);
+      }
+    }
+  }
+}
+
+template <typename KernelTuple, typename PlaceType>
+void BenchKernelMatMulS8() {
+  for (int m : {1, 2, 4}) {
+    for (int n : {16, 64, 256}) {
+      for (int k : TestSizes()) {
+        std::vector<float> a(m * k), b(k * n);
+        RandomVec<float>(m * k, a.data(), 0.f, 255.f);
+        RandomVec<float>(k * n, b.data(), -128.f, 127.f);
+        std::vector<uint8_t> a_u8(a.begin(), a.end());
+        std::vector<int8_t> b_s8(b.begin(), b.end());
+        std::vector<int8_t> packed(jit::packed_weights_s8_size(n, k));
+        jit::pack_weights_s8(b_s8.data(), packed.data(), n, k);
+        std::vector<int32_t> c(m * n);
+        const jit::matmul_attr_t attr{m, n, k};
+        BenchAllImpls<KernelTuple, PlaceType>(
+            attr, a_u8.data(), packed.data(), c.data(), &attr);
+      }
+    }
+  }
+}
+
 #define BenchKernelVMul BenchKernelXYZN
 #define BenchKernelVAdd BenchKernelXYZN
 #define BenchKernelVAddRelu BenchKernelXYZN
@@ -539,6 +593,23 @@ BENCH_FP32_CPU(MatMul);
 BENCH_FP32_CPU(Sgd);
 BENCH_FP32_CPU(VBroadcast);
 
+// low precision
+BENCH_JITKERNEL(VMulBF16, BF16, CPU) {
+  BenchKernelXYZNBF16<jit::VMulBF16Tuple, CPUPlace>();
+}
+
+BENCH_JITKERNEL(VAddBF16, BF16, CPU) {
+  BenchKernelXYZNBF16<jit::VAddBF16Tuple, CPUPlace>();
+}
+
+BENCH_JITKERNEL(MatMulBF16, BF16, CPU) {
+  BenchKernelMatMulBF16<jit::MatMulBF16Tuple, CPUPlace>();
+}
+
+BENCH_JITKERNEL(MatMulS8, INT8, CPU) {
+  BenchKernelMatMulS8<jit::MatMulS8Tuple, CPUPlace>();
+}
+
 // Benchmark all jit kernels including jitcode, mkl and refer.
 // To use this tool, run command: ./benchmark [options...]
 // Options:
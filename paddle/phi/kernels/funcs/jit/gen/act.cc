@@ -45,6 +45,13 @@ const int ALIGN32_BEG exp_int_0x7f[] ALIGN32_END = {  // NOLINT
     REPEAT_8TIMES(0x7f)};                             // NOLINT
 int ALIGN32_BEG g_tmp_mem[16] ALIGN32_END = {0};      // NOLINT
 
+static const bool g_act_symbols_registered = [] {
+  RegisterJitCodeSymbol(kExpFloatConsts, exp_float_consts);
+  RegisterJitCodeSymbol(kExpInt0x7f, exp_int_0x7f);
+  RegisterJitCodeSymbol(kTmpMem, g_tmp_mem);
+  return true;
+}();
+
 void VActJitCode::genCode() {
   int offset = 0;
   for (int i = 0; i < num_ / YMM_FLOAT_BLOCK; ++i) {
@@ -28,6 +28,13 @@ extern const float exp_float_consts[];
 extern const int exp_int_0x7f[];
 extern int g_tmp_mem[];
 
+// The ids of the tables above in the jitcode cache, never reuse an id.
+enum JitCodeSymbolId : uint32_t {
+  kExpFloatConsts = 0,
+  kExpInt0x7f = 1,
+  kTmpMem = 2,
+};
+
 #define EXP_HIG 88.3762626647949f
 #define EXP_LOW -88.3762626647949f
 #define CEPHES_LOG2EF 1.44269504088896341
@@ -100,7 +107,7 @@ class VActFunc : public JitCode {
     reg64_t reg_ptr_global = rax;
     push(reg_ptr_global);
     vmovaps(jmm_src, src);
-    mov(reg_ptr_global, reinterpret_cast<size_t>(exp_float_consts));
+    movAbs(reg_ptr_global, exp_float_consts);
     vmovaps(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_HIG]);
     vminps(jmm_src, jmm_src, jmm_tmp);
     vmovaps(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_LOW]);
@@ -141,7 +148,7 @@ class VActFunc : public JitCode {
     // build 2^n
     JMM ymm_int = jmm_fx;
     vcvttps2dq(ymm_int, jmm_fx);
-    mov(reg_ptr_global, reinterpret_cast<size_t>(exp_int_0x7f));
+    movAbs(reg_ptr_global, exp_int_0x7f);
     vmovdqa(jmm_tmp, ptr[reg_ptr_global]);
     if (phi::backends::cpu::MayIUse(phi::backends::cpu::avx2) ||
         std::is_same<JMM, xmm_t>::value) {
@@ -151,7 +158,7 @@ class VActFunc : public JitCode {
       xmm_t xtmp1 = xmm_t(ymm_int.getIdx());
       xmm_t xtmp2 = xmm_t(jmm_tmp.getIdx());
       reg64_t reg_ptr_tmp = reg_ptr_global;
-      mov(reg_ptr_tmp, reinterpret_cast<size_t>(g_tmp_mem));
+      movAbs(reg_ptr_tmp, g_tmp_mem);
       vmovdqa(ptr[reg_ptr_tmp], ymm_int);
       vmovdqa(ptr[reg_ptr_tmp + YMM_FLOAT_BLOCK * sizeof(float)], jmm_tmp);
       vpaddd(xtmp1, xtmp1, xtmp2);
@@ -187,7 +194,7 @@ class VActFunc : public JitCode {
     reg64_t reg_ptr_global = rax;
     push(reg_ptr_global);
     vmovaps(jmm_src, src);
-    mov(reg_ptr_global, reinterpret_cast<size_t>(exp_float_consts));
+    movAbs(reg_ptr_global, exp_float_consts);
     vmovaps(jmm_tmp, ptr[reg_ptr_global + OFFSET_SIGMOID_MAX]);
     vminps(jmm_src, jmm_src, jmm_tmp);
     vmovaps(jmm_tmp, ptr[reg_ptr_global + OFFSET_SIGMOID_MIN]);
@@ -217,7 +224,7 @@ class VActFunc : public JitCode {
     reg64_t reg_ptr_global = rax;
     push(reg_ptr_global);
     vmovaps(jmm_src, src);
-    mov(reg_ptr_global, reinterpret_cast<size_t>(exp_float_consts));
+    movAbs(reg_ptr_global, exp_float_consts);
     vmovaps(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_TWO]);
     vxorps(jmm_zero, jmm_zero, jmm_zero);
     vsubps(jmm_tmp, jmm_zero, jmm_tmp);
@@ -317,6 +324,9 @@ class VActJitCode : public VActFunc {
   void genCode() override;
 
  protected:
+  // Only the tables of act.cc are addressed, and they are registered.
+  bool IsPositionIndependent() const override { return true; }
+
   int num_;
   operand_type type_;
   reg64_t param1{abi_param1};
@@ -71,6 +71,10 @@ class VXXJitCode : public JitCode {
   }
   void genCode() override;
 
+ protected:
+  // Reads and writes only the vectors passed in.
+  bool IsPositionIndependent() const override { return true; }
+
  private:
   int num_;
   operand_type type_;
@@ -33,7 +33,7 @@ void GRUJitCode::genCode() {
 
   if (id_ == 2) {
     reg64_t reg_ptr_tmp = r11;
-    mov(reg_ptr_tmp, reinterpret_cast<size_t>(exp_float_consts));
+    movAbs(reg_ptr_tmp, exp_float_consts);
     vmovaps(ymm_one, ptr[reg_ptr_tmp + OFFSET_EXP_ONE]);
   }
   int offset = 0;
@@ -89,6 +89,10 @@ class GRUJitCode : public VActFunc {
   void genCode() override;
 
  protected:
+  // The gates address the act.cc tables by movAbs, the rest is relative to
+  // the gru_t argument.
+  bool IsPositionIndependent() const override { return true; }
+
   int id_;
   int num_;
   operand_type act_gate_;
@@ -16,9 +16,11 @@
 
 #include <string>
 #include <type_traits>
+#include <vector>
 
 #include "paddle/phi/backends/cpu/cpu_info.h"
 #include "paddle/phi/kernels/funcs/jit/gen_base.h"
+#include "paddle/phi/kernels/funcs/jit/kernel_cache.h"
 
 #define XBYAK_USE_MMAP_ALLOCATOR
 #include "xbyak/xbyak.h"
@@ -82,7 +84,17 @@ class JitCode : public GenBase, public Xbyak::CodeGenerator {
     return code;
   }
 
+  bool IsRelocatable() const override {
+    return IsPositionIndependent() && !embeds_unknown_address_;
+  }
+  std::vector<JitCodeReloc> Relocations() const override { return relocs_; }
+
  protected:
+  // Whether the generated code reaches memory only through its arguments,
+  // relative labels and movAbs. The code of a generator is never cached
+  // unless the generator is checked to be so and overrides this.
+  virtual bool IsPositionIndependent() const { return false; }
+
   Xbyak::Reg64 param1{abi_param1};
   const int EVEX_max_8b_offt = 0x200;
   const Xbyak::Reg64 reg_EVEX_max_8b_offt = rbp;
@@ -101,6 +113,22 @@ class JitCode : public GenBase, public Xbyak::CodeGenerator {
     }
     ret();
   }
+  // Load an absolute address into `reg`. It is always encoded as a movabs
+  // with a 64-bit immediate, so a registered address can be patched when
+  // the code is loaded from the jitcode cache. Code embedding any other
+  // address is never cached.
+  void movAbs(const Xbyak::Reg64& reg, const void* addr) {
+    db(0x48 | (reg.getIdx() >= 8 ? 1 : 0));
+    db(0xB8 | (reg.getIdx() & 7));
+    uint32_t offset = static_cast<uint32_t>(CodeGenerator::getSize());
+    dq(reinterpret_cast<uint64_t>(addr));
+    int64_t symbol = FindJitCodeSymbol(addr);
+    if (symbol >= 0) {
+      relocs_.push_back({offset, static_cast<uint32_t>(symbol)});
+    } else {
+      embeds_unknown_address_ = true;
+    }
+  }
   void L(const char* label) { Xbyak::CodeGenerator::L(label); }
   void L(Xbyak::Label& label) { Xbyak::CodeGenerator::L(label); }  // NOLINT
   // Enhanced vector extension
@@ -126,6 +154,10 @@ class JitCode : public GenBase, public Xbyak::CodeGenerator {
       return zword[re];
     }
   }
+
+ private:
+  std::vector<JitCodeReloc> relocs_;
+  bool embeds_unknown_address_{false};
 };
 
 }  // namespace gen
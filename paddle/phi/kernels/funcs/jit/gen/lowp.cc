@@ -0,0 +1,251 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/phi/kernels/funcs/jit/gen/lowp.h"
+
+#include <algorithm>
+
+#include "paddle/phi/backends/cpu/cpu_info.h"
+#include "paddle/phi/kernels/funcs/jit/macro.h"
+#include "paddle/phi/kernels/funcs/jit/registry.h"
+
+namespace phi::jit::gen {
+
+void VBF16JitCode::compute(int offset, bool with_mask) {
+  size_t bf16_offset = offset * sizeof(int16_t);
+  if (with_mask) {
+    vpmovzxwd(zmm_x | k1 | T_z, ptr[param_x + bf16_offset]);
+    vpmovzxwd(zmm_y | k1 | T_z, ptr[param_y + bf16_offset]);
+  } else {
+    vpmovzxwd(zmm_x, ptr[param_x + bf16_offset]);
+    vpmovzxwd(zmm_y, ptr[param_y + bf16_offset]);
+  }
+  vpslld(zmm_x, zmm_x, 16);
+  vpslld(zmm_y, zmm_y, 16);
+  if (type_ == operand_type::MUL) {
+    vmulps(zmm_x, zmm_x, zmm_y);
+  } else {
+    vaddps(zmm_x, zmm_x, zmm_y);
+  }
+  // round to nearest even: x + 0x7fff + ((x >> 16) & 1), then keep the
+  // high 16 bits
+  vpsrld(zmm_y, zmm_x, 16);
+  vpandd(zmm_y, zmm_y, zmm_one);
+  vpaddd(zmm_y, zmm_y, zmm_rounding);
+  vpaddd(zmm_x, zmm_x, zmm_y);
+  vpsrld(zmm_x, zmm_x, 16);
+  if (with_mask) {
+    vpmovdw(ptr[param_z + bf16_offset] | k1, zmm_x);
+  } else {
+    vpmovdw(ptr[param_z + bf16_offset], zmm_x);
+  }
+}
+
+void VBF16JitCode::genCode() {
+  // do not need push stack, only caller saved registers are used
+  mov(eax, 1);
+  vpbroadcastd(zmm_one, eax);
+  mov(eax, 0x7fff);
+  vpbroadcastd(zmm_rounding, eax);
+  int offset = 0;
+  for (int i = 0; i < num_ / ZMM_FLOAT_BLOCK; ++i) {
+    compute(offset, false);
+    offset += ZMM_FLOAT_BLOCK;
+  }
+  int rest = num_ % ZMM_FLOAT_BLOCK;
+  if (rest > 0) {
+    mov(eax, (1 << rest) - 1);
+    kmovw(k1, eax);
+    compute(offset, true);
+  }
+  ret();
+}
+
+void MatMulLowpJitCode::broadcastRestS8(int rest) {
+  // never read beyond the row of A, the missing bytes are zero
+  if (rest == 1) {
+    movzx(eax, byte[reg_ptr_a]);
+  } else {
+    movzx(eax, word[reg_ptr_a]);
+    if (rest == 3) {
+      movzx(reg_tmp.cvt32(), byte[reg_ptr_a + 2]);
+      shl(reg_tmp.cvt32(), 16);
+      or_(eax, reg_tmp.cvt32());
+    }
+  }
+  vpbroadcastd(zmm_a, eax);
+}
+
+void MatMulLowpJitCode::accumulate(int blocks) {
+  for (int j = 0; j < blocks; ++j) {
+    if (is_int8_) {
+      // 16 int32 of C take 4 rows of K of 16 columns of B, i.e. 64 bytes
+      vpdpbusd(zmm_t(j), zmm_a, ptr[reg_ptr_b + j * 64]);
+    } else {
+      zmm_t zmm_b = zmm_t(kMaxAccBlocks + j);
+      size_t b_offset = j * ZMM_FLOAT_BLOCK * sizeof(int16_t);
+      vpmovzxwd(zmm_b, ptr[reg_ptr_b + b_offset]);
+      vpslld(zmm_b, zmm_b, 16);
+      vfmadd231ps(zmm_t(j), zmm_a, zmm_b);
+    }
+  }
+}
+
+void MatMulLowpJitCode::genCode() {
+  preCode();
+  const int num_blocks = n_ / ZMM_FLOAT_BLOCK;
+  // int8 walks K by 4 rows at a time, see pack_weights_s8
+  const int k_steps = is_int8_ ? k_ / 4 : k_;
+  const int k_rest = is_int8_ ? k_ % 4 : 0;
+  const size_t a_step = is_int8_ ? 4 : sizeof(int16_t);
+  const size_t b_step =
+      is_int8_ ? static_cast<size_t>(n_) * 4 : n_ * sizeof(int16_t);
+  const size_t b_block_len =
+      is_int8_ ? ZMM_FLOAT_BLOCK * 4 : ZMM_FLOAT_BLOCK * sizeof(int16_t);
+  const size_t a_row_len = is_int8_ ? k_ : k_ * sizeof(int16_t);
+
+  for (int i = 0; i < m_; ++i) {
+    for (int g = 0; g < num_blocks; g += kMaxAccBlocks) {
+      const int blocks = std::min(kMaxAccBlocks, num_blocks - g);
+      for (int j = 0; j < blocks; ++j) {
+        vpxord(zmm_t(j), zmm_t(j), zmm_t(j));
+      }
+      lea(reg_ptr_a, ptr[param_a + i * a_row_len]);
+      lea(reg_ptr_b, ptr[param_b + g * b_block_len]);
+      if (k_steps > 0) {
+        Label l_next_k;
+        mov(reg_k, k_steps);
+        L(l_next_k);
+        if (is_int8_) {
+          vpbroadcastd(zmm_a, ptr[reg_ptr_a]);
+        } else {
+          movzx(eax, word[reg_ptr_a]);
+          shl(eax, 16);
+          vpbroadcastd(zmm_a, eax);
+        }
+        accumulate(blocks);
+        add(reg_ptr_a, a_step);
+        add(reg_ptr_b, b_step);
+        dec(reg_k);
+        jnz(l_next_k, T_NEAR);
+      }
+      if (k_rest > 0) {
+        broadcastRestS8(k_rest);
+        accumulate(blocks);
+      }
+      size_t c_offset = (static_cast<size_t>(i) * n_ + g * ZMM_FLOAT_BLOCK) *
+                        sizeof(float);
+      for (int j = 0; j < blocks; ++j) {
+        if (is_int8_) {
+          vmovdqu32(ptr[param_c + c_offset], zmm_t(j));
+        } else {
+          vmovups(ptr[param_c + c_offset], zmm_t(j));
+        }
+        c_offset += ZMM_FLOAT_BLOCK * sizeof(float);
+      }
+    }
+  }
+  postCode();
+}
+
+#define DECLARE_BF16_CREATOR(name)                                           \
+  class name##Creator : public JitCodeCreator<int> {                         \
+   public:                                                                   \
+    bool CanBeUsed(const int& attr) const override {                         \
+      return phi::backends::cpu::MayIUse(phi::backends::cpu::avx512f) &&     \
+             attr <= 1024;                                                   \
+    }                                                                        \
+    size_t CodeSize(const int& d) const override {                           \
+      return 96 + (d / ZMM_FLOAT_BLOCK + 1) * 16 * 8;                        \
+    }                                                                        \
+    std::unique_ptr<GenBase> CreateJitCode(const int& attr) const override { \
+      return make_unique<name##JitCode>(attr, CodeSize(attr));               \
+    }                                                                        \
+  }
+
+DECLARE_BF16_CREATOR(VMulBF16);
+DECLARE_BF16_CREATOR(VAddBF16);
+
+#undef DECLARE_BF16_CREATOR
+
+// The code is unrolled over M and the accumulator blocks of N.
+static size_t MatMulLowpCodeSize(const matmul_attr_t& attr) {
+  constexpr int kMaxAccBlocks = MatMulLowpJitCode::kMaxAccBlocks;
+  int blocks = attr.n / ZMM_FLOAT_BLOCK;
+  int groups = (blocks + kMaxAccBlocks - 1) / kMaxAccBlocks;
+  return 96 + static_cast<size_t>(attr.m) * groups *
+                  (128 + kMaxAccBlocks * 3 * 16 * 2);
+}
+
+static void CheckMatMulLowpAttr(const matmul_attr_t& attr) {
+  PADDLE_ENFORCE_GT(attr.m,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The attribute m (first matrix's row) of MatMul "
+                        "should be larger than 0. But it is %d.",
+                        attr.m));
+  PADDLE_ENFORCE_GT(attr.n,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The attribute n (first matrix's col) of MatMul "
+                        "should be larger than 0. But it is %d.",
+                        attr.n));
+  PADDLE_ENFORCE_GT(attr.k,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The attribute k (second matrix's col) of MatMul "
+                        "should be larger than 0. But it is %d.",
+                        attr.k));
+}
+
+class MatMulBF16Creator : public JitCodeCreator<matmul_attr_t> {
+ public:
+  bool CanBeUsed(const matmul_attr_t& attr) const override {
+    return phi::backends::cpu::MayIUse(phi::backends::cpu::avx512f) &&
+           attr.m <= 64 && attr.n % ZMM_FLOAT_BLOCK == 0 && attr.n <= 4096;
+  }
+  size_t CodeSize(const matmul_attr_t& attr) const override {
+    return MatMulLowpCodeSize(attr);
+  }
+  std::unique_ptr<GenBase> CreateJitCode(
+      const matmul_attr_t& attr) const override {
+    CheckMatMulLowpAttr(attr);
+    return make_unique<MatMulBF16JitCode>(attr, CodeSize(attr));
+  }
+};
+
+class MatMulS8Creator : public JitCodeCreator<matmul_attr_t> {
+ public:
+  bool CanBeUsed(const matmul_attr_t& attr) const override {
+    return phi::backends::cpu::MayIUse(phi::backends::cpu::avx512_core_vnni) &&
+           attr.m <= 64 && attr.n % ZMM_FLOAT_BLOCK == 0 && attr.n <= 4096;
+  }
+  size_t CodeSize(const matmul_attr_t& attr) const override {
+    return MatMulLowpCodeSize(attr);
+  }
+  std::unique_ptr<GenBase> CreateJitCode(
+      const matmul_attr_t& attr) const override {
+    CheckMatMulLowpAttr(attr);
+    return make_unique<MatMulS8JitCode>(attr, CodeSize(attr));
+  }
+};
+
+}  // namespace phi::jit::gen
+
+namespace gen = phi::jit::gen;
+
+REGISTER_JITKERNEL_GEN(kVMulBF16, gen::VMulBF16Creator);
+REGISTER_JITKERNEL_GEN(kVAddBF16, gen::VAddBF16Creator);
+REGISTER_JITKERNEL_GEN(kMatMulBF16, gen::MatMulBF16Creator);
+REGISTER_JITKERNEL_GEN(kMatMulS8, gen::MatMulS8Creator);
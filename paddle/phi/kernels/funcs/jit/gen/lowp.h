@@ -0,0 +1,160 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#pragma once
+
+#include <string>
+
+#include "glog/logging.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/kernels/funcs/jit/gen/jitcode.h"
+
+namespace phi {
+namespace jit {
+namespace gen {
+
+// Low precision jitcode on AVX-512.
+//
+// bf16 values are widened to fp32 by shifting them into the high half of a
+// dword, computed in fp32, and rounded back to bf16 (to nearest even) with
+// integer ops, so only AVX512F is required. int8 matmul uses the VNNI
+// vpdpbusd dot product, which multiplies 4 adjacent uint8 of A with 4
+// adjacent int8 of B and accumulates them into one int32.
+
+// function: z = x op y on bf16 vectors, op is MUL or ADD
+class VBF16JitCode : public JitCode {
+ public:
+  explicit VBF16JitCode(int d,
+                        operand_type type,
+                        size_t code_size = 256 * 1024,
+                        void* code_ptr = nullptr)
+      : JitCode(code_size, code_ptr), num_(d), type_(type) {
+    if (!(type_ == operand_type::MUL || type_ == operand_type::ADD)) {
+      PADDLE_THROW(common::errors::Unimplemented(
+          "Do not support operand type code: %d.", type));
+    }
+    this->genCode();
+  }
+
+  std::string name() const override {
+    std::string base = "VBF16JitCode";
+    base += (type_ == operand_type::MUL ? "_Mul" : "_Add");
+    base += "_D" + std::to_string(num_);
+    return base;
+  }
+  void genCode() override;
+
+ private:
+  void compute(int offset, bool with_mask);
+
+  int num_;
+  operand_type type_;
+  reg64_t param_x{abi_param1};
+  reg64_t param_y{abi_param2};
+  reg64_t param_z{abi_param3};
+
+  zmm_t zmm_x = zmm_t(0);
+  zmm_t zmm_y = zmm_t(1);
+  zmm_t zmm_one = zmm_t(2);
+  zmm_t zmm_rounding = zmm_t(3);
+};
+
+#define DECLARE_BF16_JITCODE(name, op_type)                                   \
+  class name##JitCode : public VBF16JitCode {                                 \
+   public:                                                                    \
+    explicit name##JitCode(int d, size_t code_size, void* code_ptr = nullptr) \
+        : VBF16JitCode(d, op_type, code_size, code_ptr) {}                    \
+  };
+
+DECLARE_BF16_JITCODE(VMulBF16, operand_type::MUL);
+DECLARE_BF16_JITCODE(VAddBF16, operand_type::ADD);
+
+#undef DECLARE_BF16_JITCODE
+
+// C(M,N) = A(M,K) * B(K,N), N should be a multiple of ZMM_FLOAT_BLOCK.
+// Every row of C is computed by blocks of up to kMaxAccBlocks zmm
+// accumulators, with a runtime loop over K.
+class MatMulLowpJitCode : public JitCode {
+ public:
+  static constexpr int kMaxAccBlocks = 8;
+
+  explicit MatMulLowpJitCode(const matmul_attr_t& attr,
+                             bool is_int8,
+                             size_t code_size = 256 * 1024,
+                             void* code_ptr = nullptr)
+      : JitCode(code_size, code_ptr),
+        m_(attr.m),
+        n_(attr.n),
+        k_(attr.k),
+        is_int8_(is_int8) {
+    PADDLE_ENFORCE_EQ(
+        n_ % ZMM_FLOAT_BLOCK,
+        0,
+        common::errors::Unimplemented(
+            "Jitcode of low precision matmul only support n %% %d == 0 now. "
+            "But n is %d.",
+            ZMM_FLOAT_BLOCK,
+            n_));
+    this->genCode();
+  }
+
+  std::string name() const override {
+    std::string base = is_int8_ ? "MatMulS8JitCode" : "MatMulBF16JitCode";
+    base = base + "_M" + std::to_string(m_) + "_N" + std::to_string(n_) + "_K" +
+           std::to_string(k_);
+    return base;
+  }
+  void genCode() override;
+
+ private:
+  // accumulate one step of K into the first `blocks` accumulators
+  void accumulate(int blocks);
+  // load the last k_ % 4 uint8 of a row of A into all dwords of zmm_a
+  void broadcastRestS8(int rest);
+
+  int m_, n_, k_;
+  bool is_int8_;
+
+  reg64_t param_a{abi_param1};
+  reg64_t param_b{abi_param2};
+  reg64_t param_c{abi_param3};
+  reg64_t reg_ptr_a{r8};
+  reg64_t reg_ptr_b{r9};
+  reg64_t reg_k{r10};
+  reg64_t reg_tmp{r11};
+
+  zmm_t zmm_a = zmm_t(31);
+  // zmm(0 ~ kMaxAccBlocks - 1) are the accumulators, the next kMaxAccBlocks
+  // registers hold the widened bf16 of B.
+};
+
+class MatMulBF16JitCode : public MatMulLowpJitCode {
+ public:
+  explicit MatMulBF16JitCode(const matmul_attr_t& attr,
+                             size_t code_size,
+                             void* code_ptr = nullptr)
+      : MatMulLowpJitCode(attr, false, code_size, code_ptr) {}
+};
+
+class MatMulS8JitCode : public MatMulLowpJitCode {
+ public:
+  explicit MatMulS8JitCode(const matmul_attr_t& attr,
+                           size_t code_size,
+                           void* code_ptr = nullptr)
+      : MatMulLowpJitCode(attr, true, code_size, code_ptr) {}
+};
+
+}  // namespace gen
+}  // namespace jit
+}  // namespace phi
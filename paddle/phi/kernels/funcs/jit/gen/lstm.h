@@ -93,6 +93,9 @@ class LSTMJitCode : public VActFunc {
   void genCode() override;
 
  protected:
+  // Like GRUJitCode, only the lstm_t argument and the act.cc tables.
+  bool IsPositionIndependent() const override { return true; }
+
   int num_;
   bool compute_c1h1_;
   bool use_peephole_;
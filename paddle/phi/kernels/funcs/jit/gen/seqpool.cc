@@ -28,9 +28,9 @@ void SeqPoolJitCode::genCode() {
   int rest_num_regs = num_block % max_num_regs;
   mov(reg32_int_h, dword[param_attr]);
   if (type_ == SeqPoolType::kAvg || type_ == SeqPoolType::kSqrt) {
-    mov(reg_tmp, reinterpret_cast<size_t>(exp_float_consts));
+    movAbs(reg_tmp, exp_float_consts);
     vmovups(xmm_t(1), ptr[reg_tmp + OFFSET_EXP_ONE]);
-    mov(reg_tmp, reinterpret_cast<size_t>(fp_h_));
+    movAbs(reg_tmp, fp_h_);
     fild(dword[param_attr]);
     fstp(dword[reg_tmp]);
     vmovss(xmm_t(0), ptr[reg_tmp]);
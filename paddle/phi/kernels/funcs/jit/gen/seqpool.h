@@ -84,7 +84,7 @@ class SeqPoolJitCode : public JitCode {
     L(l_h_done);
     // save right now
     if (type_ == SeqPoolType::kAvg || type_ == SeqPoolType::kSqrt) {
-      mov(reg_tmp, reinterpret_cast<size_t>(fp_h_));
+      movAbs(reg_tmp, fp_h_);
       vbroadcastss(JMM(max_num_regs), ptr[reg_tmp]);
     }
     offset = w_offset;
@@ -146,7 +146,7 @@ class SeqPoolJitCode : public JitCode {
     L(l_h_done);
     // save right now
     if (type_ == SeqPoolType::kAvg || type_ == SeqPoolType::kSqrt) {
-      mov(reg_tmp, reinterpret_cast<size_t>(fp_h_));
+      movAbs(reg_tmp, fp_h_);
       vbroadcastss(xmm_t(max_num_regs), ptr[reg_tmp]);
       for (int i = 0; i < rest_used_num_regs; ++i) {
         vmulps(xmm_t(i), xmm_t(i), xmm_t(max_num_regs));
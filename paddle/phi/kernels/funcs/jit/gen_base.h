@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>  // for unique_ptr
 #include <string>
 #include <vector>
@@ -30,6 +31,13 @@ PHI_DECLARE_bool(dump_jitcode);
 namespace phi {
 namespace jit {
 
+// An absolute address embedded in a jitcode: the 8 bytes at `offset` hold
+// the address of the registered symbol `symbol`, see kernel_cache.h.
+struct JitCodeReloc {
+  uint32_t offset;
+  uint32_t symbol;
+};
+
 class GenBase : public Kernel {
  public:
   virtual ~GenBase() {}
@@ -37,6 +45,10 @@ class GenBase : public Kernel {
   virtual size_t getSize() const = 0;
   virtual const unsigned char* getCodeInternal() const = 0;
   const char* ImplType() const override { return "JitCode"; }
+  // Whether the code can be reused by another process after patching its
+  // relocations, i.e. it embeds no address other than registered symbols.
+  virtual bool IsRelocatable() const { return false; }
+  virtual std::vector<JitCodeReloc> Relocations() const { return {}; }
   template <typename Func>
   Func getCode() const {
     const unsigned char* code = this->getCodeInternal();
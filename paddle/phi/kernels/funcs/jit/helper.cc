@@ -60,6 +60,13 @@ const char* to_string(KernelType kt) {
     ONE_CASE(kAdamW);
     ONE_CASE(kEmbSeqPool);
     ONE_CASE(kSgd);
+    ONE_CASE(kEmbSeqPoolBF16);
+    ONE_CASE(kLayerNormBF16);
+    ONE_CASE(kMatMulBF16);
+    ONE_CASE(kMatMulS8);
+    ONE_CASE(kSeqPoolBF16);
+    ONE_CASE(kVAddBF16);
+    ONE_CASE(kVMulBF16);
     default:
       PADDLE_THROW(common::errors::Unimplemented(
           "JIT kernel do not support type: %d.", kt));
@@ -142,6 +149,29 @@ void pack_weights<float>(const float* src, float* dst, int n, int k) {
   }
 }
 
+void pack_weights_s8(const int8_t* src, int8_t* dst, int n, int k) {
+  PADDLE_ENFORCE_GT(n,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The n of the weight should be larger than 0. "
+                        "But it is %d.",
+                        n));
+  PADDLE_ENFORCE_GT(k,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The k of the weight should be larger than 0. "
+                        "But it is %d.",
+                        k));
+  std::memset(dst, 0, packed_weights_s8_size(n, k));
+  for (int i = 0; i < k; ++i) {
+    int8_t* to = dst + static_cast<size_t>(i / 4) * n * 4 + i % 4;
+    const int8_t* from = src + static_cast<size_t>(i) * n;
+    for (int j = 0; j < n; ++j) {
+      to[j * 4] = from[j];
+    }
+  }
+}
+
 template <typename T>
 typename std::enable_if<!std::is_same<T, float>::value>::type pack_weights(
     const T* src, T* dst, int n, int k) {
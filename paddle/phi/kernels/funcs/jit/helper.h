@@ -26,6 +26,7 @@
 #include "paddle/phi/core/enforce.h"
 #include "paddle/phi/kernels/funcs/jit/gen_base.h"
 #include "paddle/phi/kernels/funcs/jit/kernel_base.h"
+#include "paddle/phi/kernels/funcs/jit/kernel_cache.h"
 #include "paddle/phi/kernels/funcs/jit/kernel_key.h"
 #include "paddle/phi/kernels/funcs/jit/kernel_pool.h"
 
@@ -34,9 +35,17 @@ namespace jit {
 
 class GenBase;
 
+// Jitcode is only generated for fp32 and the low precision kernels.
+template <typename T>
+struct IsJitCodeDataType
+    : public std::integral_constant<bool,
+                                    std::is_same<T, float>::value ||
+                                        std::is_same<T, bfloat16>::value ||
+                                        std::is_same<T, int8_t>::value> {};
+
 template <typename KernelTuple, typename PlaceType>
 inline typename std::enable_if<
-    std::is_same<typename KernelTuple::data_type, float>::value &&
+    IsJitCodeDataType<typename KernelTuple::data_type>::value &&
         std::is_same<PlaceType, phi::CPUPlace>::value,
     const Kernel*>::type
 GetJitCode(const typename KernelTuple::attr_type& attr) {
@@ -47,6 +56,15 @@ GetJitCode(const typename KernelTuple::attr_type& attr) {
     return codes.AllKernels().at(key).get();
   }
 
+  // the jitcode may have been generated by an earlier process
+  auto& cache = JitCodeCache::Instance();
+  auto cached = cache.Find(KernelTuple::kernel_type, key);
+  if (cached) {
+    auto res = cached.get();
+    codes.Insert(key, std::move(cached));
+    return res;
+  }
+
   // creator is not related with attr, so can use KernelKey as key
   KernelKey kkey(KernelTuple::kernel_type, PlaceType());
   // pool: (KernelKey(type, place), vector<GenCreatorPtr>)
@@ -59,6 +77,7 @@ GetJitCode(const typename KernelTuple::attr_type& attr) {
       if (i && i->CanBeUsed(attr)) {
         auto p = i->CreateJitCode(attr);
         if (p) {
+          cache.Record(KernelTuple::kernel_type, key, *p);
           auto res = p.get();
           codes.Insert(key, std::move(p));
           return res;
@@ -71,7 +90,7 @@ GetJitCode(const typename KernelTuple::attr_type& attr) {
 
 template <typename KernelTuple, typename PlaceType>
 inline typename std::enable_if<
-    !std::is_same<typename KernelTuple::data_type, float>::value ||
+    !IsJitCodeDataType<typename KernelTuple::data_type>::value ||
         !std::is_same<PlaceType, phi::CPUPlace>::value,
     const Kernel*>::type
 GetJitCode(const typename KernelTuple::attr_type& attr UNUSED) {
@@ -302,5 +321,15 @@ inline std::ostream& operator<<(std::ostream& os, const matmul_attr_t& attr) {
 template <typename T>
 void pack_weights(const T* src, T* dst, int n, int k);
 
+// The size in bytes of a (k, n) int8 weight packed by pack_weights_s8.
+inline size_t packed_weights_s8_size(int n, int k) {
+  return static_cast<size_t>((k + 3) / 4) * n * 4;
+}
+
+// pack the (k, n) int8 weight of MatMulS8 into the VNNI layout: the rows of
+// k are padded with zero to a multiple of 4, and every 4 rows are
+// interleaved, i.e. dst[(k / 4) * n * 4 + j * 4 + k % 4] = src[k * n + j].
+void pack_weights_s8(const int8_t* src, int8_t* dst, int n, int k);
+
 }  // namespace jit
 }  // namespace phi
@@ -16,6 +16,7 @@
 #include <cstdint>
 
 #include "paddle/common/macros.h"
+#include "paddle/phi/common/bfloat16.h"
 #include "paddle/phi/kernels/funcs/jit/macro.h"
 
 namespace phi {
@@ -51,6 +52,15 @@ typedef enum {
   kVSquare,
   kVSub,
   kVTanh,
+  // low precision kernels, appended to keep the values above stable since
+  // they are saved in the jitcode cache
+  kEmbSeqPoolBF16,
+  kLayerNormBF16,
+  kMatMulBF16,
+  kMatMulS8,
+  kSeqPoolBF16,
+  kVAddBF16,
+  kVMulBF16,
 } KernelType;
 
 typedef enum {
@@ -334,6 +344,75 @@ struct LayerNormTuple {
       T*, T*, T*, T*, const T*, const T*, int, const float, int);
 };
 
+using bfloat16 = phi::dtype::bfloat16;
+
+// The bf16 kernels load and store bf16 but compute in fp32.
+struct VMulBF16Tuple : public XYZNTuple<bfloat16> {
+  static constexpr KernelType kernel_type = kVMulBF16;
+};
+
+struct VAddBF16Tuple : public XYZNTuple<bfloat16> {
+  static constexpr KernelType kernel_type = kVAddBF16;
+};
+
+struct SeqPoolBF16Tuple {
+  static constexpr KernelType kernel_type = kSeqPoolBF16;
+  typedef bfloat16 data_type;
+  typedef seq_pool_attr_t attr_type;
+  typedef void (*func_type)(const bfloat16*, bfloat16*, const seq_pool_attr_t*);
+};
+
+struct EmbSeqPoolBF16Tuple {
+  static constexpr KernelType kernel_type = kEmbSeqPoolBF16;
+  typedef bfloat16 data_type;
+  typedef emb_seq_pool_attr_t attr_type;
+  typedef void (*func_type)(const bfloat16*,
+                            const int64_t*,
+                            bfloat16*,
+                            const emb_seq_pool_attr_t*);
+};
+
+// x, out, mean, var, scale, bias, height, epsilon, right
+// The statistics, scale and bias are kept in fp32.
+struct LayerNormBF16Tuple {
+  static constexpr KernelType kernel_type = kLayerNormBF16;
+  typedef bfloat16 data_type;
+  typedef int attr_type;
+  typedef void (*func_type)(const bfloat16*,
+                            bfloat16*,
+                            float*,
+                            float*,
+                            const float*,
+                            const float*,
+                            int,
+                            const float,
+                            int);
+};
+
+// A(M,K) bf16 * B(K,N) bf16 = C(M,N) fp32
+struct MatMulBF16Tuple {
+  static constexpr KernelType kernel_type = kMatMulBF16;
+  typedef bfloat16 data_type;
+  typedef matmul_attr_t attr_type;
+  typedef void (*func_type)(const bfloat16*,
+                            const bfloat16*,
+                            float*,
+                            const matmul_attr_t*);
+};
+
+// A(M,K) uint8 * B(K,N) int8 = C(M,N) int32
+// B is packed by pack_weights_s8, i.e. every 4 rows of K are interleaved so
+// that the 4 bytes multiplied by one dword of A are adjacent (VNNI layout).
+struct MatMulS8Tuple {
+  static constexpr KernelType kernel_type = kMatMulS8;
+  typedef int8_t data_type;
+  typedef matmul_attr_t attr_type;
+  typedef void (*func_type)(const uint8_t*,
+                            const int8_t*,
+                            int32_t*,
+                            const matmul_attr_t*);
+};
+
 // Just for adding to kernel pool without template
 class Kernel {
  public:
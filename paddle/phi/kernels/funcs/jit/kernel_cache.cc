@@ -0,0 +1,472 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/phi/kernels/funcs/jit/kernel_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "glog/logging.h"
+#include "paddle/phi/backends/cpu/cpu_info.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/kernels/funcs/jit/jit_code_version.h"
+
+PHI_DEFINE_string(jit_code_cache_path,
+                  "",
+                  "The file to load generated jitcode from at first use and "
+                  "to save newly generated jitcode to at exit. Empty means "
+                  "the jitcode cache is disabled.");
+
+namespace phi {
+namespace jit {
+
+namespace {
+
+constexpr char kCacheMagic[8] = {'P', 'D', 'J', 'I', 'T', 'C', 'C', '\0'};
+// Bump it whenever the layout of the cache file changes.
+constexpr uint32_t kCacheVersion = 1;
+constexpr size_t kCacheNameSize = 32;
+constexpr size_t kCacheBlobAlignment = 64;
+
+struct CacheFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t isa_mask;
+  uint64_t build_id;
+  uint64_t num_entries;
+  uint64_t index_offset;
+  uint64_t index_checksum;
+};
+
+struct CacheIndexEntry {
+  int32_t kernel_type;
+  uint32_t num_relocs;
+  int64_t key;
+  uint64_t code_offset;
+  uint64_t code_size;
+  uint64_t reloc_offset;
+  uint64_t checksum;
+  char name[kCacheNameSize];
+};
+
+uint64_t Fnv1aHash(const void* data,
+                   size_t size,
+                   uint64_t hash = 14695981039346656037ULL) {
+  auto* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+uint64_t EntryChecksum(const uint8_t* code,
+                       size_t code_size,
+                       const JitCodeReloc* relocs,
+                       size_t num_relocs) {
+  uint64_t hash = Fnv1aHash(code, code_size);
+  return Fnv1aHash(relocs, num_relocs * sizeof(JitCodeReloc), hash);
+}
+
+uint32_t CurrentIsaMask() {
+  namespace cpu = phi::backends::cpu;
+  const cpu::cpu_isa_t isas[] = {cpu::sse42,
+                                 cpu::avx,
+                                 cpu::avx2,
+                                 cpu::avx512f,
+                                 cpu::avx512_core,
+                                 cpu::avx512_core_vnni,
+                                 cpu::avx512_mic,
+                                 cpu::avx512_mic_4ops,
+                                 cpu::avx512_bf16};
+  uint32_t mask = 0;
+  for (auto isa : isas) {
+    if (cpu::MayIUse(isa)) {
+      mask |= 1u << static_cast<int>(isa);
+    }
+  }
+  return mask;
+}
+
+// Jitcode from another build may differ even if the kernel keys are equal.
+// The digest covers the sources of the generators, the compiler and its
+// flags, so it is the same for reproducible builds of the same code.
+uint64_t CurrentBuildId() {
+  static const char digest[] = PADDLE_JIT_CODE_DIGEST;
+  return Fnv1aHash(digest, sizeof(digest) - 1, kCacheVersion);
+}
+
+std::map<uint32_t, const void*>& JitCodeSymbols() {
+  static std::map<uint32_t, const void*> g_symbols;
+  return g_symbols;
+}
+
+size_t AlignTo(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+void RegisterJitCodeSymbol(uint32_t id, const void* addr) {
+  auto& symbols = JitCodeSymbols();
+  auto iter = symbols.find(id);
+  PADDLE_ENFORCE_EQ(
+      iter == symbols.end() || iter->second == addr,
+      true,
+      common::errors::AlreadyExists(
+          "The jitcode symbol %d has been registered with another address.",
+          id));
+  symbols[id] = addr;
+}
+
+int64_t FindJitCodeSymbol(const void* addr) {
+  for (auto& pair : JitCodeSymbols()) {
+    if (pair.second == addr) {
+      return pair.first;
+    }
+  }
+  return -1;
+}
+
+class CachedJitCodeBuffer {
+ public:
+  CachedJitCodeBuffer() = default;
+
+  ~CachedJitCodeBuffer() {
+#ifndef _WIN32
+    if (data_ != nullptr) {
+      munmap(data_, capacity_);
+    }
+#endif
+  }
+
+  // Copy the code into executable memory and patch its relocations.
+  bool Init(const uint8_t* code,
+            size_t size,
+            const std::vector<JitCodeReloc>& relocs) {
+#ifdef _WIN32
+    return false;
+#else
+    for (auto& reloc : relocs) {
+      if (reloc.offset + sizeof(uint64_t) > size ||
+          JitCodeSymbols().count(reloc.symbol) == 0) {
+        return false;
+      }
+    }
+    size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    capacity_ = AlignTo(size, page_size);
+    void* data = mmap(nullptr,
+                      capacity_,
+                      PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS,
+                      -1,
+                      0);
+    if (data == MAP_FAILED) {
+      return false;
+    }
+    data_ = static_cast<uint8_t*>(data);
+    std::memcpy(data_, code, size);
+    for (auto& reloc : relocs) {
+      uint64_t addr =
+          reinterpret_cast<uint64_t>(JitCodeSymbols()[reloc.symbol]);
+      std::memcpy(data_ + reloc.offset, &addr, sizeof(addr));
+    }
+    size_ = size;
+    return mprotect(data_, capacity_, PROT_READ | PROT_EXEC) == 0;
+#endif
+  }
+
+  const unsigned char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  uint8_t* data_{nullptr};
+  size_t size_{0};
+  size_t capacity_{0};
+  DISABLE_COPY_AND_ASSIGN(CachedJitCodeBuffer);
+};
+
+CachedJitCode::CachedJitCode(std::string name,
+                             std::shared_ptr<CachedJitCodeBuffer> buffer)
+    : name_(std::move(name)), buffer_(std::move(buffer)) {}
+
+size_t CachedJitCode::getSize() const { return buffer_->size(); }
+
+const unsigned char* CachedJitCode::getCodeInternal() const {
+  return buffer_->data();
+}
+
+struct JitCodeCache::Entry {
+  std::string name;
+  // Points into a mapped cache file, or into `owned` for recorded jitcode.
+  const uint8_t* code{nullptr};
+  size_t code_size{0};
+  std::vector<JitCodeReloc> relocs;
+  uint64_t checksum{0};
+  std::vector<uint8_t> owned;
+  std::shared_ptr<CachedJitCodeBuffer> buffer;
+};
+
+JitCodeCache& JitCodeCache::Instance() {
+  static JitCodeCache g_jit_code_cache;
+  return g_jit_code_cache;
+}
+
+JitCodeCache::~JitCodeCache() {
+  if (dirty_ && !FLAGS_jit_code_cache_path.empty()) {
+    try {
+      Save(FLAGS_jit_code_cache_path);
+    } catch (...) {
+      LOG(WARNING) << "Fail to save jitcode cache to "
+                   << FLAGS_jit_code_cache_path;
+    }
+  }
+}
+
+void JitCodeCache::EnsureLoadedFromFlag() {
+  if (flag_loaded_) {
+    return;
+  }
+  flag_loaded_ = true;
+  if (!FLAGS_jit_code_cache_path.empty()) {
+    LoadLocked(FLAGS_jit_code_cache_path);
+  }
+}
+
+bool JitCodeCache::Load(const std::string& path) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return LoadLocked(path);
+}
+
+bool JitCodeCache::LoadLocked(const std::string& path) {
+#ifdef _WIN32
+  return false;
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    VLOG(3) << "No jitcode cache file at " << path;
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      static_cast<size_t>(st.st_size) < sizeof(CacheFileHeader)) {
+    close(fd);
+    return false;
+  }
+  size_t file_size = st.st_size;
+  void* addr = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return false;
+  }
+  std::shared_ptr<void> mapping(
+      addr, [file_size](void* ptr) { munmap(ptr, file_size); });
+  auto* base = static_cast<const uint8_t*>(addr);
+
+  CacheFileHeader header;
+  std::memcpy(&header, base, sizeof(header));
+  if (std::memcmp(header.magic, kCacheMagic, sizeof(kCacheMagic)) != 0 ||
+      header.version != kCacheVersion ||
+      header.build_id != CurrentBuildId() ||
+      header.isa_mask != CurrentIsaMask()) {
+    LOG(WARNING) << "Ignore jitcode cache " << path
+                 << " written by another build or on another CPU.";
+    return false;
+  }
+  size_t index_size = header.num_entries * sizeof(CacheIndexEntry);
+  if (header.index_offset > file_size ||
+      index_size > file_size - header.index_offset ||
+      Fnv1aHash(base + header.index_offset, index_size) !=
+          header.index_checksum) {
+    LOG(WARNING) << "Ignore corrupted jitcode cache " << path;
+    return false;
+  }
+
+  size_t num_loaded = 0;
+  for (uint64_t i = 0; i < header.num_entries; ++i) {
+    CacheIndexEntry index;
+    std::memcpy(&index,
+                base + header.index_offset + i * sizeof(CacheIndexEntry),
+                sizeof(index));
+    size_t reloc_size = index.num_relocs * sizeof(JitCodeReloc);
+    if (index.code_offset > header.index_offset ||
+        index.code_size > header.index_offset - index.code_offset ||
+        index.reloc_offset > header.index_offset ||
+        reloc_size > header.index_offset - index.reloc_offset) {
+      LOG(WARNING) << "Ignore corrupted jitcode cache " << path;
+      return false;
+    }
+    EntryKey key(index.kernel_type, index.key);
+    if (entries_.count(key)) {
+      continue;
+    }
+    auto entry = std::make_shared<Entry>();
+    index.name[kCacheNameSize - 1] = '\0';
+    entry->name = index.name;
+    entry->code = base + index.code_offset;
+    entry->code_size = index.code_size;
+    entry->relocs.resize(index.num_relocs);
+    std::memcpy(entry->relocs.data(), base + index.reloc_offset, reloc_size);
+    entry->checksum = index.checksum;
+    entries_.emplace(key, std::move(entry));
+    ++num_loaded;
+  }
+  mapped_files_.emplace_back(std::move(mapping));
+  VLOG(3) << "Load " << num_loaded << " jitcode from cache " << path;
+  return true;
+#endif
+}
+
+void JitCodeCache::Save(const std::string& path) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  std::string tmp_path = path + ".tmp";
+#ifndef _WIN32
+  tmp_path += "." + std::to_string(getpid());
+#endif
+  std::ofstream fout(tmp_path, std::ios::binary | std::ios::trunc);
+  PADDLE_ENFORCE_EQ(fout.is_open(),
+                    true,
+                    common::errors::Unavailable(
+                        "Fail to open %s to save jitcode cache.", tmp_path));
+
+  CacheFileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  size_t offset = sizeof(header);
+  auto write_aligned = [&](const void* data, size_t size) {
+    size_t aligned = AlignTo(offset, kCacheBlobAlignment);
+    static const char zeros[kCacheBlobAlignment] = {0};
+    fout.write(zeros, aligned - offset);
+    fout.write(static_cast<const char*>(data), size);
+    offset = aligned + size;
+    return aligned;
+  };
+
+  std::vector<CacheIndexEntry> index;
+  index.reserve(entries_.size());
+  for (auto& pair : entries_) {
+    const Entry& entry = *pair.second;
+    CacheIndexEntry item;
+    std::memset(&item, 0, sizeof(item));
+    item.kernel_type = pair.first.first;
+    item.key = pair.first.second;
+    item.num_relocs = entry.relocs.size();
+    item.code_size = entry.code_size;
+    item.code_offset = write_aligned(entry.code, entry.code_size);
+    item.reloc_offset = write_aligned(
+        entry.relocs.data(), entry.relocs.size() * sizeof(JitCodeReloc));
+    item.checksum = entry.checksum;
+    std::strncpy(item.name, entry.name.c_str(), kCacheNameSize - 1);
+    index.emplace_back(item);
+  }
+
+  size_t index_size = index.size() * sizeof(CacheIndexEntry);
+  std::memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+  header.version = kCacheVersion;
+  header.isa_mask = CurrentIsaMask();
+  header.build_id = CurrentBuildId();
+  header.num_entries = index.size();
+  header.index_offset = write_aligned(index.data(), index_size);
+  header.index_checksum = Fnv1aHash(index.data(), index_size);
+  fout.seekp(0);
+  fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  fout.close();
+  PADDLE_ENFORCE_EQ(
+      fout.good(),
+      true,
+      common::errors::Unavailable("Fail to write jitcode cache %s.", tmp_path));
+  // Rename is atomic, so concurrent readers never see a partial file.
+  PADDLE_ENFORCE_EQ(std::rename(tmp_path.c_str(), path.c_str()),
+                    0,
+                    common::errors::Unavailable(
+                        "Fail to rename %s to %s.", tmp_path, path));
+  dirty_ = false;
+  VLOG(3) << "Save " << index.size() << " jitcode to cache " << path;
+}
+
+std::unique_ptr<GenBase> JitCodeCache::Find(KernelType kernel_type,
+                                            int64_t key) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  EnsureLoadedFromFlag();
+  auto iter = entries_.find(EntryKey(kernel_type, key));
+  if (iter == entries_.end()) {
+    return nullptr;
+  }
+  Entry& entry = *iter->second;
+  if (!entry.buffer) {
+    auto buffer = std::make_shared<CachedJitCodeBuffer>();
+    if (EntryChecksum(entry.code,
+                      entry.code_size,
+                      entry.relocs.data(),
+                      entry.relocs.size()) != entry.checksum ||
+        !buffer->Init(entry.code, entry.code_size, entry.relocs)) {
+      LOG(WARNING) << "Drop invalid cached jitcode " << entry.name;
+      entries_.erase(iter);
+      return nullptr;
+    }
+    entry.buffer = std::move(buffer);
+  }
+  return std::make_unique<CachedJitCode>(entry.name, entry.buffer);
+}
+
+void JitCodeCache::Record(KernelType kernel_type,
+                          int64_t key,
+                          const GenBase& code) {
+  if (!code.IsRelocatable()) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  EntryKey entry_key(kernel_type, key);
+  if (entries_.count(entry_key)) {
+    return;
+  }
+  auto entry = std::make_shared<Entry>();
+  entry->name = code.name();
+  entry->owned.assign(code.getCodeInternal(),
+                      code.getCodeInternal() + code.getSize());
+  entry->code = entry->owned.data();
+  entry->code_size = entry->owned.size();
+  entry->relocs = code.Relocations();
+  entry->checksum = EntryChecksum(entry->code,
+                                  entry->code_size,
+                                  entry->relocs.data(),
+                                  entry->relocs.size());
+  entries_.emplace(entry_key, std::move(entry));
+  dirty_ = true;
+}
+
+size_t JitCodeCache::Size() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return entries_.size();
+}
+
+bool PrewarmJitCodeCache(const std::string& path) {
+  return JitCodeCache::Instance().Load(path);
+}
+
+void SaveJitCodeCache(const std::string& path) {
+  JitCodeCache::Instance().Save(path);
+}
+
+}  // namespace jit
+}  // namespace phi
@@ -0,0 +1,120 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "paddle/common/flags.h"
+#include "paddle/phi/kernels/funcs/jit/gen_base.h"
+#include "paddle/phi/kernels/funcs/jit/kernel_base.h"
+#include "paddle/utils/test_macros.h"
+
+PHI_DECLARE_string(jit_code_cache_path);
+
+namespace phi {
+namespace jit {
+
+// The absolute addresses a jitcode may embed, e.g. the constant tables of
+// gen/act.cc. They are saved as symbol ids and patched when a cached code is
+// loaded by another process, where the addresses differ.
+void RegisterJitCodeSymbol(uint32_t id, const void* addr);
+// Return the id of a registered address, or -1.
+int64_t FindJitCodeSymbol(const void* addr);
+
+// An executable copy of a jitcode loaded from the cache file. It is shared by
+// the thread local JitCodePools.
+class CachedJitCodeBuffer;
+
+class CachedJitCode : public GenBase {
+ public:
+  CachedJitCode(std::string name, std::shared_ptr<CachedJitCodeBuffer> buffer);
+
+  std::string name() const override { return name_; }
+  size_t getSize() const override;
+  const unsigned char* getCodeInternal() const override;
+
+ private:
+  std::string name_;
+  std::shared_ptr<CachedJitCodeBuffer> buffer_;
+};
+
+// On-disk cache of generated jitcode.
+//
+// A cache file starts with a header identifying the format, the build and the
+// ISA of the machine it was written on, followed by the code and relocation
+// blobs of every kernel and an index footer. Entries are keyed by the kernel
+// type and the JitCodeKey of the attribute. The file is mapped read-only when
+// loaded, and an entry is only checked and copied into executable memory on
+// its first lookup. Files written by another build or on a CPU with a
+// different ISA are ignored.
+//
+// If FLAGS_jit_code_cache_path is set, the file is loaded on first use and
+// every newly generated relocatable jitcode is written back to it when the
+// process exits. PrewarmJitCodeCache/SaveJitCodeCache allow shipping a cache
+// file alongside the model instead.
+class JitCodeCache {
+ public:
+  static JitCodeCache& Instance();
+
+  // A cache of its own, e.g. to check what a new process loads from a file.
+  // The kernels use Instance().
+  JitCodeCache() = default;
+  ~JitCodeCache();
+
+  // Load the entries of the cache file at `path`, return false if the file
+  // does not exist or can not be used.
+  bool Load(const std::string& path);
+
+  // Write all loaded and recorded entries to `path`.
+  void Save(const std::string& path);
+
+  // Return a jitcode for (kernel_type, key) if the cache has one.
+  std::unique_ptr<GenBase> Find(KernelType kernel_type, int64_t key);
+
+  // Remember a generated jitcode so that it is written by the next Save.
+  void Record(KernelType kernel_type, int64_t key, const GenBase& code);
+
+  size_t Size();
+
+ private:
+  struct Entry;
+  using EntryKey = std::pair<int, int64_t>;
+
+  void EnsureLoadedFromFlag();
+  bool LoadLocked(const std::string& path);
+
+  std::mutex mutex_;
+  std::map<EntryKey, std::shared_ptr<Entry>> entries_;
+  std::vector<std::shared_ptr<void>> mapped_files_;
+  bool flag_loaded_{false};
+  bool dirty_{false};
+  DISABLE_COPY_AND_ASSIGN(JitCodeCache);
+};
+
+// Load a cache file shipped with a model, so its jitcodes are not generated
+// again. Return false if the file can not be used.
+TEST_API bool PrewarmJitCodeCache(const std::string& path);
+
+// Save the jitcodes generated so far by this process.
+TEST_API void SaveJitCodeCache(const std::string& path);
+
+}  // namespace jit
+}  // namespace phi
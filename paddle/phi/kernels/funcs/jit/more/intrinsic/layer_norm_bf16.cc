@@ -0,0 +1,169 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+// This file is built with the AVX512F flags when the compiler has them, see
+// paddle/phi/CMakeLists.txt.
+
+#include "paddle/phi/kernels/funcs/jit/more/intrinsic/layer_norm_bf16.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "paddle/phi/backends/cpu/cpu_info.h"
+#include "paddle/phi/kernels/funcs/jit/refer/refer.h"
+#include "paddle/phi/kernels/funcs/jit/registry.h"
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace phi {
+namespace jit {
+namespace more {
+namespace intrinsic {
+
+#if defined(__AVX512F__)
+namespace {
+
+// Only AVX512F is required, which has no masked 16 bits loads and stores,
+// so the tail of a row goes through a zero padded buffer.
+inline __m512 LoadBF16(const bfloat16* x, int n) {
+  __m256i raw;
+  if (n == ZMM_FLOAT_BLOCK) {
+    raw = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x));
+  } else {
+    alignas(32) uint16_t buf[ZMM_FLOAT_BLOCK] = {0};
+    memcpy(buf, x, n * sizeof(uint16_t));
+    raw = _mm256_load_si256(reinterpret_cast<const __m256i*>(buf));
+  }
+  return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_cvtepu16_epi32(raw), 16));
+}
+
+// Round to nearest even as the refer kernel: x + 0x7fff + ((x >> 16) & 1),
+// then keep the high 16 bits.
+inline void StoreBF16(__m512 v, bfloat16* out, int n) {
+  const __m512i bits = _mm512_castps_si512(v);
+  const __m512i odd =
+      _mm512_and_si512(_mm512_srli_epi32(bits, 16), _mm512_set1_epi32(1));
+  const __m512i rounded = _mm512_srli_epi32(
+      _mm512_add_epi32(bits, _mm512_add_epi32(odd, _mm512_set1_epi32(0x7fff))),
+      16);
+  const __m256i packed = _mm512_cvtepi32_epi16(rounded);
+  if (n == ZMM_FLOAT_BLOCK) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), packed);
+  } else {
+    alignas(32) uint16_t buf[ZMM_FLOAT_BLOCK];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(buf), packed);
+    memcpy(out, buf, n * sizeof(uint16_t));
+  }
+}
+
+inline __mmask16 TailMask(int n) {
+  return static_cast<__mmask16>((1u << n) - 1);
+}
+
+}  // namespace
+#endif
+
+void LayerNormBF16(const bfloat16* x,
+                   bfloat16* out,
+                   float* mean,
+                   float* var,
+                   const float* scale,
+                   const float* bias,
+                   int height,
+                   const float epsilon,
+                   int right) {
+#if defined(__AVX512F__)
+  const int block = ZMM_FLOAT_BLOCK;
+  const int rest = right % block;
+  const int end = right - rest;
+  const __mmask16 rest_mask = TailMask(rest);
+  const float reverse_num = 1.f / static_cast<float>(right);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < height; ++i) {
+    const bfloat16* px = x + static_cast<int64_t>(i) * right;
+    bfloat16* pout = out + static_cast<int64_t>(i) * right;
+
+    /* get mean, the padded tail is zero */
+    __m512 sum = _mm512_setzero_ps();
+    for (int j = 0; j < end; j += block) {
+      sum = _mm512_add_ps(sum, LoadBF16(px + j, block));
+    }
+    if (rest != 0) {
+      sum = _mm512_add_ps(sum, LoadBF16(px + end, rest));
+    }
+    const float row_mean = _mm512_reduce_add_ps(sum) * reverse_num;
+    const __m512 mean_vec = _mm512_set1_ps(row_mean);
+
+    /* get variance */
+    sum = _mm512_setzero_ps();
+    for (int j = 0; j < end; j += block) {
+      const __m512 diff = _mm512_sub_ps(LoadBF16(px + j, block), mean_vec);
+      sum = _mm512_fmadd_ps(diff, diff, sum);
+    }
+    if (rest != 0) {
+      const __m512 diff = _mm512_maskz_sub_ps(
+          rest_mask, LoadBF16(px + end, rest), mean_vec);
+      sum = _mm512_fmadd_ps(diff, diff, sum);
+    }
+    const float row_var = _mm512_reduce_add_ps(sum) * reverse_num;
+    mean[i] = row_mean;
+    var[i] = row_var;
+    const __m512 inv_std_vec =
+        _mm512_set1_ps(1.f / std::sqrt(row_var + epsilon));
+
+    /* get x_norm and calculate output */
+    for (int j = 0; j < right; j += block) {
+      const int n = j < end ? block : rest;
+      const __mmask16 mask = j < end ? static_cast<__mmask16>(0xffff)
+                                     : rest_mask;
+      __m512 y = _mm512_mul_ps(_mm512_sub_ps(LoadBF16(px + j, n), mean_vec),
+                               inv_std_vec);
+      if (scale) {
+        y = _mm512_mul_ps(y, _mm512_maskz_loadu_ps(mask, scale + j));
+      }
+      if (bias) {
+        y = _mm512_add_ps(y, _mm512_maskz_loadu_ps(mask, bias + j));
+      }
+      StoreBF16(y, pout + j, n);
+    }
+  }
+#else
+  refer::LayerNormBF16(
+      x, out, mean, var, scale, bias, height, epsilon, right);
+#endif
+}
+
+bool LayerNormBF16Kernel::CanBeUsed(const int& d) const {
+#if defined(__AVX512F__)
+  return phi::backends::cpu::MayIUse(phi::backends::cpu::avx512f) &&
+         d >= ZMM_FLOAT_BLOCK;
+#else
+  return false;
+#endif
+}
+
+}  // namespace intrinsic
+}  // namespace more
+}  // namespace jit
+}  // namespace phi
+
+namespace intrinsic = phi::jit::more::intrinsic;
+
+REGISTER_JITKERNEL_MORE(kLayerNormBF16,
+                        intrinsic,
+                        intrinsic::LayerNormBF16Kernel);
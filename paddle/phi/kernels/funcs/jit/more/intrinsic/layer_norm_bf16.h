@@ -0,0 +1,46 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#pragma once
+
+#include "paddle/phi/kernels/funcs/jit/kernel_base.h"
+
+namespace phi {
+namespace jit {
+namespace more {
+namespace intrinsic {
+
+// bf16 LayerNorm on AVX512F, the rows are widened to fp32 and the output is
+// rounded back to nearest even.
+void LayerNormBF16(const bfloat16* x,
+                   bfloat16* out,
+                   float* mean,
+                   float* var,
+                   const float* scale,
+                   const float* bias,
+                   int height,
+                   const float epsilon,
+                   int right);
+
+class LayerNormBF16Kernel : public KernelMore<LayerNormBF16Tuple> {
+ public:
+  LayerNormBF16Kernel() { this->func = LayerNormBF16; }
+  bool CanBeUsed(const typename LayerNormBF16Tuple::attr_type&) const override;
+  const char* ImplType() const override { return "Intrinsic"; }
+};
+
+}  // namespace intrinsic
+}  // namespace more
+}  // namespace jit
+}  // namespace phi
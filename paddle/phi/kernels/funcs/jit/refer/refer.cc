@@ -56,3 +56,11 @@ REGISTER_REFER_KERNEL(Sgd);
 REGISTER_REFER_KERNEL(VBroadcast);
 
 #undef REGISTER_REFER_KERNEL
+
+REGISTER_JITKERNEL_REFER(kVMulBF16, refer::VMulBF16Kernel);
+REGISTER_JITKERNEL_REFER(kVAddBF16, refer::VAddBF16Kernel);
+REGISTER_JITKERNEL_REFER(kSeqPoolBF16, refer::SeqPoolBF16Kernel);
+REGISTER_JITKERNEL_REFER(kEmbSeqPoolBF16, refer::EmbSeqPoolBF16Kernel);
+REGISTER_JITKERNEL_REFER(kLayerNormBF16, refer::LayerNormBF16Kernel);
+REGISTER_JITKERNEL_REFER(kMatMulBF16, refer::MatMulBF16Kernel);
+REGISTER_JITKERNEL_REFER(kMatMulS8, refer::MatMulS8Kernel);
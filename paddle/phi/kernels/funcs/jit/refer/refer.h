@@ -14,9 +14,11 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <string>
+#include <vector>
 
 #include "paddle/phi/core/enforce.h"
 #include "paddle/phi/kernels/funcs/jit/helper.h"
@@ -562,6 +564,158 @@ void AdamW(T beta1,
   }
 }
 
+// The bf16 kernels compute in fp32 and round to bf16 only when storing.
+inline void VMulBF16(const bfloat16* x,
+                     const bfloat16* y,
+                     bfloat16* z,
+                     int n) {
+  for (int i = 0; i < n; ++i) {
+    z[i] = static_cast<bfloat16>(static_cast<float>(x[i]) *
+                                 static_cast<float>(y[i]));
+  }
+}
+
+inline void VAddBF16(const bfloat16* x,
+                     const bfloat16* y,
+                     bfloat16* z,
+                     int n) {
+  for (int i = 0; i < n; ++i) {
+    z[i] = static_cast<bfloat16>(static_cast<float>(x[i]) +
+                                 static_cast<float>(y[i]));
+  }
+}
+
+inline void SeqPoolBF16(const bfloat16* x,
+                        bfloat16* y,
+                        const seq_pool_attr_t* attr) {
+  float scalar = 1.f;
+  if (attr->type == SeqPoolType::kAvg) {
+    scalar = 1.f / static_cast<float>(attr->h);
+  } else if (attr->type == SeqPoolType::kSqrt) {
+    scalar = 1.f / std::sqrt(static_cast<float>(attr->h));
+  }
+  for (int w = 0; w < attr->w; ++w) {
+    float sum = 0.f;
+    for (int h = 0; h < attr->h; ++h) {
+      sum += static_cast<float>(x[h * attr->w + w]);
+    }
+    y[w] = static_cast<bfloat16>(sum * scalar);
+  }
+}
+
+inline void EmbSeqPoolBF16(const bfloat16* table,
+                           const int64_t* idx,
+                           bfloat16* out,
+                           const emb_seq_pool_attr_t* attr) {
+  PADDLE_ENFORCE_EQ(
+      attr->table_width * attr->index_width,
+      attr->out_width,
+      common::errors::InvalidArgument(
+          "The attribute table_width * index_width of EmbSeqPool should "
+          "be equal to out_width. But table_width * index_width is %d and "
+          "out_width is %d.",
+          attr->table_width * attr->index_width,
+          attr->out_width));
+  std::vector<float> sum(attr->table_width);
+  for (int64_t w = 0; w < attr->index_width; ++w) {
+    std::fill(sum.begin(), sum.end(), 0.f);
+    for (int64_t h = 0; h < attr->index_height; ++h) {
+      int64_t i = h * attr->index_width + w;
+      PADDLE_ENFORCE_EQ(
+          idx[i] >= 0 && idx[i] < attr->table_height,
+          true,
+          common::errors::InvalidArgument(
+              "The idx should be in [0, table_height) of EmbSeqPool. But "
+              "%dth of idx is %d and table_height is %d.",
+              i,
+              idx[i],
+              attr->table_height));
+      const bfloat16* row = table + idx[i] * attr->table_width;
+      for (int64_t j = 0; j < attr->table_width; ++j) {
+        sum[j] += static_cast<float>(row[j]);
+      }
+    }
+    for (int64_t j = 0; j < attr->table_width; ++j) {
+      out[w * attr->table_width + j] = static_cast<bfloat16>(sum[j]);
+    }
+  }
+}
+
+inline void LayerNormBF16(const bfloat16* x,
+                          bfloat16* out,
+                          float* mean,
+                          float* var,
+                          const float* scale,
+                          const float* bias,
+                          int height,
+                          const float epsilon,
+                          int right) {
+  for (int i = 0; i < height; i++) {
+    const bfloat16* px = x + i * right;
+    float sum = 0.f;
+    for (int j = 0; j < right; j++) {
+      sum += static_cast<float>(px[j]);
+    }
+    mean[i] = sum / right;
+    sum = 0.f;
+    for (int j = 0; j < right; j++) {
+      float diff = static_cast<float>(px[j]) - mean[i];
+      sum += diff * diff;
+    }
+    var[i] = sum / right;
+    float inv_std = 1.f / std::sqrt(var[i] + epsilon);
+    for (int j = 0; j < right; j++) {
+      float y = (static_cast<float>(px[j]) - mean[i]) * inv_std;
+      if (scale) {
+        y *= scale[j];
+      }
+      if (bias) {
+        y += bias[j];
+      }
+      out[i * right + j] = static_cast<bfloat16>(y);
+    }
+  }
+}
+
+inline void MatMulBF16(const bfloat16* A,
+                       const bfloat16* B,
+                       float* C,
+                       const matmul_attr_t* attr) {
+  int M = attr->m;
+  int N = attr->n;
+  int K = attr->k;
+  for (int m = 0; m < M; ++m) {
+    for (int n = 0; n < N; ++n) {
+      float sum = 0.f;
+      for (int k = 0; k < K; ++k) {
+        sum += static_cast<float>(A[m * K + k]) *
+               static_cast<float>(B[k * N + n]);
+      }
+      C[m * N + n] = sum;
+    }
+  }
+}
+
+// B is packed by pack_weights_s8
+inline void MatMulS8(const uint8_t* A,
+                     const int8_t* B,
+                     int32_t* C,
+                     const matmul_attr_t* attr) {
+  int M = attr->m;
+  int N = attr->n;
+  int K = attr->k;
+  for (int m = 0; m < M; ++m) {
+    for (int n = 0; n < N; ++n) {
+      int32_t sum = 0;
+      for (int k = 0; k < K; ++k) {
+        sum += static_cast<int32_t>(A[m * K + k]) *
+               static_cast<int32_t>(B[(k / 4) * N * 4 + n * 4 + k % 4]);
+      }
+      C[m * N + n] = sum;
+    }
+  }
+}
+
 #define DECLARE_REFER_KERNEL(name)                          \
   template <typename T>                                     \
   class name##Kernel : public ReferKernel<name##Tuple<T>> { \
@@ -610,6 +764,22 @@ DECLARE_REFER_KERNEL(VBroadcast);
 
 #undef DECLARE_REFER_KERNEL
 
+#define DECLARE_LOWP_REFER_KERNEL(name)                  \
+  class name##Kernel : public ReferKernel<name##Tuple> { \
+   public:                                               \
+    name##Kernel() { this->func = name; }                \
+  }
+
+DECLARE_LOWP_REFER_KERNEL(VMulBF16);
+DECLARE_LOWP_REFER_KERNEL(VAddBF16);
+DECLARE_LOWP_REFER_KERNEL(SeqPoolBF16);
+DECLARE_LOWP_REFER_KERNEL(EmbSeqPoolBF16);
+DECLARE_LOWP_REFER_KERNEL(LayerNormBF16);
+DECLARE_LOWP_REFER_KERNEL(MatMulBF16);
+DECLARE_LOWP_REFER_KERNEL(MatMulS8);
+
+#undef DECLARE_LOWP_REFER_KERNEL
+
 }  // namespace refer
 }  // namespace jit
 }  // namespace phi
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <array>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <random>
 
@@ -1053,13 +1055,246 @@ void TestKernelVBroadcast() {
   }
 }
 
+using bfloat16 = phi::dtype::bfloat16;
+
+std::vector<bfloat16> RandomBF16Vec(const int n) {
+  std::vector<float> x(n);
+  RandomVec<float>(n, x.data());
+  std::vector<bfloat16> res(n);
+  for (int i = 0; i < n; ++i) {
+    res[i] = static_cast<bfloat16>(x[i]);
+  }
+  return res;
+}
+
+// bf16 kernels round the same fp32 results, so they should be bitwise equal
+void ExpectBF16EQ(const bfloat16* target, const bfloat16* refer, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    EXPECT_EQ(target[i].x, refer[i].x) << " at index : " << i;
+  }
+}
+
+template <typename KernelTuple, typename PlaceType>
+void TestKernelXYZNBF16() {
+  VLOG(10) << "Test JITKernel: " << jit::to_string(KernelTuple::kernel_type);
+  for (int d : TestSizes()) {
+    auto ref = jit::GetReferFunc<KernelTuple>();
+    EXPECT_TRUE(ref != nullptr);
+    auto x = RandomBF16Vec(d);
+    auto y = RandomBF16Vec(d);
+    std::vector<bfloat16> zref(d);
+    ref(x.data(), y.data(), zref.data(), d);
+
+    auto verifier = [](const typename KernelTuple::func_type tgt,
+                       const std::vector<bfloat16>& x,
+                       const std::vector<bfloat16>& y,
+                       const std::vector<bfloat16>& zref) {
+      EXPECT_TRUE(tgt != nullptr);
+      const int d = zref.size();
+      std::vector<bfloat16> z(d);
+      tgt(x.data(), y.data(), z.data(), d);
+      ExpectBF16EQ(z.data(), zref.data(), d);
+      // test inplace
+      std::vector<bfloat16> xinp(x);
+      tgt(xinp.data(), y.data(), xinp.data(), d);
+      ExpectBF16EQ(xinp.data(), zref.data(), d);
+    };
+    TestAllImpls<KernelTuple, PlaceType>(d, verifier, x, y, zref);
+  }
+}
+
+TEST(JITKernel, VMulBF16) {
+  TestKernelXYZNBF16<jit::VMulBF16Tuple, CPUPlace>();
+}
+
+TEST(JITKernel, VAddBF16) {
+  TestKernelXYZNBF16<jit::VAddBF16Tuple, CPUPlace>();
+}
+
+TEST(JITKernel, MatMulBF16) {
+  using KernelTuple = jit::MatMulBF16Tuple;
+  for (int m : {1, 2, 3}) {
+    // 160 takes two groups of accumulators
+    for (int n : {1, 16, 48, 160}) {
+      for (int k : {1, 3, 17, 100}) {
+        auto a = RandomBF16Vec(m * k);
+        auto b = RandomBF16Vec(k * n);
+        std::vector<float> cref(m * n);
+        const jit::matmul_attr_t attr{m, n, k};
+        auto ref = jit::GetReferFunc<KernelTuple>();
+        ref(a.data(), b.data(), cref.data(), &attr);
+        auto verifier = [](const KernelTuple::func_type tgt,
+                           const std::vector<bfloat16>& a,
+                           const std::vector<bfloat16>& b,
+                           const std::vector<float>& cref,
+                           const jit::matmul_attr_t& attr) {
+          EXPECT_TRUE(tgt != nullptr);
+          std::vector<float> c(cref.size());
+          tgt(a.data(), b.data(), c.data(), &attr);
+          for (size_t i = 0; i < c.size(); ++i) {
+            EXPECT_NEAR(c[i], cref[i], 1e-3) << " at index : " << i;
+          }
+        };
+        TestAllImpls<KernelTuple, CPUPlace>(attr, verifier, a, b, cref, attr);
+      }
+    }
+  }
+}
+
+TEST(JITKernel, MatMulS8) {
+  using KernelTuple = jit::MatMulS8Tuple;
+  std::mt19937 rng(100);
+  std::uniform_int_distribution<int> dist(-128, 127);
+  for (int m : {1, 2, 3}) {
+    for (int n : {1, 16, 48, 160}) {
+      for (int k : {1, 2, 3, 4, 5, 7, 64, 129}) {
+        std::vector<uint8_t> a(m * k);
+        std::vector<int8_t> b(k * n);
+        for (auto& v : a) {
+          v = static_cast<uint8_t>(dist(rng) + 128);
+        }
+        for (auto& v : b) {
+          v = static_cast<int8_t>(dist(rng));
+        }
+        std::vector<int8_t> packed(jit::packed_weights_s8_size(n, k));
+        jit::pack_weights_s8(b.data(), packed.data(), n, k);
+        const jit::matmul_attr_t attr{m, n, k};
+        std::vector<int32_t> cref(m * n);
+        for (int i = 0; i < m; ++i) {
+          for (int j = 0; j < n; ++j) {
+            for (int l = 0; l < k; ++l) {
+              cref[i * n + j] += a[i * k + l] * b[l * n + j];
+            }
+          }
+        }
+        auto verifier = [](const KernelTuple::func_type tgt,
+                           const std::vector<uint8_t>& a,
+                           const std::vector<int8_t>& packed,
+                           const std::vector<int32_t>& cref,
+                           const jit::matmul_attr_t& attr) {
+          EXPECT_TRUE(tgt != nullptr);
+          std::vector<int32_t> c(cref.size());
+          tgt(a.data(), packed.data(), c.data(), &attr);
+          ExpectEQ<int32_t>(c.data(), cref.data(), c.size());
+        };
+        TestAllImpls<KernelTuple, CPUPlace>(
+            attr, verifier, a, packed, cref, attr);
+      }
+    }
+  }
+}
+
+// The bf16 pooling and normalization kernels accumulate in fp32, compare
+// them with the fp32 kernels on the same inputs.
+std::vector<float> ToFloat(const std::vector<bfloat16>& x) {
+  return std::vector<float>(x.begin(), x.end());
+}
+
+void ExpectNearBF16(const std::vector<bfloat16>& target,
+                    const std::vector<float>& refer) {
+  ASSERT_EQ(target.size(), refer.size());
+  for (size_t i = 0; i < refer.size(); ++i) {
+    // bf16 has 8 significant bits
+    EXPECT_NEAR(static_cast<float>(target[i]),
+                refer[i],
+                std::abs(refer[i]) / 128 + 1e-5)
+        << " at index : " << i;
+  }
+}
+
+TEST(JITKernel, SeqPoolBF16) {
+  for (auto type : {jit::SeqPoolType::kSum,
+                    jit::SeqPoolType::kAvg,
+                    jit::SeqPoolType::kSqrt}) {
+    for (int w : {1, 7, 16, 100}) {
+      for (int h : {1, 3, 20}) {
+        const jit::seq_pool_attr_t attr(w, type, h);
+        auto x = RandomBF16Vec(h * w);
+        std::vector<bfloat16> y(w);
+        std::vector<float> yref(w);
+        jit::GetReferFunc<jit::SeqPoolBF16Tuple>()(x.data(), y.data(), &attr);
+        jit::GetReferFunc<jit::SeqPoolTuple<float>>()(
+            ToFloat(x).data(), yref.data(), &attr);
+        ExpectNearBF16(y, yref);
+      }
+    }
+  }
+}
+
+TEST(JITKernel, EmbSeqPoolBF16) {
+  const int64_t tbl_h = 100;
+  for (int64_t tbl_w : {1, 16, 33}) {
+    auto table = RandomBF16Vec(tbl_h * tbl_w);
+    auto table_fp32 = ToFloat(table);
+    for (int64_t idx_h : {1, 4}) {
+      for (int64_t idx_w : {1, 3}) {
+        const jit::emb_seq_pool_attr_t attr(
+            tbl_h, tbl_w, idx_h, idx_w, tbl_w * idx_w);
+        std::vector<int64_t> idx(idx_h * idx_w);
+        for (size_t i = 0; i < idx.size(); ++i) {
+          idx[i] = (i * 37) % tbl_h;
+        }
+        std::vector<bfloat16> out(attr.out_width);
+        std::vector<float> oref(attr.out_width);
+        jit::GetReferFunc<jit::EmbSeqPoolBF16Tuple>()(
+            table.data(), idx.data(), out.data(), &attr);
+        jit::GetReferFunc<jit::EmbSeqPoolTuple<float>>()(
+            table_fp32.data(), idx.data(), oref.data(), &attr);
+        ExpectNearBF16(out, oref);
+      }
+    }
+  }
+}
+
+TEST(JITKernel, LayerNormBF16) {
+  const float epsilon = 9.99999975e-06;
+  for (int left : {1, 9}) {
+    for (int right : {1, 16, 17, 100}) {
+      auto x = RandomBF16Vec(left * right);
+      std::vector<float> scale(right), bias(right);
+      RandomVec<float>(right, scale.data());
+      RandomVec<float>(right, bias.data());
+      auto x_fp32 = ToFloat(x);
+      std::vector<float> oref(left * right), mean_ref(left), var_ref(left);
+      jit::GetReferFunc<jit::LayerNormTuple<float>>()(x_fp32.data(),
+                                                      oref.data(),
+                                                      mean_ref.data(),
+                                                      var_ref.data(),
+                                                      scale.data(),
+                                                      bias.data(),
+                                                      left,
+                                                      epsilon,
+                                                      right);
+      auto funcs = jit::GetAllCandidateFuncsWithTypes<jit::LayerNormBF16Tuple,
+                                                      CPUPlace>(right);
+      for (auto const& f : funcs) {
+        VLOG(10) << "Test Kernel " << f.first;
+        std::vector<bfloat16> out(left * right);
+        std::vector<float> mean(left), var(left);
+        f.second(x.data(),
+                 out.data(),
+                 mean.data(),
+                 var.data(),
+                 scale.data(),
+                 bias.data(),
+                 left,
+                 epsilon,
+                 right);
+        ExpectNearBF16(out, oref);
+        ExpectEQ<float>(mean.data(), mean_ref.data(), left);
+        ExpectEQ<float>(var.data(), var_ref.data(), left);
+      }
+    }
+  }
+}
+
 // test pool
 TEST(JITKernel_pool, jitcreator) {
   const auto& jitcreators = jit::JitCodeCreatorPool::Instance().AllCreators();
 #if defined(_WIN32) || defined(__APPLE__) || defined(__OSX__)
   EXPECT_EQ(jitcreators.size(), 0UL);
 #else
-  EXPECT_EQ(jitcreators.size(), 24UL);
+  EXPECT_EQ(jitcreators.size(), 28UL);
 #endif
 }
 
@@ -1081,7 +1316,7 @@ TEST(JITKernel_pool, more) {
   size_t target_num = 7;
 
 #ifdef __AVX__
-  target_num += 2;
+  target_num += 3;
 #endif
 
 #ifdef PADDLE_WITH_MKLML
@@ -1093,7 +1328,7 @@ TEST(JITKernel_pool, more) {
 
 TEST(JITKernel_pool, refer) {
   const auto& kers = jit::ReferKernelPool::Instance().AllKernels();
-  EXPECT_EQ(kers.size(), 27UL);
+  EXPECT_EQ(kers.size(), 34UL);
 }
 
 // test helper
@@ -1212,6 +1447,53 @@ TEST(JITKernel_helper, pack_weights) {
   ExpectEQ<float>(y.data(), ref, N * K);
 }
 
+TEST(JITKernel_helper, code_cache) {
+#if !defined(_WIN32) && !defined(__APPLE__) && !defined(__OSX__)
+  if (!phi::backends::cpu::MayIUse(phi::backends::cpu::avx)) {
+    return;
+  }
+  const int d = 37;
+  auto jitker = jit::GetJitCode<jit::VExpTuple<float>, CPUPlace>(d);
+  ASSERT_TRUE(jitker != nullptr);
+  auto& cache = jit::JitCodeCache::Instance();
+  EXPECT_GE(cache.Size(), 1UL);
+
+  const std::string path = "jit_code_cache_test.bin";
+  jit::SaveJitCodeCache(path);
+
+  // A fresh cache, as in a new process, only has the code read from disk.
+  // It is patched and executed from its own buffer.
+  jit::JitCodeCache loaded;
+  EXPECT_EQ(loaded.Size(), 0UL);
+  ASSERT_TRUE(loaded.Load(path));
+  EXPECT_EQ(loaded.Size(), cache.Size());
+  auto cached = loaded.Find(jit::kVExp, jit::JitCodeKey<int>(d));
+  ASSERT_TRUE(cached != nullptr);
+  EXPECT_NE(cached->getCodeInternal(),
+            dynamic_cast<const jit::GenBase*>(jitker)->getCodeInternal());
+  EXPECT_EQ(cached->getSize(),
+            dynamic_cast<const jit::GenBase*>(jitker)->getSize());
+  std::vector<float> x(d), y(d), ref(d);
+  RandomVec<float>(d, x.data());
+  auto ref_func = jit::GetReferFunc<jit::VExpTuple<float>>();
+  ref_func(x.data(), ref.data(), d);
+  auto func = cached->getCode<jit::VExpTuple<float>::func_type>();
+  func(x.data(), y.data(), d);
+  ExpectEQ<float>(y.data(), ref.data(), d);
+
+  // A corrupted file is ignored.
+  {
+    std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+    fout << "not a jitcode cache";
+  }
+  EXPECT_FALSE(jit::PrewarmJitCodeCache(path));
+  jit::JitCodeCache corrupted;
+  EXPECT_FALSE(corrupted.Load(path));
+  EXPECT_EQ(corrupted.Size(), 0UL);
+  std::remove(path.c_str());
+#endif
+}
+
 TEST(JITKernel_helper, attr) {
   std::ostringstream out;
   // KernelTypes
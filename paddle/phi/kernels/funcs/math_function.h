@@ -15,12 +15,14 @@ limitations under the License. */
 #pragma once
 #include <cmath>
 #include <memory>
+#include <type_traits>
 #include <vector>
 
 #include "paddle/phi/backends/all_context.h"
 #include "paddle/phi/common/memory_utils.h"
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/core/utils/data_type.h"
+#include "paddle/phi/kernels/funcs/cpu_transpose.h"
 #ifdef PADDLE_WITH_XPU
 #include <type_traits>
 #include "paddle/phi/backends/context_pool.h"
@@ -57,6 +59,21 @@ struct Transpose {
                   const std::vector<int>& axis);
 };
 
+// Transpose on CPU only moves bytes, so it goes to the blocked engine in
+// cpu_transpose.h for every element type, instead of an Eigen shuffle.
+template <typename T, int Rank>
+struct Transpose<phi::CPUContext, T, Rank> {
+  void operator()(const phi::CPUContext& context,
+                  const phi::DenseTensor& in,
+                  phi::DenseTensor* out,
+                  const std::vector<int>& axis) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Transpose on CPU copies the elements as raw bytes.");
+    TransposeCPU(
+        context, in.data<T>(), out->data<T>(), sizeof(T), in.dims(), axis);
+  }
+};
+
 template <typename DeviceContext, typename T>
 struct SetConstant {
   void operator()(const DeviceContext& context,
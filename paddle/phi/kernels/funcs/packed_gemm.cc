@@ -0,0 +1,265 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/funcs/packed_gemm.h"
+
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+#include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+
+COMMON_DECLARE_bool(cpu_gemm_pack_weight);
+
+namespace phi {
+namespace funcs {
+namespace {
+
+#ifdef PADDLE_WITH_MKLML
+// The weight data, trans_b, N, K and ldb.
+using PackedWeightKey = std::tuple<const void*, bool, int, int, int>;
+
+// At most this many weights are marked or packed at a time. The weights
+// past it run the plain GEMM.
+constexpr size_t kMaxPackedWeights = 4096;
+
+uint32_t InplaceVersion(const DenseTensor& weight) {
+  // The version is only read here, InplaceVersionCounter has no const
+  // overload.
+  return const_cast<DenseTensor&>(weight)
+      .InplaceVersionCounter()
+      .CurrentVersion();
+}
+
+struct PackedWeight {
+  std::weak_ptr<phi::Allocation> holder;
+  uint32_t inplace_version{0};
+  std::shared_ptr<void> data;
+};
+
+class PackedWeightCache {
+ public:
+  static PackedWeightCache& Instance() {
+    static PackedWeightCache cache;
+    return cache;
+  }
+
+  void Mark(const DenseTensor& weight) {
+    const std::shared_ptr<phi::Allocation>& holder = weight.Holder();
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = marked_.find(holder.get());
+    if (it != marked_.end() && it->second.lock() == holder) return;
+    RemoveReleased();
+    if (marked_.size() >= kMaxPackedWeights) {
+      VLOG(4) << "Too many packable weights, the new one is not marked.";
+      return;
+    }
+    marked_[holder.get()] = holder;
+  }
+
+  // Returns the packed weight, packing it if the one kept is stale, or
+  // nullptr if weight is not marked or the cache is full. The returned
+  // pointer stays valid while it is held, even if another thread repacks
+  // the weight meanwhile.
+  template <typename T>
+  std::shared_ptr<void> Get(const phi::CPUContext& dev_ctx,
+                            const DenseTensor& weight,
+                            bool trans_b,
+                            int N,
+                            int K,
+                            int ldb) {
+    const std::shared_ptr<phi::Allocation>& holder = weight.Holder();
+    const uint32_t version = InplaceVersion(weight);
+    const PackedWeightKey key(weight.data(), trans_b, N, K, ldb);
+
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto marked = marked_.find(holder.get());
+    if (marked == marked_.end() || marked->second.lock() != holder) {
+      return nullptr;
+    }
+    auto it = packed_.find(key);
+    if (it != packed_.end() && it->second.holder.lock() == holder &&
+        it->second.inplace_version == version) {
+      return it->second.data;
+    }
+    RemoveReleased();
+    if (it == packed_.end() && packed_.size() >= kMaxPackedWeights) {
+      return nullptr;
+    }
+
+    auto blas = GetBlas<phi::CPUContext, T>(dev_ctx);
+    T* dst = blas.GEMM_ALLOC(CblasBMatrix, 1, N, K);
+    PADDLE_ENFORCE_NOT_NULL(
+        dst,
+        common::errors::ResourceExhausted(
+            "Failed to allocate the packed weight of a %d x %d GEMM.", K, N));
+    blas.GEMM_PACK(CblasBMatrix,
+                   trans_b ? CblasTrans : CblasNoTrans,
+                   1,
+                   N,
+                   K,
+                   static_cast<T>(1),
+                   weight.data<T>(),
+                   ldb,
+                   dst);
+    VLOG(4) << "Packed a " << K << " x " << N << " weight for GEMM.";
+
+    PackedWeight& entry = packed_[key];
+    entry.holder = holder;
+    entry.inplace_version = version;
+    entry.data = std::shared_ptr<void>(
+        dst, [](void* data) { CBlas<T>::GEMM_FREE(static_cast<T*>(data)); });
+    return entry.data;
+  }
+
+  size_t Size() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    RemoveReleased();
+    return packed_.size();
+  }
+
+ private:
+  // Drops the marks and packed weights whose allocation is released, the
+  // address may be taken by another tensor later.
+  void RemoveReleased() {
+    for (auto it = marked_.begin(); it != marked_.end();) {
+      it = it->second.expired() ? marked_.erase(it) : std::next(it);
+    }
+    for (auto it = packed_.begin(); it != packed_.end();) {
+      it = it->second.holder.expired() ? packed_.erase(it) : std::next(it);
+    }
+  }
+
+  std::mutex mutex_;
+  std::map<const phi::Allocation*, std::weak_ptr<phi::Allocation>> marked_;
+  std::map<PackedWeightKey, PackedWeight> packed_;
+};
+
+template <typename T>
+bool GEMMWithPackedWeightImpl(const phi::CPUContext& dev_ctx,
+                              bool trans_a,
+                              int M,
+                              int N,
+                              int K,
+                              const T* a,
+                              int lda,
+                              const DenseTensor& weight,
+                              bool trans_b,
+                              int ldb,
+                              T beta,
+                              T* c,
+                              int ldc) {
+  if (!FLAGS_cpu_gemm_pack_weight || !weight.initialized() || M <= 0 ||
+      N <= 0 || K <= 0) {
+    return false;
+  }
+  std::shared_ptr<void> packed = PackedWeightCache::Instance().Get<T>(
+      dev_ctx, weight, trans_b, N, K, ldb);
+  if (packed == nullptr) return false;
+  auto blas = GetBlas<phi::CPUContext, T>(dev_ctx);
+  blas.GEMM_COMPUTE(trans_a ? CblasTrans : CblasNoTrans,
+                    CblasPacked,
+                    M,
+                    N,
+                    K,
+                    a,
+                    lda,
+                    static_cast<const T*>(packed.get()),
+                    ldb,
+                    beta,
+                    c,
+                    ldc);
+  return true;
+}
+#else
+template <typename T>
+bool GEMMWithPackedWeightImpl(const phi::CPUContext& dev_ctx UNUSED,
+                              bool trans_a UNUSED,
+                              int M UNUSED,
+                              int N UNUSED,
+                              int K UNUSED,
+                              const T* a UNUSED,
+                              int lda UNUSED,
+                              const DenseTensor& weight UNUSED,
+                              bool trans_b UNUSED,
+                              int ldb UNUSED,
+                              T beta UNUSED,
+                              T* c UNUSED,
+                              int ldc UNUSED) {
+  // Only MKL has the packed GEMM API.
+  return false;
+}
+#endif
+
+}  // namespace
+
+template <>
+bool GEMMWithPackedWeight<float>(const phi::CPUContext& dev_ctx,
+                                 bool trans_a,
+                                 int M,
+                                 int N,
+                                 int K,
+                                 const float* a,
+                                 int lda,
+                                 const DenseTensor& weight,
+                                 bool trans_b,
+                                 int ldb,
+                                 float beta,
+                                 float* c,
+                                 int ldc) {
+  return GEMMWithPackedWeightImpl<float>(
+      dev_ctx, trans_a, M, N, K, a, lda, weight, trans_b, ldb, beta, c, ldc);
+}
+
+template <>
+bool GEMMWithPackedWeight<double>(const phi::CPUContext& dev_ctx,
+                                  bool trans_a,
+                                  int M,
+                                  int N,
+                                  int K,
+                                  const double* a,
+                                  int lda,
+                                  const DenseTensor& weight,
+                                  bool trans_b,
+                                  int ldb,
+                                  double beta,
+                                  double* c,
+                                  int ldc) {
+  return GEMMWithPackedWeightImpl<double>(
+      dev_ctx, trans_a, M, N, K, a, lda, weight, trans_b, ldb, beta, c, ldc);
+}
+
+void MarkPackableWeight(const DenseTensor& weight UNUSED) {
+#ifdef PADDLE_WITH_MKLML
+  if (FLAGS_cpu_gemm_pack_weight && weight.initialized()) {
+    PackedWeightCache::Instance().Mark(weight);
+  }
+#endif
+}
+
+size_t PackedWeightCacheSize() {
+#ifdef PADDLE_WITH_MKLML
+  return PackedWeightCache::Instance().Size();
+#else
+  return 0;
+#endif
+}
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,94 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+
+#include "paddle/common/macros.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace phi {
+namespace funcs {
+
+// Marks weight as constant, so GEMMWithPackedWeight may keep a packed copy
+// of it. Only tensors that nothing writes during a run, such as the
+// parameters of an inference program, may be marked. A writer that changes
+// a marked tensor in place must bump its inplace version afterwards. Does
+// nothing unless FLAGS_cpu_gemm_pack_weight is on and Paddle is built with
+// MKL.
+void MarkPackableWeight(const DenseTensor& weight);
+
+// C = op(A) * op(B) + beta * C, where B is the weight tensor, a K x N
+// matrix, or N x K if trans_b, with a leading dim of ldb.
+//
+// If weight is marked by MarkPackableWeight, B is packed on first use into
+// the layout of cblas_gemm_compute, and the packed copy is reused by every
+// later call on the same weight. The copy is repacked once the weight is
+// reallocated or its inplace version changes, and dropped once its
+// allocation is released. Otherwise, or when the cache is full, C is left
+// alone and false is returned, and the caller runs its plain GEMM.
+template <typename T>
+bool GEMMWithPackedWeight(const phi::CPUContext& dev_ctx UNUSED,
+                          bool trans_a UNUSED,
+                          int M UNUSED,
+                          int N UNUSED,
+                          int K UNUSED,
+                          const T* a UNUSED,
+                          int lda UNUSED,
+                          const DenseTensor& weight UNUSED,
+                          bool trans_b UNUSED,
+                          int ldb UNUSED,
+                          T beta UNUSED,
+                          T* c UNUSED,
+                          int ldc UNUSED) {
+  return false;
+}
+
+template <>
+bool GEMMWithPackedWeight<float>(const phi::CPUContext& dev_ctx,
+                                 bool trans_a,
+                                 int M,
+                                 int N,
+                                 int K,
+                                 const float* a,
+                                 int lda,
+                                 const DenseTensor& weight,
+                                 bool trans_b,
+                                 int ldb,
+                                 float beta,
+                                 float* c,
+                                 int ldc);
+
+template <>
+bool GEMMWithPackedWeight<double>(const phi::CPUContext& dev_ctx,
+                                  bool trans_a,
+                                  int M,
+                                  int N,
+                                  int K,
+                                  const double* a,
+                                  int lda,
+                                  const DenseTensor& weight,
+                                  bool trans_b,
+                                  int ldb,
+                                  double beta,
+                                  double* c,
+                                  int ldc);
+
+// The number of packed weights kept, for tests.
+size_t PackedWeightCacheSize();
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,83 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/threadpool.h"
+
+namespace phi {
+namespace funcs {
+
+// The least work of a chunk of ParallelFor, in elements, below which a
+// thread costs more than it saves.
+constexpr int64_t kParallelForMinWork = 32768;
+
+// ParallelFor calls func(chunk_begin, chunk_end) on chunks of [begin, end)
+// by the intra op threads of dev_ctx, see phi::SetIntraOpNumThreads. Every
+// index costs about work_per_index elements, so a range of less than
+// kParallelForMinWork runs serially in the calling thread. func should be
+// safe to call concurrently on disjoint chunks.
+template <typename Function>
+void ParallelFor(const phi::CPUContext& dev_ctx,
+                 int64_t begin,
+                 int64_t end,
+                 int64_t work_per_index,
+                 const Function& func) {
+  if (begin >= end) return;
+  const int64_t size = end - begin;
+  const int64_t grain_size = std::max<int64_t>(
+      1, kParallelForMinWork / std::max<int64_t>(work_per_index, 1));
+  const int64_t num_chunks =
+      std::min<int64_t>(dev_ctx.intra_op_num_threads(),
+                        (size + grain_size - 1) / grain_size);
+  if (num_chunks <= 1) {
+    func(begin, end);
+    return;
+  }
+
+  const int64_t chunk_size = (size + num_chunks - 1) / num_chunks;
+  auto* pool = dev_ctx.intra_op_pool();
+  std::vector<std::future<void>> futures;
+  futures.reserve(num_chunks - 1);
+  for (int64_t chunk_begin = begin + chunk_size; chunk_begin < end;
+       chunk_begin += chunk_size) {
+    const int64_t chunk_end = std::min(chunk_begin + chunk_size, end);
+    futures.emplace_back(pool->Run(
+        [&func, chunk_begin, chunk_end] { func(chunk_begin, chunk_end); }));
+  }
+  // The calling thread takes the first chunk, and waits for all the others
+  // before leaving, even on an exception, since they refer to func.
+  std::exception_ptr error;
+  try {
+    func(begin, begin + chunk_size);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  for (auto& future : futures) {
+    future.wait();
+  }
+  if (error) std::rethrow_exception(error);
+  for (auto& future : futures) {
+    future.get();
+  }
+}
+
+}  // namespace funcs
+}  // namespace phi
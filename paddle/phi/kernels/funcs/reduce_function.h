@@ -64,6 +64,7 @@ using dim3 = phi::kps::dim3;
 #include "paddle/phi/kernels/funcs/eigen/common.h"
 #include "paddle/phi/kernels/funcs/eigen/eigen_function.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
+#include "paddle/phi/kernels/funcs/parallel_for.h"
 namespace phi {
 namespace funcs {
 
@@ -1249,6 +1250,31 @@ void ReduceFunctor(const Context& context,
   auto& place = *context.eigen_device();
   Functor functor;
 
+  // On CPU, the rows of a kept leading dim are reduced by the intra op
+  // threads.
+  if constexpr (std::is_same<Context, phi::CPUContext>::value && D > R_D) {
+    const int64_t rows = input.dims()[0];
+    if (rows > 1 && context.intra_op_num_threads() > 1 &&
+        std::find(dims_ref.begin(), dims_ref.end(), 0) == dims_ref.end()) {
+      ParallelFor(context,
+                  0,
+                  rows,
+                  input.numel() / rows,
+                  [&](int64_t begin, int64_t end) {
+                    phi::DenseTensor input_rows = input.Slice(begin, end);
+                    phi::DenseTensor output_rows = output->Slice(begin, end);
+                    DDim rows_dims = out_dims;
+                    rows_dims[0] = end - begin;
+                    auto x_rows = EigenTensor<T, D>::From(input_rows);
+                    auto out_rows =
+                        EigenTensor<T, (D - R_D)>::From(output_rows, rows_dims);
+                    Functor rows_functor;
+                    rows_functor(place, &x_rows, &out_rows, reduce_dim);
+                  });
+      return;
+    }
+  }
+
   if (D == 1) {
     auto out = EigenScalar<T>::From(*output);
     functor(place, &x, &out, reduce_dim);
@@ -23,6 +23,7 @@ limitations under the License. */
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/kernels/funcs/cpu_vec.h"
 #include "paddle/phi/kernels/funcs/eigen/common.h"
+#include "paddle/phi/kernels/funcs/parallel_for.h"
 
 namespace phi {
 namespace funcs {
@@ -245,30 +246,49 @@ class SoftmaxFunctor<DeviceContext, T, enable_if_CPU<DeviceContext>> {
     const int batch_size = in_dims[kBatchDim];
     const int num_remain = num_classes / axis_dim;
 
+    // The rows of the batch are independent, and split over the intra op
+    // threads.
     if (num_remain == 1 &&
         phi::backends::cpu::MayIUse(phi::backends::cpu::avx)) {
-      const T* in_data = X->data<T>();
-      T* out_data = Y->data<T>();
-      for (int bs = 0; bs < batch_size; ++bs) {
-        T max_val = *std::max_element(in_data, in_data + num_classes);
-        max_val *= static_cast<T>(-1);
-        vec_add_bias<T, phi::backends::cpu::avx>(
-            num_classes, max_val, in_data, out_data);
-        vec_clip<T, phi::backends::cpu::avx>(
-            num_classes, static_cast<T>(-64), out_data, out_data);
-        vec_exp<T>(num_classes, out_data, out_data);
-
-        T sum = 0;
-        vec_sum<T, phi::backends::cpu::avx>(num_classes, out_data, &sum);
-        sum = static_cast<T>(1) / sum;
-        vec_scal<T, phi::backends::cpu::avx>(
-            num_classes, sum, out_data, out_data);
-
-        in_data += num_classes;
-        out_data += num_classes;
-      }
+      ParallelFor(context,
+                  0,
+                  batch_size,
+                  num_classes,
+                  [&](int64_t begin, int64_t end) {
+                    const T* in_data = X->data<T>() + begin * num_classes;
+                    T* out_data = Y->data<T>() + begin * num_classes;
+                    for (int64_t bs = begin; bs < end; ++bs) {
+                      T max_val =
+                          *std::max_element(in_data, in_data + num_classes);
+                      max_val *= static_cast<T>(-1);
+                      vec_add_bias<T, phi::backends::cpu::avx>(
+                          num_classes, max_val, in_data, out_data);
+                      vec_clip<T, phi::backends::cpu::avx>(
+                          num_classes, static_cast<T>(-64), out_data, out_data);
+                      vec_exp<T>(num_classes, out_data, out_data);
+
+                      T sum = 0;
+                      vec_sum<T, phi::backends::cpu::avx>(
+                          num_classes, out_data, &sum);
+                      sum = static_cast<T>(1) / sum;
+                      vec_scal<T, phi::backends::cpu::avx>(
+                          num_classes, sum, out_data, out_data);
+
+                      in_data += num_classes;
+                      out_data += num_classes;
+                    }
+                  });
     } else {
-      SoftmaxEigen<DeviceContext, T>()(context, axis_dim, X, Y);
+      ParallelFor(context,
+                  0,
+                  batch_size,
+                  num_classes,
+                  [&](int64_t begin, int64_t end) {
+                    phi::DenseTensor x_rows = X->Slice(begin, end);
+                    phi::DenseTensor y_rows = Y->Slice(begin, end);
+                    SoftmaxEigen<DeviceContext, T>()(
+                        context, axis_dim, &x_rows, &y_rows);
+                  });
     }
   }
 };
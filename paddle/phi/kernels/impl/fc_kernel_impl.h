@@ -61,7 +61,8 @@ void FCKernel(const Context& dev_ctx,
      output_data,
      bias ? bias->data<T>() : NULL,
      with_relu,
-     padding_weights);
+     padding_weights,
+     &w);
 }
 }  // namespace fusion
 }  // namespace phi
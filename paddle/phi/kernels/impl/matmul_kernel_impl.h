@@ -23,6 +23,7 @@ limitations under the License. */
 #include "paddle/phi/kernels/funcs/blas/blas.h"
 #include "paddle/phi/kernels/funcs/blas/blaslt_impl.cu.h"
 #include "paddle/phi/kernels/funcs/complex_functors.h"
+#include "paddle/phi/kernels/funcs/packed_gemm.h"
 #include "paddle/phi/kernels/scale_kernel.h"
 #if defined(PADDLE_WITH_CUDA)
 #include "paddle/phi/kernels/funcs/cublaslt.h"
@@ -97,6 +98,53 @@ static void IndexIncreaseFromDims(const int ndim,
   }
 }
 
+// Computes the GEMM of a matmul whose Y has a single batch with Y packed,
+// see funcs::GEMMWithPackedWeight. Returns false if it did not, which is
+// always the case off CPU.
+template <typename Context, typename T>
+struct MatMulWithPackedY {
+  bool operator()(const Context& dev_ctx UNUSED,
+                  const T* x_data UNUSED,
+                  const DenseTensor& y UNUSED,
+                  int M UNUSED,
+                  int N UNUSED,
+                  int K UNUSED,
+                  bool trans_x UNUSED,
+                  bool trans_y UNUSED,
+                  T beta UNUSED,
+                  T* out_data UNUSED) const {
+    return false;
+  }
+};
+
+template <typename T>
+struct MatMulWithPackedY<phi::CPUContext, T> {
+  bool operator()(const phi::CPUContext& dev_ctx,
+                  const T* x_data,
+                  const DenseTensor& y,
+                  int M,
+                  int N,
+                  int K,
+                  bool trans_x,
+                  bool trans_y,
+                  T beta,
+                  T* out_data) const {
+    return phi::funcs::GEMMWithPackedWeight<T>(dev_ctx,
+                                               trans_x,
+                                               M,
+                                               N,
+                                               K,
+                                               x_data,
+                                               trans_x ? M : K,
+                                               y,
+                                               trans_y,
+                                               trans_y ? K : N,
+                                               beta,
+                                               out_data,
+                                               N);
+  }
+};
+
 // The general implementation with blas.
 template <typename Context, typename T>
 void MatMulFunctionImplWithBlas(
@@ -373,6 +421,18 @@ void MatMulFunctionImplWithBlas(
   if (out_batch_size == 0) return;
   if (x_batch_size == 1 && y_batch_size == 1) {
     VLOG(3) << "MatMul's case 8";
+    if (MatMulWithPackedY<Context, T>()(dev_ctx,
+                                        x_data,
+                                        Y,
+                                        M,
+                                        N,
+                                        K,
+                                        trans_x,
+                                        trans_y,
+                                        static_cast<T>(flag),
+                                        dev_ctx.template Alloc<T>(Out))) {
+      return;
+    }
     blas.GEMM(trans_x ? CblasTrans : CblasNoTrans,
               trans_y ? CblasTrans : CblasNoTrans,
               M,
@@ -413,6 +473,18 @@ void MatMulFunctionImplWithBlas(
   } else if (y_batch_size == 1) {
     if (!trans_x) {
       VLOG(3) << "MatMul's case 11";
+      if (MatMulWithPackedY<Context, T>()(dev_ctx,
+                                          x_data,
+                                          Y,
+                                          x_batch_size * M,
+                                          N,
+                                          K,
+                                          false,
+                                          trans_y,
+                                          static_cast<T>(flag),
+                                          dev_ctx.template Alloc<T>(Out))) {
+        return;
+      }
       blas.GEMM(CblasNoTrans,
                 trans_y ? CblasTrans : CblasNoTrans,
                 x_batch_size * M,
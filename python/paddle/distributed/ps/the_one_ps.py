@@ -761,6 +761,12 @@ class SparseTable(Table):
             table_proto.enable_revert = usr_table_proto.enable_revert
         if usr_table_proto.HasField("shard_merge_rate"):
             table_proto.shard_merge_rate = usr_table_proto.shard_merge_rate
+        if usr_table_proto.HasField("binary_checkpoint"):
+            table_proto.binary_checkpoint = usr_table_proto.binary_checkpoint
+        if usr_table_proto.HasField("enable_delta_checkpoint"):
+            table_proto.enable_delta_checkpoint = (
+                usr_table_proto.enable_delta_checkpoint
+            )
 
         if usr_table_proto.accessor.ByteSize() == 0:
             warnings.warn(
@@ -3990,9 +3990,10 @@ def sparse_embedding(
         "CommonSparseTable",
         "SSDSparseTable",
         "MemorySparseTable",
+        "MemoryConcurrentSparseTable",
     ]:
         raise ValueError(
-            "table_class must be in [CommonSparseTable, SSDSparseTable, MemorySparseTable]"
+            "table_class must be in [CommonSparseTable, SSDSparseTable, MemorySparseTable, MemoryConcurrentSparseTable]"
         )
 
     entry_str = "none"
@@ -0,0 +1,97 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/core/memory/allocation/size_class_cpu_allocator.h"
+
+#include <cstring>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/core/memory/allocation/cpu_allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+TEST(SizeClassArenaTest, SizeClassIndex) {
+  for (size_t size = 1; size <= SizeClassArena::kMaxClassSize; ++size) {
+    size_t index = SizeClassArena::SizeClassIndex(size);
+    ASSERT_LT(index, SizeClassArena::kNumClasses);
+    ASSERT_GE(SizeClassArena::ClassSize(index), size);
+    if (index > 0) {
+      ASSERT_LT(SizeClassArena::ClassSize(index - 1), size);
+    }
+  }
+  EXPECT_EQ(SizeClassArena::ClassSize(SizeClassArena::kNumClasses - 1),
+            SizeClassArena::kMaxClassSize);
+}
+
+TEST(SizeClassCPUAllocatorTest, AllocAndFree) {
+  auto allocator =
+      std::make_shared<SizeClassCPUAllocator>(std::make_shared<CPUAllocator>());
+  std::vector<AllocationPtr> allocations;
+  for (size_t size : {1UL, 64UL, 1000UL, 4097UL, 256UL << 10, 1UL << 20}) {
+    auto allocation = allocator->Allocate(size);
+    ASSERT_NE(allocation->ptr(), nullptr);
+    ASSERT_EQ(allocation->size(), size);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(allocation->ptr()) % 64, 0UL);
+    std::memset(allocation->ptr(), 0xff, size);
+    allocations.emplace_back(std::move(allocation));
+  }
+  allocations.clear();
+
+  // Freed blocks are cached by the thread and reused in LIFO order.
+  void* ptr = nullptr;
+  {
+    auto allocation = allocator->Allocate(100);
+    ptr = allocation->ptr();
+  }
+  auto allocation = allocator->Allocate(100);
+  EXPECT_EQ(allocation->ptr(), ptr);
+}
+
+TEST(SizeClassCPUAllocatorTest, MultiThreadAndTrim) {
+  auto allocator =
+      std::make_shared<SizeClassCPUAllocator>(std::make_shared<CPUAllocator>());
+  auto func = [&](int seed) {
+    std::vector<AllocationPtr> allocations;
+    for (int i = 0; i < 4096; ++i) {
+      size_t size = 64 + (i * 131 + seed * 977) % (4 << 10);
+      auto allocation = allocator->Allocate(size);
+      std::memset(allocation->ptr(), seed, size);
+      allocations.emplace_back(std::move(allocation));
+      if (i % 3 == 0) {
+        allocations.erase(allocations.begin());
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back(func, i);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  // All threads have exited and flushed their caches, so the slabs they
+  // touched can be returned to the system.
+  uint64_t reserved = SizeClassArena::Instance().ReservedBytes();
+  EXPECT_GT(allocator->Release(phi::CPUPlace()), 0UL);
+  EXPECT_LT(SizeClassArena::Instance().ReservedBytes(), reserved);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
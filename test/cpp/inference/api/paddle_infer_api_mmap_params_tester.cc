@@ -0,0 +1,95 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "paddle/common/flags.h"
+#include "test/cpp/inference/api/tester_helper.h"
+
+namespace paddle_infer {
+
+namespace {
+
+Config MakeConfig(const std::string &params_file, bool mmap_params) {
+  std::string model_dir = FLAGS_infer_model + "/model";
+  Config config;
+  config.SetModel(model_dir + "/model", params_file);
+  config.DisableGpu();
+  config.EnableMmapParams(mmap_params);
+  return config;
+}
+
+std::vector<float> RunOnce(Predictor *predictor) {
+  std::vector<int> in_shape = {1, 3, 224, 224};
+  std::vector<float> input(3 * 224 * 224);
+  for (size_t i = 0; i < input.size(); ++i) {
+    input[i] = static_cast<float>(i % 255) / 255;
+  }
+  auto input_t = predictor->GetInputHandle(predictor->GetInputNames()[0]);
+  input_t->Reshape(in_shape);
+  input_t->CopyFromCpu(input.data());
+  predictor->Run();
+
+  auto output_t = predictor->GetOutputHandle(predictor->GetOutputNames()[0]);
+  std::vector<int> output_shape = output_t->shape();
+  int out_num = std::accumulate(
+      output_shape.begin(), output_shape.end(), 1, std::multiplies<int>());
+  std::vector<float> out_data(out_num);
+  output_t->CopyToCpu(out_data.data());
+  return out_data;
+}
+
+}  // namespace
+
+TEST(Predictor, mmap_params) {
+  std::string params_file = FLAGS_infer_model + "/model/params";
+  Config config = MakeConfig(params_file, false);
+  auto expected = RunOnce(CreatePredictor(config).get());
+
+  Config mmap_config = MakeConfig(params_file, true);
+  ASSERT_TRUE(mmap_config.mmap_params_enabled());
+  // Both predictors map the same file.
+  auto predictor = CreatePredictor(mmap_config);
+  auto other = CreatePredictor(mmap_config);
+  for (auto *p : {predictor.get(), other.get()}) {
+    auto outputs = RunOnce(p);
+    ASSERT_EQ(outputs.size(), expected.size());
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      EXPECT_NEAR(outputs[i], expected[i], 1e-5);
+    }
+  }
+}
+
+TEST(Predictor, mmap_damaged_params) {
+  std::string params_file = FLAGS_infer_model + "/model/params";
+  std::string damaged_file = "./mmap_damaged_params";
+  {
+    std::ifstream fin(params_file, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(fin)),
+                         std::istreambuf_iterator<char>());
+    std::ofstream fout(damaged_file, std::ios::binary);
+    fout.write(contents.data(), contents.size() / 2);
+  }
+  Config config = MakeConfig(damaged_file, true);
+  EXPECT_ANY_THROW(CreatePredictor(config));
+}
+
+}  // namespace paddle_infer
@@ -0,0 +1,129 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "paddle/common/flags.h"
+#include "paddle/fluid/inference/api/paddle_serving_runtime.h"
+#include "test/cpp/inference/api/tester_helper.h"
+
+namespace paddle_infer {
+
+namespace {
+
+std::vector<paddle::PaddleTensor> MakeInput(int batch_size, float value) {
+  paddle::PaddleTensor input;
+  input.shape = {batch_size, 3, 224, 224};
+  input.dtype = DataType::FLOAT32;
+  int num = batch_size * 3 * 224 * 224;
+  input.data.Resize(num * sizeof(float));
+  float *data = static_cast<float *>(input.data.data());
+  for (int i = 0; i < num; ++i) {
+    data[i] = value * (i % 255) / 255;
+  }
+  return {input};
+}
+
+Config MakeConfig() {
+  std::string model_dir = FLAGS_infer_model + "/model";
+  Config config;
+  config.SetModel(model_dir + "/model", model_dir + "/params");
+  config.DisableGpu();
+  config.SetCpuMathLibraryNumThreads(1);
+  return config;
+}
+
+}  // namespace
+
+TEST(ServingRuntime, batched_equals_alone) {
+  Config config = MakeConfig();
+  services::ServingConfig alone_config;
+  std::vector<std::vector<paddle::PaddleTensor>> expected;
+  {
+    services::ServingRuntime runtime(config, alone_config);
+    for (int i = 0; i < 6; ++i) {
+      std::vector<paddle::PaddleTensor> outputs;
+      ASSERT_TRUE(runtime.Run(MakeInput(1, 0.1 * i), &outputs));
+      expected.push_back(std::move(outputs));
+    }
+  }
+
+  services::ServingConfig serving_config;
+  serving_config.num_predictors = 2;
+  serving_config.max_batch_size = 4;
+  serving_config.batch_timeout_us = 100000;
+  services::ServingRuntime runtime(config, serving_config);
+  std::vector<std::future<std::vector<paddle::PaddleTensor>>> futures;
+  for (int i = 0; i < 6; ++i) {
+    futures.push_back(runtime.Submit(MakeInput(1, 0.1 * i)));
+  }
+  for (int i = 0; i < 6; ++i) {
+    auto outputs = futures[i].get();
+    ASSERT_EQ(outputs.size(), expected[i].size());
+    ASSERT_EQ(outputs[0].shape, expected[i][0].shape);
+    const float *data = static_cast<const float *>(outputs[0].data.data());
+    const float *expected_data =
+        static_cast<const float *>(expected[i][0].data.data());
+    for (size_t j = 0; j < outputs[0].data.length() / sizeof(float); ++j) {
+      EXPECT_NEAR(data[j], expected_data[j], 1e-5);
+    }
+  }
+
+  auto stats = runtime.GetStats();
+  EXPECT_EQ(stats.requests, 6UL);
+  EXPECT_LT(stats.batches, 6UL);
+  EXPECT_EQ(stats.queue_latency.Count(), 6UL);
+  EXPECT_EQ(stats.compute_latency.Count(), stats.batches);
+  LOG(INFO) << "batches: " << stats.batches
+            << ", queue p99: " << stats.queue_latency.Percentile(0.99)
+            << "us, compute p99: " << stats.compute_latency.Percentile(0.99)
+            << "us";
+}
+
+TEST(ServingRuntime, concurrent_clients) {
+  services::ServingConfig serving_config;
+  serving_config.num_predictors = 2;
+  serving_config.max_batch_size = 8;
+  serving_config.batch_timeout_us = 2000;
+  services::ServingRuntime runtime(MakeConfig(), serving_config);
+  std::vector<std::thread> clients;
+  for (int t = 0; t < 4; ++t) {
+    clients.emplace_back([&runtime, t] {
+      for (int i = 0; i < 4; ++i) {
+        std::vector<paddle::PaddleTensor> outputs;
+        EXPECT_TRUE(runtime.Run(MakeInput(1 + (t + i) % 2, 0.5), &outputs));
+        EXPECT_EQ(outputs[0].shape[0], 1 + (t + i) % 2);
+      }
+    });
+  }
+  for (auto &client : clients) {
+    client.join();
+  }
+  EXPECT_EQ(runtime.GetStats().requests, 16UL);
+}
+
+TEST(ServingRuntime, invalid_request) {
+  services::ServingRuntime runtime(MakeConfig(), services::ServingConfig());
+  auto inputs = MakeInput(1, 0.5);
+  inputs[0].data.Resize(16);
+  std::vector<paddle::PaddleTensor> outputs;
+  EXPECT_FALSE(runtime.Run(inputs, &outputs));
+}
+
+}  // namespace paddle_infer
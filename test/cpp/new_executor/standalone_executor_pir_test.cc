@@ -16,6 +16,7 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <string>
@@ -28,6 +29,7 @@
 #include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
 #include "paddle/fluid/pir/transforms/pd_op_to_kernel_pass.h"
 #include "paddle/pir/include/core/builder.h"
+#include "paddle/pir/include/core/builtin_attribute.h"
 #include "paddle/pir/include/core/ir_context.h"
 #include "paddle/pir/include/core/program.h"
 
@@ -46,6 +48,8 @@ PD_DECLARE_KERNEL(add, CPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(sqrt, CPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(less_than, CPU, ALL_LAYOUT);
 
+COMMON_DECLARE_bool(new_executor_use_work_stealing);
+
 bool simple_cmp(float a, float b) { return std::abs((a - b) / a) < 1e-5; }
 
 namespace paddle {
@@ -176,6 +180,81 @@ TEST(StandaloneExecutor, run_feed_tensor) {
   EXPECT_EQ(res0, true);
 }
 
+TEST(StandaloneExecutor, shape_bucket_cache) {
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  pir::Program program(ctx);
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  pir::Builder builder = pir::Builder(ctx, program.block());
+
+  pir::OpInfo feed_op_info =
+      ctx->GetRegisteredOpInfo(paddle::dialect::FeedOp::name());
+  pir::Type dense_tensor_dtype =
+      paddle::dialect::DenseTensorType::get(ctx,
+                                            pir::Float32Type::get(ctx),
+                                            phi::DDim{-1, 4},
+                                            phi::DataLayout::NCHW,
+                                            phi::LoD(),
+                                            0);
+  std::vector<pir::Value> feeds;
+  for (std::string name : {"x", "y"}) {
+    pir::AttributeMap attr_map;
+    attr_map.insert({"name", pir::StrAttribute::get(ctx, name)});
+    attr_map.insert({"col", pir::Int32Attribute::get(ctx, 0)});
+    pir::Operation* feed_op = pir::Operation::Create(
+        {}, attr_map, {dense_tensor_dtype}, feed_op_info);
+    program.block()->push_back(feed_op);
+    feeds.push_back(feed_op->result(0));
+  }
+  auto sum = builder.Build<paddle::dialect::AddOp>(feeds[0], feeds[1]).out();
+  auto out = builder.Build<paddle::dialect::AddOp>(sum, sum).out();
+  std::string out_name = "add_out";
+  builder.Build<pir::ShadowOutputOp>(out, out_name);
+
+  auto kernel_program = paddle::dialect::PdOpLowerToKernelPass(&program);
+
+  interpreter::ExecutionConfig execution_config;
+  execution_config.used_for_inference = true;
+  execution_config.skip_gc_vars.insert(out_name);
+  Scope scope;
+  InterpreterCore test_core(
+      phi::CPUPlace(), {}, kernel_program->block(), &scope, execution_config);
+
+  phi::DeviceContext* dev_ctx =
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace());
+  for (int64_t rows : {2, 3, 2}) {
+    phi::DenseTensor tensor_x;
+    tensor_x.Resize({rows, 4});
+    dev_ctx->Alloc(&tensor_x, phi::DataType::FLOAT32);
+    phi::DenseTensor tensor_y;
+    tensor_y.Resize({rows, 4});
+    dev_ctx->Alloc(&tensor_y, phi::DataType::FLOAT32);
+    for (int64_t i = 0; i < rows * 4; ++i) {
+      tensor_x.data<float>()[i] = 1.0;
+      tensor_y.data<float>()[i] = i;
+    }
+
+    test_core.Run({"x", "y"}, {tensor_x, tensor_y});
+
+    const Scope* out_scope =
+        test_core.local_scope() == nullptr ? &scope : test_core.local_scope();
+    auto out_tensor = out_scope->FindVar(out_name)->Get<phi::DenseTensor>();
+    ASSERT_EQ(out_tensor.dims(), common::make_ddim({rows, 4}));
+    for (int64_t i = 0; i < rows * 4; ++i) {
+      EXPECT_TRUE(simple_cmp(out_tensor.data<float>()[i], 2.0 * (i + 1)));
+    }
+  }
+
+  // The third run has the shapes of the first one, so both adds reuse
+  // their inferred meta.
+  auto* interpreter = dynamic_cast<const PirInterpreter*>(test_core.Impl());
+  ASSERT_NE(interpreter, nullptr);
+  auto stats = interpreter->GetShapeBucketCacheStats();
+  EXPECT_EQ(stats.bucket_misses, 2u);
+  EXPECT_EQ(stats.bucket_hits, 1u);
+  EXPECT_EQ(stats.infer_meta_misses, 4u);
+  EXPECT_EQ(stats.infer_meta_hits, 2u);
+}
+
 TEST(StandaloneExecutor, run_inplace_sqrt) {
   pir::IrContext* ctx = pir::IrContext::Instance();
   pir::Program program((ctx));
@@ -218,6 +297,93 @@ TEST(StandaloneExecutor, run_inplace_sqrt) {
   EXPECT_EQ(res3, true);
 }
 
+TEST(StandaloneExecutor, run_work_stealing) {
+  FLAGS_new_executor_use_work_stealing = true;
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  pir::Program program((ctx));
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  pir::Builder builder = pir::Builder(ctx, program.block());
+
+  // A wide graph: 8 independent chains of adds reduced by a tree of adds.
+  // The chain i has i adds, and the first one has an explicit priority.
+  std::vector<pir::Value> branches;
+  for (int i = 0; i < 8; ++i) {
+    auto full_op =
+        builder.Build<paddle::dialect::FullOp>(std::vector<int64_t>{2, 2},
+                                               1.0,
+                                               phi::DataType::FLOAT32,
+                                               phi::CPUPlace());
+    if (i == 0) {
+      full_op->set_attribute("scheduling_priority",
+                             pir::Int64Attribute::get(ctx, -1));
+    }
+    pir::Value value = full_op->result(0);
+    for (int j = 0; j < i; ++j) {
+      value = builder.Build<paddle::dialect::AddOp>(value, value)->result(0);
+    }
+    branches.push_back(value);
+  }
+  while (branches.size() > 1) {
+    std::vector<pir::Value> merged;
+    for (size_t i = 0; i < branches.size(); i += 2) {
+      merged.push_back(
+          builder.Build<paddle::dialect::AddOp>(branches[i], branches[i + 1])
+              ->result(0));
+    }
+    branches.swap(merged);
+  }
+
+  std::string out_name = "add_out";
+  builder.Build<pir::ShadowOutputOp>(branches[0], out_name);
+
+  auto kernel_program = paddle::dialect::PdOpLowerToKernelPass(&program);
+
+  auto place = phi::CPUPlace();
+  Scope scope;
+  InterpreterCore test_core(place, {}, kernel_program->block(), &scope);
+
+  test_core.SetSkipGcVars({out_name});
+
+  for (int run = 0; run < 3; ++run) {
+    test_core.Run({});
+
+    auto out_tensor = test_core.local_scope() == nullptr
+                          ? scope.FindVar(out_name)->Get<phi::DenseTensor>()
+                          : test_core.local_scope()
+                                ->FindVar(out_name)
+                                ->Get<phi::DenseTensor>();
+    // sum(2^i) for i in [0, 8)
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_EQ(simple_cmp(out_tensor.data<float>()[i], 255.0), true);
+    }
+  }
+
+  // The explicit priority comes first, then the ready fulls are ordered by
+  // the length of their chains.
+  auto* interpreter = dynamic_cast<const PirInterpreter*>(test_core.Impl());
+  ASSERT_NE(interpreter, nullptr);
+  std::vector<pir::Operation*> full_ops;
+  for (auto& op : *kernel_program->block()) {
+    if (op.attribute<pir::StrAttribute>("op_name").AsString() ==
+        "pd_op.full") {
+      full_ops.push_back(&op);
+    }
+  }
+  ASSERT_EQ(full_ops.size(), 8u);
+  std::vector<pir::Operation*> full_order;
+  for (pir::Operation* op : interpreter->GetWorkStealingOrder()) {
+    if (std::find(full_ops.begin(), full_ops.end(), op) != full_ops.end()) {
+      full_order.push_back(op);
+    }
+  }
+  std::vector<pir::Operation*> expected_order = {full_ops[0]};
+  for (int i = 7; i > 0; --i) {
+    expected_order.push_back(full_ops[i]);
+  }
+  EXPECT_EQ(full_order, expected_order);
+  FLAGS_new_executor_use_work_stealing = false;
+}
+
 TEST(StandaloneExecutor, if_op) {
   pir::IrContext* ctx = pir::IrContext::Instance();
   ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
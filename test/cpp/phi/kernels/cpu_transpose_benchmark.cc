@@ -0,0 +1,90 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/core/os_info.h"
+#include "paddle/phi/kernels/funcs/cpu_transpose.h"
+
+PD_DEFINE_int32(burning, 2, "Burning times.");
+PD_DEFINE_int32(repeat, 10, "Repeat times.");
+PD_DEFINE_int32(threads, 4, "The most intra op threads.");
+
+namespace phi {
+namespace {
+
+// Returns the average time of a transpose of float dims by axis in us.
+double BenchTranspose(const phi::CPUContext& dev_ctx,
+                      const std::vector<int64_t>& dims,
+                      const std::vector<int>& axis) {
+  int64_t numel = 1;
+  for (int64_t dim : dims) numel *= dim;
+  std::vector<float> in(numel, 1.0f);
+  std::vector<float> out(numel);
+  auto transpose = [&]() {
+    phi::funcs::TransposeCPU(dev_ctx,
+                             in.data(),
+                             out.data(),
+                             sizeof(float),
+                             common::make_ddim(dims),
+                             axis);
+  };
+  for (int i = 0; i < FLAGS_burning; ++i) transpose();
+  const uint64_t start = phi::PosixInNsec();
+  for (int i = 0; i < FLAGS_repeat; ++i) transpose();
+  const uint64_t end = phi::PosixInNsec();
+  return (end - start) / 1000.0 / FLAGS_repeat;
+}
+
+}  // namespace
+}  // namespace phi
+
+// Benchmark the tiled CPU transpose on the layout changes of common
+// models. To use this tool, run command:
+// ./cpu_transpose_benchmark [options...]
+// Options:
+//     --burning: the burning time before count
+//     --repeat: the repeat times
+//     --threads: the most intra op threads, doubled from 1
+int main(int argc, char* argv[]) {
+  paddle::flags::ParseCommandLineFlags(&argc, &argv);
+  google::InitGoogleLogging(argv[0]);
+  LOG(INFO) << "Burning " << FLAGS_burning << " times, Repeat " << FLAGS_repeat
+            << " times.";
+  auto* dev_ctx = static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+  struct Case {
+    const char* name;
+    std::vector<int64_t> dims;
+    std::vector<int> axis;
+  };
+  std::vector<Case> cases = {
+      {"NCHW to NHWC", {8, 256, 56, 56}, {0, 2, 3, 1}},
+      {"NHWC to NCHW", {8, 56, 56, 256}, {0, 3, 1, 2}},
+      {"batched matrix", {8, 256, 56 * 56}, {0, 2, 1}},
+      {"attention heads", {8, 512, 16, 64}, {0, 2, 1, 3}}};
+  for (const auto& c : cases) {
+    for (int num_threads = 1; num_threads <= FLAGS_threads; num_threads *= 2) {
+      phi::SetIntraOpNumThreads(num_threads);
+      LOG(INFO) << "float transpose " << c.name << " with " << num_threads
+                << " threads: " << phi::BenchTranspose(*dev_ctx, c.dims, c.axis)
+                << " us.";
+    }
+  }
+  phi::SetIntraOpNumThreads(1);
+  return 0;
+}
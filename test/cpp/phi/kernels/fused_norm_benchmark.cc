@@ -0,0 +1,293 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <random>
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/os_info.h"
+#include "paddle/phi/core/tensor_utils.h"
+#include "paddle/phi/kernels/cpu/elementwise.h"
+#include "paddle/phi/kernels/funcs/elementwise_base.h"
+#include "paddle/phi/kernels/funcs/elementwise_functor.h"
+#include "paddle/phi/kernels/funcs/fused_norm.h"
+#include "paddle/phi/kernels/funcs/jit/kernels.h"
+#include "paddle/phi/kernels/funcs/layer_norm_util.h"
+
+PD_DEFINE_int32(burning, 5, "Burning times.");
+PD_DEFINE_int32(repeat, 50, "Repeat times.");
+PD_DEFINE_int32(rows, 64, "The rows normalized by each call.");
+PD_DEFINE_int32(threads, 1, "The intra op threads.");
+
+namespace phi {
+namespace {
+
+using phi::funcs::NormType;
+
+template <typename T>
+void RandomFill(T* data, int64_t n, float lower, float upper) {
+  static unsigned int seed = 100;
+  std::mt19937 rng(seed++);
+  std::uniform_real_distribution<float> dist(lower, upper);
+  for (int64_t i = 0; i < n; ++i) data[i] = static_cast<T>(dist(rng));
+}
+
+// Returns the average time of func in us.
+template <typename Func>
+double Bench(const Func& func) {
+  for (int i = 0; i < FLAGS_burning; ++i) func();
+  const uint64_t start = phi::PosixInNsec();
+  for (int i = 0; i < FLAGS_repeat; ++i) func();
+  const uint64_t end = phi::PosixInNsec();
+  return (end - start) / 1000.0 / FLAGS_repeat;
+}
+
+// The layer_norm_grad CPU kernel before the fused engine, a pass over the
+// whole matrix for each step. x, dy, dx and dscale are [rows, cols], mean
+// and var [rows].
+void LayerNormGradElementwise(const CPUContext& dev_ctx,
+                              const DenseTensor& x,
+                              const DenseTensor& scale,
+                              const DenseTensor& mean,
+                              const DenseTensor& var,
+                              const DenseTensor& dy,
+                              float epsilon,
+                              DenseTensor* dx,
+                              DenseTensor* dscale,
+                              DenseTensor* dbias) {
+  const int rows = static_cast<int>(x.dims()[0]);
+  const int cols = static_cast<int>(x.dims()[1]);
+  funcs::ColwiseSum2D<CPUContext, float> colwise_sum(rows, cols, dev_ctx);
+  funcs::RowwiseMean2D<CPUContext, float> row_mean(rows, cols, dev_ctx);
+
+  DenseTensor temp;
+  temp.Resize(x.dims());
+  dev_ctx.Alloc<float>(&temp);
+  DenseTensor temp_norm;
+  temp_norm.Resize(x.dims());
+  dev_ctx.Alloc<float>(&temp_norm);
+  funcs::ElementwiseCompute<funcs::SubtractFunctor<float>, float>(
+      dev_ctx, x, mean, funcs::SubtractFunctor<float>(), &temp_norm, 0);
+  funcs::ElementwiseCompute<funcs::DivAndSqrtFunctor<float>, float>(
+      dev_ctx,
+      temp_norm,
+      var,
+      funcs::DivAndSqrtFunctor<float>(epsilon),
+      &temp_norm,
+      0);
+
+  colwise_sum(dev_ctx, dy, dbias);
+  funcs::ElementwiseCompute<funcs::MultiplyFunctor<float>, float>(
+      dev_ctx, temp_norm, dy, funcs::MultiplyFunctor<float>(), &temp, 0);
+  colwise_sum(dev_ctx, temp, dscale);
+
+  DenseTensor temp_vec;
+  temp_vec.Resize({rows});
+  dev_ctx.Alloc<float>(&temp_vec);
+  funcs::ElementwiseCompute<funcs::MultiplyFunctor<float>, float>(
+      dev_ctx, dy, scale, funcs::MultiplyFunctor<float>(), &temp, 1);
+  phi::Copy<CPUContext>(dev_ctx, temp, dev_ctx.GetPlace(), false, dx);
+  row_mean(dev_ctx, temp, &temp_vec);
+  funcs::ElementwiseCompute<funcs::SubtractFunctor<float>, float>(
+      dev_ctx, *dx, temp_vec, funcs::SubtractFunctor<float>(), dx, 0);
+  funcs::ElementwiseCompute<funcs::MultiplyFunctor<float>, float>(
+      dev_ctx, temp, temp_norm, funcs::MultiplyFunctor<float>(), &temp, 0);
+  row_mean(dev_ctx, temp, &temp_vec);
+  funcs::ElementwiseCompute<funcs::MultiplyFunctor<float>, float>(
+      dev_ctx, temp_norm, temp_vec, funcs::MultiplyFunctor<float>(), &temp, 0);
+  funcs::ElementwiseCompute<funcs::SubtractFunctor<float>, float>(
+      dev_ctx, *dx, temp, funcs::SubtractFunctor<float>(), dx, 0);
+  funcs::ElementwiseCompute<funcs::DivAndSqrtFunctor<float>, float>(
+      dev_ctx, *dx, var, funcs::DivAndSqrtFunctor<float>(epsilon), dx, 0);
+}
+
+DenseTensor RandomTensor(const CPUContext& dev_ctx,
+                         const DDim& dims,
+                         float lower,
+                         float upper) {
+  DenseTensor tensor;
+  tensor.Resize(dims);
+  RandomFill(dev_ctx.Alloc<float>(&tensor), tensor.numel(), lower, upper);
+  return tensor;
+}
+
+DenseTensor OutputTensor(const CPUContext& dev_ctx, const DDim& dims) {
+  DenseTensor tensor;
+  tensor.Resize(dims);
+  dev_ctx.Alloc<float>(&tensor);
+  return tensor;
+}
+
+// fp32 layer_norm against the jit kernel, which was its forward before the
+// fused engine, and against the elementwise passes of its old backward.
+void BenchLayerNormFP32(const CPUContext& dev_ctx, int rows, int cols) {
+  const float epsilon = 1e-5f;
+  DenseTensor x = RandomTensor(dev_ctx, {rows, cols}, -1.0f, 1.0f);
+  DenseTensor dy = RandomTensor(dev_ctx, {rows, cols}, -1.0f, 1.0f);
+  DenseTensor gamma = RandomTensor(dev_ctx, {cols}, 0.5f, 1.5f);
+  DenseTensor beta = RandomTensor(dev_ctx, {cols}, -0.5f, 0.5f);
+  DenseTensor y = OutputTensor(dev_ctx, {rows, cols});
+  DenseTensor dx = OutputTensor(dev_ctx, {rows, cols});
+  DenseTensor mean = OutputTensor(dev_ctx, {rows});
+  DenseTensor var = OutputTensor(dev_ctx, {rows});
+  DenseTensor rstd = OutputTensor(dev_ctx, {rows});
+  DenseTensor dgamma = OutputTensor(dev_ctx, {cols});
+  DenseTensor dbeta = OutputTensor(dev_ctx, {cols});
+
+  const double fused_forward = Bench([&]() {
+    funcs::NormForwardCPU<float, float>(dev_ctx,
+                                        NormType::kLayerNorm,
+                                        x.data<float>(),
+                                        nullptr,
+                                        nullptr,
+                                        gamma.data<float>(),
+                                        beta.data<float>(),
+                                        rows,
+                                        cols,
+                                        epsilon,
+                                        nullptr,
+                                        y.data<float>(),
+                                        mean.data<float>(),
+                                        var.data<float>(),
+                                        rstd.data<float>());
+  });
+  auto jit_layer_norm =
+      jit::KernelFuncs<jit::LayerNormTuple<float>, CPUPlace>::Cache().At(cols);
+  const double jit_forward = Bench([&]() {
+    jit_layer_norm(x.data<float>(),
+                   y.data<float>(),
+                   mean.data<float>(),
+                   var.data<float>(),
+                   gamma.data<float>(),
+                   beta.data<float>(),
+                   rows,
+                   epsilon,
+                   cols);
+  });
+
+  const double fused_backward = Bench([&]() {
+    funcs::NormBackwardCPU<float, float>(dev_ctx,
+                                         NormType::kLayerNorm,
+                                         x.data<float>(),
+                                         dy.data<float>(),
+                                         gamma.data<float>(),
+                                         mean.data<float>(),
+                                         rstd.data<float>(),
+                                         rows,
+                                         cols,
+                                         dx.data<float>(),
+                                         dgamma.data<float>(),
+                                         dbeta.data<float>());
+  });
+  const double elementwise_backward = Bench([&]() {
+    LayerNormGradElementwise(
+        dev_ctx, x, gamma, mean, var, dy, epsilon, &dx, &dgamma, &dbeta);
+  });
+
+  LOG(INFO) << "fp32 layer_norm of " << rows << " x " << cols
+            << ": forward fused " << fused_forward << " us, jit "
+            << jit_forward << " us; backward fused " << fused_backward
+            << " us, elementwise " << elementwise_backward << " us.";
+}
+
+// bf16 layer_norm and rms_norm had no CPU kernel before the fused engine.
+void BenchNormBF16(const CPUContext& dev_ctx,
+                   NormType type,
+                   int rows,
+                   int cols) {
+  std::vector<phi::dtype::bfloat16> x(rows * cols);
+  std::vector<phi::dtype::bfloat16> dy(rows * cols);
+  RandomFill(x.data(), rows * cols, -1.0f, 1.0f);
+  RandomFill(dy.data(), rows * cols, -1.0f, 1.0f);
+  std::vector<float> gamma(cols);
+  std::vector<float> beta(cols);
+  RandomFill(gamma.data(), cols, 0.5f, 1.5f);
+  RandomFill(beta.data(), cols, -0.5f, 0.5f);
+  std::vector<phi::dtype::bfloat16> y(rows * cols);
+  std::vector<phi::dtype::bfloat16> dx(rows * cols);
+  std::vector<float> mean(rows);
+  std::vector<float> var(rows);
+  std::vector<float> rstd(rows);
+  std::vector<float> dgamma(cols);
+  std::vector<float> dbeta(cols);
+  const bool layer_norm = type == NormType::kLayerNorm;
+
+  const double forward = Bench([&]() {
+    funcs::NormForwardCPU<phi::dtype::bfloat16, float>(
+        dev_ctx,
+        type,
+        x.data(),
+        nullptr,
+        nullptr,
+        gamma.data(),
+        layer_norm ? beta.data() : nullptr,
+        rows,
+        cols,
+        1e-5f,
+        nullptr,
+        y.data(),
+        layer_norm ? mean.data() : nullptr,
+        layer_norm ? var.data() : nullptr,
+        rstd.data());
+  });
+  const double backward = Bench([&]() {
+    funcs::NormBackwardCPU<phi::dtype::bfloat16, float>(
+        dev_ctx,
+        type,
+        x.data(),
+        dy.data(),
+        gamma.data(),
+        layer_norm ? mean.data() : nullptr,
+        rstd.data(),
+        rows,
+        cols,
+        dx.data(),
+        dgamma.data(),
+        layer_norm ? dbeta.data() : nullptr);
+  });
+  LOG(INFO) << "bf16 " << (layer_norm ? "layer_norm" : "rms_norm") << " of "
+            << rows << " x " << cols << ": forward " << forward
+            << " us, backward " << backward << " us.";
+}
+
+}  // namespace
+}  // namespace phi
+
+// Benchmark the fused LayerNorm and RMSNorm engine at the hidden sizes of
+// common transformers. To use this tool, run command:
+// ./fused_norm_benchmark [options...]
+// Options:
+//     --burning: the burning time before count
+//     --repeat: the repeat times
+//     --rows: the rows normalized by each call
+//     --threads: the intra op threads
+int main(int argc, char* argv[]) {
+  paddle::flags::ParseCommandLineFlags(&argc, &argv);
+  google::InitGoogleLogging(argv[0]);
+  LOG(INFO) << "Burning " << FLAGS_burning << " times, Repeat " << FLAGS_repeat
+            << " times, " << FLAGS_threads << " threads.";
+  phi::SetIntraOpNumThreads(FLAGS_threads);
+  auto* dev_ctx = static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+  for (int cols : {768, 1024, 2048, 4096, 8192}) {
+    phi::BenchLayerNormFP32(*dev_ctx, FLAGS_rows, cols);
+    phi::BenchNormBF16(
+        *dev_ctx, phi::funcs::NormType::kLayerNorm, FLAGS_rows, cols);
+    phi::BenchNormBF16(
+        *dev_ctx, phi::funcs::NormType::kRmsNorm, FLAGS_rows, cols);
+  }
+}
@@ -0,0 +1,148 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/kernels/funcs/elementwise_base.h"
+#include "paddle/phi/kernels/funcs/elementwise_functor.h"
+
+namespace phi {
+namespace tests {
+
+void FillTensor(const phi::CPUContext& dev_ctx,
+                const std::vector<int64_t>& dims,
+                float base,
+                phi::DenseTensor* tensor) {
+  tensor->Resize(common::make_ddim(dims));
+  float* data = dev_ctx.template Alloc<float>(tensor);
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = base + static_cast<float>(i);
+  }
+}
+
+// x - y by the index of every output element.
+std::vector<float> ReferenceSubtract(const phi::DenseTensor& x,
+                                     const phi::DenseTensor& y,
+                                     int axis) {
+  int max_dim = std::max(x.dims().size(), y.dims().size());
+  axis = axis == -1 ? std::abs(x.dims().size() - y.dims().size()) : axis;
+  // The trailing 1-dims of the operand of the smaller rank may end past the
+  // other one.
+  phi::DDim x_trimmed = x.dims();
+  phi::DDim y_trimmed = y.dims();
+  phi::DDim& smaller = x.dims().size() >= y.dims().size() ? y_trimmed
+                                                          : x_trimmed;
+  smaller = phi::funcs::TrimTrailingSingularDims(smaller);
+  if (smaller.size() == 0) axis = max_dim;
+  std::vector<int> x_dims(max_dim);
+  std::vector<int> y_dims(max_dim);
+  std::vector<int> out_dims(max_dim);
+  phi::funcs::GetBroadcastDimsArrays(x_trimmed,
+                                     y_trimmed,
+                                     x_dims.data(),
+                                     y_dims.data(),
+                                     out_dims.data(),
+                                     max_dim,
+                                     axis);
+  int64_t numel = 1;
+  for (int dim : out_dims) numel *= dim;
+  std::vector<float> out(numel);
+  std::vector<int> index(max_dim, 0);
+  for (int64_t i = 0; i < numel; ++i) {
+    int x_index =
+        phi::funcs::GetElementwiseIndex(x_dims.data(), max_dim, index.data());
+    int y_index =
+        phi::funcs::GetElementwiseIndex(y_dims.data(), max_dim, index.data());
+    out[i] = x.data<float>()[x_index] - y.data<float>()[y_index];
+    phi::funcs::UpdateElementwiseIndexArray(
+        out_dims.data(), max_dim, index.data());
+  }
+  return out;
+}
+
+TEST(cpu_broadcast, subtract) {
+  auto* dev_ctx = static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+  struct Case {
+    std::vector<int64_t> x_dims;
+    std::vector<int64_t> y_dims;
+    int axis;
+  };
+  std::vector<Case> cases = {{{2, 3, 4, 5}, {5}, -1},
+                             {{2, 3, 4, 5}, {3, 1}, 1},
+                             {{2, 3, 1, 5}, {2, 1, 4, 1}, -1},
+                             {{64, 1}, {1, 1024}, -1},
+                             {{32, 64, 32}, {1, 64, 1}, -1},
+                             {{7}, {5, 3, 7}, -1},
+                             {{3, 1}, {2, 3, 4}, 1},
+                             {{2, 3}, {3, 1}, 1},
+                             {{2, 3, 4}, {1, 1}, -1}};
+  for (int num_threads : {1, 4}) {
+    phi::SetIntraOpNumThreads(num_threads);
+    for (const auto& c : cases) {
+      phi::DenseTensor x;
+      phi::DenseTensor y;
+      phi::DenseTensor out;
+      FillTensor(*dev_ctx, c.x_dims, 0.5f, &x);
+      FillTensor(*dev_ctx, c.y_dims, -3.0f, &y);
+      std::vector<float> expected = ReferenceSubtract(x, y, c.axis);
+      out.Resize({static_cast<int64_t>(expected.size())});
+      if (x.dims().size() >= y.dims().size()) {
+        phi::funcs::ElementwiseCompute<phi::funcs::SubtractFunctor<float>,
+                                       float>(
+            *dev_ctx,
+            x,
+            y,
+            phi::funcs::SubtractFunctor<float>(),
+            &out,
+            c.axis);
+      } else {
+        phi::funcs::ElementwiseCompute<
+            phi::funcs::InverseSubtractFunctor<float>,
+            float>(*dev_ctx,
+                   x,
+                   y,
+                   phi::funcs::InverseSubtractFunctor<float>(),
+                   &out,
+                   c.axis);
+      }
+      ASSERT_EQ(out.numel(), static_cast<int64_t>(expected.size()));
+      for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(out.data<float>()[i], expected[i]);
+      }
+    }
+  }
+  phi::SetIntraOpNumThreads(1);
+}
+
+TEST(cpu_broadcast, zero_size) {
+  auto* dev_ctx = static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+  phi::DenseTensor x;
+  phi::DenseTensor y;
+  phi::DenseTensor out;
+  FillTensor(*dev_ctx, {0, 3}, 0.5f, &x);
+  FillTensor(*dev_ctx, {3}, -3.0f, &y);
+  out.Resize({0, 3});
+  phi::funcs::ElementwiseCompute<phi::funcs::SubtractFunctor<float>, float>(
+      *dev_ctx, x, y, phi::funcs::SubtractFunctor<float>(), &out);
+  EXPECT_EQ(out.numel(), 0);
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,116 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/common/complex.h"
+#include "paddle/phi/kernels/funcs/cpu_transpose.h"
+
+namespace phi {
+namespace tests {
+
+// out[o] = in[i] where the coordinates of o are those of i permuted by axis.
+template <typename T>
+std::vector<T> ReferenceTranspose(const std::vector<T>& in,
+                                  const std::vector<int64_t>& dims,
+                                  const std::vector<int>& axis) {
+  const int rank = static_cast<int>(dims.size());
+  std::vector<int64_t> in_strides(rank, 1);
+  std::vector<int64_t> out_strides(rank, 1);
+  for (int i = rank - 2; i >= 0; --i) {
+    in_strides[i] = in_strides[i + 1] * dims[i + 1];
+    out_strides[i] = out_strides[i + 1] * dims[axis[i + 1]];
+  }
+  std::vector<T> out(in.size());
+  for (int64_t o = 0; o < static_cast<int64_t>(out.size()); ++o) {
+    int64_t rest = o;
+    int64_t i = 0;
+    for (int k = 0; k < rank; ++k) {
+      i += rest / out_strides[k] * in_strides[axis[k]];
+      rest %= out_strides[k];
+    }
+    out[o] = in[i];
+  }
+  return out;
+}
+
+template <typename T>
+void TestTranspose(const std::vector<int64_t>& dims,
+                   const std::vector<int>& axis) {
+  auto* dev_ctx = static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+  const int64_t numel = std::accumulate(
+      dims.begin(), dims.end(), int64_t(1), std::multiplies<int64_t>());
+  std::vector<T> in(numel);
+  for (int64_t i = 0; i < numel; ++i) in[i] = static_cast<T>(i % 251);
+  std::vector<T> out(numel, static_cast<T>(0));
+  phi::funcs::TransposeCPU(*dev_ctx,
+                           in.data(),
+                           out.data(),
+                           sizeof(T),
+                           common::make_ddim(dims),
+                           axis);
+  EXPECT_TRUE(out == ReferenceTranspose(in, dims, axis));
+}
+
+template <typename T>
+void TestRandomTransposes(int cases) {
+  std::mt19937 rng(2024);
+  for (int c = 0; c < cases; ++c) {
+    const int rank = 1 + static_cast<int>(rng() % 6);
+    // A few large 2D and 3D shapes, so that more than one tile is used.
+    const int64_t max_dim = rank <= 3 && c % 4 == 0 ? 150 : 7;
+    std::vector<int64_t> dims(rank);
+    for (auto& dim : dims) dim = 1 + static_cast<int64_t>(rng() % max_dim);
+    std::vector<int> axis(rank);
+    std::iota(axis.begin(), axis.end(), 0);
+    std::shuffle(axis.begin(), axis.end(), rng);
+    TestTranspose<T>(dims, axis);
+  }
+}
+
+TEST(cpu_transpose, random) {
+  for (int num_threads : {1, 4}) {
+    phi::SetIntraOpNumThreads(num_threads);
+    TestRandomTransposes<uint8_t>(200);
+    TestRandomTransposes<int16_t>(200);
+    TestRandomTransposes<float>(200);
+    TestRandomTransposes<double>(200);
+    TestRandomTransposes<phi::dtype::complex<double>>(200);
+  }
+  phi::SetIntraOpNumThreads(1);
+}
+
+TEST(cpu_transpose, special_shapes) {
+  // Rank 0, an identity perm and dims of 1 everywhere.
+  TestTranspose<float>({}, {});
+  TestTranspose<float>({3, 5, 7}, {0, 1, 2});
+  TestTranspose<float>({1, 1, 1}, {2, 0, 1});
+  // The innermost dim stays, only rows move.
+  TestTranspose<float>({4, 6, 33}, {1, 0, 2});
+  // NCHW to NHWC and back, and a batched matrix transpose.
+  TestTranspose<float>({2, 35, 9, 11}, {0, 2, 3, 1});
+  TestTranspose<float>({2, 9, 11, 35}, {0, 3, 1, 2});
+  TestTranspose<double>({3, 67, 130}, {0, 2, 1});
+  // More than 6 dims.
+  TestTranspose<float>({2, 3, 2, 3, 2, 3, 2}, {6, 5, 4, 3, 2, 1, 0});
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,351 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/backends/cpu/cpu_info.h"
+#include "paddle/phi/kernels/funcs/fused_norm.h"
+
+namespace phi {
+namespace tests {
+
+using phi::funcs::NormType;
+
+template <typename T>
+std::vector<T> RandomVector(int64_t n, float lower, float upper) {
+  static unsigned int seed = 100;
+  std::mt19937 rng(seed++);
+  std::uniform_real_distribution<float> dist(lower, upper);
+  std::vector<T> data(n);
+  for (auto& value : data) value = static_cast<T>(dist(rng));
+  return data;
+}
+
+// The forward and backward of LayerNorm or RMSNorm in double, on inputs
+// already rounded to T.
+struct NormReference {
+  std::vector<double> y;
+  std::vector<double> mean;
+  std::vector<double> rstd;
+  std::vector<double> dx;
+  std::vector<double> dgamma;
+  std::vector<double> dbeta;
+};
+
+template <typename T>
+NormReference ComputeNormReference(NormType type,
+                                   const std::vector<T>& x,
+                                   const std::vector<T>& dy,
+                                   const std::vector<float>& gamma,
+                                   const std::vector<float>& beta,
+                                   int64_t rows,
+                                   int64_t cols,
+                                   float epsilon) {
+  NormReference ref;
+  ref.y.resize(rows * cols);
+  ref.dx.resize(rows * cols);
+  ref.mean.resize(rows);
+  ref.rstd.resize(rows);
+  ref.dgamma.assign(cols, 0.0);
+  ref.dbeta.assign(cols, 0.0);
+  for (int64_t i = 0; i < rows; ++i) {
+    auto value = [&](const std::vector<T>& v, int64_t j) {
+      return static_cast<double>(static_cast<float>(v[i * cols + j]));
+    };
+    double mean = 0.0;
+    if (type == NormType::kLayerNorm) {
+      for (int64_t j = 0; j < cols; ++j) mean += value(x, j);
+      mean /= cols;
+    }
+    double var = 0.0;
+    for (int64_t j = 0; j < cols; ++j) {
+      var += (value(x, j) - mean) * (value(x, j) - mean);
+    }
+    var /= cols;
+    const double rstd = 1.0 / std::sqrt(var + epsilon);
+    ref.mean[i] = mean;
+    ref.rstd[i] = rstd;
+
+    double sum_g = 0.0;
+    double sum_gx = 0.0;
+    for (int64_t j = 0; j < cols; ++j) {
+      const double xhat = (value(x, j) - mean) * rstd;
+      ref.y[i * cols + j] = xhat * gamma[j] + beta[j];
+      const double g = value(dy, j) * gamma[j];
+      sum_g += g;
+      sum_gx += g * xhat;
+      ref.dgamma[j] += value(dy, j) * xhat;
+      ref.dbeta[j] += value(dy, j);
+    }
+    const double c1 = type == NormType::kLayerNorm ? sum_g / cols : 0.0;
+    const double c2 = sum_gx / cols;
+    for (int64_t j = 0; j < cols; ++j) {
+      const double xhat = (value(x, j) - mean) * rstd;
+      ref.dx[i * cols + j] = rstd * (value(dy, j) * gamma[j] - c1 - xhat * c2);
+    }
+  }
+  return ref;
+}
+
+template <typename T>
+void ExpectNear(const std::vector<T>& actual,
+                const std::vector<double>& expected,
+                double tolerance) {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < actual.size(); ++i) {
+    const double value = static_cast<float>(actual[i]);
+    EXPECT_NEAR(value, expected[i], tolerance * (1.0 + std::abs(expected[i])))
+        << "at " << i;
+  }
+}
+
+template <typename T>
+void TestNorm(NormType type, int64_t rows, int64_t cols, double tolerance) {
+  auto* dev_ctx = static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+  const float epsilon = 1e-5f;
+  auto x = RandomVector<T>(rows * cols, -1.0f, 3.0f);
+  auto dy = RandomVector<T>(rows * cols, -1.0f, 1.0f);
+  auto gamma = RandomVector<float>(cols, 0.5f, 1.5f);
+  auto beta = RandomVector<float>(cols, -0.5f, 0.5f);
+  if (type == NormType::kRmsNorm) beta.assign(cols, 0.0f);
+  NormReference ref = ComputeNormReference(
+      type, x, dy, gamma, beta, rows, cols, epsilon);
+
+  std::vector<T> y(rows * cols);
+  std::vector<float> mean(rows);
+  std::vector<float> var(rows);
+  std::vector<float> rstd(rows);
+  phi::funcs::NormForwardCPU<T, float>(
+      *dev_ctx,
+      type,
+      x.data(),
+      nullptr,
+      nullptr,
+      gamma.data(),
+      type == NormType::kLayerNorm ? beta.data() : nullptr,
+      rows,
+      cols,
+      epsilon,
+      nullptr,
+      y.data(),
+      type == NormType::kLayerNorm ? mean.data() : nullptr,
+      type == NormType::kLayerNorm ? var.data() : nullptr,
+      rstd.data());
+  ExpectNear(y, ref.y, tolerance);
+  ExpectNear(rstd, ref.rstd, 1e-4);
+  if (type == NormType::kLayerNorm) ExpectNear(mean, ref.mean, 1e-5);
+
+  std::vector<T> dx(rows * cols);
+  std::vector<float> dgamma(cols);
+  std::vector<float> dbeta(cols);
+  phi::funcs::NormBackwardCPU<T, float>(
+      *dev_ctx,
+      type,
+      x.data(),
+      dy.data(),
+      gamma.data(),
+      type == NormType::kLayerNorm ? mean.data() : nullptr,
+      rstd.data(),
+      rows,
+      cols,
+      dx.data(),
+      dgamma.data(),
+      dbeta.data());
+  ExpectNear(dx, ref.dx, tolerance);
+  ExpectNear(dgamma, ref.dgamma, 1e-4);
+  ExpectNear(dbeta, ref.dbeta, 1e-4);
+}
+
+TEST(fused_norm, layer_norm) {
+  for (int num_threads : {1, 4}) {
+    phi::SetIntraOpNumThreads(num_threads);
+    for (int64_t cols : {1, 13, 64, 768, 1000}) {
+      TestNorm<float>(NormType::kLayerNorm, 67, cols, 1e-4);
+      TestNorm<phi::dtype::bfloat16>(NormType::kLayerNorm, 67, cols, 1e-2);
+    }
+  }
+  phi::SetIntraOpNumThreads(1);
+}
+
+TEST(fused_norm, rms_norm) {
+  for (int num_threads : {1, 4}) {
+    phi::SetIntraOpNumThreads(num_threads);
+    for (int64_t cols : {1, 13, 64, 768, 1000}) {
+      TestNorm<float>(NormType::kRmsNorm, 67, cols, 1e-4);
+      TestNorm<phi::dtype::bfloat16>(NormType::kRmsNorm, 67, cols, 1e-2);
+    }
+  }
+  phi::SetIntraOpNumThreads(1);
+}
+
+TEST(fused_norm, rms_norm_residual) {
+  auto* dev_ctx = static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+  const int64_t rows = 5;
+  const int64_t cols = 37;
+  auto x = RandomVector<float>(rows * cols, -1.0f, 1.0f);
+  auto residual = RandomVector<float>(rows * cols, -1.0f, 1.0f);
+  auto bias = RandomVector<float>(cols, -1.0f, 1.0f);
+  auto gamma = RandomVector<float>(cols, 0.5f, 1.5f);
+  std::vector<float> residual_out(rows * cols);
+  std::vector<float> y(rows * cols);
+  phi::funcs::NormForwardCPU<float, float>(*dev_ctx,
+                                           NormType::kRmsNorm,
+                                           x.data(),
+                                           residual.data(),
+                                           bias.data(),
+                                           gamma.data(),
+                                           nullptr,
+                                           rows,
+                                           cols,
+                                           1e-6f,
+                                           residual_out.data(),
+                                           y.data(),
+                                           nullptr,
+                                           nullptr,
+                                           nullptr);
+
+  std::vector<double> expected_sum(rows * cols);
+  for (int64_t i = 0; i < rows * cols; ++i) {
+    expected_sum[i] = x[i] + residual[i] + bias[i % cols];
+  }
+  ExpectNear(residual_out, expected_sum, 1e-6);
+  std::vector<double> expected_y(rows * cols);
+  for (int64_t i = 0; i < rows; ++i) {
+    double square_sum = 0.0;
+    for (int64_t j = 0; j < cols; ++j) {
+      square_sum += expected_sum[i * cols + j] * expected_sum[i * cols + j];
+    }
+    const double rstd = 1.0 / std::sqrt(square_sum / cols + 1e-6);
+    for (int64_t j = 0; j < cols; ++j) {
+      expected_y[i * cols + j] = expected_sum[i * cols + j] * rstd * gamma[j];
+    }
+  }
+  ExpectNear(y, expected_y, 1e-5);
+}
+
+// Every instruction set this CPU has against the scalar code.
+TEST(fused_norm, row_funcs) {
+  std::vector<const phi::funcs::NormRowFuncs<float>*> row_funcs;
+  if (phi::backends::cpu::MayIUse(phi::backends::cpu::avx2) &&
+      phi::funcs::detail::GetNormRowFuncsAVX2() != nullptr) {
+    row_funcs.push_back(phi::funcs::detail::GetNormRowFuncsAVX2());
+  }
+  if (phi::backends::cpu::MayIUse(phi::backends::cpu::avx512f) &&
+      phi::funcs::detail::GetNormRowFuncsAVX512() != nullptr) {
+    row_funcs.push_back(phi::funcs::detail::GetNormRowFuncsAVX512());
+  }
+  const auto& ref = phi::funcs::GetNormRowFuncs<double>();
+  for (const auto* funcs : row_funcs) {
+    for (int64_t n : {1, 7, 8, 15, 16, 17, 33, 768, 1001}) {
+      auto x = RandomVector<float>(n, 2.0f, 4.0f);
+      auto dy = RandomVector<float>(n, -1.0f, 1.0f);
+      auto gamma = RandomVector<float>(n, 0.5f, 1.5f);
+      std::vector<double> x_ref(x.begin(), x.end());
+      std::vector<double> dy_ref(dy.begin(), dy.end());
+      std::vector<double> gamma_ref(gamma.begin(), gamma.end());
+
+      float mean = 0.0f;
+      float var = 0.0f;
+      double mean_ref = 0.0;
+      double var_ref = 0.0;
+      funcs->moments(x.data(), n, &mean, &var);
+      ref.moments(x_ref.data(), n, &mean_ref, &var_ref);
+      EXPECT_NEAR(mean, mean_ref, 1e-5);
+      EXPECT_NEAR(var, var_ref, 1e-5);
+      EXPECT_NEAR(funcs->mean_square(x.data(), n),
+                  ref.mean_square(x_ref.data(), n),
+                  1e-4);
+
+      const float rstd = 1.0f / std::sqrt(var + 1e-5f);
+      std::vector<float> dx(n);
+      std::vector<float> dgamma(n, 0.0f);
+      std::vector<double> dx_ref(n);
+      std::vector<double> dgamma_ref(n, 0.0);
+      funcs->backward_dx(dy.data(),
+                         x.data(),
+                         gamma.data(),
+                         n,
+                         mean,
+                         rstd,
+                         0.25f,
+                         0.5f,
+                         dx.data(),
+                         dgamma.data(),
+                         nullptr);
+      ref.backward_dx(dy_ref.data(),
+                      x_ref.data(),
+                      gamma_ref.data(),
+                      n,
+                      mean,
+                      rstd,
+                      0.25,
+                      0.5,
+                      dx_ref.data(),
+                      dgamma_ref.data(),
+                      nullptr);
+      ExpectNear(dx, dx_ref, 1e-5);
+      ExpectNear(dgamma, dgamma_ref, 1e-5);
+    }
+  }
+}
+
+// The chunks of rows may end in any order, dgamma and dbeta should still be
+// the same on every run.
+TEST(fused_norm, deterministic_backward) {
+  auto* dev_ctx = static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+  phi::SetIntraOpNumThreads(4);
+  const int64_t rows = 512;
+  const int64_t cols = 768;
+  auto x = RandomVector<float>(rows * cols, -1.0f, 1.0f);
+  auto dy = RandomVector<float>(rows * cols, -1.0f, 1.0f);
+  auto gamma = RandomVector<float>(cols, 0.5f, 1.5f);
+  auto mean = RandomVector<float>(rows, -0.1f, 0.1f);
+  auto rstd = RandomVector<float>(rows, 0.5f, 2.0f);
+  std::vector<float> first_dgamma;
+  std::vector<float> first_dbeta;
+  for (int run = 0; run < 20; ++run) {
+    std::vector<float> dgamma(cols);
+    std::vector<float> dbeta(cols);
+    phi::funcs::NormBackwardCPU<float, float>(*dev_ctx,
+                                              NormType::kLayerNorm,
+                                              x.data(),
+                                              dy.data(),
+                                              gamma.data(),
+                                              mean.data(),
+                                              rstd.data(),
+                                              rows,
+                                              cols,
+                                              nullptr,
+                                              dgamma.data(),
+                                              dbeta.data());
+    if (run == 0) {
+      first_dgamma = dgamma;
+      first_dbeta = dbeta;
+    } else {
+      EXPECT_TRUE(dgamma == first_dgamma);
+      EXPECT_TRUE(dbeta == first_dbeta);
+    }
+  }
+  phi::SetIntraOpNumThreads(1);
+}
+
+}  // namespace tests
+}  // namespace phi
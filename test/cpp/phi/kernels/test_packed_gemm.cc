@@ -0,0 +1,172 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/kernels/funcs/packed_gemm.h"
+
+COMMON_DECLARE_bool(cpu_gemm_pack_weight);
+
+namespace phi {
+namespace tests {
+
+phi::CPUContext* GetCPUContext() {
+  return static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+}
+
+void FillRandom(float* data, int64_t n) {
+  static unsigned int seed = 100;
+  std::mt19937 rng(seed++);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (int64_t i = 0; i < n; ++i) data[i] = dist(rng);
+}
+
+// C = op(A) * op(B) in double.
+std::vector<double> ReferenceGEMM(const float* a,
+                                  const float* b,
+                                  bool trans_a,
+                                  bool trans_b,
+                                  int M,
+                                  int N,
+                                  int K) {
+  std::vector<double> c(M * N, 0.0);
+  for (int m = 0; m < M; ++m) {
+    for (int n = 0; n < N; ++n) {
+      for (int k = 0; k < K; ++k) {
+        const float a_value = trans_a ? a[k * M + m] : a[m * K + k];
+        const float b_value = trans_b ? b[n * K + k] : b[k * N + n];
+        c[m * N + n] += static_cast<double>(a_value) * b_value;
+      }
+    }
+  }
+  return c;
+}
+
+TEST(packed_gemm, disabled) {
+  FLAGS_cpu_gemm_pack_weight = false;
+  auto* dev_ctx = GetCPUContext();
+  DenseTensor weight;
+  weight.Resize({4, 3});
+  dev_ctx->Alloc<float>(&weight);
+  std::vector<float> a(2 * 4, 1.0f);
+  std::vector<float> c(2 * 3, -1.0f);
+  EXPECT_FALSE(phi::funcs::GEMMWithPackedWeight<float>(*dev_ctx,
+                                                       false,
+                                                       2,
+                                                       3,
+                                                       4,
+                                                       a.data(),
+                                                       4,
+                                                       weight,
+                                                       false,
+                                                       3,
+                                                       0.0f,
+                                                       c.data(),
+                                                       3));
+  for (float value : c) EXPECT_EQ(value, -1.0f);
+}
+
+#ifdef PADDLE_WITH_MKLML
+bool PackedGEMM(const phi::CPUContext& dev_ctx,
+                bool trans_a,
+                bool trans_b,
+                int M,
+                int N,
+                int K,
+                const float* a,
+                const DenseTensor& weight,
+                float* c) {
+  return phi::funcs::GEMMWithPackedWeight<float>(dev_ctx,
+                                                 trans_a,
+                                                 M,
+                                                 N,
+                                                 K,
+                                                 a,
+                                                 trans_a ? M : K,
+                                                 weight,
+                                                 trans_b,
+                                                 trans_b ? K : N,
+                                                 0.0f,
+                                                 c,
+                                                 N);
+}
+
+TEST(packed_gemm, unmarked_weight) {
+  FLAGS_cpu_gemm_pack_weight = true;
+  auto* dev_ctx = GetCPUContext();
+  DenseTensor weight;
+  weight.Resize({4, 3});
+  dev_ctx->Alloc<float>(&weight);
+  std::vector<float> a(2 * 4, 1.0f);
+  std::vector<float> c(2 * 3, -1.0f);
+  // An activation is never marked, so it is never packed.
+  EXPECT_FALSE(PackedGEMM(
+      *dev_ctx, false, false, 2, 3, 4, a.data(), weight, c.data()));
+  EXPECT_EQ(phi::funcs::PackedWeightCacheSize(), 0UL);
+  for (float value : c) EXPECT_EQ(value, -1.0f);
+  FLAGS_cpu_gemm_pack_weight = false;
+}
+
+TEST(packed_gemm, reuse_and_repack) {
+  FLAGS_cpu_gemm_pack_weight = true;
+  auto* dev_ctx = GetCPUContext();
+  const int M = 37;
+  const int N = 65;
+  const int K = 130;
+  for (bool trans_a : {false, true}) {
+    for (bool trans_b : {false, true}) {
+      DenseTensor weight;
+      weight.Resize(trans_b ? common::make_ddim({N, K})
+                            : common::make_ddim({K, N}));
+      float* b = dev_ctx->Alloc<float>(&weight);
+      FillRandom(b, N * K);
+      phi::funcs::MarkPackableWeight(weight);
+      std::vector<float> a(M * K);
+      FillRandom(a.data(), M * K);
+      for (int run = 0; run < 4; ++run) {
+        if (run == 2) {
+          // A whole rewrite.
+          FillRandom(b, N * K);
+          weight.InplaceVersionCounter().Bump();
+        } else if (run == 3) {
+          // A single element rewritten, as a cache updated by one row per
+          // step would.
+          b[N * K / 2 + 1] += 10.0f;
+          weight.InplaceVersionCounter().Bump();
+        }
+        std::vector<float> c(M * N);
+        ASSERT_TRUE(PackedGEMM(
+            *dev_ctx, trans_a, trans_b, M, N, K, a.data(), weight, c.data()));
+        auto expected = ReferenceGEMM(a.data(), b, trans_a, trans_b, M, N, K);
+        for (int i = 0; i < M * N; ++i) {
+          EXPECT_NEAR(c[i], expected[i], 1e-3) << "at " << i;
+        }
+        EXPECT_EQ(phi::funcs::PackedWeightCacheSize(), 1UL);
+      }
+    }
+  }
+  // Every weight above is released.
+  EXPECT_EQ(phi::funcs::PackedWeightCacheSize(), 0UL);
+  FLAGS_cpu_gemm_pack_weight = false;
+}
+#endif
+
+}  // namespace tests
+}  // namespace phi
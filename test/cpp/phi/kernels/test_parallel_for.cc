@@ -0,0 +1,88 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/kernels/funcs/parallel_for.h"
+#include "paddle/phi/kernels/funcs/reduce_function.h"
+#include "paddle/phi/kernels/funcs/reduce_functor.h"
+
+namespace phi {
+namespace tests {
+
+TEST(parallel_for, chunks) {
+  auto* dev_ctx = static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+  phi::SetIntraOpNumThreads(4);
+
+  std::vector<int> visits(1000, 0);
+  std::atomic<int> num_chunks{0};
+  auto visit = [&](int64_t begin, int64_t end) {
+    ++num_chunks;
+    for (int64_t i = begin; i < end; ++i) ++visits[i];
+  };
+  // Too little work for more than one chunk.
+  phi::funcs::ParallelFor(*dev_ctx, 0, 1000, 1, visit);
+  EXPECT_EQ(num_chunks, 1);
+  phi::funcs::ParallelFor(*dev_ctx, 0, 1000, 1024, visit);
+  EXPECT_EQ(num_chunks, 5);
+  for (int count : visits) {
+    EXPECT_EQ(count, 2);
+  }
+
+  EXPECT_ANY_THROW(phi::funcs::ParallelFor(
+      *dev_ctx, 0, 1000, 1024, [](int64_t, int64_t end) {
+        PADDLE_ENFORCE_LT(
+            end, 1000, common::errors::InvalidArgument("The last chunk."));
+      }));
+  phi::SetIntraOpNumThreads(1);
+}
+
+TEST(parallel_for, reduce_rows) {
+  auto* dev_ctx = static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+  phi::DenseTensor x;
+  x.Resize({256, 512});
+  float* x_data = dev_ctx->template Alloc<float>(&x);
+  for (int64_t i = 0; i < x.numel(); ++i) {
+    x_data[i] = static_cast<float>(i % 7);
+  }
+
+  std::vector<float> expected;
+  for (int num_threads : {1, 4}) {
+    phi::SetIntraOpNumThreads(num_threads);
+    phi::DenseTensor out;
+    out.Resize({256});
+    phi::funcs::ReduceKernelImpl<phi::CPUContext,
+                                 float,
+                                 float,
+                                 phi::funcs::SumFunctor>(
+        *dev_ctx, x, &out, {1}, false, false);
+    const float* out_data = out.data<float>();
+    if (expected.empty()) {
+      expected.assign(out_data, out_data + out.numel());
+    } else {
+      for (int64_t i = 0; i < out.numel(); ++i) {
+        EXPECT_EQ(out_data[i], expected[i]);
+      }
+    }
+  }
+  phi::SetIntraOpNumThreads(1);
+}
+
+}  // namespace tests
+}  // namespace phi
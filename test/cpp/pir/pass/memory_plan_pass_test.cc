@@ -0,0 +1,113 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "paddle/fluid/framework/new_executor/interpretercore.h"
+#include "paddle/fluid/framework/new_executor/new_executor_defs.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_op.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/fluid/pir/transforms/general/memory_plan_pass.h"
+#include "paddle/fluid/pir/transforms/pd_op_to_kernel_pass.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/pir/include/core/builtin_attribute.h"
+#include "paddle/pir/include/core/builtin_op.h"
+#include "paddle/pir/include/core/ir_context.h"
+#include "paddle/pir/include/core/program.h"
+#include "paddle/pir/include/pass/pass_manager.h"
+
+PD_DECLARE_KERNEL(full, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(add, CPU, ALL_LAYOUT);
+
+namespace {
+
+constexpr int64_t kTensorBytes = 64 * 64 * sizeof(float);
+
+int64_t PlannedOffset(pir::Operation* op) {
+  if (!op->HasAttribute(paddle::framework::interpreter::kMemoryPlanOffsets)) {
+    return -1;
+  }
+  auto offsets = op->attribute<pir::ArrayAttribute>(
+      paddle::framework::interpreter::kMemoryPlanOffsets);
+  return offsets.at(0).dyn_cast<pir::Int64Attribute>().data();
+}
+
+}  // namespace
+
+TEST(memory_plan_pass, add_chain) {
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  pir::Program program(ctx);
+  pir::Builder builder(ctx, program.block());
+
+  // out = ((1 + 2) * 2) * 2 * 2, computed by adds of a tensor with itself.
+  auto x = builder.Build<paddle::dialect::FullOp>(
+      std::vector<int64_t>{64, 64}, 1.0, phi::DataType::FLOAT32);
+  auto y = builder.Build<paddle::dialect::FullOp>(
+      std::vector<int64_t>{64, 64}, 2.0, phi::DataType::FLOAT32);
+  pir::Value out =
+      builder.Build<paddle::dialect::AddOp>(x.out(), y.out()).out();
+  for (int i = 0; i < 3; ++i) {
+    out = builder.Build<paddle::dialect::AddOp>(out, out).out();
+  }
+  builder.Build<pir::ShadowOutputOp>(out, "out");
+
+  auto kernel_program = paddle::dialect::PdOpLowerToKernelPass(&program);
+  pir::PassManager pm(ctx);
+  pm.AddPass(pir::CreateMemoryPlanPass());
+  pm.Run(kernel_program.get());
+
+  // x, y and the first sum are live together, every later sum only with the
+  // one it is computed from, the output is not planned.
+  auto* module_op = kernel_program->module_op().operation();
+  ASSERT_TRUE(module_op->HasAttribute(
+      paddle::framework::interpreter::kMemoryPlanArenaSize));
+  EXPECT_EQ(module_op
+                ->attribute<pir::Int64Attribute>(
+                    paddle::framework::interpreter::kMemoryPlanArenaSize)
+                .data(),
+            3 * kTensorBytes);
+  std::vector<int64_t> offsets;
+  for (auto& op : *kernel_program->block()) {
+    if (op.isa<paddle::dialect::PhiKernelOp>()) {
+      offsets.push_back(PlannedOffset(&op));
+    }
+  }
+  ASSERT_EQ(offsets.size(), 6UL);
+  EXPECT_EQ(offsets[0], 0);
+  EXPECT_EQ(offsets[1], kTensorBytes);
+  EXPECT_EQ(offsets[2], 2 * kTensorBytes);
+  EXPECT_EQ(offsets[3], 0);
+  EXPECT_EQ(offsets[4], kTensorBytes);
+  EXPECT_EQ(offsets[5], -1);
+
+  paddle::framework::interpreter::ExecutionConfig execution_config;
+  execution_config.used_for_inference = true;
+  execution_config.skip_gc_vars.insert("out");
+  paddle::framework::Scope scope;
+  paddle::framework::InterpreterCore core(
+      phi::CPUPlace(), {}, kernel_program->block(), &scope, execution_config);
+  for (int run = 0; run < 2; ++run) {
+    core.Run({});
+    const paddle::framework::Scope* out_scope =
+        core.local_scope() == nullptr ? &scope : core.local_scope();
+    const auto& out_tensor =
+        out_scope->FindVar("out")->Get<phi::DenseTensor>();
+    ASSERT_EQ(out_tensor.numel(), 64 * 64);
+    for (int64_t i = 0; i < out_tensor.numel(); ++i) {
+      ASSERT_FLOAT_EQ(out_tensor.data<float>()[i], 24.0f);
+    }
+  }
+}
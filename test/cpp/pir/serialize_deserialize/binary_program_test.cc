@@ -0,0 +1,114 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/fluid/pir/serialize_deserialize/include/interface.h"
+#include "paddle/pir/include/core/builtin_dialect.h"
+#include "paddle/pir/include/core/builtin_op.h"
+#include "paddle/pir/include/core/program.h"
+
+namespace {
+
+std::string ProgramString(const pir::Program& program) {
+  std::ostringstream os;
+  program.Print(os);
+  return os.str();
+}
+
+std::string ReadFile(const std::string& file_path) {
+  std::ifstream fin(file_path, std::ios::binary);
+  return std::string((std::istreambuf_iterator<char>(fin)),
+                     std::istreambuf_iterator<char>());
+}
+
+}  // namespace
+
+TEST(binary_program, save_load) {
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<pir::BuiltinDialect>();
+  pir::Program program(ctx);
+  pir::Builder builder = pir::Builder(ctx, program.block());
+
+  pir::Value sum = builder
+                       .Build<paddle::dialect::FullOp>(
+                           std::vector<int64_t>{64, 64}, 1.5)
+                       .out();
+  for (int i = 0; i < 16; ++i) {
+    auto full_op = builder.Build<paddle::dialect::FullOp>(
+        std::vector<int64_t>{64, 64}, -0.5 * i);
+    sum = builder.Build<paddle::dialect::AddOp>(sum, full_op.out()).out();
+  }
+  builder.Build<pir::ShadowOutputOp>(sum, "out");
+
+  pir::WriteModule(program,
+                   "./binary_program.json",
+                   /*pir_version*/ 0,
+                   true,
+                   false,
+                   true);
+  pir::WriteModule(program,
+                   "./binary_program.pdmodel",
+                   /*pir_version*/ 0,
+                   true,
+                   false,
+                   true,
+                   /*binary*/ true);
+  EXPECT_LT(std::filesystem::file_size("./binary_program.pdmodel"),
+            std::filesystem::file_size("./binary_program.json"));
+
+  pir::Program json_program(ctx);
+  EXPECT_TRUE(pir::ReadModule(
+      "./binary_program.json", &json_program, /*pir_version*/ 0));
+  pir::Program binary_program(ctx);
+  EXPECT_TRUE(pir::ReadModule(
+      "./binary_program.pdmodel", &binary_program, /*pir_version*/ 0));
+  EXPECT_EQ(binary_program.block()->size(), program.block()->size());
+  EXPECT_EQ(ProgramString(binary_program), ProgramString(json_program));
+}
+
+TEST(binary_program, damaged_file) {
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  pir::Program program(ctx);
+  pir::Builder builder = pir::Builder(ctx, program.block());
+  auto full_op = builder.Build<paddle::dialect::FullOp>(
+      std::vector<int64_t>{8}, 2.0);
+  builder.Build<pir::ShadowOutputOp>(full_op.out(), "out");
+  pir::WriteModule(program,
+                   "./binary_program_full.pdmodel",
+                   /*pir_version*/ 0,
+                   true,
+                   false,
+                   true,
+                   /*binary*/ true);
+
+  std::string data = ReadFile("./binary_program_full.pdmodel");
+  for (size_t size : {data.size() / 2, data.size() - 1}) {
+    std::ofstream fout("./binary_program_damaged.pdmodel", std::ios::binary);
+    fout.write(data.data(), size);
+    fout.close();
+    pir::Program damaged_program(ctx);
+    EXPECT_ANY_THROW(pir::ReadModule(
+        "./binary_program_damaged.pdmodel", &damaged_program, 0));
+  }
+}